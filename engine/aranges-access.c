@@ -29,6 +29,8 @@
 #include "util.h"
 #include "aranges-access.h"
 #include "dwarf-ranges.h"
+#include "dwarf-util.h"
+#include "index-cache.h"
 
 /*
  *
@@ -45,6 +47,16 @@ struct cu_arange_desc_struct
 	ARM_CORE_WORD		addr;
 	/*! size of this address range, in bytes */
 	ARM_CORE_WORD		len;
+	/*! the highest end address (exclusive) of all address ranges in the range table up to, and including, this one
+	 *
+	 * the range table is sorted by ascending start address,
+	 * but ranges in it may overlap (and a range may even be
+	 * completely contained within a range that precedes it in the
+	 * table); this field makes it possible to tell, when scanning the
+	 * table backwards from some position, that no range preceding
+	 * (and including) this one can contain a given address, so that
+	 * the scan can be stopped; see aranges_lookup() for details */
+	ARM_CORE_WORD		max_end;
 };
 
 /*! address range data structure for an executable
@@ -61,6 +73,52 @@ struct cu_aranges
 	int					range_cnt;
 };
 
+/*! scope table for a compilation unit
+ *
+ * this holds a flattened view of all scope debug information
+ * nodes (subprograms, lexical blocks and inline-expanded
+ * subprograms) of a compilation unit that have code address
+ * ranges associated with them; it is used for quickly
+ * locating the chain of scopes that contain a given address,
+ * see scope_tab_lookup() for details
+ *
+ * the scope tree structure is recorded in the parent links of
+ * the scope nodes, and it is taken from the debug information
+ * tree (i.e. the nesting of the die-s), and *not* from the nesting
+ * of the address ranges of the scopes - for some reasoning on this,
+ * see the comments in scope_tab_lookup() */
+struct cu_scope_tab
+{
+	/*! the number of elements in the nodes array below */
+	int				nr_nodes;
+	/*! the scope nodes, in debug information tree preorder; parents always precede their children */
+	struct scope_chain_node		* nodes;
+	/*! the number of elements in the ranges array below */
+	int				nr_ranges;
+	/*! the address ranges of all scope nodes above
+	 *
+	 * every (nonempty) address range of every scope node has an
+	 * entry here; this array is sorted by ascending start address,
+	 * and ranges starting at the same address are sorted by
+	 * ascending scope nesting depth */
+	struct scope_range
+	{
+		/*! start address (inclusive) of the address range */
+		ARM_CORE_WORD			lo;
+		/*! end address (exclusive) of the address range */
+		ARM_CORE_WORD			hi;
+		/*! the highest end address (exclusive) of all address ranges in the ranges array up to, and including, this one
+		 *
+		 * this has the same purpose as the ::max_end field of
+		 * the compilation unit address range descriptors above,
+		 * see aranges_lookup() for details */
+		ARM_CORE_WORD			max_end;
+		/*! the scope node that this address range belongs to */
+		struct scope_chain_node		* node;
+	}
+	* ranges;
+};
+
 
 
 /*
@@ -69,271 +127,218 @@ struct cu_aranges
  *
  */
 
-
 /*!
- *	\fn	static void find_subprogram_and_lexblock_for_addr(struct gear_engine_context * ctx, struct subprogram_data * subp, int addr, struct cu_data * cu, struct subprogram_data ** ret_subp, struct lexblock_data ** ret_lexblock)
- *	\brief	for a given subprogram node and a given address of interest, returns the most deeply nested lexical block (if any) and inline-expanded suprogram (if any) nodes containing the given address
- *
- *	\note	the basic mechanism of operation of this function
- *		is outlined in the comments below in the function
- *
- *	\param	ctx	gear engine context to work in
- *	\param	subp	the subprogram of interest in which to scan
- *			for lexical blocks and inline-expanded
- *			subprograms containing the given address
- *	\param	addr	address of interest for which to scan this
- *			subprogram for descendant lexical blocks and
- *			inline-expanded subprograms
- *	\param	cu	compilation unit containing the given
- *			subprogram, needed for retrieving the
- *			value of the compilation unit base address
- *			used in address range computations
- *	\param	ret_subp	a pointer to a variable in which
- *				to store the most deeply nested
- *				inline-expanded subprogram node of
- *				this subprogram,
- *				containing the given address
- *	\param	ret_lexblock	a pointer to a variable in which
- *				to store the most deeply nested
- *				lexical block node of
- *				this subprogram,
- *				containing the given address
- *	\return	none */
-static void find_subprogram_and_lexblock_for_addr(struct gear_engine_context * ctx,
-		struct subprogram_data * subp,
-		int addr,
-		struct cu_data * cu,
-		struct subprogram_data ** ret_subp,
-		struct lexblock_data ** ret_lexblock)
+ *	\fn	static struct cu_arange_desc_struct * aranges_lookup(struct cu_aranges * aranges, ARM_CORE_WORD addr)
+ *	\brief	locates the address range descriptor containing a given address
+ *
+ *	the range table is sorted by ascending start address, so a
+ *	binary search is first used to locate the last range which
+ *	starts at, or below, the address of interest; ranges are
+ *	half-open intervals ([addr; addr + len)), so of two adjacent
+ *	ranges, the one starting at the address of interest is
+ *	always the one found; if the range found does not contain
+ *	the address (this is possible when ranges overlap), the
+ *	table is scanned backwards for a containing range, until
+ *	the ::max_end field of a descriptor shows that no range
+ *	at or below it can contain the address
+ *
+ *	\note	if several ranges contain the address of interest, the
+ *		one with the highest start address (i.e., the most
+ *		specific one) is returned
+ *
+ *	\param	aranges	the address range table to search
+ *	\param	addr	the address of interest
+ *	\return	a pointer to the range descriptor containing
+ *		the address of interest, or null, if not found
+ */
+static struct cu_arange_desc_struct * aranges_lookup(struct cu_aranges * aranges, ARM_CORE_WORD addr)
 {
-#if 0
-	void scan_subp(struct subprogram_data * subp)
-	{
-
-		void scan_lexblock(struct lexblock_data * lexblock)
-
-		{
-			struct lexblock_data * l;
-			struct subprogram_data * s;
-
-			if (dwarf_ranges_is_in_range(ctx, lexblock->addr_ranges, addr,
-						cu->default_cu_base_address))
-				* ret_lexblock = lexblock;
-			for (l = lexblock->lexblocks; l; l = l->sib_ptr)
-				scan_lexblock(l);
-			for (s = lexblock->inlined_subprograms; s; s = s->sib_ptr)
-				scan_subp(s);
-
-		}
-
-		struct lexblock_data * l;
-		struct subprogram_data * s;
-
-		gprintf("%s(): scanning subprogram node %s\n", __func__, subp->name);
-		if (dwarf_ranges_is_in_range(ctx, subp->addr_ranges, addr,
-					cu->default_cu_base_address))
-			* ret_subp = subp;
-		for (l = subp->lexblocks; l; l = l->sib_ptr)
-			scan_lexblock(l);
-		for (s = subp->inlined_subprograms; s; s = s->sib_ptr)
-			scan_subp(s);
+struct cu_arange_desc_struct * p;
+int lo, hi, mid;
 
+	p = aranges->range_tab;
+	/* find the number of ranges starting at, or below, addr */
+	lo = 0;
+	hi = aranges->range_cnt;
+	while (lo < hi)
+	{
+		mid = lo + ((hi - lo) >> 1);
+		if (p[mid].addr <= addr)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
-	* ret_subp = 0;
-	* ret_lexblock = 0;
+	/* scan backwards for a range containing addr; the range
+	 * start is known to be at, or below, addr here, so compare
+	 * against the range length, which cannot overflow the way
+	 * the range end address can, for ranges at the very
+	 * top of the address space */
+	while (lo-- > 0 && addr < p[lo].max_end)
+		if (addr - p[lo].addr < p[lo].len)
+			return p + lo;
+	return 0;
+}
 
-	if (subp)
-		scan_subp(subp);
 
-#else
+/*!
+ *	\fn	static struct cu_scope_tab * get_cu_scope_tab(struct gear_engine_context * ctx, struct cu_data * cu)
+ *	\brief	retrieves the scope table of a compilation unit, building it first, if necessary
+ *
+ *	the scope table is built on first use; all subprograms of the
+ *	compilation unit are walked, descending into their lexical
+ *	blocks and inline-expanded subprograms (and their lexical blocks
+ *	and inline-expanded subprograms, and so on), and a scope node
+ *	is made for each of these; this is done in two passes - the first
+ *	one counts the scope nodes and address ranges, so that the
+ *	tables can be allocated at once, and the second one fills them
+ *
+ *	\param	ctx	gear engine context
+ *	\param	cu	the compilation unit of interest
+ *	\return	the scope table for the compilation unit
+ */
+static struct cu_scope_tab * get_cu_scope_tab(struct gear_engine_context * ctx, struct cu_data * cu)
+{
+struct cu_scope_tab * tab;
+struct subprogram_data * subp;
+struct scope_range * r;
+int i;
+bool is_counting;
 
-	struct subprogram_data * s, * saved_subp;
-	struct lexblock_data * l, * saved_lexblock;
+int scope_range_compare(struct scope_range * arg1, struct scope_range * arg2)
+{
+	if (arg1->lo != arg2->lo)
+		return (arg1->lo < arg2->lo) ? -1 : 1;
+	if (arg1->node->depth != arg2->node->depth)
+		return (arg1->node->depth < arg2->node->depth) ? -1 : 1;
+	return 0;
+}
 
-	if (!subp || !dwarf_ranges_is_in_range(ctx, subp->addr_ranges, addr,
-				cu->default_cu_base_address))
+void add_scope(struct dwarf_head_struct * scope, struct dwarf_ranges_struct * addr_ranges,
+		struct lexblock_data * lexblocks, struct subprogram_data * subps,
+		struct scope_chain_node * parent, int depth)
+{
+struct scope_chain_node * node;
+struct lexblock_data * l;
+struct subprogram_data * s;
+ARM_CORE_WORD lo, hi;
+int i, nr_ranges;
+
+	node = 0;
+	if (!is_counting)
 	{
-		* ret_subp = 0;
-		* ret_lexblock = 0;
-		return;
+		node = tab->nodes + tab->nr_nodes;
+		node->scope = scope;
+		node->parent = parent;
+		node->depth = depth;
 	}
-
-	saved_subp = subp;
-	saved_lexblock = 0;
-	/* this subprogram may have inline-expanded subprogram nodes,
-	 * some of which actually contain the address of interest;
-	 * dive in this subprogram looking for any such
-	 * inline-expanded subprograms
-	 *
-	 * as these subprograms may actually be not direct children
-	 * of this subprogram node, but rather children of lexical
-	 * blocks belonging to this subprogram node, also handle
-	 * any lexical blocks contained within this subprogram node
-	 *
-	 * the loop below consists of four basic steps; starting from within
-	 * an address-matching subprogram node:
-	 *	(1) scanning immediate descendant inline-expanded
-	 *	subprogram nodes, if a match has been found, repeat
-	 *	the scan, until no new match has been found; then,
-	 *	in the last matching inline-expanded subprogram perform:
-	 *		(2) scanning immediate descendant lexical block nodes,
-	 *		in the last matching lexical block perform:
-	 *			(3) scanning of immediate descendant
-	 *			lexical block nodes, and - as in step 1 -
-	 *			repeat the scan until no new match has
-	 *			been found; then, in the last
-	 *			matching node perform:
-	 *				(4) scanning of immediate descendant
-	 *				inline-expanded subprogram nodes
-	 *
-	 * so at the end of the last (fourth) step, what is obtained
-	 * is an inline-expanded subprogram node, to which these
-	 * four steps are successively applied until no further
-	 * progress is possible - no further progress is possible
-	 * if at the end of the second step no lexical block has
-	 * been found, or at the end of the fourth step no subprogram
-	 * node has been found */
-	do
+	tab->nr_nodes++;
+	nr_ranges = dwarf_ranges_get_range_count(ctx, addr_ranges);
+	for (i = 0; i < nr_ranges; i++)
 	{
-		gprintf("%s(): scanning subprogram %s\n", __func__, saved_subp->name);
-		/* first, scan direct inline-expanded subprogram descendants
-		 * of the last subprogram matched, and repeat the scan on
-		 * the matched subprograms until no more matches are found */
-		do
+		dwarf_ranges_get_range_data_at_idx(ctx, addr_ranges, i,
+				cu->default_cu_base_address, &lo, &hi);
+		if (lo >= hi)
+			/* empty range, ignore it */
+			continue;
+		if (!is_counting)
 		{
-			for (s = saved_subp->inlined_subprograms; s; s = s->sib_ptr)
-			{
-				gprintf("%s(): scanning child subprogram %s\n", __func__, s->name);
-				if (dwarf_ranges_is_in_range(ctx, s->addr_ranges, addr,
-							cu->default_cu_base_address))
-				{
-					/* match found */
-					gprintf("%s(): matched child subprogram %s\n", __func__, s->name);
-					saved_subp = s;
-					break;
-				}
-			}
+			tab->ranges[tab->nr_ranges].lo = lo;
+			tab->ranges[tab->nr_ranges].hi = hi;
+			tab->ranges[tab->nr_ranges].node = node;
 		}
-		while (s);
-
-		/* second, scan the last matching subprogram's lexical blocks (if any) */
-		for (l = saved_subp->lexblocks; l; l = l->sib_ptr)
-			if (dwarf_ranges_is_in_range(ctx, l->addr_ranges, addr,
-						cu->default_cu_base_address))
-			{
-				/* match found */
-				saved_lexblock = l;
-				break;
-			}
-
-		if (!l)
-			/* no further progress possible */
-		{
-			/* shopov 02082010: however, there are some quirks here...
-			 * i(sgs) could not really find in the dwarf4 standard
-			 * any explicit notion of the intuitively reasonable
-			 * assumption that any dwarf die-s that have code
-			 * address range information associated with them
-			 * (be it a DW_AT_low_pc/DW_AT_high_pc pair or a
-			 * DW_AT_ranges attribute), and which contain other
-			 * die-s that also have code address information,
-			 * should actually have all of their children die-s'
-			 * code address ranges contained within their - i.e.
-			 * the common parent's - code address ranges; in short,
-			 * i could not find any notion in the dwarf4 standard
-			 * that a die that has code address ranges will contain
-			 * in these ranges all of the ranges of any children
-			 * die-s that also have address ranges...
-			 *
-			 * some torture tests were ran with gcc 4.5.0 on this
-			 * code sample:
-
-			 volatile int x;
-
-			 .....
-
-
-			 int fhack(int (*fptr_1)(int ccc))
-			 {
-			 return x + x - 10 * fptr_1(x++ + ++x);
-			 }
-
-			 static inline int f0(void)
-			 {
-			 if (x == 0)
-			 {
-			 __label__ failure;
-			 volatile int * xxx = &x;
-			 inline int fff(int i)
-			 {
-			 if (!i)
-			 goto failure;
-			 return x + i;
-			 }
-			 return fff(*xxx) * fff(10 + xxx[1]) / fff(x - 1) - fhack(fff);
-failure:
-return 10;
-}
-else
-{
-volatile int * yyy = &x;
-if (!x && *yyy)
-return *yyy;
-else
-return 100;
-}
+		tab->nr_ranges++;
+	}
+	for (l = lexblocks; l; l = l->sib_ptr)
+		add_scope(&l->head, l->addr_ranges, l->lexblocks, l->inlined_subprograms, node, depth + 1);
+	for (s = subps; s; s = s->sib_ptr)
+		add_scope(&s->head, s->addr_ranges, s->lexblocks, s->inlined_subprograms, node, depth + 1);
 }
 
-			 * now, the dwarf generated by gcc had a
-			 * DW_AT_ranges attribute generated for the
-			 * lexical block containing the nested fff()
-			 * function, and this lexical block's address
-			 * range did not contain the address range
-			 * generated for fff(), therefore the tests
-			 * in these function will fail and the fff()
-			 * function will not be reached in the scans
-			 * in this function... however - one thing
-			 * is very important - the function is nested,
-			 * but *not* inlined - so i(sgs) am not at all
-			 * sure what should be done in this case...
-			 *
-			 * as i(sgs) could not find any formal indication
-			 * that what gcc does is non-conforming with the
-			 * standard, i(sgs) add here a few more tests
-			 * to hopefully handle cases as the one described
-			 * above better... */
-		/*! \todo	not actually done right now, code this... */
-		break;
-		}
-/* third, scan direct lexical blocks of the last
- * lexical block matched, and repeat the scan until
- * no more matches are found */
-do
-{
-	for (l = saved_lexblock->lexblocks; l; l = l->sib_ptr)
-		if (dwarf_ranges_is_in_range(ctx, l->addr_ranges, addr,
-					cu->default_cu_base_address))
-		{
-			/* match found */
-			saved_lexblock = l;
-			break;
-		}
+	if (cu->scope_tab)
+		return cu->scope_tab;
+	if (!(tab = calloc(1, sizeof * tab)))
+		panic("out of core");
+	/* first pass - count scope nodes and address ranges */
+	is_counting = true;
+	for (subp = cu->subs; subp; subp = subp->sib_ptr)
+		add_scope(&subp->head, subp->addr_ranges, subp->lexblocks, subp->inlined_subprograms, 0, 0);
+	if (tab->nr_nodes && !(tab->nodes = calloc(tab->nr_nodes, sizeof * tab->nodes)))
+		panic("out of core");
+	if (tab->nr_ranges && !(tab->ranges = calloc(tab->nr_ranges, sizeof * tab->ranges)))
+		panic("out of core");
+	/* second pass - fill the tables */
+	is_counting = false;
+	tab->nr_nodes = tab->nr_ranges = 0;
+	for (subp = cu->subs; subp; subp = subp->sib_ptr)
+		add_scope(&subp->head, subp->addr_ranges, subp->lexblocks, subp->inlined_subprograms, 0, 0);
+	qsort(tab->ranges, tab->nr_ranges, sizeof * tab->ranges,
+			(int (*)(const void *, const void *)) scope_range_compare);
+	for (i = 0, r = tab->ranges; i < tab->nr_ranges; i++, r++)
+		r->max_end = (i && r[-1].max_end > r->hi) ? r[-1].max_end : r->hi;
+
+	return cu->scope_tab = tab;
 }
-while (l);
 
-	for (s = saved_lexblock->inlined_subprograms; s; s = s->sib_ptr)
-if (dwarf_ranges_is_in_range(ctx, s->addr_ranges, addr,
-			cu->default_cu_base_address))
+/*!
+ *	\fn	static struct scope_chain_node * scope_tab_lookup(struct cu_scope_tab * tab, ARM_CORE_WORD addr)
+ *	\brief	locates the most deeply nested scope node containing a given address
+ *
+ *	the ranges table is searched in the same way as the compilation
+ *	unit address range table is searched in aranges_lookup() - a
+ *	binary search locates the last range starting at, or below, the
+ *	address of interest, and the table is then scanned backwards
+ *	for as long as the ::max_end fields show that there may be ranges
+ *	containing the address; of all ranges containing the address,
+ *	the one belonging to the most deeply nested scope node is
+ *	taken; the chain of scopes containing the address is then simply
+ *	the list formed by the parent links of this node
+ *
+ *	shopov 02082010: there are some quirks here...
+ *	i(sgs) could not really find in the dwarf4 standard any
+ *	explicit notion of the intuitively reasonable assumption
+ *	that a die that has code address ranges will contain in these
+ *	ranges all of the ranges of any children die-s that also have
+ *	address ranges; and indeed, with gcc 4.5.0, for function f0()
+ *	in gemstones/inline-tests.c, the dwarf generated had a
+ *	DW_AT_ranges attribute generated for the lexical block containing
+ *	the nested fff() function, and this lexical block's address
+ *	range did not contain the address range generated for fff();
+ *	searching scopes top-down, descending only into scopes that
+ *	contain the address of interest, therefore never reaches
+ *	fff() - this is why here all scopes are searched at once, and the
+ *	scope nesting is taken from the debug information tree
+ *	instead
+ *
+ *	\param	tab	the scope table to search
+ *	\param	addr	the address of interest
+ *	\return	the most deeply nested scope node containing the address
+ *		of interest, or null, if no scope node contains the address
+ */
+static struct scope_chain_node * scope_tab_lookup(struct cu_scope_tab * tab, ARM_CORE_WORD addr)
 {
-	saved_subp = s;
-	break;
-}
-}
-while (s);
-
-* ret_subp = saved_subp;
-* ret_lexblock = saved_lexblock;
-#endif
+struct scope_range * r;
+struct scope_chain_node * node;
+int lo, hi, mid;
+
+	r = tab->ranges;
+	/* find the number of ranges starting at, or below, addr */
+	lo = 0;
+	hi = tab->nr_ranges;
+	while (lo < hi)
+	{
+		mid = lo + ((hi - lo) >> 1);
+		if (r[mid].lo <= addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	/* scan backwards for the most deeply nested
+	 * scope with a range containing addr */
+	node = 0;
+	while (lo-- > 0 && addr < r[lo].max_end)
+		if (addr < r[lo].hi && (!node || r[lo].node->depth > node->depth))
+			node = r[lo].node;
+	return node;
 }
 
 /*
@@ -360,23 +365,86 @@ while (s);
 struct cu_data * aranges_get_cu_for_addr(struct gear_engine_context * ctx, ARM_CORE_WORD addr)
 {
 struct cu_arange_desc_struct * p;
-int i;
 
-	p = ctx->cu_aranges->range_tab;
-	i = ctx->cu_aranges->range_cnt;
-	while (i)
-	{
-		if (p->addr <= addr && addr < p->addr + p->len)
-			break;
-		p++;
-		i--;
-	}
-	if (!i)
+	if (!(p = aranges_lookup(ctx->cu_aranges, addr)))
 		return 0;
 
 	return cu_process(ctx, p->cu_die_offset);
 }
 
+/*!
+ *	\fn	void aranges_discard_cu_scope_tab(struct cu_data * cu)
+ *	\brief	deallocates the scope table of a compilation unit, if one has been built
+ *
+ *	\param	cu	the compilation unit of interest
+ *	\return	none
+ */
+void aranges_discard_cu_scope_tab(struct cu_data * cu)
+{
+	if (!cu->scope_tab)
+		return;
+	free(cu->scope_tab->nodes);
+	free(cu->scope_tab->ranges);
+	free(cu->scope_tab);
+	cu->scope_tab = 0;
+}
+
+/*!
+ *	\fn	bool aranges_get_cu_die_offset_for_addr(struct gear_engine_context * ctx, ARM_CORE_WORD addr, Dwarf_Off * cu_die_offset)
+ *	\brief	locates which compilation unit contains a given address, without building the compilation unit tree
+ *
+ *	\param	ctx	gear engine context
+ *	\param	addr	the address of interest
+ *	\param	cu_die_offset	a pointer to where to store the die offset
+ *				of the compilation unit containing the address
+ *	\return	true, if a compilation unit containing the address
+ *		was found, false otherwise
+ */
+bool aranges_get_cu_die_offset_for_addr(struct gear_engine_context * ctx, ARM_CORE_WORD addr, Dwarf_Off * cu_die_offset)
+{
+struct cu_arange_desc_struct * p;
+
+	if (!(p = aranges_lookup(ctx->cu_aranges, addr)))
+		return false;
+	* cu_die_offset = p->cu_die_offset;
+	return true;
+}
+
+/*!
+ *	\fn	struct scope_chain_node * aranges_get_scope_chain_for_addr(struct gear_engine_context * ctx, ARM_CORE_WORD addr, struct cu_data ** cu)
+ *	\brief	retrieves the chain of scopes containing a given address
+ *
+ *	the chain of scopes is returned as the most deeply nested scope
+ *	containing the address of interest - the enclosing scopes are
+ *	reached by following the ::parent links of the scope nodes, up
+ *	to the top level subprogram containing the address; i.e.,
+ *	the chain runs from the innermost lexical block or
+ *	inline-expanded subprogram, outwards through any enclosing
+ *	lexical blocks and inline-expanded subprograms, to the
+ *	top level subprogram; this one is used for execution context
+ *	determination, and for identifier scope resolution
+ *
+ *	\param	ctx	gear engine context
+ *	\param	addr	the address of interest
+ *	\param	cu	a pointer to where to store the compilation unit
+ *			containing the address of interest; can be null,
+ *			if this is not needed
+ *	\return	the most deeply nested scope node containing the
+ *		address of interest, or null, if no such scope is found
+ */
+struct scope_chain_node * aranges_get_scope_chain_for_addr(struct gear_engine_context * ctx, ARM_CORE_WORD addr, struct cu_data ** cu)
+{
+struct cu_data * p;
+
+	if (cu)
+		* cu = 0;
+	if (!(p = aranges_get_cu_for_addr(ctx, addr)))
+		/* compilation unit not found */
+		return 0;
+	if (cu)
+		* cu = p;
+	return scope_tab_lookup(get_cu_scope_tab(ctx, p), addr);
+}
 
 /*!
  *	\fn	struct subprogram_data * aranges_get_subp_for_addr(struct gear_engine_context * ctx, ARM_CORE_WORD addr)
@@ -386,6 +454,12 @@ int i;
  *	unit that contains the address; this one is used for execution context
  *	determination
  *
+ *	\note	inline-expanded subprograms are skipped, the subprogram
+ *		returned is the one which actually owns the machine code
+ *		(and the frame) at the given address; this is normally
+ *		a top level subprogram, but may also be a nested (non-inlined)
+ *		subprogram
+ *
  *	\param	ctx	gear engine context
  *	\param	addr	the address of interest
  *	\return	pointer to the subprogram_data structure for the function containing the
@@ -393,36 +467,27 @@ int i;
  */
 struct subprogram_data * aranges_get_subp_for_addr(struct gear_engine_context * ctx, ARM_CORE_WORD addr)
 {
-struct cu_data * cu;
+struct scope_chain_node * scope;
 struct subprogram_data * subp;
-struct lexblock_data * dummy_lexblock;
-
-	if (!(cu = aranges_get_cu_for_addr(ctx, addr)))
-		/* compilation unit not found */
-		return 0;
-	/* ok, locate the subprogram within the compilation unit */
-	subp = cu->subs;
 
-	while (subp)
+	for (scope = aranges_get_scope_chain_for_addr(ctx, addr, 0); scope; scope = scope->parent)
 	{
-		if (dwarf_ranges_is_in_range(ctx, subp->addr_ranges, addr,
-					cu->default_cu_base_address))
+		if (dwarf_util_get_tag_category(scope->scope->tag) != DWARF_TAG_CATEGORY_SUBPROGRAM)
+			continue;
+		subp = (struct subprogram_data *) scope->scope;
+		if (!subp->is_concrete_inline_instance_root)
 			/* match found */
-			break;
-		subp = subp->sib_ptr;
+			return subp;
 	}
-	return subp;
-
-	find_subprogram_and_lexblock_for_addr(ctx, subp, addr, cu, &subp, &dummy_lexblock);
-	return subp;
+	return 0;
 }
 
 /*!
  *	\fn	struct lexblock_data * aranges_get_lexblock_for_addr(struct gear_engine_context * ctx, ARM_CORE_WORD addr)
- *	\brief	locates which subprogram contains a given address
+ *	\brief	locates which lexical block contains a given address
  *
- *	given an address, retrieves the lexical block within
- *	the subroutine that contains the address; this one is used for
+ *	given an address, retrieves the most deeply nested lexical
+ *	block that contains the address; this one is used for
  *	execution context determination
  *
  *	\param	ctx	gear engine context
@@ -433,25 +498,91 @@ struct lexblock_data * dummy_lexblock;
  */
 struct lexblock_data * aranges_get_lexblock_for_addr(struct gear_engine_context * ctx, ARM_CORE_WORD addr)
 {
-struct cu_data * cu;
-struct subprogram_data * subp;
-struct lexblock_data * lexblock;
+struct scope_chain_node * scope;
 
-	if (!(cu = aranges_get_cu_for_addr(ctx, addr)))
-		/* compilation unit not found */
-		return 0;
-	if (!(subp = aranges_get_subp_for_addr(ctx, addr)))
-		/* subprogram not found */
-		return 0;
-	find_subprogram_and_lexblock_for_addr(ctx, subp, addr, cu, &subp, &lexblock);
+	for (scope = aranges_get_scope_chain_for_addr(ctx, addr, 0); scope; scope = scope->parent)
+		if (dwarf_util_get_tag_category(scope->scope->tag) == DWARF_TAG_CATEGORY_LEXBLOCK)
+			return (struct lexblock_data *) scope->scope;
+	return 0;
+}
+
+/*!
+ *	\fn	void aranges_save_index(struct gear_engine_context * ctx, struct index_cache_cursor * c)
+ *	\brief	stores the compilation unit address range table in an in-core index cache image
+ *
+ *	the range table is stored as it is (i.e., already sorted,
+ *	and with the ::max_end fields computed); for details, see
+ *	the comments in index-cache.c
+ *
+ *	\param	ctx	gear engine context
+ *	\param	c	the in-core index cache image to store the table in
+ *	\return	none
+ */
+void aranges_save_index(struct gear_engine_context * ctx, struct index_cache_cursor * c)
+{
+	if (!ctx->cu_aranges)
+		panic("");
+	index_cache_put(c, &ctx->cu_aranges->range_cnt, sizeof ctx->cu_aranges->range_cnt);
+	index_cache_put(c, ctx->cu_aranges->range_tab,
+			ctx->cu_aranges->range_cnt * sizeof * ctx->cu_aranges->range_tab);
+}
+
+/*!
+ *	\fn	bool aranges_restore_index(struct gear_engine_context * ctx, struct index_cache_cursor * c)
+ *	\brief	restores the compilation unit address range table from an in-core index cache image
+ *
+ *	if this succeeds, init_aranges() has nothing left to do;
+ *	on failure, nothing is changed
+ *
+ *	\param	ctx	gear engine context
+ *	\param	c	the in-core index cache image to restore the table from
+ *	\return	true, if the table was successfully restored, false otherwise
+ */
+bool aranges_restore_index(struct gear_engine_context * ctx, struct index_cache_cursor * c)
+{
+struct cu_aranges * p;
+int range_cnt;
 
-	return lexblock;
+	if (ctx->cu_aranges)
+		panic("");
+	if (!index_cache_get(c, &range_cnt, sizeof range_cnt) || range_cnt < 0
+			|| range_cnt > (c->len - c->pos) / sizeof * p->range_tab)
+		return false;
+	if (!(p = malloc(sizeof * p)))
+		panic("out of core");
+	p->range_cnt = range_cnt;
+	if (!(p->range_tab = malloc((range_cnt ? range_cnt : 1) * sizeof * p->range_tab)))
+		panic("out of core");
+	index_cache_get(c, p->range_tab, range_cnt * sizeof * p->range_tab);
+
+	ctx->cu_aranges = p;
+	return true;
+}
+
+/*!
+ *	\fn	void aranges_discard_index(struct gear_engine_context * ctx)
+ *	\brief	discards compilation unit address range data restored by aranges_restore_index()
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void aranges_discard_index(struct gear_engine_context * ctx)
+{
+	if (!ctx->cu_aranges)
+		return;
+	free(ctx->cu_aranges->range_tab);
+	free(ctx->cu_aranges);
+	ctx->cu_aranges = 0;
 }
 
 /*!
  *	\fn	void init_aranges(struct gear_engine_context * ctx)
  *	\brief 	initializes aranges data for an image file
  *
+ *	\note	if the address range table has already been
+ *		restored from the index cache (see index-cache.c),
+ *		this does nothing
+ *
  *	\param	ctx	gear engine context
  *	\return	none
  */
@@ -464,6 +595,7 @@ Dwarf_Arange	* aranges;
 Dwarf_Signed	nr_aranges;
 struct cu_aranges	* cu_aranges;
 int i, j, k;
+ARM_CORE_WORD end;
 
 int cu_aranges_compare(struct cu_arange_desc_struct * arg1, struct cu_arange_desc_struct * arg2)
 {
@@ -474,6 +606,9 @@ int cu_aranges_compare(struct cu_arange_desc_struct * arg1, struct cu_arange_des
 	return 1;
 }
 
+	if (ctx->cu_aranges)
+		/* already restored from the index cache */
+		return;
 	res = dwarf_get_aranges(ctx->dbg, &aranges, &nr_aranges, &err);
 	if (res == DW_DLV_ERROR)
 		panic("dwarf_aranges");
@@ -510,6 +645,24 @@ int cu_aranges_compare(struct cu_arange_desc_struct * arg1, struct cu_arange_des
 	dwarf_dealloc(ctx->dbg, aranges, DW_DLA_LIST);
 	/* sort the list by starting core address, in ascending order */
 	qsort(cu_aranges->range_tab, nr_aranges, sizeof * cu_aranges->range_tab, (int (*)(const void *, const void *)) cu_aranges_compare);
+	/* drop any empty ranges, they can never contain an address,
+	 * and build the running maximum end addresses needed for
+	 * handling overlapping ranges in aranges_lookup() */
+	for (i = j = 0; i < nr_aranges; i++)
+	{
+		if (!cu_aranges->range_tab[i].len)
+			continue;
+		cu_aranges->range_tab[j] = cu_aranges->range_tab[i];
+		end = cu_aranges->range_tab[j].addr + cu_aranges->range_tab[j].len;
+		if (end < cu_aranges->range_tab[j].addr)
+			/* address wraparound - the range extends to the
+			 * very top of the address space */
+			end = (ARM_CORE_WORD) -1;
+		cu_aranges->range_tab[j].max_end = (j && cu_aranges->range_tab[j - 1].max_end > end) ?
+			cu_aranges->range_tab[j - 1].max_end : end;
+		j++;
+	}
+	cu_aranges->range_cnt = j;
 	/* use simple selection sort */
 	/*!	\todo	the address ranges list will most commonly be already
 	 *		sorted; maybe check for this, wont make much difference
@@ -9,12 +9,42 @@
  * $Log: $
  */
 
+/*
+ *
+ * exported types follow
+ *
+ */
+
+/*! a node in a chain of scopes containing a code address
+ *
+ * chains of scopes are retrieved by
+ * aranges_get_scope_chain_for_addr(); a chain starts
+ * at the most deeply nested scope containing an address, and
+ * runs outwards (by following the parent links below) to the
+ * top level subprogram containing the address */
+struct scope_chain_node
+{
+	/*! the debug information node for this scope
+	 *
+	 * this is a subprogram (either a top level, or a nested
+	 * one, or an inline-expanded subprogram), or a lexical
+	 * block data node; use the tag field to find out which */
+	struct dwarf_head_struct	* scope;
+	/*! the enclosing scope, null for top level subprograms */
+	struct scope_chain_node		* parent;
+	/*! the nesting depth of this scope, zero for top level subprograms */
+	int				depth;
+};
+
 /*
  *
  * exported function prototypes follow
  *
  */
 struct cu_data * aranges_get_cu_for_addr(struct gear_engine_context * ctx, ARM_CORE_WORD addr);
+void aranges_discard_cu_scope_tab(struct cu_data * cu);
+bool aranges_get_cu_die_offset_for_addr(struct gear_engine_context * ctx, ARM_CORE_WORD addr, Dwarf_Off * cu_die_offset);
+struct scope_chain_node * aranges_get_scope_chain_for_addr(struct gear_engine_context * ctx, ARM_CORE_WORD addr, struct cu_data ** cu);
 struct subprogram_data * aranges_get_subp_for_addr(struct gear_engine_context * ctx, ARM_CORE_WORD addr);
 struct lexblock_data * aranges_get_lexblock_for_addr(struct gear_engine_context * ctx, ARM_CORE_WORD addr);
 void init_aranges(struct gear_engine_context * ctx);
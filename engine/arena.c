@@ -2,6 +2,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <string.h>
+#include <sys/time.h>
 
 #include "dwarf-common.h"
 #include "target-defs.h"
@@ -10,6 +11,13 @@
 
 #include "cu-access.h"
 #include "srcfile.h"
+#include "symtab.h"
+#include "dwarf-expr.h"
+#include "type-access.h"
+#include "aranges-access.h"
+#include "index-cache.h"
+#include "node-alloc.h"
+#include "dwarf-pubnames.h"
 #include "util.h"
 
 
@@ -27,16 +35,45 @@ void print_error(Dwarf_Debug dbg, char * errmsg, int sres, Dwarf_Error err)
 	gprintf("print_error(): %s\n", errmsg);
 }
 
+/*!
+ *	\fn	void report_init_phase_time(const char * phase_name, struct timeval * phase_start)
+ *	\brief	prints the time elapsed in a gear engine initialization phase, and starts timing the next one
+ *
+ *	this is used for producing the startup timing report
+ *	printed while the gear engine initializes
+ *
+ *	\param	phase_name	the name of the phase just completed; if
+ *				null, nothing is printed, and only the
+ *				start time of the next phase is recorded
+ *	\param	phase_start	the time at which the phase just
+ *				completed was started; updated
+ *				to the current time on return
+ *	\return	none
+ */
+void report_init_phase_time(const char * phase_name, struct timeval * phase_start)
+{
+struct timeval tv;
+
+	if (gettimeofday(&tv, 0) < 0)
+		panic("");
+	if (phase_name)
+		gprintf("startup timing: %s: %li ms\n", phase_name,
+				(long) ((tv.tv_sec - phase_start->tv_sec) * 1000
+					+ (tv.tv_usec - phase_start->tv_usec) / 1000));
+	* phase_start = tv;
+}
+
 void dwarf_hacked_init(struct gear_engine_context * ctx)
 {
 int elf_fd;
 Dwarf_Debug dbg;
 int res = DW_DLV_OK;
 Dwarf_Error err;
-Dwarf_Unsigned	next_cu_header_offset;
-Dwarf_Off cur_cu_offset;
+int nr_cus;
 Elf * libelf_d;
+struct timeval phase_start;
 
+	report_init_phase_time(0, &phase_start);
 	elf_fd = open(ctx->dbg_info_elf_disk_file_name, O_RDONLY | O_BINARY, 0);
 	/* validate libelf version */
 	if (elf_version(EV_CURRENT) == EV_NONE)
@@ -61,45 +98,87 @@ Elf * libelf_d;
 		exit_error("dwarf_elf_init() failure");
 	}
 	ctx->dbg = dbg;
-
-	while ((res = dwarf_next_cu_header(ctx->dbg,
-					/* dont need these */
-					0,
-					0,
-					0,
-					0,
-					&next_cu_header_offset,
-					&err)) == DW_DLV_OK)
-		/* kill time; as weve bloody got any of it to waste... */	 
-		;
-	if (0) init_aranges(ctx);
-	if (res != DW_DLV_NO_ENTRY)
-		panic("");
-	/* start from offset 0 - the start of the debug information
-	 * (.dbg_info) section */	 
-	cur_cu_offset = 0;
-	/* process all compilation units */
-	while ((res = dwarf_next_cu_header(ctx->dbg,
-					/* dont need these */
-					0,
-					0,
-					0,
-					0,
-					&next_cu_header_offset,
-					&err)) == DW_DLV_OK)
+	report_init_phase_time("elf and dwarf descriptors opened", &phase_start);
+
+	/* the libdwarf compilation unit header 'cursor' is at the
+	 * start of .debug_info right now, so walk the compilation
+	 * unit headers exactly once and record the compilation unit
+	 * die offsets; everything else (here, and in srcfile.c)
+	 * works from the table built, and never needs to rewind
+	 * the 'cursor' again; the table may already have been
+	 * restored from the index cache (see index-cache.c), in
+	 * which case the scan is not needed at all */
+	if (!ctx->cu_die_offsets)
+		cu_scan_die_offsets(ctx);
+	cu_get_die_offsets(ctx, &nr_cus);
+	gprintf("%i compilation units found\n", nr_cus);
+	report_init_phase_time("compilation unit headers scanned", &phase_start);
+
+	/* process all compilation units
+	 *
+	 * \note	this cannot be (easily) farmed out to a pool
+	 *		of worker threads - a libdwarf debug descriptor
+	 *		is not reentrant, the Dwarf_Line tables stored in
+	 *		the compilation unit trees are bound to ctx->dbg,
+	 *		and cu_process() updates the (shared) type and
+	 *		symbol hash tables all the way through building
+	 *		a compilation unit tree
+	 *
+	 * if lazy compilation unit building is enabled, the
+	 * compilation unit trees are built on demand instead
+	 * (see cu_build_all() in cu-access.c) */
+	if (!ctx->settings.is_lazy_cu_build_enabled)
 	{
-		if (dwarf_get_cu_die_offset_given_cu_header_offset
-			(ctx->dbg, cur_cu_offset, &cur_cu_offset, &err)
-				!= DW_DLV_OK)
-			panic("");
-		cu_process(ctx, cur_cu_offset);
-		cur_cu_offset = next_cu_header_offset;
+		cu_build_all(ctx);
+		report_init_phase_time("compilation unit trees built", &phase_start);
 	}
 
 	gprintf("dwarf engine successfully initialized\n");
 
 }
 
+/*!
+ *	\fn	void dwarf_hacked_shutdown(struct gear_engine_context * ctx)
+ *	\brief	discards all debug information, and closes the executable being debugged
+ *
+ *	this undoes dwarf_hacked_init(), init_aranges(), init_types()
+ *	and init_symtab(); all of the debug information trees, and
+ *	the symbol and type hash tables are discarded, all debug
+ *	information nodes are released at once to the system (see
+ *	node_alloc_free_all()), and the libdwarf and libelf
+ *	descriptors, and the executable file, are closed; after this
+ *	returns, the context can be initialized again for
+ *	debugging a (possibly different) executable
+ *
+ *	\note	anything else still referencing debug information
+ *		nodes (e.g. the source file tables built by
+ *		srcfile_build_src_cu_tab()) is invalidated by this
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void dwarf_hacked_shutdown(struct gear_engine_context * ctx)
+{
+Dwarf_Error err;
+
+	dwarf_pubnames_discard(ctx);
+	cu_discard_all(ctx);
+	aranges_discard_index(ctx);
+	discard_symtab(ctx);
+	discard_types(ctx);
+	node_alloc_free_all(ctx);
+
+	if (!ctx->dbg)
+		return;
+	if (dwarf_finish(ctx->dbg, &err) != DW_DLV_OK)
+		gprintf("dwarf_finish() failure\n");
+	ctx->dbg = 0;
+	elf_end(ctx->libelf_elf_desc);
+	ctx->libelf_elf_desc = 0;
+	close(ctx->dbg_elf_fd);
+	ctx->dbg_elf_fd = -1;
+}
+
 ssize_t write_to_frontends(const void *buf, size_t count)
 {
 	return write(1, buf, count);
@@ -0,0 +1,397 @@
+/*!
+ *	\file	armv7m-target-desc-test.c
+ *	\brief	armv7m fallback target call stack frame unwinder test
+ *	\author	shopov
+ *
+ *	this is a test program for the armv7m fallback target call stack
+ *	frame unwinder (see armv7m-target-desc.c); as the routines tested
+ *	are local to that module, it is included here, rather than linked;
+ *	it needs no executable - the function table, normally built from
+ *	the elf symbol table of the executable, is supplied directly, and
+ *	the target is simulated by memory buffers holding the instructions
+ *	scanned and the target stack; run it by
+ *	'make armv7m-target-desc-test-run'
+ *
+ *	the test checks, each by a table of test cases, that:
+ *		- the function prologue scanner recognizes the thumb-2
+ *		instructions that push registers on the stack, or
+ *		otherwise decrement the stack pointer, and stops
+ *		scanning at the first branch instruction
+ *		- the exception frame unwinder reads the registers stacked
+ *		on exception entry, and computes the canonical frame address
+ *		for basic and extended exception frames, with and without
+ *		the stack aligned by the core on exception entry
+ *		- addresses are only taken to be inside the function starting
+ *		closest below them, if they are below the end of the function,
+ *		or if the function size is unknown
+ *
+ *	the exit status is zero if all checks pass, and nonzero otherwise
+ *
+ *	Revision summary:
+ *
+ *	$Log: $
+ */
+
+/*
+ *
+ * include section follows
+ *
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "armv7m-target-desc.c"
+
+
+/*
+ *
+ * local definitions follow
+ *
+ */
+
+enum
+{
+	/*! the address of the function, which prologue is scanned */
+	FUNC_ADDR		= 0x1000,
+	/*! the address of the simulated target stack */
+	STACK_ADDR		= 0x20001000,
+	/*! the number of words in the simulated target stack */
+	NR_STACK_WORDS		= 32,
+	/*! the maximum number of instruction halfwords in a prologue scanner test case */
+	MAX_TEST_INSN_HWORDS	= 8,
+	/*! the thumb 'b .' instruction, which the simulated function code is padded with */
+	INSN_B_SELF		= 0xe7fe,
+};
+
+/*! a function prologue scanner test case */
+struct prologue_case
+{
+	/*! a description of the test case, for failure reports */
+	const char	* what;
+	/*! the instruction halfwords at the start of the function; the remaining ones are 'b .' instructions */
+	unsigned short	insns[MAX_TEST_INSN_HWORDS];
+	/*! the number of stack pointer adjusting instructions expected to be recorded */
+	int		nr_steps;
+	/*! the stack pointer adjusting instructions expected to be recorded; the insn_addr fields are offsets from the function start */
+	struct prologue_step	steps[MAX_PROLOGUE_STEPS];
+};
+
+static const struct prologue_case prologue_cases[] =
+{
+	{ .what = "push {r4, r5, r7, lr}", .insns = { 0xb5b0, },
+		.nr_steps = 1, .steps = { { 0, 16, 1 << 4 | 1 << 5 | 1 << 7 | 1 << 14, }, }, },
+	{ .what = "push.w {r4-r11, lr}", .insns = { 0xe92d, 0x4ff0, },
+		.nr_steps = 1, .steps = { { 0, 36, 0x4ff0, }, }, },
+	{ .what = "str.w lr, [sp, #-4]!", .insns = { 0xf84d, 0xed04, },
+		.nr_steps = 1, .steps = { { 0, 4, 1 << 14, }, }, },
+	{ .what = "push {r7, lr}; mov r7, sp; sub sp, #16", .insns = { 0xb580, 0x466f, 0xb084, },
+		.nr_steps = 2, .steps = { { 0, 8, 1 << 7 | 1 << 14, }, { 4, 24, 0, }, }, },
+	/* the immediate constant is encoded as 0x80, rotated right by 31 */
+	{ .what = "push {lr}; sub.w sp, sp, #0x100", .insns = { 0xb500, 0xf5ad, 0x7d80, },
+		.nr_steps = 2, .steps = { { 0, 4, 1 << 14, }, { 2, 0x104, 0, }, }, },
+	{ .what = "sub.w sp, sp, #8", .insns = { 0xf1ad, 0x0d08, },
+		.nr_steps = 1, .steps = { { 0, 8, 0, }, }, },
+	{ .what = "subw sp, sp, #0x404", .insns = { 0xf2ad, 0x4d04, },
+		.nr_steps = 1, .steps = { { 0, 0x404, 0, }, }, },
+	{ .what = "push {r4, lr}; vpush {d8-d15}", .insns = { 0xb510, 0xed2d, 0x8b10, },
+		.nr_steps = 2, .steps = { { 0, 8, 1 << 4 | 1 << 14, }, { 2, 72, 0, }, }, },
+	{ .what = "vpush {s16-s17}", .insns = { 0xed2d, 0x8a02, },
+		.nr_steps = 1, .steps = { { 0, 8, 0, }, }, },
+	{ .what = "push {r7, lr}; bl; sub sp, #16", .insns = { 0xb580, 0xf000, 0xf800, 0xb084, },
+		.nr_steps = 1, .steps = { { 0, 8, 1 << 7 | 1 << 14, }, }, },
+	{ .what = "cbz; push {r7, lr}", .insns = { 0xb100, 0xb580, },
+		.nr_steps = 0, },
+};
+
+/*! an exception frame unwinder test case */
+struct exception_frame_case
+{
+	/*! a description of the test case, for failure reports */
+	const char	* what;
+	/*! the EXC_RETURN value, i.e. the program counter value of the frame unwound */
+	ARM_CORE_WORD	exc_return;
+	/*! the stacked xpsr value */
+	ARM_CORE_WORD	xpsr;
+	/*! nonzero, if the frame is expected to be unwound */
+	bool		is_unwound;
+	/*! the expected size of the exception frame, i.e. the offset of the canonical frame address from the stack pointer */
+	ARM_CORE_WORD	frame_size;
+};
+
+static const struct exception_frame_case exception_frame_cases[] =
+{
+	{ .what = "basic frame", .exc_return = 0xfffffff9, .xpsr = 0x01000000,
+		.is_unwound = true, .frame_size = 0x20, },
+	{ .what = "basic frame, stack aligned on exception entry", .exc_return = 0xfffffff9, .xpsr = 0x01000200,
+		.is_unwound = true, .frame_size = 0x24, },
+	{ .what = "basic frame, nested exception", .exc_return = 0xfffffff1, .xpsr = 0x0100000f,
+		.is_unwound = true, .frame_size = 0x20, },
+	{ .what = "extended frame", .exc_return = 0xffffffe9, .xpsr = 0x01000000,
+		.is_unwound = true, .frame_size = 0x68, },
+	{ .what = "extended frame, stack aligned on exception entry", .exc_return = 0xffffffe9, .xpsr = 0x01000200,
+		.is_unwound = true, .frame_size = 0x6c, },
+	{ .what = "frame on the process stack", .exc_return = 0xfffffffd, .xpsr = 0x01000000,
+		.is_unwound = false, },
+};
+
+/*! a function lookup test case */
+struct func_lookup_case
+{
+	/*! the address to look the function up for */
+	ARM_CORE_WORD	pc;
+	/*! nonzero, if a function is expected to be found */
+	bool		is_found;
+	/*! the expected function start address */
+	ARM_CORE_WORD	func_start;
+};
+
+/*! the function table the function lookup test cases below are run on */
+static struct func_range func_table[] =
+{
+	{ .start = 0x1000, .size = 0x20, },
+	{ .start = 0x1040, .size = 0x10, },
+	/* size unknown, e.g. an assembly language function */
+	{ .start = 0x2000, .size = 0, },
+};
+
+static const struct func_lookup_case func_lookup_cases[] =
+{
+	{ .pc = 0x0ffe, .is_found = false, },
+	{ .pc = 0x1000, .is_found = true, .func_start = 0x1000, },
+	{ .pc = 0x101e, .is_found = true, .func_start = 0x1000, },
+	/* between the end of a function and the start of the next one */
+	{ .pc = 0x1020, .is_found = false, },
+	{ .pc = 0x103e, .is_found = false, },
+	{ .pc = 0x1040, .is_found = true, .func_start = 0x1040, },
+	{ .pc = 0x1050, .is_found = false, },
+	{ .pc = 0x2000, .is_found = true, .func_start = 0x2000, },
+	{ .pc = 0x8000, .is_found = true, .func_start = 0x2000, },
+};
+
+/*! the number of checks failed */
+static int nr_failures;
+
+/*! the simulated function code */
+static unsigned short func_code[MAX_PROLOGUE_SIZE / 2];
+/*! the simulated target stack */
+static ARM_CORE_WORD target_stack[NR_STACK_WORDS];
+
+
+/*
+ *
+ * local functions follow
+ *
+ */
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM target_mem_read(struct gear_engine_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes)
+ *	\brief	reads the simulated function code, or the simulated target stack; installed as ctx->cc->core_mem_read()
+ *
+ *	\param	ctx	gear engine context
+ *	\param	dest	the buffer to store the bytes read in
+ *	\param	source	the target memory address to read from
+ *	\param	nbytes	the number of bytes to read
+ *	\return	the status code of the memory read
+ */
+static enum GEAR_ENGINE_ERR_ENUM target_mem_read(struct gear_engine_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes)
+{
+	if (source >= FUNC_ADDR && source - FUNC_ADDR <= sizeof func_code
+			&& * nbytes <= sizeof func_code - (source - FUNC_ADDR))
+		memcpy(dest, (unsigned char *) func_code + (source - FUNC_ADDR), * nbytes);
+	else if (source >= STACK_ADDR && source - STACK_ADDR <= sizeof target_stack
+			&& * nbytes <= sizeof target_stack - (source - STACK_ADDR))
+		memcpy(dest, (unsigned char *) target_stack + (source - STACK_ADDR), * nbytes);
+	else
+		return GEAR_ERR_GENERIC_ERROR;
+	return GEAR_ERR_NO_ERROR;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM read_test_stack_word(struct gear_engine_context * ctx, ARM_CORE_WORD addr, ARM_CORE_WORD * val)
+ *	\brief	reads a word from the simulated target stack; supplied to the fallback frame unwinder
+ *
+ *	\param	ctx	gear engine context
+ *	\param	addr	the target address to read from
+ *	\param	val	a pointer to where to store the value read
+ *	\return	GEAR_ERR_NO_ERROR on success, GEAR_ERR_GENERIC_ERROR on failure
+ */
+static enum GEAR_ENGINE_ERR_ENUM read_test_stack_word(struct gear_engine_context * ctx, ARM_CORE_WORD addr, ARM_CORE_WORD * val)
+{
+unsigned nbytes;
+
+	nbytes = sizeof * val;
+	return target_mem_read(ctx, val, addr, & nbytes);
+}
+
+/*!
+ *	\fn	static void run_prologue_case(struct gear_engine_context * ctx, const struct prologue_case * c)
+ *	\brief	scans a simulated function prologue, and checks the stack pointer adjusting instructions recorded
+ *
+ *	\param	ctx	gear engine context
+ *	\param	c	the test case to run
+ *	\return	none
+ */
+static void run_prologue_case(struct gear_engine_context * ctx, const struct prologue_case * c)
+{
+struct prologue_info pi;
+int i;
+
+	for (i = 0; i < sizeof func_code / sizeof * func_code; i++)
+		func_code[i] = (i < MAX_TEST_INSN_HWORDS && c->insns[i]) ? c->insns[i] : INSN_B_SELF;
+	memset(& pi, 0, sizeof pi);
+	pi.func_start = FUNC_ADDR;
+	scan_prologue(ctx, & pi);
+	if (!pi.is_scanned)
+	{
+		printf("FAIL: %s: prologue not scanned\n", c->what);
+		nr_failures ++;
+		return;
+	}
+	if (pi.nr_steps != c->nr_steps)
+	{
+		printf("FAIL: %s: %i stack pointer adjusting instructions found, expected %i\n",
+				c->what, pi.nr_steps, c->nr_steps);
+		nr_failures ++;
+		return;
+	}
+	for (i = 0; i < pi.nr_steps; i++)
+		if (pi.steps[i].insn_addr != FUNC_ADDR + c->steps[i].insn_addr
+				|| pi.steps[i].frame_size != c->steps[i].frame_size
+				|| pi.steps[i].saved_regs_mask != c->steps[i].saved_regs_mask)
+		{
+			printf("FAIL: %s: instruction %i: offset 0x%x, frame size 0x%x, saved registers 0x%04x; "
+					"expected offset 0x%x, frame size 0x%x, saved registers 0x%04x\n",
+					c->what, i, (unsigned) (pi.steps[i].insn_addr - FUNC_ADDR),
+					pi.steps[i].frame_size, pi.steps[i].saved_regs_mask,
+					(unsigned) c->steps[i].insn_addr, c->steps[i].frame_size, c->steps[i].saved_regs_mask);
+			nr_failures ++;
+		}
+}
+
+/*!
+ *	\fn	static void run_exception_frame_case(struct gear_engine_context * ctx, const struct exception_frame_case * c)
+ *	\brief	unwinds a simulated exception frame, and checks the registers and the canonical frame address retrieved
+ *
+ *	\param	ctx	gear engine context
+ *	\param	c	the test case to run
+ *	\return	none
+ */
+static void run_exception_frame_case(struct gear_engine_context * ctx, const struct exception_frame_case * c)
+{
+/* the core registers stacked on exception entry, in stacking order */
+static const int stacked_regs[NR_EXCEPTION_FRAME_WORDS - 1] = { 0, 1, 2, 3, 12, 14, 15, };
+struct tdesc_unwound_reg cur_regs[16], prev_regs[16];
+ARM_CORE_WORD cfa;
+bool is_exception_frame;
+enum GEAR_ENGINE_ERR_ENUM err;
+int i;
+
+	for (i = 0; i < NR_STACK_WORDS; i++)
+		target_stack[i] = 0xdead0000 + i;
+	target_stack[NR_EXCEPTION_FRAME_WORDS - 1] = c->xpsr;
+	for (i = 0; i < 16; i++)
+		cur_regs[i] = (struct tdesc_unwound_reg) { .is_valid = true, .reg_val = 0x1000 + i, };
+	cur_regs[13].reg_val = STACK_ADDR;
+	cur_regs[14].reg_val = cur_regs[15].reg_val = c->exc_return;
+	is_exception_frame = false;
+	err = ctx->tdesc->unwind_frame(ctx, cur_regs, prev_regs, & cfa, & is_exception_frame, read_test_stack_word);
+	if ((err == GEAR_ERR_NO_ERROR) != c->is_unwound)
+	{
+		printf("FAIL: %s: frame %sunwound\n", c->what, c->is_unwound ? "not " : "");
+		nr_failures ++;
+		return;
+	}
+	if (!c->is_unwound)
+		return;
+	if (!is_exception_frame)
+	{
+		printf("FAIL: %s: not reported as an exception frame\n", c->what);
+		nr_failures ++;
+	}
+	if (cfa != STACK_ADDR + c->frame_size)
+	{
+		printf("FAIL: %s: canonical frame address is 0x%08x, expected 0x%08x\n",
+				c->what, (unsigned) cfa, (unsigned) (STACK_ADDR + c->frame_size));
+		nr_failures ++;
+	}
+	for (i = 0; i < NR_EXCEPTION_FRAME_WORDS - 1; i++)
+		if (!prev_regs[stacked_regs[i]].is_valid || !prev_regs[stacked_regs[i]].is_stored_in_memory
+				|| prev_regs[stacked_regs[i]].reg_addr != STACK_ADDR + i * sizeof(ARM_CORE_WORD)
+				|| prev_regs[stacked_regs[i]].reg_val != target_stack[i])
+		{
+			printf("FAIL: %s: register r%i not retrieved from the exception frame\n", c->what, stacked_regs[i]);
+			nr_failures ++;
+		}
+	for (i = 4; i < 12; i++)
+		if (!prev_regs[i].is_valid || prev_regs[i].reg_val != cur_regs[i].reg_val)
+		{
+			printf("FAIL: %s: register r%i not preserved\n", c->what, i);
+			nr_failures ++;
+		}
+}
+
+/*!
+ *	\fn	static void run_func_lookup_case(struct gear_engine_context * ctx, const struct func_lookup_case * c)
+ *	\brief	looks a function up in the function table, and checks the function found
+ *
+ *	\param	ctx	gear engine context
+ *	\param	c	the test case to run
+ *	\return	none
+ */
+static void run_func_lookup_case(struct gear_engine_context * ctx, const struct func_lookup_case * c)
+{
+ARM_CORE_WORD func_start;
+bool is_found;
+
+	is_found = find_func_start(ctx, c->pc, & func_start);
+	if (is_found != c->is_found || (is_found && func_start != c->func_start))
+	{
+		printf("FAIL: function lookup at 0x%08x: ", (unsigned) c->pc);
+		if (is_found)
+			printf("found function at 0x%08x, ", (unsigned) func_start);
+		else
+			printf("no function found, ");
+		if (c->is_found)
+			printf("expected function at 0x%08x\n", (unsigned) c->func_start);
+		else
+			printf("expected none\n");
+		nr_failures ++;
+	}
+}
+
+
+/*
+ *
+ * exported functions follow
+ *
+ */
+
+int main(int argc, char ** argv)
+{
+struct gear_engine_context ctx;
+struct core_control cc;
+int i;
+
+	memset(& ctx, 0, sizeof ctx);
+	memset(& cc, 0, sizeof cc);
+	cc.core_mem_read = target_mem_read;
+	ctx.cc = & cc;
+	init_armv7m_target_desc(& ctx);
+
+	for (i = 0; i < sizeof prologue_cases / sizeof * prologue_cases; i++)
+		run_prologue_case(& ctx, prologue_cases + i);
+	for (i = 0; i < sizeof exception_frame_cases / sizeof * exception_frame_cases; i++)
+		run_exception_frame_case(& ctx, exception_frame_cases + i);
+
+	/* supply the function table directly, instead of
+	 * building it from the elf symbol table */
+	ctx.tdesc->p->funcs = func_table;
+	ctx.tdesc->p->nr_funcs = sizeof func_table / sizeof * func_table;
+	ctx.tdesc->p->is_func_table_built = true;
+	for (i = 0; i < sizeof func_lookup_cases / sizeof * func_lookup_cases; i++)
+		run_func_lookup_case(& ctx, func_lookup_cases + i);
+
+	printf("%i failures\n", nr_failures);
+	return nr_failures ? 1 : 0;
+}
@@ -1,5 +1,8 @@
 #include <stdarg.h>
 #include <stdlib.h>
+#include <string.h>
+#include <libelf.h>
+#include <gelf.h>
 
 #include "dwarf-common.h"
 #include "target-defs.h"
@@ -21,6 +24,93 @@
 
 #define MEMBUF_BYTE_SIZE	256
 
+/*
+ * fallback target call stack frame unwinding
+ *
+ * frames that the call frame information of the executable does
+ * not cover are unwound here (see the unwind_frame field in struct
+ * target_desc_struct, in target-description.h); two kinds of frames
+ * are handled:
+ *	- exception frames - when an exception is taken, the core
+ *	stacks r0-r3, r12, lr, pc and xpsr (and, for an extended frame,
+ *	the floating point context), and loads lr with an EXC_RETURN
+ *	value; the frame whose program counter is an EXC_RETURN value
+ *	is unwound by reading the registers stacked by the core
+ *	- frames of functions without call frame information - the
+ *	start of the function executing in the frame is looked up in
+ *	the elf symbol table of the executable, and the function prologue
+ *	is scanned for thumb-2 instructions that push registers on the
+ *	stack, or otherwise decrement the stack pointer; the prologue
+ *	scan results are kept in a cache, keyed by function start address
+ *
+ * the instructions scanned are read by ctx->cc->core_mem_read(),
+ * so that they are usually served from the executable image (see
+ * image-mem.c), and not read from the target */
+
+enum
+{
+	/*! the number of entries in the function prologue scan results cache */
+	NR_CACHED_PROLOGUES		= 64,
+	/*! the maximum number of bytes scanned at the start of a function */
+	MAX_PROLOGUE_SIZE		= 64,
+	/*! the maximum number of stack pointer adjusting instructions recorded for a function prologue */
+	MAX_PROLOGUE_STEPS		= 8,
+	/*! the number of words stacked by the core on exception entry, for a basic (not extended) frame */
+	NR_EXCEPTION_FRAME_WORDS	= 8,
+	/*! the size of an extended exception frame (one holding the floating point context), in bytes */
+	EXTENDED_EXCEPTION_FRAME_SIZE	= 0x68,
+};
+
+/*! the address range of a function, taken from the elf symbol table of the executable */
+struct func_range
+{
+	/*! the function start address */
+	ARM_CORE_WORD	start;
+	/*! the function size, in bytes; zero, if unknown */
+	ARM_CORE_WORD	size;
+};
+
+/*! the effect of a function prologue instruction that adjusts the stack pointer */
+struct prologue_step
+{
+	/*! the address of the instruction */
+	ARM_CORE_WORD	insn_addr;
+	/*! the number of bytes the function has allocated on the stack, after the instruction has executed */
+	int		frame_size;
+	/*! the registers the instruction has pushed on the stack - a bitmask, indexed by register number */
+	unsigned	saved_regs_mask;
+};
+
+/*! the result of scanning a function prologue */
+struct prologue_info
+{
+	/*! nonzero, if this entry holds a prologue scan result; zero, if this entry is unused */
+	bool		is_valid;
+	/*! nonzero, if the function prologue has been read and scanned successfully */
+	bool		is_scanned;
+	/*! the function start address */
+	ARM_CORE_WORD	func_start;
+	/*! the number of elements in the steps array below */
+	int		nr_steps;
+	/*! the stack pointer adjusting instructions in the function prologue, in program order */
+	struct prologue_step	steps[MAX_PROLOGUE_STEPS];
+	/*! the next less recently used cache entry */
+	struct prologue_info	* next;
+};
+
+/*! armv7m target description private data */
+struct tdesc_private_data
+{
+	/*! nonzero, if the funcs array below has been built */
+	bool		is_func_table_built;
+	/*! the function address ranges, sorted by ascending start address */
+	struct func_range	* funcs;
+	/*! the number of elements in the funcs array above */
+	int		nr_funcs;
+	/*! the most recently used function prologue scan results cache entry - the list head */
+	struct prologue_info	* mru;
+};
+
 
 
 static int get_nr_target_core_regs(struct gear_engine_context * ctx) { return 16; } 
@@ -81,6 +171,393 @@ static int armv7m_insn_decode(struct gear_engine_context * ctx,
 	return 0;
 }
 
+static int func_range_compare(const void * a, const void * b)
+{
+	if (((const struct func_range *) a)->start < ((const struct func_range *) b)->start)
+		return -1;
+	return ((const struct func_range *) a)->start > ((const struct func_range *) b)->start;
+}
+
+/*!
+ *	\fn	static void build_func_table(struct gear_engine_context * ctx)
+ *	\brief	builds the sorted table of function address ranges from the elf symbol table of the executable
+ *
+ *	\param	ctx	context to work in
+ *	\return	none; if the executable has no symbol table,
+ *		the table built is empty */
+static void build_func_table(struct gear_engine_context * ctx)
+{
+struct tdesc_private_data * p;
+Elf_Scn * scn;
+GElf_Shdr shdr;
+GElf_Sym sym;
+Elf_Data * data;
+int i, j, nr_syms;
+
+	p = ctx->tdesc->p;
+	p->is_func_table_built = true;
+	if (!ctx->libelf_elf_desc)
+		return;
+	for (scn = 0; (scn = elf_nextscn(ctx->libelf_elf_desc, scn)); )
+	{
+		if (!gelf_getshdr(scn, &shdr))
+			panic("");
+		if (shdr.sh_type == SHT_SYMTAB)
+			break;
+	}
+	if (!scn || !shdr.sh_entsize || !(data = elf_getdata(scn, 0)))
+		return;
+	nr_syms = shdr.sh_size / shdr.sh_entsize;
+	if (!nr_syms || !(p->funcs = calloc(nr_syms, sizeof * p->funcs)))
+		return;
+	for (i = 0; i < nr_syms; i++)
+		if (gelf_getsym(data, i, &sym) && GELF_ST_TYPE(sym.st_info) == STT_FUNC
+				&& sym.st_shndx != SHN_UNDEF)
+			/* discard the thumb bit */
+			p->funcs[p->nr_funcs++] = (struct func_range) { .start = sym.st_value & ~1, .size = sym.st_size, };
+	qsort(p->funcs, p->nr_funcs, sizeof * p->funcs, func_range_compare);
+	/* remove duplicates (e.g. aliases), keeping the largest size */
+	for (i = j = 0; i < p->nr_funcs; i++)
+		if (!j || p->funcs[j - 1].start != p->funcs[i].start)
+			p->funcs[j++] = p->funcs[i];
+		else if (p->funcs[i].size > p->funcs[j - 1].size)
+			p->funcs[j - 1].size = p->funcs[i].size;
+	p->nr_funcs = j;
+	gprintf("%i function start addresses available for prologue scanning\n", j);
+}
+
+/*!
+ *	\fn	static bool find_func_start(struct gear_engine_context * ctx, ARM_CORE_WORD pc, ARM_CORE_WORD * func_start)
+ *	\brief	finds the start address of the function containing a target address
+ *
+ *	\param	ctx	context to work in
+ *	\param	pc	the target address to find the function for
+ *	\param	func_start	a pointer to where to store the
+ *				function start address found
+ *	\return	true, if the function has been found, false otherwise;
+ *		the function found is the one starting closest below the
+ *		address, and the address must be inside it, unless the
+ *		function size is unknown (zero) - so that code not covered
+ *		by any function symbol is not taken for the function
+ *		preceding it */
+static bool find_func_start(struct gear_engine_context * ctx, ARM_CORE_WORD pc, ARM_CORE_WORD * func_start)
+{
+struct tdesc_private_data * p;
+int lo, hi, mid;
+
+	p = ctx->tdesc->p;
+	if (!p->is_func_table_built)
+		build_func_table(ctx);
+	/* find the first function starting past the address */
+	lo = 0;
+	hi = p->nr_funcs;
+	while (lo < hi)
+	{
+		mid = (lo + hi) / 2;
+		if (p->funcs[mid].start <= pc)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (!lo)
+		return false;
+	if (p->funcs[lo - 1].size && pc - p->funcs[lo - 1].start >= p->funcs[lo - 1].size)
+		return false;
+	* func_start = p->funcs[lo - 1].start;
+	return true;
+}
+
+/*!
+ *	\fn	static ARM_CORE_WORD thumb_expand_imm(unsigned imm12)
+ *	\brief	decodes a thumb-2 modified immediate constant
+ *
+ *	\param	imm12	the i:imm3:imm8 instruction fields
+ *	\return	the constant value */
+static ARM_CORE_WORD thumb_expand_imm(unsigned imm12)
+{
+ARM_CORE_WORD x;
+unsigned rot;
+
+	if (!(imm12 >> 10))
+	{
+		x = imm12 & 0xff;
+		switch ((imm12 >> 8) & 3)
+		{
+			case 0: return x;
+			case 1: return x << 16 | x;
+			case 2: return x << 24 | x << 8;
+			default: return x * 0x01010101;
+		}
+	}
+	x = 0x80 | (imm12 & 0x7f);
+	rot = imm12 >> 7;
+	return (x >> rot) | (x << (32 - rot));
+}
+
+/*!
+ *	\fn	static void scan_prologue(struct gear_engine_context * ctx, struct prologue_info * pi)
+ *	\brief	scans a function prologue for instructions that adjust the stack pointer
+ *
+ *	the scan stops at the first branch instruction, or after
+ *	MAX_PROLOGUE_SIZE bytes; the thumb-2 instructions recognized are:
+ *		- push {reglist} (16 and 32 bit encodings)
+ *		- str rt, [sp, #-4]! (a single register push)
+ *		- sub sp, sp, #imm (16 and 32 bit encodings, and subw)
+ *		- vpush {reglist}
+ *
+ *	\param	ctx	context to work in
+ *	\param	pi	the prologue scan result to fill; its func_start
+ *			field must be set to the function start address
+ *	\return	none */
+static void scan_prologue(struct gear_engine_context * ctx, struct prologue_info * pi)
+{
+unsigned char buf[MAX_PROLOGUE_SIZE];
+unsigned nbytes, i, insn_len, hw1, hw2, saved_regs_mask, adjust;
+int frame_size;
+ARM_CORE_WORD addr;
+
+	pi->nr_steps = 0;
+	pi->is_scanned = false;
+	/* the function may end close to the end of a memory region,
+	 * and reading the full prologue size may fail */
+	for (nbytes = MAX_PROLOGUE_SIZE; nbytes >= 4; nbytes /= 2)
+	{
+		i = nbytes;
+		if (ctx->cc->core_mem_read(ctx, buf, pi->func_start, &i) == GEAR_ERR_NO_ERROR && i == nbytes)
+			break;
+	}
+	if (nbytes < 4)
+		return;
+	pi->is_scanned = true;
+
+	frame_size = 0;
+	for (i = 0; i + 2 <= nbytes && pi->nr_steps < MAX_PROLOGUE_STEPS; i += insn_len)
+	{
+		addr = pi->func_start + i;
+		hw1 = buf[i] | buf[i + 1] << 8;
+		hw2 = 0;
+		insn_len = 2;
+		if ((hw1 >> 11) >= 0x1d)
+		{
+			/* 32 bit instruction */
+			if (i + 4 > nbytes)
+				break;
+			hw2 = buf[i + 2] | buf[i + 3] << 8;
+			insn_len = 4;
+		}
+		saved_regs_mask = adjust = 0;
+		if (insn_len == 2)
+		{
+			if ((hw1 & 0xfe00) == 0xb400)
+				/* push {reglist} */
+				saved_regs_mask = (hw1 & 0xff) | ((hw1 & 0x100) ? 1 << 14 : 0);
+			else if ((hw1 & 0xff80) == 0xb080)
+				/* sub sp, sp, #imm */
+				adjust = (hw1 & 0x7f) << 2;
+			else if ((hw1 & 0xf000) == 0xd000 || (hw1 & 0xf800) == 0xe000
+					|| (hw1 & 0xff00) == 0x4700 || (hw1 & 0xff00) == 0xbd00
+					|| (hw1 & 0xf500) == 0xb100)
+				/* b<c>, svc, b, bx, blx, pop {..., pc}, cbz, cbnz */
+				break;
+		}
+		else
+		{
+			if (hw1 == 0xe92d)
+				/* push.w {reglist} */
+				saved_regs_mask = hw2 & 0x5fff;
+			else if (hw1 == 0xf84d && (hw2 & 0x0fff) == 0x0d04)
+				/* str.w rt, [sp, #-4]! */
+				saved_regs_mask = 1 << (hw2 >> 12);
+			else if ((hw1 & 0xfbef) == 0xf1ad && (hw2 & 0x8f00) == 0x0d00)
+				/* sub.w sp, sp, #const */
+				adjust = thumb_expand_imm((hw1 & 0x400) << 1 | (hw2 & 0x7000) >> 4 | (hw2 & 0xff));
+			else if ((hw1 & 0xfbff) == 0xf2ad && (hw2 & 0x8f00) == 0x0d00)
+				/* subw sp, sp, #imm */
+				adjust = (hw1 & 0x400) << 1 | (hw2 & 0x7000) >> 4 | (hw2 & 0xff);
+			else if ((hw1 & 0xffbf) == 0xed2d && (hw2 & 0x0e00) == 0x0a00)
+				/* vpush {reglist} - the floating point registers
+				 * are not tracked, only the stack adjustment is */
+				adjust = (hw2 & 0xff) << 2;
+			else if ((hw1 & 0xf800) == 0xf000 && (hw2 & 0x8000))
+				/* branches, and miscellaneous control instructions */
+				break;
+		}
+		if (!saved_regs_mask && !adjust)
+			continue;
+		frame_size += adjust + 4 * __builtin_popcount(saved_regs_mask);
+		pi->steps[pi->nr_steps++] = (struct prologue_step)
+			{ .insn_addr = addr, .frame_size = frame_size, .saved_regs_mask = saved_regs_mask, };
+	}
+}
+
+/*!
+ *	\fn	static struct prologue_info * get_prologue_info(struct gear_engine_context * ctx, ARM_CORE_WORD func_start)
+ *	\brief	retrieves the prologue scan result for a function
+ *
+ *	the result is looked up in the prologue scan results cache
+ *	first, and the prologue is scanned only if not found there;
+ *	the cache entries form a list, ordered from the most recently
+ *	used to the least recently used one, and the least recently used
+ *	entry is reused when scanning the prologue of a function not in
+ *	the cache; the scan results depend only on the executable being
+ *	debugged, so the cache is never invalidated
+ *
+ *	\param	ctx	context to work in
+ *	\param	func_start	the function start address
+ *	\return	a pointer to the cache entry holding the scan result;
+ *		the entry is only valid until the next invocation of
+ *		this routine */
+static struct prologue_info * get_prologue_info(struct gear_engine_context * ctx, ARM_CORE_WORD func_start)
+{
+struct tdesc_private_data * p;
+struct prologue_info * pi, * prev;
+
+	p = ctx->tdesc->p;
+	prev = 0;
+	pi = p->mru;
+	while (!(pi->is_valid && pi->func_start == func_start) && pi->next)
+		prev = pi, pi = pi->next;
+	if (!(pi->is_valid && pi->func_start == func_start))
+	{
+		pi->func_start = func_start;
+		scan_prologue(ctx, pi);
+		pi->is_valid = true;
+	}
+	/* move the entry to the front of the list */
+	if (prev)
+	{
+		prev->next = pi->next;
+		pi->next = p->mru;
+		p->mru = pi;
+	}
+	return pi;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM unwind_exception_frame(struct gear_engine_context * ctx, const struct tdesc_unwound_reg cur_regs[], struct tdesc_unwound_reg prev_regs[], ARM_CORE_WORD * cfa, enum GEAR_ENGINE_ERR_ENUM (* read_stack_word)(struct gear_engine_context * ctx, ARM_CORE_WORD addr, ARM_CORE_WORD * val))
+ *	\brief	unwinds a frame whose program counter is an EXC_RETURN value, by reading the registers stacked on exception entry
+ *
+ *	for the parameters and the return value, see the comments about
+ *	the unwind_frame field in struct target_desc_struct, in
+ *	target-description.h */
+static enum GEAR_ENGINE_ERR_ENUM unwind_exception_frame(struct gear_engine_context * ctx,
+		const struct tdesc_unwound_reg cur_regs[],
+		struct tdesc_unwound_reg prev_regs[],
+		ARM_CORE_WORD * cfa,
+		enum GEAR_ENGINE_ERR_ENUM (* read_stack_word)(struct gear_engine_context * ctx,
+			ARM_CORE_WORD addr, ARM_CORE_WORD * val))
+{
+/* the core registers stacked on exception entry, in stacking order */
+static const int stacked_regs[NR_EXCEPTION_FRAME_WORDS - 1] = { 0, 1, 2, 3, 12, 14, 15, };
+ARM_CORE_WORD exc_return, sp, xpsr, frame_size;
+int i;
+
+	exc_return = cur_regs[15].reg_val;
+	if (exc_return & (1 << 2))
+	{
+		/* the registers have been stacked on the process stack,
+		 * whose stack pointer is not available here */
+		gprintf("cannot unwind an exception frame stacked on the process stack\n");
+		return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
+	}
+	sp = cur_regs[13].reg_val;
+	for (i = 0; i < NR_EXCEPTION_FRAME_WORDS - 1; i++)
+	{
+		prev_regs[stacked_regs[i]] = (struct tdesc_unwound_reg) { .is_valid = true,
+			.is_stored_in_memory = true, .reg_addr = sp + i * sizeof(ARM_CORE_WORD), };
+		if (read_stack_word(ctx, prev_regs[stacked_regs[i]].reg_addr,
+					&prev_regs[stacked_regs[i]].reg_val) != GEAR_ERR_NO_ERROR)
+			return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
+	}
+	if (read_stack_word(ctx, sp + i * sizeof(ARM_CORE_WORD), &xpsr) != GEAR_ERR_NO_ERROR)
+		return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
+	/* bit 4 of EXC_RETURN is clear for an extended frame */
+	frame_size = (exc_return & (1 << 4)) ? NR_EXCEPTION_FRAME_WORDS * sizeof(ARM_CORE_WORD) : EXTENDED_EXCEPTION_FRAME_SIZE;
+	/* bit 9 of the stacked xpsr is set if the core has
+	 * aligned the stack to 8 bytes on exception entry */
+	if (xpsr & (1 << 9))
+		frame_size += 4;
+	/* the registers not stacked are preserved by the exception handler */
+	for (i = 4; i < 12; i++)
+		prev_regs[i] = cur_regs[i];
+	* cfa = sp + frame_size;
+	return GEAR_ERR_NO_ERROR;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM armv7m_unwind_frame(struct gear_engine_context * ctx, const struct tdesc_unwound_reg cur_regs[], struct tdesc_unwound_reg prev_regs[], ARM_CORE_WORD * cfa, bool * is_exception_frame, enum GEAR_ENGINE_ERR_ENUM (* read_stack_word)(struct gear_engine_context * ctx, ARM_CORE_WORD addr, ARM_CORE_WORD * val))
+ *	\brief	the armv7m fallback target call stack frame unwinder
+ *
+ *	for the parameters and the return value, see the comments about
+ *	the unwind_frame field in struct target_desc_struct, in
+ *	target-description.h; also see the comments about fallback
+ *	target call stack frame unwinding at the start of this file */
+static enum GEAR_ENGINE_ERR_ENUM armv7m_unwind_frame(struct gear_engine_context * ctx,
+		const struct tdesc_unwound_reg cur_regs[],
+		struct tdesc_unwound_reg prev_regs[],
+		ARM_CORE_WORD * cfa,
+		bool * is_exception_frame,
+		enum GEAR_ENGINE_ERR_ENUM (* read_stack_word)(struct gear_engine_context * ctx,
+			ARM_CORE_WORD addr, ARM_CORE_WORD * val))
+{
+ARM_CORE_WORD pc, func_start;
+struct prologue_info * pi;
+int i, j, k, frame_size;
+
+	if (!cur_regs[13].is_valid || !cur_regs[15].is_valid)
+		return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
+	for (i = 0; i < 16; i++)
+		prev_regs[i] = (struct tdesc_unwound_reg) { .is_valid = false, };
+	pc = cur_regs[15].reg_val;
+	if ((pc & 0xffffffe0) == 0xffffffe0)
+	{
+		/* the stacked program counter value is the address of
+		 * the instruction interrupted, not a return address */
+		* is_exception_frame = true;
+		return unwind_exception_frame(ctx, cur_regs, prev_regs, cfa, read_stack_word);
+	}
+
+	pc &= ~1;
+	if (!find_func_start(ctx, pc, &func_start))
+		return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
+	pi = get_prologue_info(ctx, func_start);
+	if (!pi->is_scanned)
+		return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
+
+	/* callee saved registers not pushed by the prologue keep their values */
+	for (i = 0; i < 16; i++)
+		if (is_dwarf_reg_nr_callee_saved(ctx, i) && i != 14)
+			prev_regs[i] = cur_regs[i];
+	/* find the stack frame size first - only the prologue
+	 * instructions already executed are taken into account */
+	for (frame_size = i = 0; i < pi->nr_steps && pi->steps[i].insn_addr < pc; i++)
+		frame_size = pi->steps[i].frame_size;
+	* cfa = cur_regs[13].reg_val + frame_size;
+	/* now retrieve the registers pushed */
+	for (i = 0; i < pi->nr_steps && pi->steps[i].insn_addr < pc; i++)
+		for (j = k = 0; j < 16; j++)
+			if (pi->steps[i].saved_regs_mask & (1 << j))
+			{
+				prev_regs[j] = (struct tdesc_unwound_reg) { .is_valid = true,
+					.is_stored_in_memory = true,
+					.reg_addr = * cfa - pi->steps[i].frame_size + 4 * k ++, };
+				if (read_stack_word(ctx, prev_regs[j].reg_addr, &prev_regs[j].reg_val) != GEAR_ERR_NO_ERROR)
+					return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
+			}
+	/* the return address is the value of the link register,
+	 * either pushed by the prologue, or still in the register */
+	if (prev_regs[14].is_valid)
+	{
+		prev_regs[15] = prev_regs[14];
+		prev_regs[14].is_valid = false;
+	}
+	else if (cur_regs[14].is_valid)
+		prev_regs[15] = cur_regs[14];
+	else
+		return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
+	return GEAR_ERR_NO_ERROR;
+}
+
 
 static struct target_desc_struct armv7m_desc_struct =
 {
@@ -93,10 +570,22 @@ static struct target_desc_struct armv7m_desc_struct =
 	.translate_target_core_reg_nr_to_human_readable	= translate_target_core_reg_nr_to_human_readable,
 	.decode_insn = armv7m_insn_decode,
 	.print_disassembled_insn = armv7m_print_disassembled_insn,
+	.unwind_frame = armv7m_unwind_frame,
 };
 
 void init_armv7m_target_desc(struct gear_engine_context * ctx)
 {
+struct prologue_info * pi;
+int i;
+
 	ctx->tdesc = &armv7m_desc_struct;
+	if (!(ctx->tdesc->p = calloc(1, sizeof * ctx->tdesc->p)))
+		panic("");
+	/* create the function prologue scan results cache */
+	if (!(pi = calloc(NR_CACHED_PROLOGUES, sizeof * pi)))
+		panic("");
+	for (i = 0; i < NR_CACHED_PROLOGUES; i++)
+		pi[i].next = (i == NR_CACHED_PROLOGUES - 1) ? 0 : pi + i + 1;
+	ctx->tdesc->p->mru = pi;
 }
 
@@ -0,0 +1,268 @@
+/*!
+ *	\file	cu-hash-bench.c
+ *	\brief	gear engine - compilation unit hash table lookup benchmark
+ *	\author	shopov
+ *
+ *	this measures the cost of looking up compilation units by die
+ *	offset in the compilation unit hash table (cu-hash.c) - the very
+ *	same code used by the gear engine - for a synthetic executable
+ *	with a large number of compilation units; the die offsets are
+ *	laid out the way they are in real executables (the compilation
+ *	units follow each other in the .debug_info section, with sizes
+ *	varying wildly, and each compilation unit die immediately follows
+ *	the compilation unit header), so no executable is needed; for
+ *	comparison, the same lookups are also performed in a linked list
+ *	of compilation units, which is what the gear engine used to do
+ *
+ *	for each number of compilation units benchmarked, the time to
+ *	build the table, the average lookup time, and the average number
+ *	of slots probed per lookup are reported, for both lookups
+ *	of compilation units present in the table, and lookups of
+ *	die offsets not in the table; for running the benchmark,
+ *	see the 'run-cu-hash' target in the makefile in this directory
+ *
+ *	Revision summary:
+ *
+ *	$Log: $
+ */
+
+/*
+ *
+ * include section follows
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "cu-hash.h"
+#include "gprintf.h"
+#include "util.h"
+
+/*
+ *
+ * local constants follow
+ *
+ */
+
+/*! the default number of lookups performed for each number of compilation units benchmarked */
+static const int DEFAULT_NR_LOOKUPS = 1000000;
+/*! the number of lookups performed in the linked list of compilation units, which is way too slow for the default number of lookups above */
+static const int NR_LIST_LOOKUPS = 2000;
+/*! the size of a compilation unit header in the .debug_info section (dwarf 2, 3 and 4, 32 bit dwarf format) */
+static const unsigned CU_HEADER_SIZE = 11;
+/*! the numbers of compilation units benchmarked, unless overridden on the command line */
+static const int default_nr_cus[] = { 1000, 10000, 100000, };
+
+/*
+ *
+ * local data types follow
+ *
+ */
+
+/*! a node in a linked list of compilation units, the way the gear engine used to keep them */
+struct cu_list_node
+{
+	unsigned long long	die_offset;
+	struct cu_data		* cu_data;
+	struct cu_list_node	* next;
+};
+
+/*
+ *
+ * local functions follow
+ *
+ */
+
+/*!
+ *	\fn	static unsigned long long get_nsecs(void)
+ *	\brief	returns a monotonic timestamp, in nanoseconds
+ *
+ *	\return	the current timestamp
+ */
+static unsigned long long get_nsecs(void)
+{
+struct timespec t;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &t))
+		panic("");
+	return t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+/*!
+ *	\fn	static int nr_probes(struct cu_hash * p, unsigned long long die_offset)
+ *	\brief	counts the hash table slots examined when looking up a die offset
+ *
+ *	\param	p	the hash table to examine
+ *	\param	die_offset	the die offset looked up
+ *	\return	the number of slots examined by cu_hash_get() for die_offset
+ */
+static int nr_probes(struct cu_hash * p, unsigned long long die_offset)
+{
+int i, n;
+
+	for (n = 1, i = cu_hash_offset(die_offset) & (p->htab_size - 1);
+			p->htab[i].cu_data && p->htab[i].die_offset != die_offset;
+			i = (i + 1) & (p->htab_size - 1))
+		n ++;
+	return n;
+}
+
+/*!
+ *	\fn	static struct cu_data * list_get_cu(struct cu_list_node * list, unsigned long long die_offset)
+ *	\brief	looks up a die offset in a linked list of compilation units
+ *
+ *	\param	list	the list to look up
+ *	\param	die_offset	the die offset to look up
+ *	\return	the compilation unit found, null if not found
+ */
+static struct cu_data * list_get_cu(struct cu_list_node * list, unsigned long long die_offset)
+{
+	for (; list; list = list->next)
+		if (list->die_offset == die_offset)
+			return list->cu_data;
+	return 0;
+}
+
+/*!
+ *	\fn	static void bench_nr_cus(int nr_cus, int nr_lookups)
+ *	\brief	benchmarks the compilation unit hash table for a given number of compilation units, and reports the results
+ *
+ *	\param	nr_cus	the number of compilation units
+ *	\param	nr_lookups	the number of lookups to perform
+ *	\return	none
+ */
+static void bench_nr_cus(int nr_cus, int nr_lookups)
+{
+unsigned long long * offsets, * lookups, offset, start, hit_nsecs, miss_nsecs, build_nsecs, list_nsecs;
+unsigned long long hit_probes, miss_probes;
+struct cu_list_node * list, * nodes;
+struct cu_hash * p;
+char * cus;
+int i;
+
+	if (!(offsets = malloc(nr_cus * sizeof * offsets))
+			|| !(lookups = malloc(nr_lookups * sizeof * lookups))
+			|| !(nodes = malloc(nr_cus * sizeof * nodes))
+			/* the compilation unit data nodes are never
+			 * dereferenced here - just make up distinct pointers */
+			|| !(cus = malloc(nr_cus)))
+		panic("out of core");
+
+	/* lay out the compilation units in the .debug_info section;
+	 * compilation unit sizes range from a few tens of bytes to
+	 * a few tens of kilobytes */
+	for (offset = i = 0; i < nr_cus; i++)
+	{
+		offsets[i] = offset + CU_HEADER_SIZE;
+		offset += CU_HEADER_SIZE + 16 + (rand() % 64) * (rand() % 512);
+	}
+	for (i = 0; i < nr_lookups; i++)
+		lookups[i] = offsets[rand() % nr_cus];
+
+	/* build the hash table - starting with a small table, so
+	 * that growing the table is accounted for as well */
+	start = get_nsecs();
+	p = cu_hash_create(0);
+	for (i = 0; i < nr_cus; i++)
+		cu_hash_put(p, offsets[i], (struct cu_data *) (cus + i));
+	build_nsecs = get_nsecs() - start;
+
+	/* lookups of compilation units present in the table */
+	start = get_nsecs();
+	for (i = 0; i < nr_lookups; i++)
+		if (!cu_hash_get(p, lookups[i]))
+			panic("");
+	hit_nsecs = get_nsecs() - start;
+	/* lookups of die offsets not in the table - these
+	 * fall in the middle of compilation units */
+	start = get_nsecs();
+	for (i = 0; i < nr_lookups; i++)
+		if (cu_hash_get(p, lookups[i] + 1))
+			panic("");
+	miss_nsecs = get_nsecs() - start;
+
+	/* validate the table, and gather the probe statistics */
+	for (i = 0; i < nr_cus; i++)
+		if (cu_hash_get(p, offsets[i]) != (struct cu_data *) (cus + i))
+			panic("");
+	for (hit_probes = miss_probes = i = 0; i < nr_lookups; i++)
+	{
+		hit_probes += nr_probes(p, lookups[i]);
+		miss_probes += nr_probes(p, lookups[i] + 1);
+	}
+
+	/* the linked list of compilation units, for comparison */
+	for (list = 0, i = 0; i < nr_cus; i++)
+	{
+		nodes[i].die_offset = offsets[i];
+		nodes[i].cu_data = (struct cu_data *) (cus + i);
+		nodes[i].next = list;
+		list = nodes + i;
+	}
+	start = get_nsecs();
+	for (i = 0; i < NR_LIST_LOOKUPS && i < nr_lookups; i++)
+		if (!list_get_cu(list, lookups[i]))
+			panic("");
+	list_nsecs = get_nsecs() - start;
+
+	printf("%10i%12i%12.1f%12.2f%12.2f%12.2f%12.2f%14.1f\n",
+			nr_cus, p->htab_size, build_nsecs / 1000000.0,
+			hit_nsecs / (double) nr_lookups, hit_probes / (double) nr_lookups,
+			miss_nsecs / (double) nr_lookups, miss_probes / (double) nr_lookups,
+			list_nsecs / (double) (i ? i : 1));
+	fflush(stdout);
+
+	free(p->htab);
+	free(p);
+	free(cus);
+	free(nodes);
+	free(lookups);
+	free(offsets);
+}
+
+/*
+ *
+ * exported functions follow
+ *
+ */
+
+int main(int argc, char ** argv)
+{
+int i, nr_lookups, nr_cus;
+
+	nr_lookups = DEFAULT_NR_LOOKUPS;
+	nr_cus = 0;
+	for (i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--lookups") && i + 1 < argc)
+			nr_lookups = strtoul(argv[++i], 0, 0);
+		else if (!strcmp(argv[i], "--cus") && i + 1 < argc)
+			nr_cus = strtoul(argv[++i], 0, 0);
+		else
+		{
+			printf("usage: %s [--cus nr_compilation_units] [--lookups nr_lookups]\n", argv[0]);
+			exit(1);
+		}
+	}
+	if (nr_lookups <= 0 || nr_cus < 0)
+	{
+		printf("bad options\n");
+		exit(1);
+	}
+
+	srand(1);
+	printf("lookups: %i (%i in the linked list)\n", nr_lookups, NR_LIST_LOOKUPS);
+	printf("%10s%12s%12s%12s%12s%12s%12s%14s\n", "cus", "slots", "build (ms)",
+			"hit (ns)", "hit probes", "miss (ns)", "miss probes", "list hit (ns)");
+	if (nr_cus)
+		bench_nr_cus(nr_cus, nr_lookups);
+	else
+		for (i = 0; i < (int) (sizeof default_nr_cus / sizeof * default_nr_cus); i++)
+			bench_nr_cus(default_nr_cus[i], nr_lookups);
+	return 0;
+}
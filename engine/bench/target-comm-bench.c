@@ -0,0 +1,408 @@
+/*!
+ *	\file	target-comm-bench.c
+ *	\brief	gear engine - target core controller communication benchmark
+ *	\author	shopov
+ *
+ *	this measures the throughput and latency of the communication
+ *	between the gear engine and a target core controller, by
+ *	driving the target core access routines of the target
+ *	communication module (target-comm.c) - the very same code
+ *	used by the gear engine - against a target core controller;
+ *	this is normally run against the loopback target core
+ *	controller (see target-ctl/loopback), which models a target
+ *	core in memory, with an optional artificial latency and
+ *	bandwidth limit, so that no target hardware is needed and
+ *	the results are reproducible; for running the benchmark,
+ *	see the 'run' target in the makefile in this directory
+ *
+ *	for each operation benchmarked, the number of operations per
+ *	second, the target memory throughput (where applicable), and
+ *	the median (p50) and 99th percentile (p99) operation latencies
+ *	are reported; at the end, the target communication statistics
+ *	(see target_comm_dump_xfer_stats_mi()) are dumped as well
+ *
+ *	Revision summary:
+ *
+ *	$Log: $
+ */
+
+/*
+ *
+ * include section follows
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+/* only pointers to these are needed (in struct gear_engine_context);
+ * they are declared here, so that the benchmark builds without
+ * the libdwarf and libelf headers */
+typedef struct Elf Elf;
+typedef struct Dwarf_Debug_s * Dwarf_Debug;
+
+#include "target-defs.h"
+#include "gear-engine-context.h"
+#include "engine-err.h"
+#include "core-access.h"
+#include "target-description.h"
+#include "target-comm.h"
+#include "target-comm-frame.h"
+#include "gprintf.h"
+#include "miprintf.h"
+#include "util.h"
+
+/* these are not declared in any header */
+void init_target_comm(struct gear_engine_context * ctx);
+int target_comm_get_core_access(struct core_control * cc);
+void gprintf_switch_on(bool on);
+
+/*
+ *
+ * local constants follow
+ *
+ */
+
+/*! the port on which the target core controller listens for incoming connections */
+static const int TARGET_CORE_CONTROLLER_SERVER_SOCKET_PORT_NR = 0x1111;
+/*! the target address of the ram model of the loopback target core controller; see target-ctl/loopback/target/target.c */
+static const ARM_CORE_WORD BENCH_RAM_BASE = 0x20000000;
+/*! the size of the ram model of the loopback target core controller */
+static const unsigned BENCH_RAM_SIZE = 0x100000;
+/*! the default number of times each operation is performed */
+static const int DEFAULT_NR_ITERATIONS = 1000;
+/*! the default number of bytes transferred by each target memory operation */
+static const unsigned DEFAULT_XFER_SIZE = 0x1000;
+/*! the default maximum number of target memory transfer requests outstanding */
+static const int DEFAULT_TARGET_XFER_WINDOW = 8;
+/*! the number of attempts to connect to the target core controller */
+static const int CONNECT_RETRY_COUNT = 50;
+/*! the delay between the attempts to connect to the target core controller, in milliseconds */
+static const int CONNECT_RETRY_DELAY_MS = 100;
+
+/*
+ *
+ * local data follows
+ *
+ */
+
+/*! the operations benchmarked */
+enum BENCH_OP_ENUM
+{
+	BENCH_OP_MEM_READ = 0,
+	BENCH_OP_MEM_WRITE,
+	BENCH_OP_REG_READ,
+	BENCH_OP_STEP,
+	BENCH_OP_RUN,
+	NR_BENCH_OPS,
+};
+
+static const char * bench_op_names[NR_BENCH_OPS] =
+{
+	[BENCH_OP_MEM_READ]	= "mem_read",
+	[BENCH_OP_MEM_WRITE]	= "mem_write",
+	[BENCH_OP_REG_READ]	= "reg_read",
+	[BENCH_OP_STEP]		= "step",
+	[BENCH_OP_RUN]		= "run",
+};
+
+/*! if true, the gear engine machine interface output is printed, otherwise it is discarded; see write_to_frontends() */
+static bool is_mi_output_enabled;
+
+/*
+ *
+ * local functions follow
+ *
+ */
+
+/* the target description of the loopback target core controller;
+ * only the routines needed by the target communication module
+ * are provided - the register numbering is the armv7m one */
+static int get_nr_target_core_regs(struct gear_engine_context * ctx) { return 16; }
+static int get_target_pc_reg_nr(struct gear_engine_context * ctx) { return 15; }
+static int get_target_sp_reg_nr(struct gear_engine_context * ctx) { return 13; }
+static int get_target_pstat_reg_nr(struct gear_engine_context * ctx) { return 17; }
+
+static struct target_desc_struct bench_desc_struct =
+{
+	.get_nr_target_core_regs = get_nr_target_core_regs,
+	.get_target_pc_reg_nr = get_target_pc_reg_nr,
+	.get_target_sp_reg_nr = get_target_sp_reg_nr,
+	.get_target_pstat_reg_nr = get_target_pstat_reg_nr,
+};
+
+/*!
+ *	\fn	static unsigned long long get_usecs(void)
+ *	\brief	returns a monotonic timestamp, in microseconds
+ *
+ *	\return	the current timestamp
+ */
+static unsigned long long get_usecs(void)
+{
+struct timespec t;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &t))
+		panic("");
+	return t.tv_sec * 1000000ULL + t.tv_nsec / 1000;
+}
+
+static int cmp_usecs(const void * a, const void * b)
+{
+unsigned long long x, y;
+
+	x = * (const unsigned long long *) a;
+	y = * (const unsigned long long *) b;
+	return (x < y) ? -1 : ((x > y) ? 1 : 0);
+}
+
+/*!
+ *	\fn	static void wait_halted(struct gear_engine_context * ctx)
+ *	\brief	waits until the target core halts, after it has been run or single stepped
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+static void wait_halted(struct gear_engine_context * ctx)
+{
+enum TARGET_CORE_STATE_ENUM state;
+
+	do
+		if (ctx->cc->core_get_status(ctx, &state) != GEAR_ERR_NO_ERROR)
+			panic("");
+	while (state == TARGET_CORE_STATE_RUNNING);
+	if (state != TARGET_CORE_STATE_HALTED)
+		panic("");
+}
+
+/*!
+ *	\fn	static unsigned do_op(struct gear_engine_context * ctx, enum BENCH_OP_ENUM op, int iteration, unsigned char * buf, unsigned xfer_size)
+ *	\brief	performs a single benchmarked operation
+ *
+ *	\param	ctx	context to work in
+ *	\param	op	the operation to perform
+ *	\param	iteration	the number of the operation; target memory
+ *				operations cycle through the ram model, so that
+ *				the same target memory is not accessed every time
+ *	\param	buf	a buffer for the target memory operations
+ *	\param	xfer_size	the number of bytes transferred by the target memory operations
+ *	\return	the number of target memory bytes transferred by the operation
+ */
+static unsigned do_op(struct gear_engine_context * ctx, enum BENCH_OP_ENUM op, int iteration, unsigned char * buf, unsigned xfer_size)
+{
+ARM_CORE_WORD addr;
+ARM_CORE_WORD regs[16];
+unsigned nbytes;
+
+	/* keep clear of the top of the ram model, where the
+	 * target stack pointer of the loopback target core points */
+	addr = BENCH_RAM_BASE + (iteration * xfer_size) % (BENCH_RAM_SIZE / 2);
+	nbytes = xfer_size;
+	switch (op)
+	{
+		case BENCH_OP_MEM_READ:
+			if (ctx->cc->core_mem_read(ctx, buf, addr, &nbytes) != GEAR_ERR_NO_ERROR
+					|| nbytes != xfer_size)
+				panic("");
+			return nbytes;
+		case BENCH_OP_MEM_WRITE:
+			if (ctx->cc->core_mem_write(ctx, addr, buf, &nbytes) != GEAR_ERR_NO_ERROR
+					|| nbytes != xfer_size)
+				panic("");
+			return nbytes;
+		case BENCH_OP_REG_READ:
+			if (ctx->cc->core_reg_read(ctx, 0, (1 << get_nr_target_core_regs(ctx)) - 1, regs)
+					!= GEAR_ERR_NO_ERROR)
+				panic("");
+			return 0;
+		case BENCH_OP_STEP:
+			if (ctx->cc->core_insn_step(ctx) != GEAR_ERR_NO_ERROR)
+				panic("");
+			wait_halted(ctx);
+			return 0;
+		case BENCH_OP_RUN:
+			if (ctx->cc->core_run(ctx) != GEAR_ERR_NO_ERROR)
+				panic("");
+			wait_halted(ctx);
+			return 0;
+		default:
+			panic("");
+	}
+}
+
+/*!
+ *	\fn	static void bench_op(struct gear_engine_context * ctx, enum BENCH_OP_ENUM op, int nr_iterations, unsigned xfer_size)
+ *	\brief	benchmarks an operation, and reports the results
+ *
+ *	\param	ctx	context to work in
+ *	\param	op	the operation to benchmark
+ *	\param	nr_iterations	the number of times to perform the operation
+ *	\param	xfer_size	the number of bytes transferred by the target memory operations
+ *	\return	none
+ */
+static void bench_op(struct gear_engine_context * ctx, enum BENCH_OP_ENUM op, int nr_iterations, unsigned xfer_size)
+{
+unsigned long long * usecs, start, total_usecs, nr_bytes;
+unsigned char * buf;
+unsigned i;
+
+	if (!(usecs = malloc(nr_iterations * sizeof * usecs)))
+		panic("out of core");
+	if (!(buf = malloc(xfer_size)))
+		panic("out of core");
+	for (i = 0; i < xfer_size; i++)
+		buf[i] = i;
+	total_usecs = nr_bytes = 0;
+	for (i = 0; i < nr_iterations; i++)
+	{
+		start = get_usecs();
+		nr_bytes += do_op(ctx, op, i, buf, xfer_size);
+		usecs[i] = get_usecs() - start;
+		total_usecs += usecs[i];
+	}
+	qsort(usecs, nr_iterations, sizeof * usecs, cmp_usecs);
+	if (!total_usecs)
+		total_usecs = 1;
+	printf("%-12s%12.1f", bench_op_names[op], nr_iterations * 1000000.0 / total_usecs);
+	if (nr_bytes)
+		printf("%12.3f", nr_bytes / (double) total_usecs);
+	else
+		printf("%12s", "-");
+	printf("%12llu%12llu\n", usecs[nr_iterations / 2], usecs[nr_iterations * 99 / 100]);
+	fflush(stdout);
+	free(buf);
+	free(usecs);
+}
+
+/*
+ *
+ * exported functions follow
+ *
+ */
+
+/*!
+ *	\fn	int write_to_frontends(const void * buf, size_t count)
+ *	\brief	sends gear engine machine interface output to the front ends
+ *
+ *	the target communication module reports its statistics in
+ *	machine interface format; there are no front ends connected
+ *	here, so the output is discarded, unless the statistics are
+ *	being dumped at the end of the benchmark
+ *
+ *	\param	buf	the output to send
+ *	\param	count	the number of bytes to send
+ *	\return	the number of bytes sent
+ */
+int write_to_frontends(const void * buf, size_t count)
+{
+	if (is_mi_output_enabled)
+		fwrite(buf, 1, count, stdout);
+	return count;
+}
+
+int main(int argc, char ** argv)
+{
+static struct gear_engine_context ctx;
+static struct core_control cc;
+const char * errmsg_hint;
+int i, nr_iterations;
+unsigned xfer_size;
+enum BENCH_OP_ENUM op;
+enum GEAR_ENGINE_ERR_ENUM err;
+
+	ctx.settings.target_ctl_port_nr = TARGET_CORE_CONTROLLER_SERVER_SOCKET_PORT_NR;
+	ctx.settings.target_xfer_window = DEFAULT_TARGET_XFER_WINDOW;
+	/* retrieve the top of the target stack whenever the target
+	 * halts, just like the gear engine does by default */
+	ctx.settings.nr_halt_snapshot_windows = 1;
+	ctx.settings.halt_snapshot_windows[0].base_reg_nr = HALT_SNAPSHOT_WINDOW_SP;
+	ctx.settings.halt_snapshot_windows[0].offset = 0;
+	ctx.settings.halt_snapshot_windows[0].nbytes = 0x400;
+	nr_iterations = DEFAULT_NR_ITERATIONS;
+	xfer_size = DEFAULT_XFER_SIZE;
+
+	for (i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--binary-target-protocol"))
+			ctx.settings.is_binary_target_protocol_enabled = true;
+		else if (!strcmp(argv[i], "--target-xfer-window") && i + 1 < argc)
+			ctx.settings.target_xfer_window = strtoul(argv[++i], 0, 0);
+		else if (!strcmp(argv[i], "--target-compression") && i + 1 < argc)
+		{
+			i++;
+			if (!strcmp(argv[i], "rle"))
+				ctx.settings.target_payload_encodings = 1 << TARGET_COMM_ENCODING_RLE;
+			else if (!strcmp(argv[i], "lz"))
+				ctx.settings.target_payload_encodings = 1 << TARGET_COMM_ENCODING_LZ;
+			else if (strcmp(argv[i], "none"))
+			{
+				printf("bad options\n");
+				exit(1);
+			}
+		}
+		else if (!strcmp(argv[i], "--iterations") && i + 1 < argc)
+			nr_iterations = strtoul(argv[++i], 0, 0);
+		else if (!strcmp(argv[i], "--xfer-size") && i + 1 < argc)
+			xfer_size = strtoul(argv[++i], 0, 0);
+		else
+		{
+			printf("usage: %s [--binary-target-protocol] [--target-xfer-window nr_requests] "
+					"[--target-compression rle|lz|none] "
+					"[--iterations nr_iterations] [--xfer-size nbytes]\n", argv[0]);
+			exit(1);
+		}
+	}
+	if (nr_iterations <= 0 || !xfer_size || xfer_size > BENCH_RAM_SIZE / 2
+			|| ctx.settings.target_xfer_window <= 0)
+	{
+		printf("bad options\n");
+		exit(1);
+	}
+
+	/* keep the target communication module quiet */
+	gprintf_switch_on(false);
+	miprintf_switch_debug(false);
+
+	ctx.tdesc = &bench_desc_struct;
+	init_target_comm(&ctx);
+	target_comm_get_core_access(ctx.cc = &cc);
+	/* the target core controller may have just been started,
+	 * and may not be accepting connections yet - retry for a while */
+	for (i = 0; i < CONNECT_RETRY_COUNT; i++)
+	{
+		errmsg_hint = 0;
+		if ((err = ctx.cc->core_open(&ctx, &errmsg_hint)) == GEAR_ERR_NO_ERROR)
+			break;
+		usleep(CONNECT_RETRY_DELAY_MS * 1000);
+	}
+	if (err != GEAR_ERR_NO_ERROR)
+	{
+		printf("failed to connect to a target core controller: %s\n",
+				errmsg_hint ? errmsg_hint : "unknown error");
+		exit(1);
+	}
+	/* make sure the target core is halted */
+	wait_halted(&ctx);
+
+	printf("protocol: %s, transfer window: %i, compression: %s, iterations: %i, transfer size: %u bytes\n",
+			ctx.settings.is_binary_target_protocol_enabled ? "binary" : "ascii",
+			ctx.settings.target_xfer_window,
+			(ctx.settings.target_payload_encodings & (1 << TARGET_COMM_ENCODING_LZ)) ? "lz" :
+			(ctx.settings.target_payload_encodings & (1 << TARGET_COMM_ENCODING_RLE)) ? "rle" : "none",
+			nr_iterations, xfer_size);
+	printf("%-12s%12s%12s%12s%12s\n", "operation", "ops/s", "MB/s", "p50 (us)", "p99 (us)");
+	for (op = 0; op < NR_BENCH_OPS; op++)
+		bench_op(&ctx, op, nr_iterations, xfer_size);
+
+	is_mi_output_enabled = true;
+	target_comm_dump_xfer_stats_mi(&ctx);
+	miprintf("\n");
+	return 0;
+}
+
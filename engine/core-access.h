@@ -37,7 +37,7 @@
  *		be also brought up to date whenever a modification
  *		to the list is made
  *
- *		to day (17032009) the following modules in the
+ *		to day (18102026) the following modules in the
  *		gear engine, along with the target state change
  *		notification callback functions within them, are present:
  *		- module exec.c, function exec_update_target_state(); this
@@ -57,6 +57,15 @@
  *			purpose - used for stepping over breakpointed
  *			instructions for arm targets that do not support
  *			this natively (in hardware)
+ *		- module image-mem.c, function
+ *			image_mem_target_state_change_callback();
+ *			used for discarding the verification status of the
+ *			executable image program segments when the target dies
+ *		- module mem-cache.c, function
+ *			mem_cache_target_state_change_callback();
+ *			used for making the target memory cache operative
+ *			or inoperative, and for discarding stale cached
+ *			target memory contents
  *
  *	\todo	somehow enforce the requirements above
  *
@@ -75,7 +84,7 @@
  *		be also brought up to date whenever a modification
  *		to the list is made
  *
- *		to day (17032009) the following modules in the
+ *		to day (18102026) the following modules in the
  *		gear engine, along with the overriding functions
  *		contained within them, are present:
  *		- module frame-reg-cache.c, functions:
@@ -93,6 +102,24 @@
  *			purpose - used for stepping over breakpointed
  *			instructions for arm targets that do not support
  *			this natively (in hardware)
+ *		- module frame-reg-cache.c, function
+ *			reg_cache_core_get_halt_snapshot(), overrides function
+ *			core_get_halt_snapshot; purpose - populate the
+ *			register cache from the target core registers
+ *			retrieved when the target halts
+ *		- module image-mem.c, functions:
+ *			image_mem_core_mem_read(), overrides function
+ *			core_mem_read; function image_mem_core_mem_write(),
+ *			overrides function core_mem_write; purpose - serve
+ *			reads of the non-writable program segments of
+ *			the executable from the executable file
+ *		- module mem-cache.c, functions:
+ *			mem_cache_core_mem_read(), overrides function
+ *			core_mem_read; function mem_cache_core_mem_write(),
+ *			overrides function core_mem_write; function
+ *			mem_cache_core_get_halt_snapshot(), overrides function
+ *			core_get_halt_snapshot; purpose - cache target
+ *			memory contents
  *
  *
  *	\todo	somehow enforce the requirements above
@@ -117,6 +144,9 @@
  * separate header file because it is also needed by
  * the target controller code */
 #include "target-state.h"
+/* the error code enumeration is needed for the halt snapshot
+ * memory window data structure below */
+#include "engine-err.h"
 
 /*
  *
@@ -124,6 +154,48 @@
  *
  */
 
+/*! a target memory window, retrieved as part of a halt snapshot (see struct core_halt_snapshot below) */
+struct core_mem_window
+{
+	/*! the number of the target core register holding the base address of the window; CORE_MEM_WINDOW_ABSOLUTE if the window address is absolute
+	 *
+	 * the base register must be present in the register mask of the snapshot */
+	int		base_reg_nr;
+/*! a value for the base_reg_nr field above, denoting an absolute window address */
+#define CORE_MEM_WINDOW_ABSOLUTE	(-1)
+	/*! the offset of the window from the base address (or the window address, if the window address is absolute) */
+	ARM_CORE_WORD	offset;
+	/*! on entry - the number of bytes in the window; on exit - the number of bytes actually read */
+	unsigned	nbytes;
+	/*! on exit - the target address of the window, as computed by the target core controller */
+	ARM_CORE_WORD	addr;
+	/*! on exit - the status code of reading the window */
+	enum GEAR_ENGINE_ERR_ENUM	err;
+	/*! the buffer to store the window contents in; must be at least nbytes (on entry) in size */
+	unsigned char	* buf;
+};
+
+/*! a target halt snapshot - the data retrieved by a single core_get_halt_snapshot() request
+ *
+ * this is the target core state, a set of target core registers,
+ * and a set of target memory windows, the addresses of which may
+ * be specified relative to the values of target core registers
+ * (e.g. the top of the target stack); the registers and memory
+ * windows are only retrieved if the target core is halted */
+struct core_halt_snapshot
+{
+	/*! on exit - the target core state */
+	enum TARGET_CORE_STATE_ENUM	state;
+	/*! the mask of target core registers to retrieve, encoded as for core_reg_read() */
+	unsigned long	reg_mask;
+	/*! on exit - the values of the registers retrieved, one for each bit set in reg_mask, in ascending bit order */
+	ARM_CORE_WORD	* regs;
+	/*! the number of target memory windows in the mem_windows array below */
+	int		nr_mem_windows;
+	/*! the target memory windows to retrieve */
+	struct core_mem_window	* mem_windows;
+};
+
 /*! core control data structure */
 struct core_control
 {
@@ -187,6 +259,22 @@ struct core_control
 	enum GEAR_ENGINE_ERR_ENUM (*io_ctl)(struct gear_engine_context * ctx, int request_len, ARM_CORE_WORD * request, ARM_CORE_WORD response_len, ARM_CORE_WORD * response);
 	/*! obtains target core status information */
 	enum GEAR_ENGINE_ERR_ENUM (*core_get_status)(struct gear_engine_context * ctx, enum TARGET_CORE_STATE_ENUM * status);
+	/*! obtains a halt snapshot - the target core status, target core registers and target memory windows - in a single request
+	 *
+	 * this is what most gear engine modules need to retrieve
+	 * whenever the target halts; it is served by a single round
+	 * trip to the target core controller when possible - when
+	 * the target core controller does not support this, the
+	 * snapshot is put together from separate requests; see
+	 * struct core_halt_snapshot above for details
+	 *
+	 * \note	this routine does not invoke the target state change
+	 *		callbacks; it is invoked by the target core controller
+	 *		communication module whenever the target is found to
+	 *		have halted, right before the callbacks are invoked,
+	 *		so that modules overriding this routine can populate
+	 *		their caches from the snapshot */
+	enum GEAR_ENGINE_ERR_ENUM (*core_get_halt_snapshot)(struct gear_engine_context * ctx, struct core_halt_snapshot * snapshot);
 	/*! registers a callback function to be invoked when a (possible) change of the state of a target core is detected by some of the core-control routines here
 	 *
 	 * this is mainly needed to inform interested parties about (eventual)
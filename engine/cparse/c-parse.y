@@ -282,6 +282,7 @@
 #include "dwarf-loc.h"
 #include "subprogram-access.h"
 #include "dobj-access.h"
+#include "dobj-value.h"
 #include "aranges-access.h"
 #include "type-access.h"
 #include "util.h"
@@ -421,6 +422,13 @@ struct parser_state
 	 * fails, it never gets reset to 'false' during the operation of the
 	 * parser */
 	bool is_target_access_failed;
+	/*! the reason for the is_target_access_failed flag above to be set
+	 *
+	 * this is GEAR_ERR_TARGET_ACCESS_ERROR if accessing the target
+	 * failed, or GEAR_ERR_DOBJ_OPTIMIZED_OUT if the value of a
+	 * data object is unavailable in the currently selected target
+	 * call stack frame (see dobj_value_fetch() in dobj-value.c) */
+	enum GEAR_ENGINE_ERR_ENUM	target_access_errcode;
 
 	/*! error code returned by the parser
 	 *
@@ -1409,6 +1417,21 @@ static inline void set_parse_abort_vars(struct parser_state * state, enum GEAR_E
 		state->parse_msg = 0;
 }
 
+/*!
+ *	\fn	static void set_target_access_abort_vars(struct parser_state * state)
+ *	\brief	sets the parser abort variables after fetching the value of a data object has failed
+ *
+ *	\param	state	parser state whose abort variables must be set; its
+ *			is_target_access_failed flag is expected to be set
+ *	\return	none */
+static void set_target_access_abort_vars(struct parser_state * state)
+{
+	if (state->target_access_errcode == GEAR_ERR_DOBJ_OPTIMIZED_OUT)
+		set_parse_abort_vars(state, GEAR_ERR_DOBJ_OPTIMIZED_OUT, "value optimized out");
+	else
+		set_parse_abort_vars(state, GEAR_ERR_TARGET_ACCESS_ERROR, "error accessing the target");
+}
+
 /*!
  *	\fn	static enum GEAR_ENGINE_ERR_ENUM resolve_id(struct parser_state * state, struct exp_data_node * exp_node)
  *	\brief	resolves the location of an identifier used in an expression
@@ -1446,12 +1469,16 @@ static inline void set_parse_abort_vars(struct parser_state * state, enum GEAR_E
  *	\return	GEAR_ERR_NO_ERROR on success, GEAR_ERR_EXPR_SEMANTIC_ERROR (and the
  *		parser abortion variables will have been properly set) in case of an error,
  *		GEAR_ERR_TARGET_ACCESS_ERROR if resolving the identifier requires
- *		target resources that are inaccessible
+ *		target resources that are inaccessible, GEAR_ERR_DOBJ_OPTIMIZED_OUT
+ *		if the identifier is a data object that is not available at the
+ *		program counter value of the selected frame; the data object
+ *		location is computed by dobj_value_locate() in dobj-value.c
  */
 static enum GEAR_ENGINE_ERR_ENUM resolve_id(struct parser_state * state, struct exp_data_node * exp_node)
 {
-ARM_CORE_WORD addr;
-bool is_result_in_reg;
+enum GEAR_ENGINE_ERR_ENUM err;
+struct dobj_location loc;
+bool is_result_in_reg, is_fbreg_valid;
 enum DWARF_EXPR_INFO_ENUM eval_info;
 struct dwarf_head_struct * dwhead;
 struct dobj_data * dobj;
@@ -1520,6 +1547,7 @@ ARM_CORE_WORD pc;
 			cubase = ((struct cu_data *) dwhead)->default_cu_base_address;
 
 			fbreg = 0;
+			is_fbreg_valid = false;
 
 			/* retrieve frame base address */
 			if (state->ctx->cc->core_reg_read(state->ctx,
@@ -1529,6 +1557,7 @@ ARM_CORE_WORD pc;
 			{
 				/* target access error */
 				state->is_target_access_failed = true;
+				state->target_access_errcode = GEAR_ERR_TARGET_ACCESS_ERROR;
 
 				/*! \todo	this mysterious -2 is to
 				 *		force the program counter to
@@ -1549,69 +1578,43 @@ ARM_CORE_WORD pc;
 				if (cu)
 					cubase = cu->default_cu_base_address;
 
-				if (subp)
-				{
-					if (!subp->is_frame_base_available)
-						panic("");
-					if (dwarf_loc_eval_loc_from_list(state->ctx,
+				if (subp && subp->is_frame_base_available)
+					is_fbreg_valid = dwarf_loc_eval_loc_from_list(state->ctx,
 								&fbreg,
 								&is_result_in_reg,
 								&eval_info,
 								&subp->fb_location,
 								pc,
 								cubase,
-								0) != GEAR_ERR_NO_ERROR)
-						panic("");
-					if (eval_info == DW_EXPR_INFO_INVALID || eval_info >= DW_EXPR_NEEDS_FBREG)
-						panic("");
-				}
+								0) == GEAR_ERR_NO_ERROR
+						&& eval_info != DW_EXPR_INFO_INVALID && eval_info < DW_EXPR_NEEDS_FBREG;
 			}
 
 			exp_node->data_obj.type = dobj->type;
 
-			/* retrieve object address */
-			if (!dobj->is_location_valid)
+			/* retrieve object location */
+			if ((err = dobj_value_locate(state->ctx, dobj, pc, cubase,
+							fbreg, is_fbreg_valid, &loc)) != GEAR_ERR_NO_ERROR)
 			{
-				void * buf;
-				int size;
-				/* no location information is present about
-				 * this data object - however, it may still
-				 * be possible to access it if it has been
-				 * reduced to a constant value */
-				if (!dobj->is_constant_value)
-					panic("");
-				/*! \todo	fix the size checks when
-				 *		dwarf block forms are supported */
-				size = dtype_access_sizeof((struct dwarf_head_struct *) exp_node->data_obj.type);
-				if (size > sizeof dobj->const_val)
-					panic("");
-				exp_node->data_obj.flags.is_val_applicable = 1;
-				exp_node->data_obj.flags.is_addr_applicable = 0;
-				if (!(buf = calloc(1, size)))
-					panic("");
-				exp_node->val.data = buf;
-				exp_node->data_obj.flags.is_val_fetched = 1;
-				memcpy(buf, &dobj->const_val, size);
-				break;
+				if (state->is_target_access_failed)
+					err = GEAR_ERR_TARGET_ACCESS_ERROR;
+				switch (err)
+				{
+					case GEAR_ERR_TARGET_ACCESS_ERROR:
+						set_parse_abort_vars(state, err, "target access error");
+						break;
+					case GEAR_ERR_DOBJ_OPTIMIZED_OUT:
+						set_parse_abort_vars(state, err, "value optimized out");
+						break;
+					default:
+						set_parse_abort_vars(state, err, "error retrieving object address");
+						break;
+				}
+				return err;
 			}
-
-			/* location information is present - process it */
-			if (dwarf_loc_eval_loc_from_list(state->ctx,
-				&addr,
-				&is_result_in_reg,
-				&eval_info,
-				&dobj->location,
-				pc,
-				cubase,
-				fbreg) != GEAR_ERR_NO_ERROR)
-					panic("error retrieving object address");
-
-			/* validate address computed */
-			if (eval_info == DW_EXPR_INFO_INVALID || eval_info > DW_EXPR_NEEDS_FBREG)
-				panic("");
 			if (state->is_target_access_failed)
 			{
-					if (eval_info >= DW_EXPR_NEEDS_TARGET_MEM_ACCESS)
+					if (loc.eval_info >= DW_EXPR_NEEDS_TARGET_MEM_ACCESS)
 					{
 						set_parse_abort_vars(state, GEAR_ERR_TARGET_ACCESS_ERROR, "target access error");
 						return GEAR_ERR_TARGET_ACCESS_ERROR;
@@ -1620,44 +1623,34 @@ ARM_CORE_WORD pc;
 					state->is_target_access_failed = 0;
 			}
 
-			exp_node->data_obj.flags.is_val_applicable = exp_node->data_obj.flags.is_addr_applicable = 1;
-			/*! \todo	a quick hack - fix this */
-			if (is_result_in_reg)
+			switch (loc.kind)
 			{
-				int nr_target_core_regs;
-				exp_node->data_obj.flags.is_addr_a_reg_nr = 1;
-				if (!(nr_target_core_regs
-						= state->ctx->tdesc->get_nr_target_core_regs(state->ctx)))
-					panic("");
-				if (addr >= nr_target_core_regs)
-					panic("");
-				exp_node->data_obj.reg_nr = addr;
-			}
-			else
-			{
-				if (eval_info != DW_EXPR_LOCATION_IS_CONSTANT_BUT_NOT_ADDR)
-				{
-					exp_node->data_obj.addr = addr;
-				}
-				else
-				{
-				int size;
-				void * buf;
+				case DOBJ_LOCATION_VALUE:
 					/* the data object processed does not have address,
-					 * but its value is nonetheless known - and actually
-					 * it has been returned in the 'addr' parameter
-					 * in the dwarf_loc_eval_loc_from_list() call above */
+					 * but its value is nonetheless known */
+					exp_node->data_obj.flags.is_val_applicable = 1;
 					exp_node->data_obj.flags.is_addr_applicable = 0;
-
-					size = dtype_access_sizeof((struct dwarf_head_struct *) exp_node->data_obj.type);
-					if (size > sizeof(ARM_CORE_WORD))
-						panic("");
-					if (!(buf = calloc(1, size)))
-						panic("");
-					exp_node->val.data = buf;
+					if ((err = dobj_value_fetch(state->ctx, &loc,
+							dtype_access_sizeof((struct dwarf_head_struct *) exp_node->data_obj.type),
+							&exp_node->val.data)) != GEAR_ERR_NO_ERROR)
+					{
+						set_parse_abort_vars(state, err, "error retrieving object value");
+						return err;
+					}
 					exp_node->data_obj.flags.is_val_fetched = 1;
-					memcpy(buf, &addr, size);
-				}
+					break;
+				case DOBJ_LOCATION_REGISTER:
+					/*! \todo	a quick hack - fix this */
+					exp_node->data_obj.flags.is_val_applicable = exp_node->data_obj.flags.is_addr_applicable = 1;
+					exp_node->data_obj.flags.is_addr_a_reg_nr = 1;
+					exp_node->data_obj.reg_nr = loc.reg_nr;
+					break;
+				case DOBJ_LOCATION_MEMORY:
+					exp_node->data_obj.flags.is_val_applicable = exp_node->data_obj.flags.is_addr_applicable = 1;
+					exp_node->data_obj.addr = loc.addr;
+					break;
+				default:
+					panic("");
 			}
 			/* all seems ok */
 		}
@@ -1699,9 +1692,8 @@ ARM_CORE_WORD pc;
  */
 static void fetch_data(struct parser_state * state, struct exp_data_node * exp_node)
 {
-int size;
-int nbytes;
-void * buf;
+enum GEAR_ENGINE_ERR_ENUM err;
+struct dobj_location loc;
 
 	/* sanity checks */
 	if (exp_node->type == DATA_TYPE_INVALID
@@ -1739,48 +1731,27 @@ void * buf;
 		}
 		return;
 	}
-	size = dtype_access_sizeof((struct dwarf_head_struct *) exp_node->data_obj.type);
-	if (!(buf = calloc(1, size)))
-		panic("");
 	/*! \note	this is currently the only place where
-	 *		target resources are accessed */ 
+	 *		target resources are accessed - the value
+	 *		is retrieved by dobj_value_fetch() in dobj-value.c */
 	/*! \todo	a quick hack - fix this */
 	if (exp_node->data_obj.flags.is_addr_a_reg_nr)
-	{
-		ARM_CORE_WORD reg;
-		int nr_target_core_regs, target_reg_nr;
-		if (!(nr_target_core_regs
-				= state->ctx->tdesc->get_nr_target_core_regs(state->ctx)))
-			panic("");
-		target_reg_nr = exp_node->data_obj.reg_nr;
-		if (state->ctx->tdesc->translate_dwarf_reg_nr_to_target_reg_nr(state->ctx, &target_reg_nr)
-				!= GEAR_ERR_NO_ERROR)
-			panic("");
-		if (target_reg_nr >= nr_target_core_regs)
-			panic("");
-		if (state->ctx->cc->core_reg_read(state->ctx, 0, 1 << target_reg_nr, &reg) != GEAR_ERR_NO_ERROR)
-		{
-			/* target access error */
-			state->is_target_access_failed = true;
-			return;
-		}
-		if (size > sizeof(ARM_CORE_WORD))
-			panic("");
-		/*! \todo	this is braindamaged... */
-		memcpy(buf, &reg, size);
-	}
+		loc = (struct dobj_location) { .kind = DOBJ_LOCATION_REGISTER,
+			.reg_nr = exp_node->data_obj.reg_nr, };
 	else
-	{
-		nbytes = size;
-		if (state->ctx->cc->core_mem_read(state->ctx, buf, exp_node->data_obj.addr, &nbytes) != GEAR_ERR_NO_ERROR
-				|| nbytes != size)
-		{
-			/* target access error */
-			state->is_target_access_failed = true;
-			return;
-		}
+		loc = (struct dobj_location) { .kind = DOBJ_LOCATION_MEMORY,
+			.addr = exp_node->data_obj.addr, };
+	if ((err = dobj_value_fetch(state->ctx, &loc,
+			dtype_access_sizeof((struct dwarf_head_struct *) exp_node->data_obj.type),
+			&exp_node->val.data)) != GEAR_ERR_NO_ERROR)
+	{
+		/* target access error, or the value is not available
+		 * in the selected frame */
+		if (!state->is_target_access_failed)
+			state->target_access_errcode = err;
+		state->is_target_access_failed = true;
+		return;
 	}
-	exp_node->val.data = buf;
 	exp_node->data_obj.flags.is_val_fetched = 1;
 }
 
@@ -3303,7 +3274,7 @@ dump_error_and_return:
 
 	if (flags.print_val && state.is_target_access_failed)
 	{
-		set_parse_abort_vars(&state, GEAR_ERR_TARGET_ACCESS_ERROR, "error accessing the target");
+		set_target_access_abort_vars(&state);
 		goto dump_error_and_return;
 	}
 
@@ -3373,7 +3344,7 @@ dump_error_and_return:
 				fetch_data(&state, state.parse_head);
 				if (flags.print_val && state.is_target_access_failed)
 				{
-					set_parse_abort_vars(&state, GEAR_ERR_TARGET_ACCESS_ERROR, "error accessing the target");
+					set_target_access_abort_vars(&state);
 					goto dump_error_and_return;
 				}
 			}
@@ -30,6 +30,7 @@
 #include "gear-engine-context.h"
 #include "core-access.h"
 #include "cu-access.h"
+#include "cu-hash.h"
 #include "srcfile.h"
 #include "dwarf-expr.h"
 #include "dwarf-loc.h"
@@ -37,8 +38,13 @@
 #include "util.h"
 #include "dobj-access.h"
 #include "type-access.h"
+#include "lexblock-access.h"
 #include "symtab.h"
+#include "aranges-access.h"
 #include "gprintf.h"
+#include "miprintf.h"
+#include "index-cache.h"
+#include "node-alloc.h"
 
 
 #include <windows.h>
@@ -52,31 +58,34 @@
 
 /*
  *
- * compile unit type hash operations
- * these are just stubs for the time being...
- *
- *	\todo	actually implement this
+ * compilation unit hash operations
  *
  */
 
-/*! \todo document this */
-struct cu_hash
+/*!
+ *	\fn	static void init_cu_hash(struct gear_engine_context * ctx, int nr_expected_cus)
+ *	\brief	allocates and initializes the compilation unit hash table
+ *
+ *	the hash table itself lives in cu-hash.c
+ *
+ *	\param	ctx	context to work in
+ *	\param	nr_expected_cus	the expected number of compilation
+ *				units to be stored in the hash table;
+ *				used for sizing the table
+ *	\return	none
+ */
+static void init_cu_hash(struct gear_engine_context * ctx, int nr_expected_cus)
 {
-	/*! the die offset for the described type */
-	Dwarf_Off		die_offset;
-	/*! pointer to the data type tree built for the type */
-	struct cu_data		* cu_data;
-	/*! link pointer for the hash table */
-	struct cu_hash		* next;
-};
+	if (ctx->cus)
+		panic("");
+	ctx->cus = cu_hash_create(nr_expected_cus);
+}
 
 /*!
  *	\fn	static struct cu_data * hash_get_cu(struct gear_engine_context * ctx, Dwarf_Off die_offset)
  *	\brief	retrieves a pointer to the compilation unit described by the die at
  *		offset ::die_offset, if present
  *
- *	\todo	actually implement this
- *
  *	\param	ctx	gear engine context data structure, used to access
  *			the compilation unit hash table
  *	\param	die_offset	the offset of the compilation unit of interest
@@ -86,24 +95,15 @@ struct cu_hash
 
 static struct cu_data * hash_get_cu(struct gear_engine_context * ctx, Dwarf_Off die_offset)
 {
-struct cu_hash * p;
-
-	p = ctx->cus;
-
-	while (p)
-	{
-		if (p->die_offset == die_offset)
-			break;
-		p = p->next;
-	}
-	return p ? p->cu_data : 0;
+	return cu_hash_get(ctx->cus, die_offset);
 }
 
 /*!
  *	\fn	static void hash_put_cu(struct gear_engine_context * ctx, Dwarf_Off die_offset, struct cu_data * cu_data)
- *	\brief	brief description
+ *	\brief	inserts a compilation unit in the compilation unit hash table
  *
- *	\todo	actually implement this
+ *	\note	it is a fatal error to attempt inserting a
+ *		compilation unit that is already in the table
  *
  *	\param	ctx	gear engine context data structure, used to access
  *			the compilation unit hash table
@@ -114,34 +114,86 @@ struct cu_hash * p;
 
 static void hash_put_cu(struct gear_engine_context * ctx, Dwarf_Off die_offset, struct cu_data * cu_data)
 {
-struct cu_hash * p;
+	if (!ctx->cus)
+		init_cu_hash(ctx, 0);
+	cu_hash_put(ctx->cus, die_offset, cu_data);
+}
 
-	if (hash_get_cu(ctx, die_offset))
-		panic("data type already in hash table");
-	if (!(p = malloc(sizeof * p)))
-		panic("out of core");
-	/* just put it in front of the list */
-	p->cu_data = cu_data;
-	p->die_offset = die_offset;
-	p->next = ctx->cus;
-	ctx->cus = p;
+/*! the table of compilation unit die offsets for the executable being debugged
+ *
+ * this table is built by a single pass over the compilation
+ * unit headers in the .debug_info section (see
+ * cu_scan_die_offsets() below), and is then used by all
+ * code that needs to visit every compilation unit in turn
+ * (e.g. the initial building of the compilation unit trees in
+ * arena.c, or building the source file tables in srcfile.c),
+ * so that the libdwarf compilation unit header 'cursor' never
+ * needs to be rewound again; the offsets are stored in the
+ * order in which the compilation units appear in .debug_info */
+struct cu_die_offset_tab
+{
+	/*! the number of valid elements in the die_offsets array below */
+	int		nr_cus;
+	/*! the number of allocated elements in the die_offsets array below */
+	int		tab_size;
+	/*! the offsets of the compilation unit dies in the .debug_info section */
+	Dwarf_Off	* die_offsets;
+};
 
-}
+/*! the initial number of entries allocated in the compilation unit die offset table; the table doubles when full */
+#define CU_DIE_OFFSET_TAB_INITIAL_SIZE		256
 
 /*!
- *	\fn	static struct cu_data * get_cu_node(void)
+ *	\fn	static struct cu_data * get_cu_node(struct gear_engine_context * ctx)
  *	\brief	allocates memory for a cu_node structure and initializes it
  *
  *	\return	a pointer to the newly allocated cu_node data structure
  */
 
-static struct cu_data * get_cu_node(void)
+static struct cu_data * get_cu_node(struct gear_engine_context * ctx)
 {
-struct cu_data * p;
+	return node_alloc(ctx, NODE_KIND_CU, sizeof(struct cu_data));
+}
 
-	if (!(p = (struct cu_data * )calloc(1, sizeof * p)))
-		panic("out of core");
-	return p;
+/*!
+ *	\fn	static unsigned long cu_tree_bytes(void)
+ *	\brief	returns the memory used by all debug information tree nodes built so far
+ *
+ *	this is taken from the node allocator statistics (see node-alloc.c),
+ *	so it only accounts for the tree nodes themselves - i.e. memory
+ *	used by names, address ranges and location lists (most of which
+ *	is owned by libdwarf anyway) is not accounted for; this is used
+ *	for tracking the memory used by the compilation unit
+ *	trees built, by sampling it before and after building
+ *	a compilation unit tree
+ *
+ *	\return	the memory used by all debug information
+ *		tree nodes built so far, in bytes
+ */
+static unsigned long cu_tree_bytes(void)
+{
+	return node_alloc_get_total_bytes();
+}
+
+/*!
+ *	\fn	static void cu_built(struct gear_engine_context * ctx, Dwarf_Off die_offset, struct cu_data * cu, unsigned long start_tree_bytes)
+ *	\brief	records a newly built compilation unit tree
+ *
+ *	the compilation unit is put in the compilation unit
+ *	hash table, and the memory used by its tree is accounted for
+ *
+ *	\param	ctx	context to work in
+ *	\param	die_offset	the die offset of the compilation unit built
+ *	\param	cu	the compilation unit tree built
+ *	\param	start_tree_bytes	the value returned by cu_tree_bytes()
+ *					before building the compilation unit tree
+ *	\return	none
+ */
+static void cu_built(struct gear_engine_context * ctx, Dwarf_Off die_offset, struct cu_data * cu, unsigned long start_tree_bytes)
+{
+	cu->tree_bytes = cu_tree_bytes() - start_tree_bytes;
+	hash_put_cu(ctx, die_offset, cu);
+	ctx->cus->tree_bytes += cu->tree_bytes;
 }
 
 
@@ -151,6 +203,255 @@ struct cu_data * p;
  *
  */
 
+/*!
+ *	\fn	int cu_scan_die_offsets(struct gear_engine_context * ctx)
+ *	\brief	builds the table of compilation unit die offsets for the executable being debugged
+ *
+ *	this walks the compilation unit headers in the .debug_info
+ *	section exactly once, and records the offset of each
+ *	compilation unit die; the table built is then available
+ *	via cu_get_die_offsets()
+ *
+ *	\note	this must be invoked right after the libdwarf
+ *		debug descriptor (ctx->dbg) has been initialized, and
+ *		before anything else has invoked dwarf_next_cu_header();
+ *		the libdwarf compilation unit header 'cursor' is then
+ *		at the start of the .debug_info section, and no
+ *		rewinding is needed; after this routine returns, the
+ *		'cursor' has wrapped around, and the table built here
+ *		should be used instead of calling dwarf_next_cu_header()
+ *
+ *	\param	ctx	context to work in
+ *	\return	the number of compilation units found
+ */
+int cu_scan_die_offsets(struct gear_engine_context * ctx)
+{
+struct cu_die_offset_tab * p;
+int res;
+Dwarf_Error err;
+Dwarf_Unsigned	next_cu_header_offset;
+Dwarf_Off cur_cu_offset;
+Dwarf_Off die_offset;
+
+	if (ctx->cu_die_offsets)
+		panic("");
+	if (!(p = calloc(1, sizeof * p)))
+		panic("out of core");
+	p->tab_size = CU_DIE_OFFSET_TAB_INITIAL_SIZE;
+	if (!(p->die_offsets = malloc(p->tab_size * sizeof * p->die_offsets)))
+		panic("out of core");
+
+	/* start from offset 0 - the start of the debug information
+	 * (.dbg_info) section */	 
+	cur_cu_offset = 0;
+	while ((res = dwarf_next_cu_header(ctx->dbg,
+					/* dont need these */
+					0,
+					0,
+					0,
+					0,
+					&next_cu_header_offset,
+					&err)) == DW_DLV_OK)
+	{
+		if (dwarf_get_cu_die_offset_given_cu_header_offset
+			(ctx->dbg, cur_cu_offset, &die_offset, &err)
+				!= DW_DLV_OK)
+			panic("");
+		if (p->nr_cus == p->tab_size)
+		{
+			p->tab_size <<= 1;
+			if (!(p->die_offsets = realloc(p->die_offsets,
+						p->tab_size * sizeof * p->die_offsets)))
+				panic("out of core");
+		}
+		p->die_offsets[p->nr_cus++] = die_offset;
+		cur_cu_offset = next_cu_header_offset;
+	}
+	if (res != DW_DLV_NO_ENTRY)
+		panic("");
+
+	ctx->cu_die_offsets = p;
+	/* now that the number of compilation units is known, size
+	 * the compilation unit hash table so that it never needs to grow */
+	if (!ctx->cus)
+		init_cu_hash(ctx, p->nr_cus);
+	return p->nr_cus;
+}
+
+/*!
+ *	\fn	Dwarf_Off * cu_get_die_offsets(struct gear_engine_context * ctx, int * nr_cus)
+ *	\brief	retrieves the table of compilation unit die offsets built by cu_scan_die_offsets()
+ *
+ *	\param	ctx	context to work in
+ *	\param	nr_cus	a pointer to where to store the number
+ *			of elements in the table returned
+ *	\return	a pointer to the table of compilation unit die
+ *		offsets, in .debug_info order; this must not be
+ *		modified or freed by the caller
+ */
+Dwarf_Off * cu_get_die_offsets(struct gear_engine_context * ctx, int * nr_cus)
+{
+	if (!ctx->cu_die_offsets)
+		panic("");
+	*nr_cus = ctx->cu_die_offsets->nr_cus;
+	return ctx->cu_die_offsets->die_offsets;
+}
+
+/*!
+ *	\fn	int cu_build_all(struct gear_engine_context * ctx)
+ *	\brief	builds the trees of all compilation units which have not yet been built
+ *
+ *	when lazy compilation unit building is not enabled, this is
+ *	invoked at startup; otherwise, compilation unit trees are built
+ *	on demand (by cu_process()), as they are needed - e.g. the
+ *	compilation unit containing an address, or the compilation
+ *	units defining a global identifier (see
+ *	dwarf_pubnames_build_cus_for_name() in dwarf-pubnames.c), and
+ *	this is only invoked when all of the compilation units must be
+ *	examined
+ *
+ *	\param	ctx	context to work in
+ *	\return	the number of compilation unit trees built
+ */
+int cu_build_all(struct gear_engine_context * ctx)
+{
+Dwarf_Off * cu_offsets;
+int i, nr_cus, nr_built;
+
+	cu_offsets = cu_get_die_offsets(ctx, &nr_cus);
+	if (ctx->cus && ctx->cus->nr_entries == nr_cus)
+		/* all built */
+		return 0;
+	nr_built = ctx->cus ? ctx->cus->nr_entries : 0;
+	for (i = 0; i < nr_cus; i++)
+		cu_process(ctx, cu_offsets[i]);
+	return ctx->cus->nr_entries - nr_built;
+}
+
+/*!
+ *	\fn	void cu_dump_mem_usage_mi(struct gear_engine_context * ctx)
+ *	\brief	dumps compilation unit tree memory usage statistics, in machine interface format
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void cu_dump_mem_usage_mi(struct gear_engine_context * ctx)
+{
+int nr_cus;
+
+	cu_get_die_offsets(ctx, &nr_cus);
+	miprintf("CU_TREES = [NR_CUS = %i, NR_BUILT = %i, BYTES = %lu,],", nr_cus,
+			ctx->cus ? ctx->cus->nr_entries : 0,
+			ctx->cus ? ctx->cus->tree_bytes : 0);
+}
+
+/*!
+ *	\fn	void cu_save_index(struct gear_engine_context * ctx, struct index_cache_cursor * c)
+ *	\brief	stores the table of compilation unit die offsets in an in-core index cache image
+ *
+ *	for details, see the comments in index-cache.c
+ *
+ *	\param	ctx	context to work in
+ *	\param	c	the in-core index cache image to store the table in
+ *	\return	none
+ */
+void cu_save_index(struct gear_engine_context * ctx, struct index_cache_cursor * c)
+{
+	if (!ctx->cu_die_offsets)
+		panic("");
+	index_cache_put(c, &ctx->cu_die_offsets->nr_cus, sizeof ctx->cu_die_offsets->nr_cus);
+	index_cache_put(c, ctx->cu_die_offsets->die_offsets,
+			ctx->cu_die_offsets->nr_cus * sizeof * ctx->cu_die_offsets->die_offsets);
+}
+
+/*!
+ *	\fn	bool cu_restore_index(struct gear_engine_context * ctx, struct index_cache_cursor * c)
+ *	\brief	restores the table of compilation unit die offsets from an in-core index cache image
+ *
+ *	this is an alternative to cu_scan_die_offsets(); on success,
+ *	the compilation unit hash table is also sized, exactly as
+ *	cu_scan_die_offsets() does it; on failure, nothing is changed
+ *
+ *	\param	ctx	context to work in
+ *	\param	c	the in-core index cache image to restore the table from
+ *	\return	true, if the table was successfully restored, false otherwise
+ */
+bool cu_restore_index(struct gear_engine_context * ctx, struct index_cache_cursor * c)
+{
+struct cu_die_offset_tab * p;
+int nr_cus;
+
+	if (ctx->cu_die_offsets)
+		panic("");
+	if (!index_cache_get(c, &nr_cus, sizeof nr_cus) || nr_cus < 0
+			|| nr_cus > (c->len - c->pos) / sizeof * p->die_offsets)
+		return false;
+	if (!(p = calloc(1, sizeof * p)))
+		panic("out of core");
+	p->nr_cus = nr_cus;
+	p->tab_size = nr_cus ? nr_cus : 1;
+	if (!(p->die_offsets = malloc(p->tab_size * sizeof * p->die_offsets)))
+		panic("out of core");
+	index_cache_get(c, p->die_offsets, nr_cus * sizeof * p->die_offsets);
+
+	ctx->cu_die_offsets = p;
+	if (!ctx->cus)
+		init_cu_hash(ctx, p->nr_cus);
+	return true;
+}
+
+/*!
+ *	\fn	void cu_discard_index(struct gear_engine_context * ctx)
+ *	\brief	discards compilation unit index data restored by cu_restore_index()
+ *
+ *	this is used when restoring the index cache fails after
+ *	cu_restore_index() has succeeded (e.g. when the data of some
+ *	other module is damaged), so that the indices are then built
+ *	from scratch, and not on top of partially restored data
+ *
+ *	\note	no compilation unit trees may have been built yet
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void cu_discard_index(struct gear_engine_context * ctx)
+{
+	if (ctx->cus && ctx->cus->nr_entries)
+		panic("");
+	cu_discard_all(ctx);
+}
+
+/*!
+ *	\fn	void cu_discard_all(struct gear_engine_context * ctx)
+ *	\brief	discards the compilation unit hash table, and the table of compilation unit die offsets
+ *
+ *	the per compilation unit tables hanging off the compilation
+ *	unit trees built (i.e. the scope tables) are deallocated
+ *	here as well; the compilation unit tree nodes themselves
+ *	are owned by the node allocator, and are deallocated by
+ *	node_alloc_free_all()
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void cu_discard_all(struct gear_engine_context * ctx)
+{
+int i;
+
+	if (ctx->cus)
+		for (i = 0; i < ctx->cus->htab_size; i++)
+			if (ctx->cus->htab[i].cu_data)
+				aranges_discard_cu_scope_tab(ctx->cus->htab[i].cu_data);
+	cu_hash_destroy(ctx->cus);
+	ctx->cus = 0;
+	if (ctx->cu_die_offsets)
+	{
+		free(ctx->cu_die_offsets->die_offsets);
+		free(ctx->cu_die_offsets);
+		ctx->cu_die_offsets = 0;
+	}
+}
+
 /*!
  *	\fn	struct cu_data * cu_process(struct gear_engine_context * ctx, Dwarf_Unsigned cu_die_offset);
  *	\brief	compilation unit access routine
@@ -176,10 +477,12 @@ struct subprogram_data **	subs;
 struct dobj_data **		vars;
 Dwarf_Attribute attr;
 Dwarf_Bool flag;
+unsigned long start_tree_bytes;
 
 	/* see if the cu die tree is already in the hash table */
 	if ((p = hash_get_cu(ctx, cu_die_offset)))
 		return p;
+	start_tree_bytes = cu_tree_bytes();
 
 	/* make sure this is indeed a compilation unit die */
 	/* read the cu die */
@@ -192,7 +495,7 @@ Dwarf_Bool flag;
 		panic("fatal: expected a compilation unit die");
 
 	/* allocate memory for the cu tree root */
-	p = get_cu_node();
+	p = get_cu_node(ctx);
 
 	/* validate the cu die */
 	/* check for unsupported attributes */
@@ -323,6 +626,9 @@ Dwarf_Bool flag;
 			break;
 		case DW_DLV_NO_ENTRY:
 			gprintf("this compilation unit does not have children\n");
+			/* save cu entry into hash table, so that it
+			 * is not built again, and return */
+			cu_built(ctx, cu_die_offset, p, start_tree_bytes);
 			dwarf_dealloc(ctx->dbg, cu_die, DW_DLA_DIE);
 			return p;
 			break;
@@ -434,7 +740,7 @@ Dwarf_Bool flag;
 				break;
 			case DW_DLV_NO_ENTRY:
 				/* save cu entry into hash table and return */
-				hash_put_cu(ctx, cu_die_offset, p);
+				cu_built(ctx, cu_die_offset, p, start_tree_bytes);
 				dwarf_dealloc(ctx->dbg, cu_die, DW_DLA_DIE);
 				return p;
 				break;
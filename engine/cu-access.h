@@ -264,6 +264,21 @@ struct cu_data
 	 *
 	 * see the dwarf_srcfiles() documentation in libdwarf for details */
 	Dwarf_Signed			srccount;
+	/*! the decoded, address-sorted line number table for the compilation unit; opaque
+	 *
+	 * this is null until the line number information for the
+	 * compilation unit is first needed (it is then built from the
+	 * ::linebuf array above); for details, see the comments in srcfile.c */
+	struct srcfile_line_tab *	line_tab;
+	/*! the scope table for the compilation unit; opaque
+	 *
+	 * this is null until the scope table is first needed;
+	 * for details, see the comments in aranges-access.c */
+	struct cu_scope_tab *		scope_tab;
+	/*! an estimate of the memory used by the tree of this compilation unit, in bytes
+	 *
+	 * for details, see the comments about cu_tree_bytes() in cu-access.c */
+	unsigned long			tree_bytes;
 };
 
 /*
@@ -272,5 +287,10 @@ struct cu_data
  *
  */
 struct cu_data * cu_process(struct gear_engine_context * ctx, Dwarf_Unsigned cu_die_offset);
+int cu_scan_die_offsets(struct gear_engine_context * ctx);
+Dwarf_Off * cu_get_die_offsets(struct gear_engine_context * ctx, int * nr_cus);
+int cu_build_all(struct gear_engine_context * ctx);
+void cu_discard_all(struct gear_engine_context * ctx);
+void cu_dump_mem_usage_mi(struct gear_engine_context * ctx);
 struct subprogram_data * cu_get_subprogram_list(struct gear_engine_context, struct cu_data * cu);
 
@@ -0,0 +1,203 @@
+/*!
+ * \file	cu-hash.c
+ * \brief	compilation unit hash table
+ * \author	shopov
+ *
+ *	this is the table that maps compilation unit die offsets
+ *	to the compilation unit trees built (see cu_process() in
+ *	cu-access.c); it is kept in its own module, with no dependencies
+ *	on the libdwarf headers, so that it can be benchmarked
+ *	on its own (see bench/cu-hash-bench.c)
+ *
+ * Revision summary:
+ *
+ * $Log: $
+ */
+
+/*
+ *
+ * include section follows
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+
+#include "cu-hash.h"
+#include "gprintf.h"
+#include "util.h"
+
+/*
+ *
+ * local definitions follow
+ *
+ */
+
+/*! the minimum number of slots in the compilation unit hash table */
+#define CU_HASH_MIN_SIZE		64
+/*! the maximum load factor of the compilation unit hash table, in percent, before it gets grown */
+#define CU_HASH_MAX_LOAD_PERCENT	50
+
+/*
+ *
+ * local functions follow
+ *
+ */
+
+/*!
+ *	\fn	static void grow_cu_hash(struct cu_hash * p)
+ *	\brief	doubles the size of the compilation unit hash table and rehashes its entries
+ *
+ *	\param	p	the hash table to grow
+ *	\return	none
+ */
+static void grow_cu_hash(struct cu_hash * p)
+{
+struct cu_hash_node * old_htab;
+int old_size;
+int i, j;
+
+	old_htab = p->htab;
+	old_size = p->htab_size;
+	p->htab_size <<= 1;
+	if (!(p->htab = calloc(p->htab_size, sizeof * p->htab)))
+		panic("out of core");
+	for (i = 0; i < old_size; i++)
+	{
+		if (!old_htab[i].cu_data)
+			continue;
+		for (j = cu_hash_offset(old_htab[i].die_offset) & (p->htab_size - 1);
+				p->htab[j].cu_data;
+				j = (j + 1) & (p->htab_size - 1))
+			;
+		p->htab[j] = old_htab[i];
+	}
+	free(old_htab);
+}
+
+/*
+ *
+ * exported functions follow
+ *
+ */
+
+/*!
+ *	\fn	unsigned int cu_hash_offset(unsigned long long die_offset)
+ *	\brief	computes the hash value of a compilation unit die offset
+ *
+ *	compilation unit die offsets are quite regularly spaced (and always
+ *	have the low bits of the compilation unit header size added to
+ *	them), so they are passed through an integer mixer (the
+ *	fibonacci hashing multiplier, with the high bits folded down)
+ *	before being reduced modulo the table size
+ *
+ *	\param	die_offset	the die offset to hash
+ *	\return	the hash value for die_offset
+ */
+unsigned int cu_hash_offset(unsigned long long die_offset)
+{
+unsigned long long x;
+
+	x = die_offset * 0x9e3779b97f4a7c15ULL;
+	return (unsigned int) (x >> 32) ^ (unsigned int) x;
+}
+
+/*!
+ *	\fn	struct cu_hash * cu_hash_create(int nr_expected_cus)
+ *	\brief	allocates and initializes a compilation unit hash table
+ *
+ *	\param	nr_expected_cus	the expected number of compilation
+ *				units to be stored in the hash table;
+ *				used for sizing the table
+ *	\return	the newly allocated hash table
+ */
+struct cu_hash * cu_hash_create(int nr_expected_cus)
+{
+struct cu_hash * p;
+int size;
+
+	for (size = CU_HASH_MIN_SIZE;
+			size * CU_HASH_MAX_LOAD_PERCENT / 100 < nr_expected_cus;
+			size <<= 1)
+		;
+	if (!(p = calloc(1, sizeof * p)))
+		panic("out of core");
+	if (!(p->htab = calloc(size, sizeof * p->htab)))
+		panic("out of core");
+	p->htab_size = size;
+	return p;
+}
+
+/*!
+ *	\fn	struct cu_data * cu_hash_get(struct cu_hash * p, unsigned long long die_offset)
+ *	\brief	retrieves a pointer to the compilation unit described by the die at
+ *		offset ::die_offset, if present
+ *
+ *	\param	p	the hash table to look up, may be null
+ *	\param	die_offset	the offset of the compilation unit of interest
+ *	\return	pointer to the data for the compilation unit die at offset ::die_offset, or
+ *		null, if the compilation unit is not available
+ */
+struct cu_data * cu_hash_get(struct cu_hash * p, unsigned long long die_offset)
+{
+int i;
+
+	if (!p)
+		return 0;
+	for (i = cu_hash_offset(die_offset) & (p->htab_size - 1);
+			p->htab[i].cu_data;
+			i = (i + 1) & (p->htab_size - 1))
+		if (p->htab[i].die_offset == die_offset)
+			return p->htab[i].cu_data;
+	return 0;
+}
+
+/*!
+ *	\fn	void cu_hash_put(struct cu_hash * p, unsigned long long die_offset, struct cu_data * cu_data)
+ *	\brief	inserts a compilation unit in a compilation unit hash table
+ *
+ *	\note	it is a fatal error to attempt inserting a
+ *		compilation unit that is already in the table
+ *
+ *	\param	p	the hash table to insert into
+ *	\param	die_offset	the offset of the compilation unit of interest
+ *	\param	cu_data		the data node to put in the hash table
+ *	\return	none
+ */
+void cu_hash_put(struct cu_hash * p, unsigned long long die_offset, struct cu_data * cu_data)
+{
+int i;
+
+	if (!cu_data)
+		panic("");
+	if ((p->nr_entries + 1) * 100 > p->htab_size * CU_HASH_MAX_LOAD_PERCENT)
+		grow_cu_hash(p);
+	for (i = cu_hash_offset(die_offset) & (p->htab_size - 1);
+			p->htab[i].cu_data;
+			i = (i + 1) & (p->htab_size - 1))
+		if (p->htab[i].die_offset == die_offset)
+			panic("compilation unit already in hash table");
+	p->htab[i].die_offset = die_offset;
+	p->htab[i].cu_data = cu_data;
+	p->nr_entries++;
+}
+
+/*!
+ *	\fn	void cu_hash_destroy(struct cu_hash * p)
+ *	\brief	deallocates a compilation unit hash table
+ *
+ *	\note	the compilation unit trees referenced by the table
+ *		are not deallocated here
+ *
+ *	\param	p	the hash table to deallocate, may be null
+ *	\return	none
+ */
+void cu_hash_destroy(struct cu_hash * p)
+{
+	if (!p)
+		return;
+	free(p->htab);
+	free(p);
+}
+
@@ -0,0 +1,69 @@
+/*!
+ * \file	cu-hash.h
+ * \brief	compilation unit hash table header file
+ * \author	shopov
+ *
+ *
+ * Revision summary:
+ *
+ * $Log: $
+ */
+
+#ifndef __CU_HASH_H__
+#define __CU_HASH_H__
+
+/*
+ *
+ * exported types follow
+ *
+ */
+
+/*! the compilation unit hash table, keyed by compilation unit die offset
+ *
+ * this is an open addressing hash table, with linear
+ * probing; the table size is always a power of two, and
+ * the table is doubled (and rehashed) whenever its load
+ * factor would exceed CU_HASH_MAX_LOAD_PERCENT; entries are
+ * never deleted from the table, so no tombstones are needed;
+ * a slot is free if, and only if, its cu_data field is null
+ *
+ * the table is initially sized from the number of compilation
+ * units found in the executable (see cu_scan_die_offsets()),
+ * so that for the common case, it never needs to grow
+ *
+ * \note	die offsets are passed around here as unsigned long
+ *		long-s (which is what the libdwarf Dwarf_Off type is),
+ *		so that this module does not depend on the libdwarf
+ *		headers, and can be benchmarked on its own (see
+ *		bench/cu-hash-bench.c) */
+struct cu_hash
+{
+	/*! the number of slots in the htab array below; always a power of two */
+	int	htab_size;
+	/*! the number of slots used in the htab array below; this is also the number of compilation unit trees built */
+	int	nr_entries;
+	/*! an estimate of the memory used by all compilation unit trees built, in bytes; see cu_tree_bytes() in cu-access.c */
+	unsigned long	tree_bytes;
+	/*! the hash table slots */
+	struct cu_hash_node
+	{
+		/*! the die offset of the compilation unit described */
+		unsigned long long	die_offset;
+		/*! pointer to the compilation unit tree built; null for free slots */
+		struct cu_data		* cu_data;
+	}
+	* htab;
+};
+
+/*
+ *
+ * exported function prototypes follow
+ *
+ */
+unsigned int cu_hash_offset(unsigned long long die_offset);
+struct cu_hash * cu_hash_create(int nr_expected_cus);
+struct cu_data * cu_hash_get(struct cu_hash * p, unsigned long long die_offset);
+void cu_hash_put(struct cu_hash * p, unsigned long long die_offset, struct cu_data * cu_data);
+void cu_hash_destroy(struct cu_hash * p);
+
+#endif /* __CU_HASH_H__ */
@@ -142,6 +142,9 @@ IS			(u|U|l|L)*
 "$lr"		{ lex_count(); dbx_lval.reg_nr = 14; return HACK_REG_KW; }
 "$r15"		{ lex_count(); dbx_lval.reg_nr = 15; return HACK_REG_KW; }
 "$pc"		{ lex_count(); dbx_lval.reg_nr = 15; return HACK_REG_KW; }
+"targetstats"	{ lex_count(); return HACK_TARGETSTATS_KW; }
+"memdump"	{ lex_count(); return HACK_MEMDUMP_KW; }
+"memdumpcancel"	{ lex_count(); return HACK_MEMDUMP_CANCEL_KW; }
 "="		{ lex_count(); return '='; }
 
 
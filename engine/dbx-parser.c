@@ -68,12 +68,20 @@
 #include "cu-access.h"
 #include "dwarf-expr.h"
 #include "dwarf-loc.h"
+#include "dobj-access.h"
+#include "dobj-value.h"
+#include "lexblock-access.h"
 #include "subprogram-access.h"
 #include "aranges-access.h"
+#include "dwarf-util.h"
 #include "breakpoint.h"
 #include "frame-reg-cache.h"
 #include "srcfile.h"
+#include "type-access.h"
 #include "exec.h"
+#include "target-comm.h"
+#include "mem-cache.h"
+#include "image-mem.h"
 
 #include "gprintf.h"
 
@@ -292,6 +300,192 @@ static void dump_errcode(enum GEAR_ENGINE_ERR_ENUM errcode, char * msg)
 	miprintf("ERRCODE=[%i,\"%s\"],", errcode, msg);
 }
 
+/*!
+ *	\fn	static void dump_memdump_data(int xfer_id, enum GEAR_ENGINE_ERR_ENUM result, const unsigned char * buf, unsigned nbytes)
+ *	\brief	prints the result of a 'memdump' command, in gear machine interface format
+ *
+ *	\param	xfer_id	the identifier of the target memory transfer, -1
+ *			if the transfer has been performed synchronously
+ *	\param	result	the status code of the transfer
+ *	\param	buf	the bytes read
+ *	\param	nbytes	the number of bytes read
+ *	\return	none
+ */
+static void dump_memdump_data(int xfer_id, enum GEAR_ENGINE_ERR_ENUM result, const unsigned char * buf, unsigned nbytes)
+{
+unsigned i, j;
+
+	miprintf("MEMDUMP_COMPLETE, [ID = %i, ERRCODE = %i, NBYTES = %u, DATA = \"", xfer_id, result, nbytes);
+	/* print the data in small pieces, so that the machine
+	 * interface output buffer does not overflow */
+	for (i = 0; i < nbytes; i += j)
+		for (j = 0; j < 32 && i + j < nbytes; j++)
+			miprintf("%02x", buf[i + j]);
+	miprintf("\",]\n");
+}
+
+/*!
+ *	\fn	static void memdump_xfer_callback(struct gear_engine_context * ctx, void * cookie, int xfer_id, enum GEAR_ENGINE_ERR_ENUM result, unsigned nbytes)
+ *	\brief	completion callback for the asynchronous target memory reads started by the 'memdump' command
+ *
+ *	\param	ctx	context to work in
+ *	\param	cookie	the buffer holding the bytes read; it is free()-d here
+ *	\param	xfer_id	the identifier of the target memory transfer
+ *	\param	result	the status code of the transfer
+ *	\param	nbytes	the number of bytes read
+ *	\return	none
+ */
+static void memdump_xfer_callback(struct gear_engine_context * ctx, void * cookie, int xfer_id, enum GEAR_ENGINE_ERR_ENUM result, unsigned nbytes)
+{
+	dump_memdump_data(xfer_id, result, cookie, nbytes);
+	free(cookie);
+}
+
+/*!
+ *	\fn	static ARM_CORE_WORD * get_bkpt_addrs(struct gear_engine_context * ctx, const char * srcname, signed long long exp_val, int * nr_addrs)
+ *	\brief	retrieves the target core addresses at which to set (or clear) breakpoints for a 'stop'/'clear' command location
+ *
+ *	a single source code line may well have several target core
+ *	addresses corresponding to it (e.g. for c 'for' loops, inline
+ *	functions, or source files included in several compilation
+ *	units) - a breakpoint on a source line means a breakpoint
+ *	on every one of these addresses; these are only the entry
+ *	points into the line (the first statement starting address of
+ *	each contiguous address range of the line), so that the target
+ *	stops once per entry into the line, and hardware breakpoints
+ *	are not needlessly exhausted
+ *
+ *	\param	ctx	context to work in
+ *	\param	srcname	the source file name, or an empty string, if the
+ *			location is a target core address
+ *	\param	exp_val	the source line number, or the target core address,
+ *			depending on the srcname parameter above
+ *	\param	nr_addrs	a pointer to where to store the number of
+ *				addresses retrieved
+ *	\return	a malloc()-ed array of the addresses retrieved, which
+ *		must be free()-d by the caller; null if no addresses
+ *		have been found (in this case, *nr_addrs is set to zero)
+ */
+static ARM_CORE_WORD * get_bkpt_addrs(struct gear_engine_context * ctx, const char * srcname, signed long long exp_val, int * nr_addrs)
+{
+ARM_CORE_WORD * addrs;
+
+	if (!*srcname)
+		* nr_addrs = 1;
+	else if (!(* nr_addrs = srcfile_get_core_addrs_for_line_nr(ctx, srcname, exp_val, 0, 0)))
+		return 0;
+	if (!(addrs = malloc(* nr_addrs * sizeof * addrs)))
+		panic("out of core");
+	if (!*srcname)
+		addrs[0] = exp_val;
+	else
+		srcfile_get_core_addrs_for_line_nr(ctx, srcname, exp_val, addrs, * nr_addrs);
+	return addrs;
+}
+
+/*!
+ *	\fn	static void dump_dobj_list_mi(struct gear_engine_context * ctx, struct dobj_data * dobj, ARM_CORE_WORD pc, ARM_CORE_WORD cu_base_addr, ARM_CORE_WORD fbreg, bool is_fbreg_valid)
+ *	\brief	prints the names and values of a list of data objects in the currently selected frame, in gear machine interface format
+ *
+ *	data objects whose values cannot be retrieved are printed
+ *	with an error code instead of a value list - this is quite
+ *	normal when dumping all of the data objects in a frame, e.g.
+ *	data objects may have been optimized out at the program counter
+ *	value of the frame, or may reside in registers whose values in
+ *	the frame cannot be recovered (GEAR_ERR_DOBJ_OPTIMIZED_OUT)
+ *
+ *	\param	ctx	context to work in
+ *	\param	dobj	the first data object in the list; the list
+ *			is linked by the sib_ptr fields of the data objects
+ *	\param	pc	the program counter value for the selected frame
+ *	\param	cu_base_addr	the base address of the compilation unit
+ *				containing the program counter
+ *	\param	fbreg	the frame base register value for the selected frame
+ *	\param	is_fbreg_valid	true, if the fbreg parameter above is valid
+ *	\return	none
+ */
+static void dump_dobj_list_mi(struct gear_engine_context * ctx, struct dobj_data * dobj, ARM_CORE_WORD pc, ARM_CORE_WORD cu_base_addr, ARM_CORE_WORD fbreg, bool is_fbreg_valid)
+{
+enum GEAR_ENGINE_ERR_ENUM err;
+struct dobj_location loc;
+void * data;
+
+	for (; dobj; dobj = dobj->sib_ptr)
+	{
+		if (!dobj->name || dobj->is_node_a_declaration
+				|| !dobj->type || dobj->type->is_node_a_declaration)
+			continue;
+		miprintf("[NAME = \"%s\", ", dobj->name);
+		if ((err = dobj_value_locate(ctx, dobj, pc, cu_base_addr, fbreg, is_fbreg_valid, &loc)) == GEAR_ERR_NO_ERROR)
+			err = dobj_value_fetch(ctx, &loc, dtype_access_sizeof((struct dwarf_head_struct *) dobj->type), &data);
+		if (err != GEAR_ERR_NO_ERROR)
+			miprintf("ERRCODE = %i, ", err);
+		else
+		{
+			miprintf("VALUE_LIST = (");
+			type_dump_data_mi(ctx, dobj->type, data);
+			miprintf("), ");
+			free(data);
+		}
+		miprintf("], ");
+	}
+}
+
+/*!
+ *	\fn	static void dump_frame_dobjs_mi(struct gear_engine_context * ctx, ARM_CORE_WORD pc)
+ *	\brief	prints the arguments and local variables of the currently selected frame, in gear machine interface format
+ *
+ *	the arguments are the formal parameters of the innermost
+ *	subprogram (possibly an inline-expanded one) containing the
+ *	program counter; the local variables are the variables of
+ *	this subprogram, and of all of the lexical blocks nested in
+ *	it that contain the program counter, innermost first
+ *
+ *	\param	ctx	context to work in
+ *	\param	pc	the program counter value for the selected frame
+ *	\return	none
+ */
+static void dump_frame_dobjs_mi(struct gear_engine_context * ctx, ARM_CORE_WORD pc)
+{
+struct scope_chain_node * scope, * s;
+struct subprogram_data * subp;
+struct cu_data * cu;
+ARM_CORE_WORD cu_base_addr, fbreg;
+enum DWARF_EXPR_INFO_ENUM eval_info;
+bool is_result_in_reg, is_fbreg_valid;
+
+	cu = 0;
+	scope = aranges_get_scope_chain_for_addr(ctx, pc, &cu);
+	cu_base_addr = cu ? cu->default_cu_base_address : 0;
+
+	/* compute the frame base register value */
+	fbreg = 0;
+	is_fbreg_valid = false;
+	if ((subp = aranges_get_subp_for_addr(ctx, pc)) && subp->is_frame_base_available)
+		is_fbreg_valid = dwarf_loc_eval_loc_from_list(ctx, &fbreg, &is_result_in_reg, &eval_info,
+				&subp->fb_location, pc, cu_base_addr, 0) == GEAR_ERR_NO_ERROR
+			&& eval_info != DW_EXPR_INFO_INVALID && eval_info < DW_EXPR_NEEDS_FBREG;
+
+	/* locate the innermost subprogram scope */
+	for (s = scope; s; s = s->parent)
+		if (dwarf_util_get_tag_category(s->scope->tag) == DWARF_TAG_CATEGORY_SUBPROGRAM)
+			break;
+
+	miprintf("ARGS = (");
+	if (s)
+		dump_dobj_list_mi(ctx, ((struct subprogram_data *) s->scope)->params, pc, cu_base_addr, fbreg, is_fbreg_valid);
+	miprintf("), LOCALS = (");
+	for (; scope; scope = scope->parent)
+		if (dwarf_util_get_tag_category(scope->scope->tag) == DWARF_TAG_CATEGORY_LEXBLOCK)
+			dump_dobj_list_mi(ctx, ((struct lexblock_data *) scope->scope)->vars, pc, cu_base_addr, fbreg, is_fbreg_valid);
+		else
+		{
+			dump_dobj_list_mi(ctx, ((struct subprogram_data *) scope->scope)->vars, pc, cu_base_addr, fbreg, is_fbreg_valid);
+			break;
+		}
+	miprintf("), ");
+}
+
 
 /*
  *
@@ -483,11 +677,11 @@ int frame_nr;
 			break;
 		case CLEAR_KW:
 		{
-			ARM_CORE_WORD addr;
+			ARM_CORE_WORD * addrs;
 			char * srcname;
 			int srcline_nr;
 			bool is_addr_at_src_boundary;
-			int i;
+			int i, j, nr_addrs, nr_cleared;
 			char * c_exp;
 			signed long long exp_val;
 
@@ -521,44 +715,54 @@ int frame_nr;
 
 			srcname[i] = 0;
 
-			if (*srcname)
+			/* the location is either a source code location (and
+			 * then there may be several target core addresses
+			 * for it), or a target core address */
+			if (!(addrs = get_bkpt_addrs(ctx, *srcname ? srcname + 1 : srcname, exp_val, &nr_addrs)))
 			{
-				/* halt at source code location */
-				if (srcfile_get_core_addr_for_line_nr(ctx, srcname + 1, exp_val, &addr)
-						!= GEAR_ERR_NO_ERROR)
-				{
-					dump_errcode(GEAR_ERR_GENERIC_ERROR, "could not locate target core address for "
+				dump_errcode(GEAR_ERR_GENERIC_ERROR, "could not locate target core address for "
 "the source file/line number supplied");
-					miprintf("BREAKPOINT_DATA,");
-					miprintf("\n");
-					break;
-				}
+				miprintf("BREAKPOINT_DATA,");
+				miprintf("\n");
+				break;
 			}
-			else
-				/* halt at target core address */
-				addr = exp_val;
 
-			if (!bkpt_locate_at_addr(ctx, addr))
+			/* only keep the addresses at which there are breakpoints */
+			for (j = nr_cleared = 0; j < nr_addrs; j++)
+				if (bkpt_locate_at_addr(ctx, addrs[j]))
+					addrs[nr_cleared ++] = addrs[j];
+			if (!nr_cleared)
 			{
+				free(addrs);
 				dump_errcode(GEAR_ERR_GENERIC_ERROR, "no breakpoint at the location supplied");
 				miprintf("BREAKPOINT_DATA,");
 				miprintf("\n");
 				break;
 			}
-			if (bkpt_clear_at_addr(ctx, addr) != GEAR_ERR_NO_ERROR)
+			for (j = 0; j < nr_cleared; j++)
+				if (bkpt_clear_at_addr(ctx, addrs[j]) != GEAR_ERR_NO_ERROR)
+					break;
+			if (j != nr_cleared)
 			{
+				free(addrs);
 				dump_errcode(GEAR_ERR_GENERIC_ERROR, "error clearing breakpoint");
 				miprintf("BREAKPOINT_DATA,");
 				miprintf("\n");
 				break;
 			}
 			dump_errcode(GEAR_ERR_NO_ERROR, "");
-			srcfile_get_srcinfo_for_addr(ctx, addr, 0, 0, &srcname, &srcline_nr, &is_addr_at_src_boundary); 
-			miprintf("BREAKPOINT_DATA, BREAKPOINT_REMOVED = ([ADDR = 0x%08x,", addr);
-			miprintf("SRCFILE = \"%s\",", srcname ? srcname : "");
-			miprintf("SRCLINE = %i,", srcline_nr);
-			miprintf("IS_AT_START_OF_STATEMENT = %i,", is_addr_at_src_boundary ? 1 : 0);
-			miprintf("],)\n");
+			miprintf("BREAKPOINT_DATA, BREAKPOINT_REMOVED = (");
+			for (j = 0; j < nr_cleared; j++)
+			{
+				srcfile_get_srcinfo_for_addr(ctx, addrs[j], 0, 0, &srcname, &srcline_nr, &is_addr_at_src_boundary); 
+				miprintf("[ADDR = 0x%08x,", addrs[j]);
+				miprintf("SRCFILE = \"%s\",", srcname ? srcname : "");
+				miprintf("SRCLINE = %i,", srcline_nr);
+				miprintf("IS_AT_START_OF_STATEMENT = %i,", is_addr_at_src_boundary ? 1 : 0);
+				miprintf("],");
+			}
+			miprintf(")\n");
+			free(addrs);
 			break;
 		}
 		case COLLECTOR_KW:
@@ -1633,11 +1837,24 @@ If the given format string does not contain a %, dbx automatically prepends one.
 		case SEARCH_KW:
 		case SHOWBLOCK_KW:
 		case SHOWLEAKS_KW:
-		case SHOWMEMUSE_KW:
 		case SOURCE_KW:
 			dump_errcode(GEAR_ERR_DBX_CMD_NOT_CODED, "dbx command not yet coded");
 			miprintf("\n");
 			break;
+		case SHOWMEMUSE_KW:
+			/* this differs from the dbx 'showmemuse' command - what
+			 * is reported here is the memory used by the gear engine
+			 * itself for holding the (decoded) debug information */
+			if (*dbx_lexer_str)
+				panic("");
+			dump_errcode(GEAR_ERR_NO_ERROR, "");
+			miprintf("MEMORY_USAGE, [");
+			cu_dump_mem_usage_mi(ctx);
+			node_alloc_dump_mem_usage_mi(ctx);
+			dtype_access_dump_mem_usage_mi(ctx);
+			srcfile_dump_mem_usage_mi(ctx);
+			miprintf("]\n");
+			break;
 			/*
 			   status Command
 
@@ -1799,11 +2016,11 @@ stepi Command
 			break;
 		case STOP_KW:
 		{
-			ARM_CORE_WORD addr;
+			ARM_CORE_WORD * addrs;
 			char * srcname;
 			int srcline_nr;
 			bool is_addr_at_src_boundary;
-			int i;
+			int i, j, nr_addrs, nr_inserted;
 			char * c_exp;
 			signed long long exp_val;
 
@@ -1837,39 +2054,47 @@ stepi Command
 
 			srcname[i] = 0;
 
+			/* the location is either a source code location (and
+			 * then there may be several target core addresses
+			 * for it - halt at each one of them), or a target
+			 * core address */
 			if (*srcname)
-			{
-				/* halt at source code location */
 				gprintf("searching for address for %s:%i\n", srcname + 1, (unsigned int) exp_val);
-				if (srcfile_get_core_addr_for_line_nr(ctx, srcname + 1, exp_val, &addr)
-						!= GEAR_ERR_NO_ERROR)
-				{
-					dump_errcode(GEAR_ERR_GENERIC_ERROR, "could not locate target core address for "
+			if (!(addrs = get_bkpt_addrs(ctx, *srcname ? srcname + 1 : srcname, exp_val, &nr_addrs)))
+			{
+				dump_errcode(GEAR_ERR_GENERIC_ERROR, "could not locate target core address for "
 "the source file/line number supplied");
-					miprintf("BREAKPOINT_DATA,");
-					miprintf("\n");
-					break;
-				}
-				gprintf("ok, address is 0x%08x\n", (unsigned int) addr);
+				miprintf("BREAKPOINT_DATA,");
+				miprintf("\n");
+				break;
 			}
-			else
-				/* halt at target core address */
-				addr = exp_val;
 
-			if (bkpt_setup_at_addr(ctx, addr) == 0)
+			/* only keep the addresses at which breakpoints
+			 * have actually been set up */
+			for (j = nr_inserted = 0; j < nr_addrs; j++)
+				if (bkpt_setup_at_addr(ctx, addrs[j]))
+					addrs[nr_inserted ++] = addrs[j];
+			if (!nr_inserted)
 			{
+				free(addrs);
 				dump_errcode(GEAR_ERR_GENERIC_ERROR, "breakpoint already set");
 				miprintf("BREAKPOINT_DATA,");
 				miprintf("\n");
 				break;
 			}
 			dump_errcode(GEAR_ERR_NO_ERROR, "");
-			srcfile_get_srcinfo_for_addr(ctx, addr, 0, 0, &srcname, &srcline_nr, &is_addr_at_src_boundary); 
-			miprintf("BREAKPOINT_DATA, BREAKPOINT_INSERTED = ([ADDR = 0x%08x,", addr);
-			miprintf("SRCFILE = \"%s\",", srcname ? srcname : "");
-			miprintf("SRCLINE = %i,", srcline_nr);
-			miprintf("IS_AT_START_OF_STATEMENT = %i,", is_addr_at_src_boundary ? 1 : 0);
-			miprintf("],)\n");
+			miprintf("BREAKPOINT_DATA, BREAKPOINT_INSERTED = (");
+			for (j = 0; j < nr_inserted; j++)
+			{
+				srcfile_get_srcinfo_for_addr(ctx, addrs[j], 0, 0, &srcname, &srcline_nr, &is_addr_at_src_boundary); 
+				miprintf("[ADDR = 0x%08x,", addrs[j]);
+				miprintf("SRCFILE = \"%s\",", srcname ? srcname : "");
+				miprintf("SRCLINE = %i,", srcline_nr);
+				miprintf("IS_AT_START_OF_STATEMENT = %i,", is_addr_at_src_boundary ? 1 : 0);
+				miprintf("],");
+			}
+			miprintf(")\n");
+			free(addrs);
 			break;
 		}
 		case STOPI_KW:
@@ -2136,13 +2361,21 @@ where [thread_id]
 		    thread_id is a dbx-style thread ID or the Java thread name specified for the thread.
 */
 		{
-		ARM_CORE_WORD pc;
+		ARM_CORE_WORD pc, sp, stack_lo, stack_hi;
 		struct cu_data * cu;
 		struct subprogram_data * subp;
 		char * srcfile;
 		int srcline_nr;
 		int selected_frame_nr;
+		bool is_verbose;
 
+			is_verbose = false;
+			if (!strncmp(dbx_lexer_str, "-v", 2))
+			{
+				is_verbose = true;
+				dbx_lexer_str += 2;
+				dbx_lexer_str += strspn(dbx_lexer_str, " \t");
+			}
 			if (*dbx_lexer_str)
 				panic("");
 			if ((res = frame_move_to_relative(ctx, 0, &selected_frame_nr)) != GEAR_ERR_NO_ERROR)
@@ -2164,6 +2397,38 @@ where [thread_id]
 				}
 				break;
 			}
+			if (is_verbose)
+			{
+				/* first, unwind all of the frames, in order to
+				 * find out the extent of the target stack
+				 * memory holding them, and fetch it all in
+				 * the memory cache at once - instead of reading
+				 * the arguments and local variables of each frame
+				 * in separate small target memory reads; the data
+				 * objects of the outermost frame, which lie past
+				 * its stack pointer, are still read on demand */
+				stack_lo = stack_hi = 0;
+				do
+				{
+					if (ctx->cc->core_reg_read(ctx,
+								0,
+								1 << ctx->tdesc->get_target_sp_reg_nr(ctx),
+								&sp) == GEAR_ERR_NO_ERROR)
+					{
+						if (!stack_hi || sp < stack_lo)
+							stack_lo = sp;
+						if (sp > stack_hi)
+							stack_hi = sp;
+					}
+					res = frame_move_to_relative(ctx, -1, &selected_frame_nr);
+					if (res != GEAR_ERR_NO_ERROR && res != GEAR_ERR_CANT_UNWIND_STACK_FRAME)
+						panic("");
+				}
+				while (res == GEAR_ERR_NO_ERROR);
+				if (frame_move_to_relative(ctx, 0, 0) != GEAR_ERR_NO_ERROR)
+					panic("");
+				mem_cache_prefetch(ctx, stack_lo, stack_hi);
+			}
 			dump_errcode(GEAR_ERR_NO_ERROR, "");
 			miprintf("BACKTRACE,(");
 			/* start from the innermost frame - rewind to
@@ -2196,9 +2461,9 @@ where [thread_id]
 				}
 				if (srcline_nr)
 					miprintf("SRCLINE_NR = %i, ", srcline_nr);
+				if (is_verbose)
+					dump_frame_dobjs_mi(ctx, pc);
 				miprintf("], ");
-				if (selected_frame_nr == MAX_NR_FRAMES_TO_UNWIND)
-					break;
 				res = frame_move_to_relative(ctx, -1, &selected_frame_nr);
 				if (res == GEAR_ERR_CANT_UNWIND_STACK_FRAME)
 					break;
@@ -2257,6 +2522,107 @@ where [thread_id]
 
 			break;
 		}
+		case HACK_TARGETSTATS_KW:
+			/* report statistics about the communication with
+			 * the target core controller, about the target
+			 * memory cache and image-backed target memory,
+			 * and about the target stack prefetching */
+			if (*dbx_lexer_str)
+				panic("");
+			dump_errcode(GEAR_ERR_NO_ERROR, "");
+			miprintf("TARGET_STATS, [");
+			target_comm_dump_xfer_stats_mi(ctx);
+			mem_cache_dump_stats_mi(ctx);
+			image_mem_dump_stats_mi(ctx);
+			frame_reg_cache_dump_stats_mi(ctx);
+			miprintf("]\n");
+			break;
+		case HACK_MEMDUMP_KW:
+		/* try to recognize a pattern of the form:
+		 * memdump "address-expression" / byte-count
+		 * this reads target memory asynchronously - the command
+		 * completes immediately, reporting the identifier of the
+		 * transfer started; the data is reported when the transfer
+		 * completes (always between the outputs of other commands,
+		 * see target_comm_dispatch_completed_xfers()), while other
+		 * commands may be processed in the meantime; the transfer may be cancelled with the
+		 * 'memdumpcancel' command; if an asynchronous transfer
+		 * is not possible (e.g. the binary target protocol is
+		 * not in effect), target memory is read synchronously
+		 *
+		 * the target memory is read directly from the target, bypassing
+		 * the memory cache and the image-backed target memory */
+		{
+			/*! the maximum number of bytes that can be read by a single 'memdump' command */
+			static const int MAX_MEMDUMP_SIZE = 0x1000000;
+			char * c_exp;
+			signed long long addr;
+			unsigned cnt;
+			unsigned char * buf;
+			int xfer_id;
+			enum GEAR_ENGINE_ERR_ENUM err;
+
+			c_exp = extract_expression();
+			if (!c_expression_eval_int(ctx, c_exp, &addr))
+				panic("");
+			free(c_exp);
+			if (*dbx_lexer_str++ != '/')
+				panic("");
+			dbx_lexer_str += strspn(dbx_lexer_str, " \t");
+			/* extract the byte count field, this is in decimal */
+			cnt = 0;
+			while (isdigit(*dbx_lexer_str) && cnt <= MAX_MEMDUMP_SIZE)
+			{
+				cnt *= 10;
+				cnt += *dbx_lexer_str++ - '0';
+			}
+			if (!cnt || cnt > MAX_MEMDUMP_SIZE)
+			{
+				dump_errcode(GEAR_ERR_GENERIC_ERROR, "bad byte count");
+				miprintf("\n");
+				/* leave the scanner buffer in a known state */
+				YY_FLUSH_BUFFER;
+				break;
+			}
+			if (!(buf = malloc(cnt)))
+				panic("out of core");
+			xfer_id = target_comm_start_mem_read(ctx, buf, addr, cnt, memdump_xfer_callback, buf);
+			dump_errcode(GEAR_ERR_NO_ERROR, "");
+			miprintf("MEMDUMP_STARTED, [ID = %i,]\n", xfer_id);
+			if (xfer_id == -1)
+			{
+				err = ctx->cc->core_mem_read(ctx, buf, addr, &cnt);
+				dump_memdump_data(-1, err, buf, (err == GEAR_ERR_NO_ERROR) ? cnt : 0);
+				free(buf);
+			}
+			/* leave the scanner buffer in a known state */
+			YY_FLUSH_BUFFER;
+			break;
+		}
+		case HACK_MEMDUMP_CANCEL_KW:
+		/* try to recognize a pattern of the form:
+		 * memdumpcancel [transfer-id]
+		 * if the transfer identifier is omitted, all transfers
+		 * in progress are cancelled; the cancelled transfers are
+		 * reported as completed, with the GEAR_ERR_TARGET_XFER_CANCELLED
+		 * status code */
+		{
+			int xfer_id;
+
+			dbx_lexer_str += strspn(dbx_lexer_str, " \t");
+			xfer_id = -1;
+			if (isdigit(*dbx_lexer_str))
+				for (xfer_id = 0; isdigit(*dbx_lexer_str); dbx_lexer_str++)
+					xfer_id = xfer_id * 10 + *dbx_lexer_str - '0';
+			if (target_comm_cancel_xfer(ctx, xfer_id))
+				dump_errcode(GEAR_ERR_NO_ERROR, "");
+			else
+				dump_errcode(GEAR_ERR_GENERIC_ERROR, "no such transfer in progress");
+			miprintf("\n");
+			/* leave the scanner buffer in a known state */
+			YY_FLUSH_BUFFER;
+			break;
+		}
 		default:
 			dump_errcode(GEAR_ERR_DBX_CMD_NOT_RECOGNIZED, "dbx command not recognized");
 			miprintf("\n");
@@ -120,5 +120,8 @@ enum dbx_cmd_keyword_enum
 	 * dbx command set */
 	HACK_CSTR,
 	HACK_REG_KW,
+	HACK_TARGETSTATS_KW,
+	HACK_MEMDUMP_KW,
+	HACK_MEMDUMP_CANCEL_KW,
 };
 
@@ -32,6 +32,7 @@
 #include "dobj-access.h"
 
 #include "cxx-hacks.h"
+#include "node-alloc.h"
 
 /*
  *
@@ -40,34 +41,16 @@
  */
 
 /*!
- *	\fn	static struct dobj_data * get_dobj_node(void)
+ *	\fn	static struct dobj_data * get_dobj_node(struct gear_engine_context * ctx)
  *	\brief	allocates memory for a dobj_data structure and initializes it
  *
+ *	\param	ctx	context to work in
  *	\return	a pointer to the newly allocated dobj_data data structure
  */
 
-static struct dobj_data * get_dobj_node(void)
+static struct dobj_data * get_dobj_node(struct gear_engine_context * ctx)
 {
-#if 0
-struct dobj_data * p;
-
-	if (!(p = (struct dobj_data * ) calloc(1, sizeof * p)))
-		panic("out of core");
-	return p;
-#else
-/*! \todo	fix these */
-static struct dobj_data * dobj_cache = 0;
-static int dcache_size = 0;
-	
-	if (!dcache_size)
-	{
-		if (!(dobj_cache = calloc(dcache_size = 256, sizeof * dobj_cache)))
-			panic("");
-	}
-	dcache_size --;
-	return dobj_cache ++;
-
-#endif	
+	return node_alloc(ctx, NODE_KIND_DOBJ, sizeof(struct dobj_data));
 }
 /*
  *
@@ -152,7 +135,7 @@ Dwarf_Off die_offset;
 		panic("unsupported data object attribute found");
 
 	/* get core for the new node */
-	p = get_dobj_node();
+	p = get_dobj_node(ctx);
 	/*! \todo	debug only, remove when done */
 	p->head.die_offset = die_offset;
 
@@ -166,7 +149,7 @@ Dwarf_Off die_offset;
 { Dwarf_Off x; if (dwarf_die_CU_offset(die, &x, &err) != DW_DLV_OK) panic(""); gprintf("cu relative offset: %i\n", (int) x); }
 		gprintf("downgraded from panic(), skipping panic now: unsupported attribute found");
 		/*! \todo	hack hack hack */
-		p = get_dobj_node();
+		p = get_dobj_node(ctx);
 		p->head.die_offset = die_offset;
 		return p;
 	}
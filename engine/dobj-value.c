@@ -0,0 +1,192 @@
+/*!
+ * \file	dobj-value.c
+ * \brief	data object location and value retrieval
+ * \author	shopov
+ *
+ *	this is the code that locates data objects in the target, and
+ *	fetches their values, in the context of the currently selected
+ *	target call stack frame; it is shared by the c expression
+ *	parser (see resolve_id() and fetch_data() in cparse/c-parse.y)
+ *	and the dbx command parser (see dbx-parser.c); it is kept out
+ *	of dobj-access.c, because it depends on the register cache
+ *	(see frame-reg-cache.c)
+ *
+ * Revision summary:
+ *
+ * $Log: $
+ */
+
+/*
+ *
+ * include section follows
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include "dwarf-common.h"
+#include "target-defs.h"
+#include "gear-engine-context.h"
+#include "target-description.h"
+#include "engine-err.h"
+#include "core-access.h"
+#include "dwarf-expr.h"
+#include "dwarf-loc.h"
+#include "dobj-access.h"
+#include "dobj-value.h"
+#include "frame-reg-cache.h"
+#include "gprintf.h"
+#include "util.h"
+
+/*
+ *
+ * exported functions follow
+ *
+ */
+
+/*!
+ *	\fn	enum GEAR_ENGINE_ERR_ENUM dobj_value_locate(struct gear_engine_context * ctx, struct dobj_data * dobj, ARM_CORE_WORD pc, ARM_CORE_WORD cu_base_addr, ARM_CORE_WORD fbreg, bool is_fbreg_valid, struct dobj_location * loc)
+ *	\brief	computes the location of a data object at a given program counter value
+ *
+ *	it is not an error for a data object to be unavailable at
+ *	some program counter value (e.g. because it has been optimized
+ *	out there), and such conditions are reported to the caller,
+ *	rather than aborting
+ *
+ *	\param	ctx	context to work in
+ *	\param	dobj	the data object of interest
+ *	\param	pc	the program counter value for the selected frame
+ *	\param	cu_base_addr	the base address of the compilation unit
+ *				containing the program counter
+ *	\param	fbreg	the frame base register value for the selected frame
+ *	\param	is_fbreg_valid	true, if the fbreg parameter above is valid
+ *	\param	loc	a pointer to where to store the location computed;
+ *			not touched on error
+ *	\return	GEAR_ERR_NO_ERROR on success, GEAR_ERR_DOBJ_OPTIMIZED_OUT
+ *		if the data object is not available at the program counter
+ *		value, GEAR_ERR_GENERIC_ERROR if its location description
+ *		cannot be used
+ */
+enum GEAR_ENGINE_ERR_ENUM dobj_value_locate(struct gear_engine_context * ctx, struct dobj_data * dobj, ARM_CORE_WORD pc, ARM_CORE_WORD cu_base_addr, ARM_CORE_WORD fbreg, bool is_fbreg_valid, struct dobj_location * loc)
+{
+enum DWARF_EXPR_INFO_ENUM eval_info;
+ARM_CORE_WORD addr;
+bool is_result_in_reg;
+
+	if (dobj->is_constant_value)
+	{
+		* loc = (struct dobj_location) { .kind = DOBJ_LOCATION_VALUE,
+			.eval_info = DW_EXPR_IS_CONSTANT, .val = dobj->const_val, };
+		return GEAR_ERR_NO_ERROR;
+	}
+	if (!dobj->is_location_valid)
+		return GEAR_ERR_DOBJ_OPTIMIZED_OUT;
+	if (dwarf_loc_eval_loc_from_list(ctx, &addr, &is_result_in_reg, &eval_info,
+				&dobj->location, pc, cu_base_addr, fbreg) != GEAR_ERR_NO_ERROR
+			|| eval_info == DW_EXPR_INFO_INVALID)
+		/* most probably, the data object is not
+		 * available at this program counter value */
+		return GEAR_ERR_DOBJ_OPTIMIZED_OUT;
+	if (eval_info > DW_EXPR_NEEDS_FBREG
+			|| (eval_info == DW_EXPR_NEEDS_FBREG && !is_fbreg_valid))
+		return GEAR_ERR_GENERIC_ERROR;
+
+	if (is_result_in_reg)
+		* loc = (struct dobj_location) { .kind = DOBJ_LOCATION_REGISTER,
+			.eval_info = eval_info, .reg_nr = addr, };
+	else if (eval_info == DW_EXPR_LOCATION_IS_CONSTANT_BUT_NOT_ADDR)
+		/* the data object has no address, but its value
+		 * has been computed in the 'addr' variable */
+		* loc = (struct dobj_location) { .kind = DOBJ_LOCATION_VALUE,
+			.eval_info = eval_info, .val = addr, };
+	else
+		* loc = (struct dobj_location) { .kind = DOBJ_LOCATION_MEMORY,
+			.eval_info = eval_info, .addr = addr, };
+	return GEAR_ERR_NO_ERROR;
+}
+
+/*!
+ *	\fn	enum GEAR_ENGINE_ERR_ENUM dobj_value_fetch(struct gear_engine_context * ctx, const struct dobj_location * loc, int size, void ** data)
+ *	\brief	retrieves the value of a data object from its location, in the currently selected frame
+ *
+ *	data objects residing in registers whose values are not known
+ *	in the currently selected frame (see frame_reg_cache_is_reg_defined())
+ *	are reported as optimized out, rather than having the meaningless
+ *	values of these registers returned
+ *
+ *	\param	ctx	context to work in
+ *	\param	loc	the location of the data object, as computed by
+ *			dobj_value_locate()
+ *	\param	size	the size of the data object, in bytes
+ *	\param	data	a pointer to where to store a pointer to the data
+ *			object value bytes; the buffer is malloc()-ed and
+ *			must be free()-d by the caller; not touched on error
+ *	\return	GEAR_ERR_NO_ERROR on success, GEAR_ERR_DOBJ_OPTIMIZED_OUT
+ *		if the value of the register holding the data object is not
+ *		known in the selected frame, GEAR_ERR_TARGET_ACCESS_ERROR
+ *		if accessing the target failed, GEAR_ERR_GENERIC_ERROR
+ *		if the size of the data object does not fit its location
+ */
+enum GEAR_ENGINE_ERR_ENUM dobj_value_fetch(struct gear_engine_context * ctx, const struct dobj_location * loc, int size, void ** data)
+{
+enum GEAR_ENGINE_ERR_ENUM err;
+ARM_CORE_WORD reg;
+int reg_nr;
+unsigned nbytes;
+void * buf;
+
+	if (size <= 0)
+		return GEAR_ERR_GENERIC_ERROR;
+	if (!(buf = calloc(1, size)))
+		panic("out of core");
+	err = GEAR_ERR_GENERIC_ERROR;
+
+	switch (loc->kind)
+	{
+		case DOBJ_LOCATION_VALUE:
+			/*! \todo	fix the size checks when
+			 *		dwarf block forms are supported */
+			if (size > (int) sizeof loc->val)
+				goto error;
+			memcpy(buf, &loc->val, size);
+			break;
+		case DOBJ_LOCATION_REGISTER:
+			reg_nr = loc->reg_nr;
+			if (size > (int) sizeof reg
+					|| ctx->tdesc->translate_dwarf_reg_nr_to_target_reg_nr(ctx, &reg_nr) != GEAR_ERR_NO_ERROR
+					|| reg_nr >= ctx->tdesc->get_nr_target_core_regs(ctx))
+				goto error;
+			if (!frame_reg_cache_is_reg_defined(ctx, reg_nr))
+			{
+				err = GEAR_ERR_DOBJ_OPTIMIZED_OUT;
+				goto error;
+			}
+			if (ctx->cc->core_reg_read(ctx, 0, 1 << reg_nr, &reg) != GEAR_ERR_NO_ERROR)
+			{
+				err = GEAR_ERR_TARGET_ACCESS_ERROR;
+				goto error;
+			}
+			/*! \todo	this is braindamaged... */
+			memcpy(buf, &reg, size);
+			break;
+		case DOBJ_LOCATION_MEMORY:
+			nbytes = size;
+			if (ctx->cc->core_mem_read(ctx, buf, loc->addr, &nbytes) != GEAR_ERR_NO_ERROR
+					|| nbytes != (unsigned) size)
+			{
+				err = GEAR_ERR_TARGET_ACCESS_ERROR;
+				goto error;
+			}
+			break;
+		default:
+			panic("");
+	}
+	* data = buf;
+	return GEAR_ERR_NO_ERROR;
+
+error:
+	free(buf);
+	return err;
+}
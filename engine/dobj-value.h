@@ -0,0 +1,69 @@
+/*!
+ * \file	dobj-value.h
+ * \brief	data object location and value retrieval header file
+ * \author	shopov
+ *
+ *
+ * Revision summary:
+ *
+ * $Log: $
+ */
+
+#ifndef __DOBJ_VALUE_H__
+#define __DOBJ_VALUE_H__
+
+/*
+ *
+ * exported types follow
+ *
+ */
+
+/*! the kinds of places where the value of a data object may be found, see struct dobj_location */
+enum DOBJ_LOCATION_ENUM
+{
+	/*! invalid value, do not use */
+	DOBJ_LOCATION_INVALID = 0,
+	/*! the data object resides in target memory */
+	DOBJ_LOCATION_MEMORY,
+	/*! the data object resides in a target core register */
+	DOBJ_LOCATION_REGISTER,
+	/*! the data object is not present in the target, but its value is known */
+	DOBJ_LOCATION_VALUE,
+};
+
+/*! the location of a data object at a given program counter value, as computed by dobj_value_locate()
+ *
+ * this is also what dobj_value_fetch() retrieves data object values from;
+ * users that compute locations by other means (e.g. the c expression
+ * parser, when accessing structure members) may fill it in themselves */
+struct dobj_location
+{
+	/*! the kind of the location, determines which of the fields in the union below applies */
+	enum DOBJ_LOCATION_ENUM		kind;
+	/*! information about evaluating the dwarf location description of the data object
+	 *
+	 * e.g. this tells if the evaluation needed the target memory to be read;
+	 * this is DW_EXPR_IS_CONSTANT for data objects that have a constant value
+	 * (i.e. for which the is_constant_value flag of struct dobj_data is set) */
+	enum DWARF_EXPR_INFO_ENUM	eval_info;
+	union
+	{
+		/*! the address of the data object, for DOBJ_LOCATION_MEMORY locations */
+		ARM_CORE_WORD	addr;
+		/*! the dwarf register number of the register holding the data object, for DOBJ_LOCATION_REGISTER locations */
+		int		reg_nr;
+		/*! the value of the data object, for DOBJ_LOCATION_VALUE locations */
+		Dwarf_Signed	val;
+	};
+};
+
+/*
+ *
+ * exported function prototypes follow
+ *
+ */
+
+enum GEAR_ENGINE_ERR_ENUM dobj_value_locate(struct gear_engine_context * ctx, struct dobj_data * dobj, ARM_CORE_WORD pc, ARM_CORE_WORD cu_base_addr, ARM_CORE_WORD fbreg, bool is_fbreg_valid, struct dobj_location * loc);
+enum GEAR_ENGINE_ERR_ENUM dobj_value_fetch(struct gear_engine_context * ctx, const struct dobj_location * loc, int size, void ** data);
+
+#endif /* __DOBJ_VALUE_H__ */
@@ -0,0 +1,1204 @@
+/*!
+ * \file	dwarf-frame.c
+ * \brief	call frame information parser
+ * \author	shopov
+ *
+ *	this module parses the call frame information of the executable
+ *	being debugged (described in the dwarf 3 standard document,
+ *	paragraph 6.4 - 'call frame information'), and computes the
+ *	register unwinding rules in effect at a given target address;
+ *	it is used by the target call stack unwinder, see frame-reg-cache.c
+ *
+ *	the call frame information is read directly from the executable,
+ *	from the following sections:
+ *		- .debug_frame - cie versions 1 (dwarf 2), 3 (dwarf 3)
+ *		and 4 (dwarf 4 and 5) are supported, and so are 64-bit
+ *		dwarf entries
+ *		- .eh_frame - the gcc flavour of the call frame information,
+ *		which is used for exception handling, and which gcc emits
+ *		instead of .debug_frame on many targets (e.g. i386 linux);
+ *		the cie augmentations 'z', 'R', 'P', 'L' and 'S' (e.g. "zR",
+ *		"zPLR") are supported, and so is the older "eh" augmentation;
+ *		pointers may be encoded (the DW_EH_PE_xxx encodings in the
+ *		lsb documentation) as absolute, pc relative, text relative,
+ *		data relative, or aligned values
+ *		- .eh_frame_hdr - if present, its binary search table
+ *		is used for locating the fdes in .eh_frame, instead of
+ *		decoding all of .eh_frame when initializing
+ *
+ *	the section contents are retrieved by means of elf_rawfile(), so
+ *	they are not copied anywhere; the fdes in .debug_frame (and in
+ *	.eh_frame, when there is no usable .eh_frame_hdr) are decoded once,
+ *	when initializing, into a table sorted by starting address, and
+ *	are looked up by a binary search; where both .debug_frame and
+ *	.eh_frame fdes cover an address, the .debug_frame one is used
+ *
+ *	the register unwinding rules at an address are computed by
+ *	interpreting the call frame instructions of the cie and the
+ *	fde covering the address; registers for which the call frame
+ *	information does not give a rule are considered to have the same
+ *	value in the previous frame - this is what the frame register
+ *	cache expects, see dwarf_frame_unwind() in frame-reg-cache.c
+ *
+ * Revision summary:
+ *
+ * $Log: $
+ */
+
+/*
+ *
+ * include section follows
+ *
+ */
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libelf.h>
+#include <gelf.h>
+
+#include "dwarf-common.h"
+#include "target-defs.h"
+#include "gear-engine-context.h"
+#include "dwarf-frame.h"
+#include "gprintf.h"
+#include "miprintf.h"
+#include "util.h"
+
+/*
+ *
+ * local definitions follow
+ *
+ */
+
+/*! pointer encodings, as used in .eh_frame and .eh_frame_hdr */
+enum
+{
+	/* the low nibble - the format of the encoded value */
+	EH_PE_ABSPTR		= 0x00,
+	EH_PE_ULEB128		= 0x01,
+	EH_PE_UDATA2		= 0x02,
+	EH_PE_UDATA4		= 0x03,
+	EH_PE_UDATA8		= 0x04,
+	EH_PE_SLEB128		= 0x09,
+	EH_PE_SDATA2		= 0x0a,
+	EH_PE_SDATA4		= 0x0b,
+	EH_PE_SDATA8		= 0x0c,
+	EH_PE_FORMAT_MASK	= 0x0f,
+	/* bits 4 to 6 - what the encoded value is relative to */
+	EH_PE_PCREL		= 0x10,
+	EH_PE_TEXTREL		= 0x20,
+	EH_PE_DATAREL		= 0x30,
+	EH_PE_FUNCREL		= 0x40,
+	EH_PE_ALIGNED		= 0x50,
+	EH_PE_APPLICATION_MASK	= 0x70,
+	/* the encoded value is the address of the actual value */
+	EH_PE_INDIRECT		= 0x80,
+	/* no value is present */
+	EH_PE_OMIT		= 0xff,
+};
+
+enum
+{
+	/*! the maximum depth of the DW_CFA_remember_state stack */
+	MAX_REMEMBERED_ROWS	= 8,
+};
+
+/*
+ *
+ * local data types follow
+ *
+ */
+
+/*! a decoded common information entry (cie) */
+struct cie_struct
+{
+	/*! the offset of the cie in its section */
+	unsigned		offset;
+	/*! the cie version number */
+	int			version;
+	/*! the size of a target address, in bytes */
+	int			address_size;
+	/*! the size of a segment selector, in bytes (dwarf 4 only) */
+	int			segment_size;
+	/*! the code alignment factor */
+	unsigned long long	code_align;
+	/*! the data alignment factor */
+	long long		data_align;
+	/*! the dwarf register number of the return address column */
+	int			ret_addr_column;
+	/*! the encoding of the addresses in the fdes of this cie ('R' augmentation) */
+	unsigned char		fde_encoding;
+	/*! nonzero, if the fdes of this cie have augmentation data ('z' augmentation) */
+	bool			has_augmentation_data;
+	/*! nonzero, if the fdes of this cie describe signal handler frames ('S' augmentation) */
+	bool			is_signal_frame;
+	/*! nonzero, if the cie can be used for unwinding; unknown versions and augmentations make a cie unusable */
+	bool			is_supported;
+	/*! the initial call frame instructions */
+	const unsigned char	* insns;
+	/*! the end of the initial call frame instructions */
+	const unsigned char	* insns_end;
+};
+
+/*! a section holding call frame information */
+struct cfi_section
+{
+	/*! the section contents; null, if the section is not present */
+	const unsigned char	* buf;
+	/*! the number of bytes in the section */
+	unsigned		size;
+	/*! the target address of the section; zero for .debug_frame */
+	ARM_CORE_WORD		addr;
+	/*! nonzero for .eh_frame, zero for .debug_frame */
+	bool			is_eh_frame;
+	/*! the cies in the section, in section offset order */
+	struct cie_struct	* cies;
+	/*! the number of elements in the cies array above */
+	int			nr_cies;
+};
+
+/*! a decoded frame description entry (fde) */
+struct fde_struct
+{
+	/*! the address of the first instruction covered by the fde */
+	unsigned long long	low_pc;
+	/*! the address past the last instruction covered by the fde */
+	unsigned long long	high_pc;
+	/*! the cie of the fde */
+	const struct cie_struct	* cie;
+	/*! the section holding the fde */
+	const struct cfi_section	* sect;
+	/*! the call frame instructions of the fde */
+	const unsigned char	* insns;
+	/*! the end of the call frame instructions of the fde */
+	const unsigned char	* insns_end;
+};
+
+/*! a cursor for reading call frame information */
+struct reader
+{
+	/*! the next byte to read */
+	const unsigned char	* p;
+	/*! the end of the data that may be read */
+	const unsigned char	* end;
+	/*! the start of the section being read */
+	const unsigned char	* base;
+	/*! the target address of the start of the section being read, for pc relative pointers */
+	ARM_CORE_WORD		base_addr;
+	/*! nonzero, if multibyte values are big endian */
+	bool			is_big_endian;
+	/*! set when an attempt is made to read past the end of the data */
+	bool			is_overrun;
+};
+
+/*! the header of a cie or an fde */
+struct entry_header
+{
+	/*! nonzero, if the entry is a cie */
+	bool		is_cie;
+	/*! for an fde - the offset of its cie in the section */
+	unsigned long long	cie_offset;
+	/*! the offset of the entry following this one in the section */
+	unsigned	next_offset;
+};
+
+/*! the call frame information of the executable being debugged */
+struct dwarf_frame_data
+{
+	/*! nonzero, if the executable is big endian */
+	bool		is_big_endian;
+	/*! the size of a target address, in bytes, as determined by the elf class of the executable */
+	int		address_size;
+	/*! the target address of the .text section, for text relative pointers */
+	ARM_CORE_WORD	text_addr;
+	/*! the target address of the .got section, for data relative pointers in .eh_frame */
+	ARM_CORE_WORD	got_addr;
+	/*! the .debug_frame section */
+	struct cfi_section	debug_frame;
+	/*! the .eh_frame section */
+	struct cfi_section	eh_frame;
+	/*! the .eh_frame_hdr section */
+	struct
+	{
+		/*! the section itself; only the buf, size and addr fields are used */
+		struct cfi_section	sect;
+		/*! the binary search table, sorted by starting address */
+		const unsigned char	* table;
+		/*! the number of entries in the table; zero, if the table is not present or not usable */
+		int		nr_entries;
+		/*! the encoding of the table entry fields */
+		unsigned char	table_encoding;
+		/*! the size of a table entry field, in bytes */
+		int		field_size;
+	}
+	eh_frame_hdr;
+	/*! the decoded fdes, sorted by starting address */
+	struct fde_struct	* fdes;
+	/*! the number of elements in the fdes array above */
+	int		nr_fdes;
+	/*! the number of call frame information table rows computed */
+	int		nr_rows_computed;
+};
+
+/*
+ *
+ * local functions follow
+ *
+ */
+
+static void init_reader(struct dwarf_frame_data * cfi, struct reader * r, const struct cfi_section * sect, unsigned offset)
+{
+	r->base = sect->buf;
+	r->base_addr = sect->addr;
+	r->p = sect->buf + offset;
+	r->end = sect->buf + sect->size;
+	r->is_big_endian = cfi->is_big_endian;
+	r->is_overrun = false;
+}
+
+static unsigned long long read_unsigned(struct reader * r, int nbytes)
+{
+unsigned long long x;
+int i;
+
+	if (r->end - r->p < nbytes)
+	{
+		r->is_overrun = true;
+		r->p = r->end;
+		return 0;
+	}
+	for (x = i = 0; i < nbytes; i++)
+		x |= (unsigned long long) r->p[r->is_big_endian ? nbytes - 1 - i : i] << (8 * i);
+	r->p += nbytes;
+	return x;
+}
+
+static long long read_signed(struct reader * r, int nbytes)
+{
+unsigned long long x;
+
+	x = read_unsigned(r, nbytes);
+	if (nbytes < 8 && (x & (1ULL << (8 * nbytes - 1))))
+		x |= ~0ULL << (8 * nbytes);
+	return x;
+}
+
+static unsigned long long read_uleb128(struct reader * r)
+{
+unsigned long long x;
+int shift;
+unsigned char b;
+
+	x = shift = 0;
+	do
+	{
+		if (r->p == r->end)
+		{
+			r->is_overrun = true;
+			return 0;
+		}
+		b = * r->p ++;
+		if (shift < 64)
+			x |= (unsigned long long) (b & 0x7f) << shift;
+		shift += 7;
+	}
+	while (b & 0x80);
+	return x;
+}
+
+static long long read_sleb128(struct reader * r)
+{
+unsigned long long x;
+int shift;
+unsigned char b;
+
+	x = shift = 0;
+	do
+	{
+		if (r->p == r->end)
+		{
+			r->is_overrun = true;
+			return 0;
+		}
+		b = * r->p ++;
+		if (shift < 64)
+			x |= (unsigned long long) (b & 0x7f) << shift;
+		shift += 7;
+	}
+	while (b & 0x80);
+	if (shift < 64 && (b & 0x40))
+		x |= ~0ULL << shift;
+	return x;
+}
+
+/*!
+ *	\fn	static bool skip_bytes(struct reader * r, unsigned long long nbytes)
+ *	\brief	skips a number of bytes
+ *
+ *	\param	r	the reader to skip bytes in
+ *	\param	nbytes	the number of bytes to skip
+ *	\return	true, if the bytes have been skipped, false, if
+ *		there are not as many bytes available */
+static bool skip_bytes(struct reader * r, unsigned long long nbytes)
+{
+	if (nbytes > (unsigned long long) (r->end - r->p))
+	{
+		r->is_overrun = true;
+		r->p = r->end;
+		return false;
+	}
+	r->p += nbytes;
+	return true;
+}
+
+/*!
+ *	\fn	static bool read_encoded(struct dwarf_frame_data * cfi, struct reader * r, unsigned char encoding, int address_size, ARM_CORE_WORD data_base, unsigned long long * val)
+ *	\brief	reads an encoded pointer value
+ *
+ *	\param	cfi	the call frame information data
+ *	\param	r	the reader to read from
+ *	\param	encoding	the pointer encoding - one of the
+ *				EH_PE_xxx values, but not EH_PE_OMIT
+ *	\param	address_size	the size of an absolute pointer, in bytes
+ *	\param	data_base	the base address for data relative pointers
+ *	\param	val	a pointer to where to store the value read
+ *	\return	true, if the value has been read, and is usable; false,
+ *		if the value is malformed, or cannot be determined without
+ *		accessing the target (indirect and function relative values);
+ *		in the latter case, the value is still skipped */
+static bool read_encoded(struct dwarf_frame_data * cfi, struct reader * r, unsigned char encoding, int address_size, ARM_CORE_WORD data_base, unsigned long long * val)
+{
+unsigned long long x;
+ARM_CORE_WORD addr;
+
+	if ((encoding & EH_PE_APPLICATION_MASK) == EH_PE_ALIGNED)
+	{
+		addr = r->base_addr + (r->p - r->base);
+		if (!skip_bytes(r, (address_size - addr % address_size) % address_size))
+			return false;
+	}
+	/* the target address of the value, for pc relative values */
+	addr = r->base_addr + (r->p - r->base);
+	switch (encoding & EH_PE_FORMAT_MASK)
+	{
+		case EH_PE_ABSPTR:
+			x = read_unsigned(r, address_size);
+			break;
+		case EH_PE_ULEB128:
+			x = read_uleb128(r);
+			break;
+		case EH_PE_UDATA2:
+			x = read_unsigned(r, 2);
+			break;
+		case EH_PE_UDATA4:
+			x = read_unsigned(r, 4);
+			break;
+		case EH_PE_UDATA8:
+			x = read_unsigned(r, 8);
+			break;
+		case EH_PE_SLEB128:
+			x = read_sleb128(r);
+			break;
+		case EH_PE_SDATA2:
+			x = read_signed(r, 2);
+			break;
+		case EH_PE_SDATA4:
+			x = read_signed(r, 4);
+			break;
+		case EH_PE_SDATA8:
+			x = read_signed(r, 8);
+			break;
+		default:
+			/* the size of the value is not known,
+			 * so nothing more can be read */
+			r->is_overrun = true;
+			return false;
+	}
+	switch (encoding & EH_PE_APPLICATION_MASK)
+	{
+		case 0:
+		case EH_PE_ALIGNED:
+			break;
+		case EH_PE_PCREL:
+			x += addr;
+			break;
+		case EH_PE_TEXTREL:
+			x += cfi->text_addr;
+			break;
+		case EH_PE_DATAREL:
+			x += data_base;
+			break;
+		default:
+			return false;
+	}
+	* val = x;
+	return !r->is_overrun && !(encoding & EH_PE_INDIRECT);
+}
+
+/*!
+ *	\fn	static bool read_entry_header(struct dwarf_frame_data * cfi, const struct cfi_section * sect, unsigned offset, struct entry_header * h, struct reader * r)
+ *	\brief	reads the header of a cie or an fde
+ *
+ *	\param	cfi	the call frame information data
+ *	\param	sect	the section holding the entry
+ *	\param	offset	the offset of the entry in the section
+ *	\param	h	a pointer to where to store the entry header
+ *	\param	r	a reader, which is set up for reading the
+ *			rest of the entry
+ *	\return	true, if the entry header has been read; false, at the
+ *		end of the section (or of the entries in it), or if the
+ *		entry header is malformed */
+static bool read_entry_header(struct dwarf_frame_data * cfi, const struct cfi_section * sect, unsigned offset, struct entry_header * h, struct reader * r)
+{
+unsigned long long len, id;
+bool is_64;
+unsigned id_offset;
+
+	init_reader(cfi, r, sect, offset);
+	is_64 = false;
+	len = read_unsigned(r, 4);
+	if (len == 0xffffffff)
+	{
+		/* 64-bit dwarf */
+		is_64 = true;
+		len = read_unsigned(r, 8);
+	}
+	/* a zero length terminates .eh_frame */
+	if (r->is_overrun || !len || len > (unsigned long long) (r->end - r->p))
+		return false;
+	id_offset = r->p - r->base;
+	h->next_offset = id_offset + len;
+	r->end = r->p + len;
+	if (sect->is_eh_frame)
+	{
+		/* the cie id is zero, and the cie pointer in an fde
+		 * is relative to the cie pointer itself */
+		id = read_unsigned(r, 4);
+		h->is_cie = !id;
+		h->cie_offset = id_offset - id;
+		if (id > id_offset)
+			return false;
+	}
+	else
+	{
+		id = read_unsigned(r, is_64 ? 8 : 4);
+		h->is_cie = is_64 ? (id == ~0ULL) : (id == 0xffffffff);
+		h->cie_offset = id;
+	}
+	return !r->is_overrun;
+}
+
+/*!
+ *	\fn	static bool parse_cie(struct dwarf_frame_data * cfi, const struct cfi_section * sect, unsigned offset, struct cie_struct * cie)
+ *	\brief	decodes a cie
+ *
+ *	\param	cfi	the call frame information data
+ *	\param	sect	the section holding the cie
+ *	\param	offset	the offset of the cie in the section
+ *	\param	cie	a pointer to where to store the decoded cie
+ *	\return	true, if the entry at the offset given is a cie,
+ *		false otherwise; a cie that has been decoded, but cannot
+ *		be used, has its is_supported field cleared */
+static bool parse_cie(struct dwarf_frame_data * cfi, const struct cfi_section * sect, unsigned offset, struct cie_struct * cie)
+{
+struct entry_header h;
+struct reader r;
+const char * augmentation, * s;
+const unsigned char * augmentation_data_end;
+unsigned long long unused;
+
+	if (!read_entry_header(cfi, sect, offset, &h, &r) || !h.is_cie)
+		return false;
+	memset(cie, 0, sizeof * cie);
+	cie->offset = offset;
+	cie->version = read_unsigned(&r, 1);
+	augmentation = (const char *) r.p;
+	while (r.p < r.end && * r.p)
+		r.p ++;
+	if (!skip_bytes(&r, 1))
+		return true;
+	cie->address_size = cfi->address_size;
+	cie->fde_encoding = EH_PE_ABSPTR;
+	if (cie->version == 4)
+	{
+		cie->address_size = read_unsigned(&r, 1);
+		cie->segment_size = read_unsigned(&r, 1);
+	}
+	if (!strcmp(augmentation, "eh"))
+		/* skip the old gcc exception table pointer */
+		read_unsigned(&r, cie->address_size);
+	cie->code_align = read_uleb128(&r);
+	cie->data_align = read_sleb128(&r);
+	cie->ret_addr_column = (cie->version == 1) ? read_unsigned(&r, 1) : read_uleb128(&r);
+
+	if (augmentation[0] == 'z')
+	{
+		cie->has_augmentation_data = true;
+		unused = read_uleb128(&r);
+		if (r.is_overrun || unused > (unsigned long long) (r.end - r.p))
+			return true;
+		augmentation_data_end = r.p + unused;
+		for (s = augmentation + 1; * s; s ++)
+		{
+			if (* s == 'R')
+				cie->fde_encoding = read_unsigned(&r, 1);
+			else if (* s == 'L')
+				/* the lsda pointer encoding is of no interest */
+				read_unsigned(&r, 1);
+			else if (* s == 'P')
+				/* neither is the personality routine */
+				read_encoded(cfi, &r, read_unsigned(&r, 1), cie->address_size, cfi->got_addr, &unused);
+			else if (* s == 'S')
+				cie->is_signal_frame = true;
+			else
+				/* unknown augmentation - the rest of the
+				 * augmentation data cannot be interpreted */
+				break;
+		}
+		r.p = augmentation_data_end;
+	}
+	else if (augmentation[0] && strcmp(augmentation, "eh"))
+		/* unknown augmentation */
+		return true;
+
+	cie->insns = r.p;
+	cie->insns_end = r.end;
+	switch (cie->version)
+	{
+		case 1:
+		case 3:
+			cie->is_supported = true;
+			break;
+		case 4:
+			cie->is_supported = !sect->is_eh_frame;
+			break;
+	}
+	if (r.is_overrun || cie->segment_size
+			|| (cie->address_size != 2 && cie->address_size != 4 && cie->address_size != 8))
+		cie->is_supported = false;
+	return true;
+}
+
+/*!
+ *	\fn	static const struct cie_struct * find_cie(const struct cfi_section * sect, unsigned long long offset)
+ *	\brief	finds a decoded cie by its section offset
+ *
+ *	\param	sect	the section to search in
+ *	\param	offset	the offset of the cie in the section
+ *	\return	the cie found, null if not found */
+static const struct cie_struct * find_cie(const struct cfi_section * sect, unsigned long long offset)
+{
+int lo, hi, mid;
+
+	lo = 0;
+	hi = sect->nr_cies;
+	while (lo < hi)
+	{
+		mid = (lo + hi) / 2;
+		if (sect->cies[mid].offset == offset)
+			return sect->cies + mid;
+		if (sect->cies[mid].offset < offset)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return 0;
+}
+
+/*!
+ *	\fn	static bool parse_fde(struct dwarf_frame_data * cfi, const struct cfi_section * sect, unsigned offset, struct fde_struct * fde)
+ *	\brief	decodes an fde
+ *
+ *	\param	cfi	the call frame information data
+ *	\param	sect	the section holding the fde; its cies
+ *			must already have been decoded
+ *	\param	offset	the offset of the fde in the section
+ *	\param	fde	a pointer to where to store the decoded fde
+ *	\return	true, if the entry at the offset given is an fde
+ *		which can be used for unwinding, false otherwise */
+static bool parse_fde(struct dwarf_frame_data * cfi, const struct cfi_section * sect, unsigned offset, struct fde_struct * fde)
+{
+struct entry_header h;
+struct reader r;
+const struct cie_struct * cie;
+unsigned long long low_pc, len;
+
+	if (!read_entry_header(cfi, sect, offset, &h, &r) || h.is_cie)
+		return false;
+	if (!(cie = find_cie(sect, h.cie_offset)) || !cie->is_supported)
+		return false;
+	if (!read_encoded(cfi, &r, cie->fde_encoding, cie->address_size, cfi->got_addr, &low_pc))
+		return false;
+	/* the address range is never relative to anything */
+	if (!read_encoded(cfi, &r, cie->fde_encoding & EH_PE_FORMAT_MASK, cie->address_size, 0, &len))
+		return false;
+	if (cie->has_augmentation_data && !skip_bytes(&r, read_uleb128(&r)))
+		return false;
+	fde->low_pc = low_pc;
+	fde->high_pc = low_pc + len;
+	fde->cie = cie;
+	fde->sect = sect;
+	fde->insns = r.p;
+	fde->insns_end = r.end;
+	return !r.is_overrun;
+}
+
+/*!
+ *	\fn	static void scan_section(struct dwarf_frame_data * cfi, struct cfi_section * sect, bool is_fde_table_needed)
+ *	\brief	decodes the cies in a call frame information section, and, optionally, adds its fdes to the fde table
+ *
+ *	\param	cfi	the call frame information data
+ *	\param	sect	the section to scan; may be not present
+ *	\param	is_fde_table_needed	if nonzero, the fdes in the
+ *					section are added to the fde table
+ *	\return	none */
+static void scan_section(struct dwarf_frame_data * cfi, struct cfi_section * sect, bool is_fde_table_needed)
+{
+struct entry_header h;
+struct reader r;
+unsigned offset;
+int nr_cies, nr_fdes;
+
+	if (!sect->buf)
+		return;
+	/* count the entries first */
+	nr_cies = nr_fdes = 0;
+	for (offset = 0; offset < sect->size && read_entry_header(cfi, sect, offset, &h, &r); offset = h.next_offset)
+		if (h.is_cie)
+			nr_cies ++;
+		else
+			nr_fdes ++;
+	if (nr_cies && !(sect->cies = calloc(nr_cies, sizeof * sect->cies)))
+		panic("out of core");
+	for (offset = 0; offset < sect->size && read_entry_header(cfi, sect, offset, &h, &r); offset = h.next_offset)
+		if (h.is_cie && parse_cie(cfi, sect, offset, sect->cies + sect->nr_cies))
+			sect->nr_cies ++;
+	if (!is_fde_table_needed || !nr_fdes)
+		return;
+	if (!(cfi->fdes = realloc(cfi->fdes, (cfi->nr_fdes + nr_fdes) * sizeof * cfi->fdes)))
+		panic("out of core");
+	for (offset = 0; offset < sect->size && read_entry_header(cfi, sect, offset, &h, &r); offset = h.next_offset)
+		/* fdes covering nothing (e.g. ones for discarded
+		 * sections) can never be found, drop them */
+		if (!h.is_cie && parse_fde(cfi, sect, offset, cfi->fdes + cfi->nr_fdes)
+				&& cfi->fdes[cfi->nr_fdes].high_pc > cfi->fdes[cfi->nr_fdes].low_pc)
+			cfi->nr_fdes ++;
+}
+
+/*!
+ *	\fn	static void init_eh_frame_hdr(struct dwarf_frame_data * cfi)
+ *	\brief	validates the .eh_frame_hdr section and locates its binary search table
+ *
+ *	\param	cfi	the call frame information data
+ *	\return	none; if the binary search table is usable, the
+ *		eh_frame_hdr.nr_entries field is set to a nonzero value */
+static void init_eh_frame_hdr(struct dwarf_frame_data * cfi)
+{
+struct reader r;
+unsigned char eh_frame_ptr_encoding, fde_count_encoding, table_encoding;
+unsigned long long x;
+
+	if (!cfi->eh_frame_hdr.sect.buf || !cfi->eh_frame.buf)
+		return;
+	init_reader(cfi, &r, &cfi->eh_frame_hdr.sect, 0);
+	if (read_unsigned(&r, 1) != 1)
+		/* unknown version */
+		return;
+	eh_frame_ptr_encoding = read_unsigned(&r, 1);
+	fde_count_encoding = read_unsigned(&r, 1);
+	table_encoding = read_unsigned(&r, 1);
+	if (eh_frame_ptr_encoding != EH_PE_OMIT)
+		read_encoded(cfi, &r, eh_frame_ptr_encoding, cfi->address_size, cfi->eh_frame_hdr.sect.addr, &x);
+	if (fde_count_encoding == EH_PE_OMIT || table_encoding == EH_PE_OMIT)
+		return;
+	if (!read_encoded(cfi, &r, fde_count_encoding, cfi->address_size, cfi->eh_frame_hdr.sect.addr, &x))
+		return;
+	/* the table can only be binary searched if its entries
+	 * are of fixed size, and are not relative to their location */
+	switch (table_encoding & EH_PE_FORMAT_MASK)
+	{
+		case EH_PE_ABSPTR:
+			cfi->eh_frame_hdr.field_size = cfi->address_size;
+			break;
+		case EH_PE_UDATA2:
+		case EH_PE_SDATA2:
+			cfi->eh_frame_hdr.field_size = 2;
+			break;
+		case EH_PE_UDATA4:
+		case EH_PE_SDATA4:
+			cfi->eh_frame_hdr.field_size = 4;
+			break;
+		case EH_PE_UDATA8:
+		case EH_PE_SDATA8:
+			cfi->eh_frame_hdr.field_size = 8;
+			break;
+		default:
+			return;
+	}
+	if (table_encoding & ~(EH_PE_FORMAT_MASK | EH_PE_DATAREL))
+		return;
+	if (r.is_overrun || x > (unsigned long long) (r.end - r.p) / (2 * cfi->eh_frame_hdr.field_size))
+		return;
+	cfi->eh_frame_hdr.table_encoding = table_encoding;
+	cfi->eh_frame_hdr.table = r.p;
+	cfi->eh_frame_hdr.nr_entries = x;
+}
+
+/*!
+ *	\fn	static unsigned long long read_eh_frame_hdr_field(struct dwarf_frame_data * cfi, int entry_idx, int field_idx)
+ *	\brief	reads a field of an .eh_frame_hdr binary search table entry
+ *
+ *	\param	cfi	the call frame information data
+ *	\param	entry_idx	the number of the table entry
+ *	\param	field_idx	zero for the starting address, one
+ *				for the address of the fde
+ *	\return	the field value */
+static unsigned long long read_eh_frame_hdr_field(struct dwarf_frame_data * cfi, int entry_idx, int field_idx)
+{
+struct reader r;
+unsigned long long x;
+
+	init_reader(cfi, &r, &cfi->eh_frame_hdr.sect,
+			cfi->eh_frame_hdr.table - cfi->eh_frame_hdr.sect.buf
+			+ (2 * entry_idx + field_idx) * cfi->eh_frame_hdr.field_size);
+	/* the table has been validated by init_eh_frame_hdr() */
+	read_encoded(cfi, &r, cfi->eh_frame_hdr.table_encoding, cfi->address_size, cfi->eh_frame_hdr.sect.addr, &x);
+	return x;
+}
+
+/*!
+ *	\fn	static bool find_fde(struct dwarf_frame_data * cfi, ARM_CORE_WORD pc, struct fde_struct * fde)
+ *	\brief	finds the fde covering a target address
+ *
+ *	the fde table is searched first, and then, if present,
+ *	the .eh_frame_hdr binary search table
+ *
+ *	\param	cfi	the call frame information data
+ *	\param	pc	the target address to search for
+ *	\param	fde	a pointer to where to store the fde found
+ *	\return	true, if an fde covering the address has been found, false otherwise */
+static bool find_fde(struct dwarf_frame_data * cfi, ARM_CORE_WORD pc, struct fde_struct * fde)
+{
+int lo, hi, mid;
+unsigned long long fde_addr;
+
+	/* find the first fde starting past the address */
+	lo = 0;
+	hi = cfi->nr_fdes;
+	while (lo < hi)
+	{
+		mid = (lo + hi) / 2;
+		if (cfi->fdes[mid].low_pc <= pc)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	/* see if the fde preceding it covers the address */
+	if (lo && pc < cfi->fdes[lo - 1].high_pc)
+	{
+		* fde = cfi->fdes[lo - 1];
+		return true;
+	}
+
+	if (!cfi->eh_frame_hdr.nr_entries)
+		return false;
+	lo = 0;
+	hi = cfi->eh_frame_hdr.nr_entries;
+	while (lo < hi)
+	{
+		mid = (lo + hi) / 2;
+		if (read_eh_frame_hdr_field(cfi, mid, 0) <= pc)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (!lo)
+		return false;
+	fde_addr = read_eh_frame_hdr_field(cfi, lo - 1, 1);
+	if (fde_addr < cfi->eh_frame.addr || fde_addr - cfi->eh_frame.addr >= cfi->eh_frame.size)
+		return false;
+	if (!parse_fde(cfi, &cfi->eh_frame, fde_addr - cfi->eh_frame.addr, fde))
+		return false;
+	return pc >= fde->low_pc && pc < fde->high_pc;
+}
+
+/*!
+ *	\fn	static int fde_compare(const void * a, const void * b)
+ *	\brief	fde comparison routine for qsort(), ordering fdes by their starting address
+ *
+ *	fdes starting at the same address are ordered so that
+ *	the .debug_frame ones come last - these are the ones
+ *	that find_fde() picks
+ *
+ *	\param	a	a pointer to the first fde to compare
+ *	\param	b	a pointer to the second fde to compare
+ *	\return	a negative value, zero, or a positive value, if the
+ *		first fde should (respectively) precede, need not be
+ *		ordered with regard to, or follow the second one */
+static int fde_compare(const void * a, const void * b)
+{
+const struct fde_struct * x, * y;
+
+	x = a;
+	y = b;
+	if (x->low_pc < y->low_pc)
+		return -1;
+	if (x->low_pc > y->low_pc)
+		return 1;
+	return y->sect->is_eh_frame - x->sect->is_eh_frame;
+}
+
+/*!
+ *	\fn	static void set_rule(struct dwarf_frame_row * row, unsigned long long reg_nr, enum DWARF_FRAME_RULE_ENUM type, unsigned long long src_reg_nr, long long offset, const unsigned char * expr, int expr_len)
+ *	\brief	sets the unwinding rule for a register in a call frame information table row
+ *
+ *	rules for registers which are not tracked are ignored
+ *
+ *	\param	row	the row to update
+ *	\param	reg_nr	the dwarf number of the register
+ *	\param	type	the rule type
+ *	\param	src_reg_nr	the register number, for register rules
+ *	\param	offset	the offset, for offset and register rules
+ *	\param	expr	the dwarf expression, for expression rules
+ *	\param	expr_len	the length of the dwarf expression above
+ *	\return	none */
+static void set_rule(struct dwarf_frame_row * row, unsigned long long reg_nr, enum DWARF_FRAME_RULE_ENUM type, unsigned long long src_reg_nr, long long offset, const unsigned char * expr, int expr_len)
+{
+	if (reg_nr >= DWARF_FRAME_MAX_NR_REGS)
+		return;
+	row->rules[reg_nr] = (struct dwarf_frame_rule)
+		{ .type = type, .reg_nr = src_reg_nr, .offset = offset,
+			.expr = expr, .expr_len = expr_len, };
+}
+
+/*!
+ *	\fn	static bool read_block(struct reader * r, const unsigned char ** expr, int * expr_len)
+ *	\brief	reads a dwarf expression block - a length, followed by the expression bytes
+ *
+ *	\param	r	the reader to read from
+ *	\param	expr	a pointer to where to store the start of the expression
+ *	\param	expr_len	a pointer to where to store the expression length
+ *	\return	true, if the block has been read, false if it is malformed */
+static bool read_block(struct reader * r, const unsigned char ** expr, int * expr_len)
+{
+unsigned long long len;
+
+	len = read_uleb128(r);
+	* expr = r->p;
+	* expr_len = len;
+	return !r->is_overrun && skip_bytes(r, len);
+}
+
+/*!
+ *	\fn	static bool execute_insns(struct dwarf_frame_data * cfi, const struct fde_struct * fde, const unsigned char * insns, const unsigned char * insns_end, ARM_CORE_WORD pc, unsigned long long * loc, struct dwarf_frame_row * row, const struct dwarf_frame_row * initial_row)
+ *	\brief	interprets call frame instructions, up to a target address
+ *
+ *	\param	cfi	the call frame information data
+ *	\param	fde	the fde being processed
+ *	\param	insns	the call frame instructions to interpret
+ *	\param	insns_end	the end of the call frame instructions
+ *	\param	pc	the target address to stop at
+ *	\param	loc	the current location; updated by the
+ *			location advancing instructions
+ *	\param	row	the row to update
+ *	\param	initial_row	the row after interpreting the initial
+ *				instructions of the cie - the one restored
+ *				by DW_CFA_restore; null when interpreting
+ *				the initial instructions themselves
+ *	\return	true, if the instructions have been interpreted, false
+ *		if they are malformed, or unsupported */
+static bool execute_insns(struct dwarf_frame_data * cfi, const struct fde_struct * fde, const unsigned char * insns, const unsigned char * insns_end, ARM_CORE_WORD pc, unsigned long long * loc, struct dwarf_frame_row * row, const struct dwarf_frame_row * initial_row)
+{
+struct dwarf_frame_row remembered_rows[MAX_REMEMBERED_ROWS];
+int nr_remembered_rows;
+const struct cie_struct * cie;
+struct reader r;
+unsigned char op;
+unsigned long long reg_nr, x, new_loc;
+const unsigned char * expr;
+int expr_len;
+
+	cie = fde->cie;
+	init_reader(cfi, &r, fde->sect, insns - fde->sect->buf);
+	r.end = insns_end;
+	nr_remembered_rows = 0;
+
+	while (r.p < r.end)
+	{
+		op = read_unsigned(&r, 1);
+		switch (op & 0xc0)
+		{
+			case DW_CFA_advance_loc:
+				new_loc = * loc + (op & 0x3f) * cie->code_align;
+				if (new_loc > pc)
+					return true;
+				* loc = new_loc;
+				continue;
+			case DW_CFA_offset:
+				set_rule(row, op & 0x3f, DWARF_FRAME_RULE_OFFSET, 0,
+						read_uleb128(&r) * cie->data_align, 0, 0);
+				continue;
+			case DW_CFA_restore:
+				reg_nr = op & 0x3f;
+				if (initial_row && reg_nr < DWARF_FRAME_MAX_NR_REGS)
+					row->rules[reg_nr] = initial_row->rules[reg_nr];
+				else
+					set_rule(row, reg_nr, DWARF_FRAME_RULE_SAME_VALUE, 0, 0, 0, 0);
+				continue;
+		}
+		switch (op)
+		{
+			case DW_CFA_nop:
+				break;
+			case DW_CFA_set_loc:
+				if (!read_encoded(cfi, &r, cie->fde_encoding, cie->address_size, cfi->got_addr, &new_loc))
+					return false;
+				if (new_loc > pc)
+					return true;
+				* loc = new_loc;
+				break;
+			case DW_CFA_advance_loc1:
+			case DW_CFA_advance_loc2:
+			case DW_CFA_advance_loc4:
+				x = read_unsigned(&r, (op == DW_CFA_advance_loc1) ? 1 : ((op == DW_CFA_advance_loc2) ? 2 : 4));
+				new_loc = * loc + x * cie->code_align;
+				if (new_loc > pc)
+					return !r.is_overrun;
+				* loc = new_loc;
+				break;
+			case DW_CFA_offset_extended:
+				reg_nr = read_uleb128(&r);
+				set_rule(row, reg_nr, DWARF_FRAME_RULE_OFFSET, 0,
+						read_uleb128(&r) * cie->data_align, 0, 0);
+				break;
+			case DW_CFA_offset_extended_sf:
+				reg_nr = read_uleb128(&r);
+				set_rule(row, reg_nr, DWARF_FRAME_RULE_OFFSET, 0,
+						read_sleb128(&r) * cie->data_align, 0, 0);
+				break;
+			case DW_CFA_GNU_negative_offset_extended:
+				reg_nr = read_uleb128(&r);
+				set_rule(row, reg_nr, DWARF_FRAME_RULE_OFFSET, 0,
+						- (long long) read_uleb128(&r) * cie->data_align, 0, 0);
+				break;
+			case DW_CFA_val_offset:
+				reg_nr = read_uleb128(&r);
+				set_rule(row, reg_nr, DWARF_FRAME_RULE_VAL_OFFSET, 0,
+						read_uleb128(&r) * cie->data_align, 0, 0);
+				break;
+			case DW_CFA_val_offset_sf:
+				reg_nr = read_uleb128(&r);
+				set_rule(row, reg_nr, DWARF_FRAME_RULE_VAL_OFFSET, 0,
+						read_sleb128(&r) * cie->data_align, 0, 0);
+				break;
+			case DW_CFA_restore_extended:
+				reg_nr = read_uleb128(&r);
+				if (initial_row && reg_nr < DWARF_FRAME_MAX_NR_REGS)
+					row->rules[reg_nr] = initial_row->rules[reg_nr];
+				else
+					set_rule(row, reg_nr, DWARF_FRAME_RULE_SAME_VALUE, 0, 0, 0, 0);
+				break;
+			case DW_CFA_undefined:
+				set_rule(row, read_uleb128(&r), DWARF_FRAME_RULE_UNDEFINED, 0, 0, 0, 0);
+				break;
+			case DW_CFA_same_value:
+				set_rule(row, read_uleb128(&r), DWARF_FRAME_RULE_SAME_VALUE, 0, 0, 0, 0);
+				break;
+			case DW_CFA_register:
+				reg_nr = read_uleb128(&r);
+				set_rule(row, reg_nr, DWARF_FRAME_RULE_REGISTER, read_uleb128(&r), 0, 0, 0);
+				break;
+			case DW_CFA_expression:
+			case DW_CFA_val_expression:
+				reg_nr = read_uleb128(&r);
+				if (!read_block(&r, &expr, &expr_len))
+					return false;
+				set_rule(row, reg_nr, (op == DW_CFA_expression) ?
+						DWARF_FRAME_RULE_EXPRESSION : DWARF_FRAME_RULE_VAL_EXPRESSION,
+						0, 0, expr, expr_len);
+				break;
+			case DW_CFA_remember_state:
+				if (nr_remembered_rows == MAX_REMEMBERED_ROWS)
+					return false;
+				/* as gcc expects, the cfa rule is
+				 * remembered along with the register rules */
+				remembered_rows[nr_remembered_rows ++] = * row;
+				break;
+			case DW_CFA_restore_state:
+				if (!nr_remembered_rows)
+					return false;
+				* row = remembered_rows[-- nr_remembered_rows];
+				break;
+			case DW_CFA_def_cfa:
+				reg_nr = read_uleb128(&r);
+				row->cfa_rule = (struct dwarf_frame_rule) { .type = DWARF_FRAME_RULE_REGISTER,
+						.reg_nr = reg_nr, .offset = read_uleb128(&r), };
+				break;
+			case DW_CFA_def_cfa_sf:
+				reg_nr = read_uleb128(&r);
+				row->cfa_rule = (struct dwarf_frame_rule) { .type = DWARF_FRAME_RULE_REGISTER,
+						.reg_nr = reg_nr, .offset = read_sleb128(&r) * cie->data_align, };
+				break;
+			case DW_CFA_def_cfa_register:
+				row->cfa_rule.reg_nr = read_uleb128(&r);
+				row->cfa_rule.type = DWARF_FRAME_RULE_REGISTER;
+				break;
+			case DW_CFA_def_cfa_offset:
+				row->cfa_rule.offset = read_uleb128(&r);
+				break;
+			case DW_CFA_def_cfa_offset_sf:
+				row->cfa_rule.offset = read_sleb128(&r) * cie->data_align;
+				break;
+			case DW_CFA_def_cfa_expression:
+				if (!read_block(&r, &expr, &expr_len))
+					return false;
+				row->cfa_rule = (struct dwarf_frame_rule) { .type = DWARF_FRAME_RULE_VAL_EXPRESSION,
+						.expr = expr, .expr_len = expr_len, };
+				break;
+			case DW_CFA_GNU_args_size:
+				read_uleb128(&r);
+				break;
+			default:
+				/* unknown instruction - its operands
+				 * cannot be skipped */
+				return false;
+		}
+	}
+	return !r.is_overrun;
+}
+
+/*
+ *
+ * exported functions follow
+ *
+ */
+
+/*!
+ *	\fn	bool dwarf_frame_get_row(struct dwarf_frame_data * cfi, ARM_CORE_WORD pc, struct dwarf_frame_row * row)
+ *	\brief	computes the register unwinding rules in effect at a target address
+ *
+ *	\param	cfi	the call frame information data, as returned
+ *			by dwarf_frame_init(); may be null
+ *	\param	pc	the target address to compute the rules for
+ *	\param	row	a pointer to where to store the rules computed
+ *	\return	true, if the rules have been computed, false if there
+ *		is no (usable) call frame information for the address */
+bool dwarf_frame_get_row(struct dwarf_frame_data * cfi, ARM_CORE_WORD pc, struct dwarf_frame_row * row)
+{
+struct fde_struct fde;
+struct dwarf_frame_row initial_row;
+unsigned long long loc;
+int i;
+
+	if (!cfi || !find_fde(cfi, pc, &fde))
+		return false;
+	row->cfa_rule = (struct dwarf_frame_rule) { .type = DWARF_FRAME_RULE_UNDEFINED, };
+	for (i = 0; i < DWARF_FRAME_MAX_NR_REGS; i++)
+		row->rules[i] = (struct dwarf_frame_rule) { .type = DWARF_FRAME_RULE_SAME_VALUE, };
+	row->ret_addr_column = fde.cie->ret_addr_column;
+	row->is_signal_frame = fde.cie->is_signal_frame;
+
+	loc = fde.low_pc;
+	if (!execute_insns(cfi, &fde, fde.cie->insns, fde.cie->insns_end, pc, &loc, row, 0))
+		return false;
+	initial_row = * row;
+	if (!execute_insns(cfi, &fde, fde.insns, fde.insns_end, pc, &loc, row, &initial_row))
+		return false;
+	cfi->nr_rows_computed ++;
+	return true;
+}
+
+/*!
+ *	\fn	void dwarf_frame_dump_stats_mi(struct dwarf_frame_data * cfi)
+ *	\brief	dumps call frame information statistics, in machine interface format
+ *
+ *	\param	cfi	the call frame information data, as returned
+ *			by dwarf_frame_init(); may be null
+ *	\return	none */
+void dwarf_frame_dump_stats_mi(struct dwarf_frame_data * cfi)
+{
+	if (!cfi)
+	{
+		miprintf("CFI = [],");
+		return;
+	}
+	miprintf("CFI = [DEBUG_FRAME_CIES = %i, EH_FRAME_CIES = %i, NR_FDES = %i, "
+			"EH_FRAME_HDR_FDES = %i, ROWS_COMPUTED = %i,],",
+			cfi->debug_frame.nr_cies, cfi->eh_frame.nr_cies, cfi->nr_fdes,
+			cfi->eh_frame_hdr.nr_entries, cfi->nr_rows_computed);
+}
+
+/*!
+ *	\fn	struct dwarf_frame_data * dwarf_frame_init(struct gear_engine_context * ctx)
+ *	\brief	reads the call frame information of the executable being debugged
+ *
+ *	\param	ctx	context to work in
+ *	\return	the call frame information data, to be passed to the
+ *		other routines in this module; null, if the executable
+ *		is not accessible */
+struct dwarf_frame_data * dwarf_frame_init(struct gear_engine_context * ctx)
+{
+struct dwarf_frame_data * cfi;
+GElf_Ehdr ehdr;
+GElf_Shdr shdr;
+Elf_Scn * scn;
+const unsigned char * img;
+size_t img_size;
+const char * name;
+struct cfi_section * sect;
+
+	if (!ctx->libelf_elf_desc)
+		return 0;
+	if (!gelf_getehdr(ctx->libelf_elf_desc, &ehdr))
+		panic("");
+	if (!(img = (const unsigned char *) elf_rawfile(ctx->libelf_elf_desc, &img_size)))
+		panic("");
+	if (!(cfi = calloc(1, sizeof * cfi)))
+		panic("out of core");
+	cfi->is_big_endian = (ehdr.e_ident[EI_DATA] == ELFDATA2MSB);
+	cfi->address_size = (ehdr.e_ident[EI_CLASS] == ELFCLASS64) ? 8 : 4;
+	cfi->eh_frame.is_eh_frame = true;
+
+	for (scn = 0; (scn = elf_nextscn(ctx->libelf_elf_desc, scn)); )
+	{
+		if (!gelf_getshdr(scn, &shdr))
+			panic("");
+		if (!(name = elf_strptr(ctx->libelf_elf_desc, ehdr.e_shstrndx, shdr.sh_name)))
+			continue;
+		if (!strcmp(name, ".text"))
+		{
+			cfi->text_addr = shdr.sh_addr;
+			continue;
+		}
+		if (!strcmp(name, ".got"))
+		{
+			cfi->got_addr = shdr.sh_addr;
+			continue;
+		}
+		if (!strcmp(name, ".debug_frame"))
+			sect = &cfi->debug_frame;
+		else if (!strcmp(name, ".eh_frame"))
+			sect = &cfi->eh_frame;
+		else if (!strcmp(name, ".eh_frame_hdr"))
+			sect = &cfi->eh_frame_hdr.sect;
+		else
+			continue;
+		if (shdr.sh_type == SHT_NOBITS || !shdr.sh_size
+				|| shdr.sh_offset + shdr.sh_size > img_size)
+			continue;
+		sect->buf = img + shdr.sh_offset;
+		sect->size = shdr.sh_size;
+		sect->addr = shdr.sh_addr;
+	}
+
+	init_eh_frame_hdr(cfi);
+	scan_section(cfi, &cfi->debug_frame, true);
+	/* the .eh_frame fdes need not be decoded
+	 * if they can be located by .eh_frame_hdr */
+	scan_section(cfi, &cfi->eh_frame, !cfi->eh_frame_hdr.nr_entries);
+	qsort(cfi->fdes, cfi->nr_fdes, sizeof * cfi->fdes, fde_compare);
+	gprintf("call frame information: %i fdes decoded, %i fdes in .eh_frame_hdr\n",
+			cfi->nr_fdes, cfi->eh_frame_hdr.nr_entries);
+	return cfi;
+}
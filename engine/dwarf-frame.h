@@ -0,0 +1,105 @@
+/*!
+ * \file	dwarf-frame.h
+ * \brief	call frame information parser header
+ * \author	shopov
+ *
+ *
+ * Revision summary:
+ *
+ * $Log: $
+ */
+
+#ifndef __DWARF_FRAME_H__
+#define __DWARF_FRAME_H__
+
+/*
+ *
+ * exported definitions follow
+ *
+ */
+
+enum
+{
+	/*! the number of register columns tracked in a call frame information table row
+	 *
+	 * the rules for registers with higher dwarf register
+	 * numbers (e.g. floating point registers) are ignored;
+	 * this must not be less than the number of target core registers */
+	DWARF_FRAME_MAX_NR_REGS		= 32,
+};
+
+/*
+ *
+ * exported data types follow
+ *
+ */
+
+/*! register unwinding rules, as defined in the dwarf 3 standard document, paragraph 6.4.1 */
+enum DWARF_FRAME_RULE_ENUM
+{
+	/*! the register has no recoverable value in the previous frame */
+	DWARF_FRAME_RULE_UNDEFINED = 0,
+	/*! the register has the same value in the previous frame */
+	DWARF_FRAME_RULE_SAME_VALUE,
+	/*! the register is saved at address cfa + offset */
+	DWARF_FRAME_RULE_OFFSET,
+	/*! the register value is cfa + offset */
+	DWARF_FRAME_RULE_VAL_OFFSET,
+	/*! the register value is the value of register reg_nr, plus offset
+	 *
+	 * offset is always zero, except for the cfa rule */
+	DWARF_FRAME_RULE_REGISTER,
+	/*! the register is saved at the address computed by a dwarf expression */
+	DWARF_FRAME_RULE_EXPRESSION,
+	/*! the register value is computed by a dwarf expression */
+	DWARF_FRAME_RULE_VAL_EXPRESSION,
+};
+
+/*! a single register unwinding rule */
+struct dwarf_frame_rule
+{
+	/*! the rule type */
+	enum DWARF_FRAME_RULE_ENUM	type;
+	/*! the dwarf register number, for DWARF_FRAME_RULE_REGISTER rules */
+	int		reg_nr;
+	/*! the (already data alignment factored) offset, for DWARF_FRAME_RULE_OFFSET, DWARF_FRAME_RULE_VAL_OFFSET and DWARF_FRAME_RULE_REGISTER rules */
+	long long	offset;
+	/*! the dwarf expression, for DWARF_FRAME_RULE_EXPRESSION and DWARF_FRAME_RULE_VAL_EXPRESSION rules */
+	const unsigned char	* expr;
+	/*! the number of bytes in the dwarf expression above */
+	int		expr_len;
+};
+
+/*! a call frame information table row - the rules for unwinding a frame at a given address */
+struct dwarf_frame_row
+{
+	/*! the rule for computing the canonical frame address
+	 *
+	 * this is either a DWARF_FRAME_RULE_REGISTER rule (the
+	 * cfa is a register value plus an offset), or a
+	 * DWARF_FRAME_RULE_VAL_EXPRESSION rule; it is
+	 * DWARF_FRAME_RULE_UNDEFINED if the call frame information
+	 * does not define the cfa at the address */
+	struct dwarf_frame_rule	cfa_rule;
+	/*! the register rules, indexed by dwarf register number
+	 *
+	 * registers for which the call frame information does
+	 * not define a rule have the DWARF_FRAME_RULE_SAME_VALUE rule */
+	struct dwarf_frame_rule	rules[DWARF_FRAME_MAX_NR_REGS];
+	/*! the dwarf register number of the column holding the return address */
+	int		ret_addr_column;
+	/*! nonzero, if the frame is a signal handler frame (cie augmentation 'S') */
+	bool		is_signal_frame;
+};
+
+/*
+ *
+ * exported function prototypes follow
+ *
+ */
+
+struct dwarf_frame_data * dwarf_frame_init(struct gear_engine_context * ctx);
+bool dwarf_frame_get_row(struct dwarf_frame_data * cfi, ARM_CORE_WORD pc, struct dwarf_frame_row * row);
+void dwarf_frame_dump_stats_mi(struct dwarf_frame_data * cfi);
+
+#endif /* __DWARF_FRAME_H__ */
@@ -3,6 +3,36 @@
  *	\brief	provides support for handling the dwarf global symbols section, .debug_pubnames
  *	\author	shopov
  *
+ *	this module maintains an index mapping global identifier names
+ *	to the compilation units that define them, without needing
+ *	to build any compilation unit trees; the index is used when
+ *	compilation unit trees are built on demand (see cu_process()
+ *	in cu-access.c) - when an identifier is not found in the
+ *	engine symbol table, the index tells which compilation
+ *	unit(s) must be built for the identifier to get in the symbol
+ *	table; if the index does not know about an identifier, no
+ *	compilation unit tree is built at all
+ *
+ *	the index is gathered from these sources:
+ *	- the .debug_pubnames section (global data objects and
+ *	functions)
+ *	- the .debug_pubtypes section (global types)
+ *	- the elf symbol table of the executable (data objects and
+ *	functions, including ones with internal linkage, which are
+ *	not recorded in .debug_pubnames); the compilation unit owning
+ *	an elf symbol is determined by the symbol address, via the
+ *	compilation unit address range table (see aranges-access.c)
+ *
+ *	none of these sources is mandatory; gcc, for example, by
+ *	default does not generate the .debug_pubnames and .debug_pubtypes
+ *	sections, in which case only the elf symbol table is used
+ *
+ *	\note	identifiers in none of the sources above (most notably
+ *		enumeration constants, and, when there is no
+ *		.debug_pubtypes section, type names) are only found in
+ *		the symbol table after the compilation unit defining them
+ *		has been built for some other reason
+ *
  *	Revision summary:
  *
  *	$Log: $
@@ -16,11 +46,18 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "dwarf-common.h"
+#include "target-defs.h"
 #include "gear-engine-context.h"
 
 #include "dwarf-pubnames.h"
+#include "aranges-access.h"
+#include "cu-access.h"
+#include "cu-hash.h"
+#include "gprintf.h"
 #include "util.h"
 
 /*
@@ -29,45 +66,190 @@
  *
  */
 
-/*! a data structure used for describing a global symbol (one residing in .debug_pubtypes) 
- *
- *	\todo	some of the members here may be redundand; revise this
- *		and fix this comment when this has been in active use
- *		for some time */
-struct dwarf_glob_sym_struct
+/*! the global identifier name index */
+struct dwarf_name_index
 {
-	/*! name of the symbol */
-	char		* name;
-	/*! offset in .debug_info of the die for the symbol */
-	Dwarf_Off	die_offset;
-	/*! offset in .debug_info of the compilation unit containing the symbol */
-	Dwarf_Off	cu_offset;
+	/*! the number of valid elements in the entries array below */
+	int	nr_entries;
+	/*! the number of allocated elements in the entries array below */
+	int	tab_size;
+	/*! the index entries; sorted by name, and then by compilation unit die offset, with duplicates removed */
+	struct dwarf_name_index_entry
+	{
+		/*! the identifier name; the string is owned by libdwarf or libelf */
+		const char	* name;
+		/*! offset in .debug_info of the die for the compilation unit defining the identifier */
+		Dwarf_Off	cu_die_offset;
+	}
+	* entries;
 };
 
+/*! the initial number of entries allocated in the name index; the table doubles when full */
+#define NAME_INDEX_INITIAL_SIZE		1024
+
 /*
  *
- * local data follows
+ * local functions follow
  *
+ */ 
+
+/*!
+ *	\fn	static void add_entry(struct dwarf_name_index * p, const char * name, Dwarf_Off cu_die_offset)
+ *	\brief	appends an entry to the name index
+ *
+ *	\param	p	the name index to append to
+ *	\param	name	the identifier name
+ *	\param	cu_die_offset	the die offset of the compilation unit defining the identifier
+ *	\return	none
+ */
+static void add_entry(struct dwarf_name_index * p, const char * name, Dwarf_Off cu_die_offset)
+{
+	if (!name || !* name)
+		return;
+	if (p->nr_entries == p->tab_size)
+	{
+		p->tab_size = p->tab_size ? p->tab_size << 1 : NAME_INDEX_INITIAL_SIZE;
+		if (!(p->entries = realloc(p->entries, p->tab_size * sizeof * p->entries)))
+			panic("out of core");
+	}
+	p->entries[p->nr_entries].name = name;
+	p->entries[p->nr_entries].cu_die_offset = cu_die_offset;
+	p->nr_entries++;
+}
+
+/*!
+ *	\fn	static int entry_compare(const void * a, const void * b)
+ *	\brief	name index entry comparison function, for qsort()
  */
+static int entry_compare(const void * a, const void * b)
+{
+const struct dwarf_name_index_entry * x = a, * y = b;
+int res;
 
-/*! a pointer to an array of Dwarf_Global data structures describing the debuggees global symbols */
-static Dwarf_Global * dwarf_globsyms;
-/*! number of elements in the dwarf_globsyms array above */
-static Dwarf_Signed globsyms_cnt;
+	if ((res = strcmp(x->name, y->name)))
+		return res;
+	if (x->cu_die_offset != y->cu_die_offset)
+		return (x->cu_die_offset < y->cu_die_offset) ? -1 : 1;
+	return 0;
+}
 
-/*! a pointer to an array of dwarf_glob_sym_struct structures
+/*!
+ *	\fn	static void add_pubnames(struct gear_engine_context * ctx, struct dwarf_name_index * p)
+ *	\brief	adds the entries of the .debug_pubnames and .debug_pubtypes sections, if present, to the name index
  *
- * this is used to cache the data of interest for the global symbols;
- * the entries in this array correspond to the entries in the
- * dwarf_globsyms array; the number of elements in this array
- * is, likewise, given by the value of ::globsyms_cnt */ 
-static struct dwarf_glob_sym_struct * globsyms;
+ *	\param	ctx	context used to access the debuggee debug information
+ *	\param	p	the name index to add to
+ *	\return	none
+ */
+static void add_pubnames(struct gear_engine_context * ctx, struct dwarf_name_index * p)
+{
+Dwarf_Error err;
+Dwarf_Global * globals;
+Dwarf_Type * types;
+Dwarf_Signed i, cnt;
+Dwarf_Off die_offset, cu_die_offset;
+char * name;
+int res;
 
-/*
+	res = dwarf_get_globals(ctx->dbg, &globals, &cnt, &err);
+	if (res == DW_DLV_ERROR)
+		panic("dwarf_get_globals()");
+	if (res == DW_DLV_OK)
+		for (i = 0; i < cnt; i++)
+		{
+			if (dwarf_global_name_offsets(globals[i], &name, &die_offset,
+						&cu_die_offset, &err) != DW_DLV_OK)
+				panic("dwarf_global_name_offsets()");
+			add_entry(p, name, cu_die_offset);
+		}
+	res = dwarf_get_pubtypes(ctx->dbg, &types, &cnt, &err);
+	if (res == DW_DLV_ERROR)
+		panic("dwarf_get_pubtypes()");
+	if (res == DW_DLV_OK)
+		for (i = 0; i < cnt; i++)
+		{
+			if (dwarf_pubtype_name_offsets(types[i], &name, &die_offset,
+						&cu_die_offset, &err) != DW_DLV_OK)
+				panic("dwarf_pubtype_name_offsets()");
+			add_entry(p, name, cu_die_offset);
+		}
+}
+
+/*!
+ *	\fn	static void add_elf_symbols(struct gear_engine_context * ctx, struct dwarf_name_index * p)
+ *	\brief	adds the data object and function symbols from the elf symbol table, if present, to the name index
  *
- * local functions follow
+ *	\param	ctx	context used to access the debuggee executable
+ *	\param	p	the name index to add to
+ *	\return	none
+ */
+static void add_elf_symbols(struct gear_engine_context * ctx, struct dwarf_name_index * p)
+{
+Elf_Scn * scn;
+GElf_Shdr shdr;
+GElf_Sym sym;
+Elf_Data * data;
+Dwarf_Off cu_die_offset;
+ARM_CORE_WORD addr;
+int i, nr_syms;
+
+	if (!ctx->libelf_elf_desc)
+		return;
+	for (scn = 0; (scn = elf_nextscn(ctx->libelf_elf_desc, scn)); )
+	{
+		if (!gelf_getshdr(scn, &shdr))
+			panic("");
+		if (shdr.sh_type == SHT_SYMTAB)
+			break;
+	}
+	if (!scn || !shdr.sh_entsize || !(data = elf_getdata(scn, 0)))
+		return;
+	nr_syms = shdr.sh_size / shdr.sh_entsize;
+	for (i = 0; i < nr_syms; i++)
+	{
+		if (!gelf_getsym(data, i, &sym) || sym.st_shndx == SHN_UNDEF)
+			continue;
+		if (GELF_ST_TYPE(sym.st_info) != STT_OBJECT
+				&& GELF_ST_TYPE(sym.st_info) != STT_FUNC)
+			continue;
+		addr = sym.st_value;
+		if (GELF_ST_TYPE(sym.st_info) == STT_FUNC)
+			/* discard the thumb bit */
+			addr &= ~1;
+		if (!aranges_get_cu_die_offset_for_addr(ctx, addr, &cu_die_offset))
+			continue;
+		add_entry(p, elf_strptr(ctx->libelf_elf_desc, shdr.sh_link, sym.st_name), cu_die_offset);
+	}
+}
+
+/*!
+ *	\fn	static struct dwarf_name_index * get_name_index(struct gear_engine_context * ctx)
+ *	\brief	retrieves the global identifier name index, building it first, if necessary
  *
- */ 
+ *	\param	ctx	context to work in
+ *	\return	the global identifier name index
+ */
+static struct dwarf_name_index * get_name_index(struct gear_engine_context * ctx)
+{
+struct dwarf_name_index * p;
+int i, j;
+
+	if (ctx->name_index)
+		return ctx->name_index;
+	if (!(p = calloc(1, sizeof * p)))
+		panic("out of core");
+	add_pubnames(ctx, p);
+	add_elf_symbols(ctx, p);
+	qsort(p->entries, p->nr_entries, sizeof * p->entries, entry_compare);
+	/* remove duplicates (e.g. functions found both in
+	 * .debug_pubnames and in the elf symbol table) */
+	for (i = j = 0; i < p->nr_entries; i++)
+		if (!j || entry_compare(p->entries + j - 1, p->entries + i))
+			p->entries[j++] = p->entries[i];
+	p->nr_entries = j;
+	gprintf("%i global identifier name index entries built\n", j);
+	return ctx->name_index = p;
+}
 
 /*
  *  
@@ -77,76 +259,63 @@ static struct dwarf_glob_sym_struct * globsyms;
 
 
 /*!
- *	\fn	int dwarf_pubnames_scan(char * name, Dwarf_Off * die_offset, Dwarf_Off * cu_offset)
- *	\brief	scans the global symbol list for a given symbol
- *
- *	\todo	it may be more useful to actually return here a
- *		pointer to the debug information tree node for
- *		the global symbol
- *	\todo	define error codes here
- *
- *	\param	name	the name of the symbol to be searched for
- *	\param	die_offset	a pointer to a Dwarf_Off where to
- *			store the die offset of the symbol (if found);
- *			can be null
- *
- *	\param	cu_offset	a pointer to a Dwarf_Off where to
- *			store the compilation unint offset for the symbol
- *			(if found); can be null
- *	\return	zero, if the symbol is found and the offset fields
- *		were set properly; non-zero, if some error occurred
+ *	\fn	int dwarf_pubnames_build_cus_for_name(struct gear_engine_context * ctx, const char * name)
+ *	\brief	builds the trees of all compilation units known to define a given global identifier
+ *
+ *	this is used when compilation unit trees are built on
+ *	demand, and an identifier lookup in the engine symbol table
+ *	fails - the compilation units defining the identifier (if
+ *	any are known) are then built, which puts the identifier in
+ *	the symbol table, and the lookup can be retried; if the
+ *	identifier is unknown (e.g. because of a typo), nothing
+ *	is built
+ *
+ *	\param	ctx	context to work in
+ *	\param	name	the name of the identifier of interest
+ *	\return	the number of compilation unit trees built
  */
-int dwarf_pubnames_scan(char * name, Dwarf_Off * die_offset, Dwarf_Off * cu_offset)
+int dwarf_pubnames_build_cus_for_name(struct gear_engine_context * ctx, const char * name)
 {
-int i;	
+struct dwarf_name_index * p;
+int lo, hi, mid, nr_built;
+
 	if (!name)
 		panic("");
-	for (i = 0; i < globsyms_cnt; i++)
-		if (!strcmp(globsyms[i].name, name))
-		{
-			if (die_offset)
-				*die_offset = globsyms[i].die_offset;
-			if (cu_offset)
-				*cu_offset = globsyms[i].cu_offset;
-			return 0;
-		}
-	return 1;
+	p = get_name_index(ctx);
+	/* find the first entry for name */
+	lo = 0;
+	hi = p->nr_entries;
+	while (lo < hi)
+	{
+		mid = lo + ((hi - lo) >> 1);
+		if (strcmp(p->entries[mid].name, name) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	nr_built = ctx->cus ? ctx->cus->nr_entries : 0;
+	for (; lo < p->nr_entries && !strcmp(p->entries[lo].name, name); lo++)
+		cu_process(ctx, p->entries[lo].cu_die_offset);
+	return (ctx->cus ? ctx->cus->nr_entries : 0) - nr_built;
 }
 
 /*!
- *	\fn	void init_dwarf_pubnames(struct gear_engine_context * ctx)
- *	\brief	loads the global symbols for a program (reads section .debug_pubnames)
+ *	\fn	void dwarf_pubnames_discard(struct gear_engine_context * ctx)
+ *	\brief	deallocates the global identifier name index, if it has been built
  *
- *	\param	ctx	context used to access the debuggee debug information
+ *	\note	the names in the index are owned by libdwarf and
+ *		libelf, so this must be called before the libdwarf
+ *		and libelf descriptors are closed
+ *
+ *	\param	ctx	context to work in
  *	\return	none
  */
-void init_dwarf_pubnames(struct gear_engine_context * ctx)
+void dwarf_pubnames_discard(struct gear_engine_context * ctx)
 {
-Dwarf_Error err;
-int res, i;
-
-	gprintf("loading global symbols...\n");
-
-	globsyms = 0;
-	res = dwarf_get_globals(ctx->dbg, &dwarf_globsyms, &globsyms_cnt, &err);
-	if (res == DW_DLV_ERROR)
-		panic("dwarf_get_globals()"); 
-	else if (res == DW_DLV_NO_ENTRY)
-		/* .debug_pubnames section non-present */
+	if (!ctx->name_index)
 		return;
-	if (!(globsyms = (struct dwarf_glob_sym_struct *)
-				malloc(globsyms_cnt * sizeof(*globsyms))))
-		panic("out of core");
-	for (i = 0; i < globsyms_cnt; i++)
-	{
-		res = dwarf_global_name_offsets(
-				dwarf_globsyms[i],
-				&globsyms[i].name,
-				&globsyms[i].die_offset,
-				&globsyms[i].cu_offset,
-				&err);
-		if (res == DW_DLV_ERROR)
-			panic("dwarf_global_name_offsets()");
-	}
+	free(ctx->name_index->entries);
+	free(ctx->name_index);
+	ctx->name_index = 0;
 }
 
@@ -14,6 +14,6 @@
  *
  */
 
-void init_dwarf_pubnames(struct gear_engine_context * ctx);
-int dwarf_pubnames_scan(char * name, Dwarf_Off * die_offset, Dwarf_Off * cu_offset);
+int dwarf_pubnames_build_cus_for_name(struct gear_engine_context * ctx, const char * name);
+void dwarf_pubnames_discard(struct gear_engine_context * ctx);
 
@@ -48,9 +48,14 @@ int gprintf(const char * format, ...);
 #include "breakpoint.h"
 #include "dbx-support.h"
 #include "target-comm.h"
+#include "target-comm-frame.h"
 #include "target-img-load.h"
 #include "frame-reg-cache.h"
 #include "target-dump-cstring.h"
+#include "index-cache.h"
+#include "node-alloc.h"
+#include "mem-cache.h"
+#include "image-mem.h"
 
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 
@@ -109,6 +114,7 @@ int target_comm_get_core_access(struct core_control * cc);
 void init_target_comm(struct gear_engine_context * ctx);
 
 void dwarf_hacked_init(struct gear_engine_context * ctx);
+void report_init_phase_time(const char * phase_name, struct timeval * phase_start);
 
 #ifdef TARGET_i386
 void init_i386_target_desc(struct gear_engine_context * ctx);
@@ -148,14 +154,52 @@ static void process_cmdline(struct gear_engine_context * ctx, int argc, char **
 static const int GEAR_ENGINE_SERVER_SOCKET_PORT_NR = 0x1234;
 /*! \todo	move this to some parameter file */
 static const int TARGET_CORE_CONTROLLER_SERVER_SOCKET_PORT_NR = 0x1111;
+/*! \todo	move this to some parameter file */
+static const int DEFAULT_TARGET_XFER_WINDOW = 8;
+/*! the maximum target memory transfer window allowed
+ *
+ * this is kept small enough, so that the replies to all of the
+ * outstanding memory read requests fit in the operating system
+ * socket buffers */
+static const int MAX_TARGET_XFER_WINDOW = 16;
+/*! the size of the default target memory window retrieved when the target halts - the top of the target stack */
+static const int DEFAULT_HALT_SNAPSHOT_STACK_WINDOW_SIZE = 0x400;
+/*! the maximum size of a target memory window retrieved when the target halts
+ *
+ * this is kept small enough, so that all of the windows fit
+ * in a single binary frame (see target-comm-frame.h) */
+static const int MAX_HALT_SNAPSHOT_WINDOW_SIZE = 0x2000;
+/*! the default minimum number of bytes of the target stack prefetched when the target halts */
+static const int DEFAULT_STACK_PREFETCH_SIZE = 0x400;
+/*! the maximum number of bytes of the target stack prefetched when the target halts */
+static const int MAX_STACK_PREFETCH_SIZE = 0x10000;
+/*! the default number of target call stack frames that the target stack prefetch is sized to cover */
+static const int DEFAULT_STACK_PREFETCH_NR_FRAMES = 8;
+/*! the maximum number of target call stack frames that the target stack prefetch may be sized to cover */
+static const int MAX_STACK_PREFETCH_NR_FRAMES = 64;
+/*! the default maximum number of target call stack frames unwound */
+static const int DEFAULT_FRAME_UNWIND_LIMIT = 0x800;
 int i;
 bool is_exec_specified;
+bool is_halt_snapshot_window_specified;
 
 	/* initialize default settings values */
 	ctx->settings.server_port_nr = GEAR_ENGINE_SERVER_SOCKET_PORT_NR;
 	ctx->settings.target_ctl_port_nr = TARGET_CORE_CONTROLLER_SERVER_SOCKET_PORT_NR;
+	ctx->settings.target_xfer_window = DEFAULT_TARGET_XFER_WINDOW;
+	ctx->settings.is_mem_cache_enabled = true;
+	ctx->settings.is_image_mem_enabled = true;
+	ctx->settings.is_image_mem_verify_enabled = true;
+	ctx->settings.nr_halt_snapshot_windows = 1;
+	ctx->settings.halt_snapshot_windows[0].base_reg_nr = HALT_SNAPSHOT_WINDOW_SP;
+	ctx->settings.halt_snapshot_windows[0].offset = 0;
+	ctx->settings.halt_snapshot_windows[0].nbytes = DEFAULT_HALT_SNAPSHOT_STACK_WINDOW_SIZE;
+	ctx->settings.stack_prefetch_size = DEFAULT_STACK_PREFETCH_SIZE;
+	ctx->settings.stack_prefetch_nr_frames = DEFAULT_STACK_PREFETCH_NR_FRAMES;
+	ctx->settings.frame_unwind_limit = DEFAULT_FRAME_UNWIND_LIMIT;
 
 	is_exec_specified = false;
+	is_halt_snapshot_window_specified = false;
 
 	for (i = 1; i < argc; i++)
 	{
@@ -167,7 +211,7 @@ bool is_exec_specified;
 				gprintf(
 "gear, a c-language debug engine\n"
 "\n"
-"usage: %s [--server-port port_number] [--target-port port_number] executable-file\n"
+"usage: %s [--server-port port_number] [--target-port port_number] [--lazy-cus] [--dedup-types] [--binary-target-protocol] [--target-xfer-window nr_requests] [--target-compression rle|lz|none] [--no-mem-cache] [--no-image-mem] [--trust-image-mem] [--halt-snapshot-window base,offset,nbytes] [--no-halt-snapshot-windows] [--stack-prefetch-size nbytes] [--stack-prefetch-frames nr_frames] [--frame-unwind-limit nr_frames] executable-file\n"
 "\n"
 "executable-file is an executable file to debug\n"
 "	only executables in elf file format are supported, only dwarf debug\n"
@@ -185,6 +229,103 @@ bool is_exec_specified;
 "	specifies socket port number of the target core controller to which\n"
 "	to attempt connection for the purposes of debugging the specified\n"
 "	executable; if not specified, defaults to 0x1111 (decimal 4369)\n"
+"\n"
+"--lazy-cus\n"
+"	do not build the debug information trees of all compilation units\n"
+"	at startup - build them on demand instead, as they are needed; this\n"
+"	speeds up startup and saves memory for large executables; global\n"
+"	identifiers are located via .debug_pubnames, .debug_pubtypes and\n"
+"	the elf symbol table, so that only the compilation units defining\n"
+"	them get built\n"
+"\n"
+"--dedup-types\n"
+"	merge structurally identical data types described in different\n"
+"	compilation units into a single data type node; this saves memory\n"
+"	for executables built from many compilation units including\n"
+"	the same header files\n"
+"\n"
+"--binary-target-protocol\n"
+"	attempt to switch to the binary framed protocol when talking\n"
+"	to the target core controller; this speeds up target memory\n"
+"	and register accesses; the target core controller must understand\n"
+"	the 'SET_PROTOCOL' request - if it replies with an error, or\n"
+"	supports none of the protocol versions known to the gear engine,\n"
+"	the ascii protocol remains in effect, but any other reply (e.g.\n"
+"	from a target core controller that does not know the request at\n"
+"	all) is a fatal error; do not use this option with such target\n"
+"	core controllers\n"
+"\n"
+"--target-xfer-window nr_requests\n"
+"	specifies the maximum number of target memory transfer requests\n"
+"	to send to the target core controller without waiting for\n"
+"	replies; only applicable with '--binary-target-protocol'; a value\n"
+"	of 1 disables request pipelining; if not specified, defaults to 8,\n"
+"	the maximum value is 16\n"
+"\n"
+"--target-compression rle|lz|none\n"
+"	transfer target memory contents compressed, if the target core\n"
+"	controller supports it; 'rle' selects run length encoding, which\n"
+"	is cheap, and catches zero filled or padded memory areas, 'lz'\n"
+"	selects lempel-ziv encoding, which also catches repeating patterns;\n"
+"	this is worthwhile on slow target connections (e.g. serial lines,\n"
+"	jtag bridges); only applicable with '--binary-target-protocol'; if\n"
+"	not specified, defaults to 'none'\n"
+"\n"
+"--no-mem-cache\n"
+"	do not cache target memory contents in the gear engine; by default,\n"
+"	target memory read while the target is halted is cached until\n"
+"	the target is run again, and target memory in the read-only\n"
+"	sections of the executable (e.g. code) is cached until the\n"
+"	target dies\n"
+"\n"
+"--no-image-mem\n"
+"	always read target memory from the target; by default, target\n"
+"	memory in the non-writable program segments of the executable\n"
+"	(e.g. code) is read from the executable file instead, provided\n"
+"	that the segment contents in the target have been verified to\n"
+"	match the ones in the executable\n"
+"\n"
+"--trust-image-mem\n"
+"	do not verify the program segments of the executable against\n"
+"	target memory - assume that the target runs the executable\n"
+"	specified; this saves reading the segments from the target once\n"
+"	each time the target is connected to\n"
+"\n"
+"--halt-snapshot-window base,offset,nbytes\n"
+"	specifies a target memory window to retrieve, along with the target\n"
+"	core registers, whenever the target halts; base is either a target\n"
+"	core register number, 'sp' for the target stack pointer, or 'abs'\n"
+"	for an absolute window address; the window starts at offset bytes\n"
+"	from the base register value (or at address offset, if base is\n"
+"	'abs'), and is nbytes bytes long (at most 8192); may be specified\n"
+"	up to 4 times; if not specified, a single window of 1024 bytes at\n"
+"	the top of the target stack is retrieved; the windows are only\n"
+"	retrieved when target memory is cached (see '--no-mem-cache'), and\n"
+"	the binary target protocol is in effect - all of these are then\n"
+"	retrieved in a single request\n"
+"\n"
+"--no-halt-snapshot-windows\n"
+"	only retrieve the target core registers when the target halts;\n"
+"	do not retrieve any target memory windows\n"
+"\n"
+"--stack-prefetch-size nbytes\n"
+"	specifies the minimum number of bytes of the target stack that are\n"
+"	fetched in a single transfer whenever the target halts, so that the\n"
+"	target call stack can be unwound without accessing the target for\n"
+"	every saved register (at most 65536, default 1024); the number\n"
+"	of bytes fetched is increased to cover the number of frames given\n"
+"	by --stack-prefetch-frames; zero disables the stack prefetching\n"
+"\n"
+"--stack-prefetch-frames nr_frames\n"
+"	specifies the number of target call stack frames that the stack\n"
+"	prefetching described above is sized to cover (at most 64,\n"
+"	default 8)\n"
+"\n"
+"--frame-unwind-limit nr_frames\n"
+"	specifies the maximum number of target call stack frames that are\n"
+"	unwound (at least 1, default 2048); this is a hard cap - requests\n"
+"	to move past this many frames up the target call stack fail, even\n"
+"	if the unwind information would allow unwinding more frames\n"
 "",
 argv[0]
 );
@@ -224,6 +365,161 @@ argv[0]
 				}
 				ctx->settings.target_ctl_port_nr = p;
 			}
+			else if (!strcmp(argv[i] + 2, "lazy-cus"))
+				ctx->settings.is_lazy_cu_build_enabled = true;
+			else if (!strcmp(argv[i] + 2, "dedup-types"))
+				ctx->settings.is_type_dedup_enabled = true;
+			else if (!strcmp(argv[i] + 2, "binary-target-protocol"))
+				ctx->settings.is_binary_target_protocol_enabled = true;
+			else if (!strcmp(argv[i] + 2, "target-xfer-window"))
+			{
+				char * endptr;
+				long p;
+				if (i + 1 == argc)
+				{
+					gprintf("bad option\n");
+					exit(1);
+				}
+				p = strtoul(argv[++i], &endptr, 0);
+				if (*endptr || !p || p > MAX_TARGET_XFER_WINDOW)
+				{
+					gprintf("bad option\n");
+					exit(1);
+				}
+				ctx->settings.target_xfer_window = p;
+			}
+			else if (!strcmp(argv[i] + 2, "target-compression"))
+			{
+				if (i + 1 == argc)
+				{
+					gprintf("bad option\n");
+					exit(1);
+				}
+				i++;
+				if (!strcmp(argv[i], "rle"))
+					ctx->settings.target_payload_encodings = 1 << TARGET_COMM_ENCODING_RLE;
+				else if (!strcmp(argv[i], "lz"))
+					ctx->settings.target_payload_encodings = 1 << TARGET_COMM_ENCODING_LZ;
+				else if (!strcmp(argv[i], "none"))
+					ctx->settings.target_payload_encodings = 0;
+				else
+				{
+					gprintf("bad option\n");
+					exit(1);
+				}
+			}
+			else if (!strcmp(argv[i] + 2, "no-mem-cache"))
+				ctx->settings.is_mem_cache_enabled = false;
+			else if (!strcmp(argv[i] + 2, "no-image-mem"))
+				ctx->settings.is_image_mem_enabled = false;
+			else if (!strcmp(argv[i] + 2, "trust-image-mem"))
+				ctx->settings.is_image_mem_verify_enabled = false;
+			else if (!strcmp(argv[i] + 2, "halt-snapshot-window"))
+			{
+				char * endptr;
+				long base;
+				unsigned long offset, nbytes;
+				if (i + 1 == argc)
+				{
+					gprintf("bad option\n");
+					exit(1);
+				}
+				i++;
+				if (!strncmp(argv[i], "sp,", 3))
+					base = HALT_SNAPSHOT_WINDOW_SP, endptr = argv[i] + 2;
+				else if (!strncmp(argv[i], "abs,", 4))
+					base = CORE_MEM_WINDOW_ABSOLUTE, endptr = argv[i] + 3;
+				else
+					base = strtoul(argv[i], &endptr, 0);
+				if (*endptr != ',' || base >= 32)
+				{
+					gprintf("bad option\n");
+					exit(1);
+				}
+				offset = strtoul(endptr + 1, &endptr, 0);
+				if (*endptr != ',')
+				{
+					gprintf("bad option\n");
+					exit(1);
+				}
+				nbytes = strtoul(endptr + 1, &endptr, 0);
+				if (*endptr || !nbytes || nbytes > MAX_HALT_SNAPSHOT_WINDOW_SIZE)
+				{
+					gprintf("bad option\n");
+					exit(1);
+				}
+				if (!is_halt_snapshot_window_specified)
+				{
+					/* discard the default window */
+					ctx->settings.nr_halt_snapshot_windows = 0;
+					is_halt_snapshot_window_specified = true;
+				}
+				if (ctx->settings.nr_halt_snapshot_windows == MAX_HALT_SNAPSHOT_WINDOWS)
+				{
+					gprintf("bad option - too many halt snapshot windows specified\n");
+					exit(1);
+				}
+				ctx->settings.halt_snapshot_windows[ctx->settings.nr_halt_snapshot_windows].base_reg_nr = base;
+				ctx->settings.halt_snapshot_windows[ctx->settings.nr_halt_snapshot_windows].offset = offset;
+				ctx->settings.halt_snapshot_windows[ctx->settings.nr_halt_snapshot_windows].nbytes = nbytes;
+				ctx->settings.nr_halt_snapshot_windows ++;
+			}
+			else if (!strcmp(argv[i] + 2, "no-halt-snapshot-windows"))
+			{
+				ctx->settings.nr_halt_snapshot_windows = 0;
+				is_halt_snapshot_window_specified = true;
+			}
+			else if (!strcmp(argv[i] + 2, "stack-prefetch-size"))
+			{
+				char * endptr;
+				unsigned long p;
+				if (i + 1 == argc)
+				{
+					gprintf("bad option\n");
+					exit(1);
+				}
+				p = strtoul(argv[++i], &endptr, 0);
+				if (*endptr || p > MAX_STACK_PREFETCH_SIZE)
+				{
+					gprintf("bad option\n");
+					exit(1);
+				}
+				ctx->settings.stack_prefetch_size = p;
+			}
+			else if (!strcmp(argv[i] + 2, "stack-prefetch-frames"))
+			{
+				char * endptr;
+				long p;
+				if (i + 1 == argc)
+				{
+					gprintf("bad option\n");
+					exit(1);
+				}
+				p = strtoul(argv[++i], &endptr, 0);
+				if (*endptr || !p || p > MAX_STACK_PREFETCH_NR_FRAMES)
+				{
+					gprintf("bad option\n");
+					exit(1);
+				}
+				ctx->settings.stack_prefetch_nr_frames = p;
+			}
+			else if (!strcmp(argv[i] + 2, "frame-unwind-limit"))
+			{
+				char * endptr;
+				long p;
+				if (i + 1 == argc)
+				{
+					gprintf("bad option\n");
+					exit(1);
+				}
+				p = strtol(argv[++i], &endptr, 0);
+				if (*endptr || p < 1)
+				{
+					gprintf("bad option\n");
+					exit(1);
+				}
+				ctx->settings.frame_unwind_limit = p;
+			}
 			else
 			{
 					gprintf("bad option; run with '--help' to get help on command line options\n");
@@ -375,6 +671,10 @@ struct core_control cc;
  * the frontend and one for the target monitor */
 fd_set read_fds, err_fds;
 int nfds;
+/* the number of file descriptors to pass to select(), minus one */
+int select_nfds;
+/* the target core controller file descriptor to monitor, -1 if none */
+int target_fd;
 /* server socket file descriptor */
 int socket_fd;
 int comm_fd;
@@ -382,6 +682,10 @@ struct sockaddr_in addr;
 int len;
 struct timeval tv;
 struct timezone tz;
+/* used for the startup timing report */
+struct timeval phase_start, init_start;
+/* nonzero if the debug information indices were restored from the index cache */
+bool is_index_cache_valid;
 
 	gprintf("!!! WARNING !!! COMPILING WITH PROFILING AND CODE COVERAGE ENABLED MAY CAUSE VERY CONFUSING AND ERRATIC BEHAVIOR !!!\n");
 	gprintf("!!! YOU HAVE BEEN WARNED !!!\n");
@@ -454,10 +758,16 @@ if (0) {
 
 
 	gprintf_switch_on(true);
+	report_init_phase_time(0, &init_start);
+	report_init_phase_time(0, &phase_start);
+	is_index_cache_valid = index_cache_load(ctx);
+	report_init_phase_time("debug information index cache read", &phase_start);
 	dwarf_hacked_init(ctx);
 	gprintf_switch_on(true);
 
+	report_init_phase_time(0, &phase_start);
 	init_aranges(ctx);
+	report_init_phase_time("compilation unit address ranges read", &phase_start);
 
 	gprintf("initialization complete\n");
 	gprintf("dtype_data usage counts:\n");
@@ -476,9 +786,20 @@ if (0) {
 	gprintf("nr_lexblocks == %i\n", type_access_stats.nr_lexblocks);
 	gprintf("nr_subprogram_prototype_nodes == %i\n", type_access_stats.nr_subprogram_prototype_nodes);
 	gprintf("nr_symtab_nodes == %i\n", type_access_stats.nr_symtab_nodes);
+	node_alloc_dump_stats(ctx);
+	dtype_access_dump_hash_stats(ctx);
 
 	init_frame_reg_cache(ctx);
+	report_init_phase_time("frame unwind information read", &phase_start);
 	target_hacks_init(ctx);
+	/* this must come before the memory cache is installed,
+	 * see the comments in image-mem.c */
+	if (ctx->settings.is_image_mem_enabled)
+		init_image_mem(ctx);
+	/* this must come after all target state change callbacks
+	 * have been installed, see the comments in mem-cache.c */
+	if (ctx->settings.is_mem_cache_enabled)
+		init_mem_cache(ctx);
 
 
 #ifdef TARGET_ARM
@@ -488,9 +809,17 @@ if (0) {
 
 	gprintf("not loading image\n");
 	gprintf("initializing frame unwinder...\n");
+	report_init_phase_time(0, &phase_start);
 	srcfile_build_src_cu_tab(ctx);
+	report_init_phase_time("source file tables built", &phase_start);
+	if (!is_index_cache_valid)
+	{
+		index_cache_save(ctx);
+		report_init_phase_time("debug information index cache written", &phase_start);
+	}
 	
 	init_bkpt(ctx);
+	report_init_phase_time("total debug information initialization", &init_start);
 	//init_thread_ctl();
 
 	/* create frontend comm socket */
@@ -599,29 +928,32 @@ if (0) {
 					
 					&& ctx->cc->is_connected(ctx))
 			{
-			enum TARGET_CORE_STATE_ENUM unused;
-				/* time to read the target status query response */
-				/* it shouldnt really be necessary to handle errors
-				 * here, because, in case of some error, if the
-				 * target core state has changed, the appropriate
-				 * interested party should have been notified
-				 * (this could for example be the executor,
-				 * function exec_update_target_state(), or the
-				 * target-img-load.c module, etc.), and the error
-				 * should have been handled there,
-				 * which is about all that should be done in case of
-				 * an error */
-				if (ctx->cc->core_get_status(ctx, &unused)
-						!= GEAR_ERR_NO_ERROR)
-					panic("");
+				/* time to issue another target status query; the
+				 * response is not waited for here - it is processed by
+				 * target_comm_process_input() below, whenever it
+				 * arrives; if the previous query has not yet been
+				 * responded to, no new query is issued */
 				target_comm_issue_core_status_request(ctx);
 				if (gettimeofday(&tv, &tz) < 0)
 					panic("");
 			}
 
-			/* compute file descriptor masks */
+			/* report the asynchronous target memory transfers
+			 * completed since the last time here; this is done
+			 * here, so that the reports never end up in the
+			 * middle of the output for a frontend request */
+			target_comm_dispatch_completed_xfers(ctx);
+			/* compute file descriptor masks; the target core
+			 * controller connection is also monitored, if any
+			 * responses from it are expected */
 			FD_ZERO(&read_fds);
 			FD_ZERO(&err_fds);
+			select_nfds = nfds;
+			if ((target_fd = target_comm_get_input_fd(ctx)) != -1)
+			{
+				FD_SET(target_fd, &read_fds);
+				select_nfds = MAX(nfds, target_fd);
+			}
 			for (i = 0; i < MAX_FRONTEND_CONNECTIONS; i++)
 				if (frontend_comm_data[i].is_used)
 				{
@@ -636,7 +968,15 @@ if (0) {
 			}
 			timeout.tv_sec = 0;
 			timeout.tv_usec = TARGET_STATE_POLL_PERIOD_MS * 1000;
-			res = select(nfds + 1, &read_fds, 0, &err_fds, &timeout);
+			res = select(select_nfds + 1, &read_fds, 0, &err_fds, &timeout);
+			if (res > 0 && target_fd != -1 && FD_ISSET(target_fd, &read_fds))
+			{
+				/* process the target core controller responses
+				 * received, without blocking */
+				target_comm_process_input(ctx);
+				FD_CLR(target_fd, &read_fds);
+				res --;
+			}
 			if (res < 0)
 			{
 				perror("select");
@@ -678,15 +1018,12 @@ if (0) {
 								if (!--nr_open_connections)
 								{
 									/* all connections closed */
-									/* read the target core status request response
-									 * to flush the incoming target controller data
-									 * buffer */
-									{
-									enum TARGET_CORE_STATE_ENUM unused;
-									if (ctx->cc->core_get_status(ctx, &unused)
-											!= GEAR_ERR_NO_ERROR)
-										panic("");
-									}
+									/* cancel any asynchronous target memory
+									 * transfers, and read the target core status
+									 * request response to flush the incoming
+									 * target controller data buffer */
+									target_comm_cancel_xfer(ctx, -1);
+									target_comm_sync(ctx);
 								}
 								/* get out of the loop - the number of open
 								 * connections is reinspected below, if zero,
@@ -782,16 +1119,12 @@ close_connection:
 					if (!--nr_open_connections)
 					{
 						/* all connections closed */
-						/* read the target core status request response
-						 * to flush the incoming target controller data
-						 * buffer */
-						if (ctx->cc->is_connected(ctx))
-						{
-						enum TARGET_CORE_STATE_ENUM unused;
-						if (ctx->cc->core_get_status(ctx, &unused)
-								!= GEAR_ERR_NO_ERROR)
-							panic("");
-						}
+						/* cancel any asynchronous target memory
+						 * transfers, and read the target core status
+						 * request response to flush the incoming
+						 * target controller data buffer */
+						target_comm_cancel_xfer(ctx, -1);
+						target_comm_sync(ctx);
 					}
 					/* get out of the loop - the number of open
 					 * connections is reinspected below, if zero,
@@ -823,24 +1156,11 @@ close_connection:
 						/* just prior to invoking the command parser, the target
 						 * status query response must be read so that it does
 						 * not interfere with requests sent from the command
-						 * parser to the target controller */
-						/* it shouldnt really be necessary to handle errors
-						 * here, because, in case of some error, if the
-						 * target core state has changed, the appropriate
-						 * interested party should have been notified
-						 * (this could for example be the executor,
-						 * function exec_update_target_state(), or the
-						 * target-img-load.c module, etc.), and the error
-						 * should have been handled there,
-						 * which is about all that should be done in case of
-						 * an error */
-						if (ctx->cc->is_connected(ctx))
-						{
-						enum TARGET_CORE_STATE_ENUM unused;
-						if (ctx->cc->core_get_status(ctx, &unused)
-								!= GEAR_ERR_NO_ERROR)
-							panic("");
-						}
+						 * parser to the target controller; asynchronous
+						 * target memory transfers in progress are not waited
+						 * for - they proceed along with the requests sent
+						 * from the command parser */
+						target_comm_sync(ctx);
 						/* invoke the parser */
 						gprintf("frontend> \n\n%s\n", frontend_comm_data[i].cmd_buf);
 						/*! \todo	remove this; this is here to add
@@ -156,6 +156,7 @@
 #include "dwarf-loc.h"
 #include "subprogram-access.h"
 #include "breakpoint.h"
+#include "frame-reg-cache.h"
 #include "exec.h"
 
 
@@ -395,6 +396,26 @@ int srcline_nr;
 
 }
 
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM step_target_run(struct gear_engine_context * ctx)
+ *	\brief	resumes the target for stepping it
+ *
+ *	stepping the target is mostly performed by setting breakpoints
+ *	and running the target; this routine tells the frame unwinder
+ *	that the target is being stepped, so that the target call stack
+ *	frames unwound so far are kept for reuse when the target halts
+ *	again (most of them are usually not affected by stepping),
+ *	and then runs the target
+ *
+ *	\param	ctx	context to work into
+ *	\return	the result of running the target
+ */
+static enum GEAR_ENGINE_ERR_ENUM step_target_run(struct gear_engine_context * ctx)
+{
+	frame_reg_cache_keep_frames_on_resume(ctx);
+	return ctx->cc->core_run(ctx);
+}
+
 
 /*
  *
@@ -553,7 +574,7 @@ static void exec_target_halted(struct gear_engine_context * ctx)
 					 * ignore it and allow the target
 					 * to free run some more */
 					p->exec_state = EXEC_STATE_WAITING_FOR_END_OF_SINGLE_STEP_SRC;
-					if (ctx->cc->core_run(ctx) != GEAR_ERR_NO_ERROR)
+					if (step_target_run(ctx) != GEAR_ERR_NO_ERROR)
 						panic("");
 /*! \warning hack hack hack
  *
@@ -632,7 +653,7 @@ must_run_target = 1;
 					 * ignore it and allow the target
 					 * to free run some more */
 					p->exec_state = EXEC_STATE_WAITING_FOR_END_OF_STEP_OVER;
-					if (ctx->cc->core_run(ctx) != GEAR_ERR_NO_ERROR)
+					if (step_target_run(ctx) != GEAR_ERR_NO_ERROR)
 						panic("");
 /*! \warning hack hack hack
  *
@@ -697,7 +718,7 @@ must_run_target = 1;
 					 * ignore it and allow the target
 					 * to free run some more */
 					p->exec_state = EXEC_STATE_WAITING_FOR_END_OF_STEP_OVER_SRC;
-					if (ctx->cc->core_run(ctx) != GEAR_ERR_NO_ERROR)
+					if (step_target_run(ctx) != GEAR_ERR_NO_ERROR)
 						panic("");
 /*! \warning hack hack hack
  *
@@ -929,7 +950,7 @@ ARM_CORE_WORD current_pc;
 
 		p->exec_state = EXEC_STATE_WAITING_FOR_END_OF_SINGLE_STEP;
 		p->flags.is_stepping_over = 0;
-		if (ctx->cc->core_run(ctx) != GEAR_ERR_NO_ERROR)
+		if (step_target_run(ctx) != GEAR_ERR_NO_ERROR)
 			panic("");
 	}
 }
@@ -1036,7 +1057,7 @@ int insn_len;
 			p->flags.must_step_mode_be_terminated = 0;
 		}
 		p->exec_state = EXEC_STATE_WAITING_FOR_END_OF_SINGLE_STEP_SRC;
-		if (ctx->cc->core_run(ctx) != GEAR_ERR_NO_ERROR)
+		if (step_target_run(ctx) != GEAR_ERR_NO_ERROR)
 			panic("");
 	}
 	else
@@ -1084,7 +1105,7 @@ int insn_len;
 				panic("");
 
 			p->exec_state = EXEC_STATE_WAITING_FOR_END_OF_SINGLE_STEP_SRC;
-			if (ctx->cc->core_run(ctx) != GEAR_ERR_NO_ERROR)
+			if (step_target_run(ctx) != GEAR_ERR_NO_ERROR)
 				panic("");
 		}
 		else /* if returning_to_caller_with_no_debug_information */
@@ -1173,7 +1194,7 @@ ARM_CORE_WORD current_pc;
 	}
 
 	p->exec_state = EXEC_STATE_WAITING_FOR_END_OF_STEP_OVER;
-	if (ctx->cc->core_run(ctx) != GEAR_ERR_NO_ERROR)
+	if (step_target_run(ctx) != GEAR_ERR_NO_ERROR)
 		panic("");
 }
 
@@ -1257,7 +1278,7 @@ int insn_len;
 			p->flags.must_step_mode_be_terminated = 0;
 		}
 		p->exec_state = EXEC_STATE_WAITING_FOR_END_OF_STEP_OVER_SRC;
-		if (ctx->cc->core_run(ctx) != GEAR_ERR_NO_ERROR)
+		if (step_target_run(ctx) != GEAR_ERR_NO_ERROR)
 			panic("");
 	}
 	else
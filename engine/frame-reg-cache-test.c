@@ -0,0 +1,454 @@
+/*!
+ *	\file	frame-reg-cache-test.c
+ *	\brief	target call stack unwinding test
+ *	\author	shopov
+ *
+ *	this is a test program for the target call stack unwinder (see
+ *	frame-reg-cache.c); it needs no executable - the call frame
+ *	information is simulated by a table of functions (see
+ *	dwarf_frame_get_row() below), and the target is simulated by
+ *	a register file and a memory buffer holding the target stack;
+ *	run it by 'make frame-reg-cache-test-run'
+ *
+ *	the simulated functions are laid out so that the register
+ *	unwinding rules looked up for a frame determine the values
+ *	of the registers unwound for the next older frame; for each
+ *	of the test cases (see the unwind_cases array below), the
+ *	target is halted, the target call stack is unwound, and the
+ *	stack pointer and program counter values of the outermost
+ *	frame unwound are checked; exception frames are unwound by
+ *	a simulated fallback frame unwinder (see unwind_frame() below)
+ *
+ *	the exit status is zero if all checks pass, and nonzero otherwise
+ *
+ *	Revision summary:
+ *
+ *	$Log: $
+ */
+
+/*
+ *
+ * include section follows
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+
+int gprintf(const char * format, ...);
+
+#include "dwarf-common.h"
+#include "target-defs.h"
+#include "gear-engine-context.h"
+#include "target-description.h"
+#include "engine-err.h"
+#include "core-access.h"
+#include "util.h"
+#include "frame-reg-cache.h"
+#include "dwarf-frame.h"
+
+
+/*
+ *
+ * local definitions follow
+ *
+ */
+
+enum
+{
+	/*! the number of target core registers */
+	NR_TARGET_CORE_REGS	= 16,
+	/*! the stack pointer register number */
+	SP_REG_NR		= 13,
+	/*! the link register number */
+	LR_REG_NR		= 14,
+	/*! the program counter register number */
+	PC_REG_NR		= 15,
+	/*! the address of the simulated target stack */
+	STACK_ADDR		= 0x20001000,
+	/*! the number of words in the simulated target stack */
+	NR_STACK_WORDS		= 16,
+	/*! a program counter value in the innermost function; see the functions array below */
+	INNERMOST_PC		= 0x1004,
+	/*! the return address into the outermost function; see the functions array below */
+	OUTERMOST_RET_ADDR	= 0x3001,
+	/*! the EXC_RETURN value for returning to handler mode, using the main stack */
+	EXC_RETURN_HANDLER	= 0xfffffff1,
+	/*! the number of words stacked on exception entry */
+	NR_EXCEPTION_FRAME_WORDS	= 8,
+	/*! the index of the stacked program counter value in an exception frame */
+	EXCEPTION_FRAME_PC_IDX	= 6,
+};
+
+/*! a simulated function, with the call frame information for it
+ *
+ * each function saves the link register just below the canonical
+ * frame address, which is the stack pointer value on function
+ * entry, and has no other register unwinding rules */
+struct func_info
+{
+	/*! the function start address */
+	ARM_CORE_WORD	start;
+	/*! the function end address - the address past the last function instruction */
+	ARM_CORE_WORD	end;
+	/*! the offset of the canonical frame address from the stack pointer, throughout the function */
+	int		cfa_offset;
+};
+
+/*! the simulated functions covered by call frame information
+ *
+ * the innermost function, at 0x1000, always saves the return address
+ * to its caller in the second word of the simulated target stack;
+ * the caller may be either of the two adjacent functions, at 0x2000
+ * and at 0x2010, which allocate different numbers of bytes on the
+ * stack - so that the words read from the simulated target stack,
+ * when unwinding the caller, identify which function the unwinder
+ * has taken the caller to be; the innermost function may also be
+ * an exception handler, in which case the caller is the function
+ * interrupted by the exception, and there is an exception frame
+ * between the two; the outermost function, at 0x3000, has no call
+ * frame information, and the unwinding stops there */
+static const struct func_info functions[] =
+{
+	{ .start = 0x1000, .end = 0x1010, .cfa_offset = 8, },
+	{ .start = 0x2000, .end = 0x2010, .cfa_offset = 8, },
+	{ .start = 0x2010, .end = 0x2020, .cfa_offset = 16, },
+};
+
+/*! a target call stack unwinding test case */
+struct unwind_case
+{
+	/*! a description of the test case, for failure reports */
+	const char	* what;
+	/*! the return address from the innermost function */
+	ARM_CORE_WORD	ret_addr;
+	/*! the address of the instruction interrupted by an exception, if the return address is an EXC_RETURN value */
+	ARM_CORE_WORD	interrupted_pc;
+	/*! the number of the caller function in the functions array above, which the return address is expected to be taken into */
+	int		caller;
+};
+
+static const struct unwind_case unwind_cases[] =
+{
+	{ .what = "thumb return address inside the caller", .ret_addr = 0x2005, .caller = 1, },
+	{ .what = "thumb return address inside the next function", .ret_addr = 0x2015, .caller = 2, },
+	/* this happens after a call to a function that does not
+	 * return, placed at the very end of the caller */
+	{ .what = "thumb return address past the end of the caller", .ret_addr = 0x2011, .caller = 1, },
+	{ .what = "exception return inside the function interrupted", .ret_addr = EXC_RETURN_HANDLER,
+		.interrupted_pc = 0x2004, .caller = 1, },
+	/* the stacked program counter value is the address of
+	 * the instruction interrupted, and must not be taken
+	 * for a return address past the end of a caller */
+	{ .what = "exception return to the start of the function interrupted", .ret_addr = EXC_RETURN_HANDLER,
+		.interrupted_pc = 0x2010, .caller = 2, },
+};
+
+/*! the number of checks failed */
+static int nr_failures;
+
+/*! the simulated target core registers */
+static ARM_CORE_WORD target_regs[NR_TARGET_CORE_REGS];
+/*! the simulated target stack */
+static ARM_CORE_WORD target_stack[NR_STACK_WORDS];
+/*! the register cache target state change callback, installed by init_frame_reg_cache() */
+static bool (* state_change_callback)(struct gear_engine_context * ctx, enum TARGET_CORE_STATE_ENUM state);
+/*! a placeholder for the call frame information of the executable */
+static char cfi_placeholder;
+
+
+/*
+ *
+ * local functions follow
+ *
+ */
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM target_mem_read(struct gear_engine_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes)
+ *	\brief	reads the simulated target stack; installed as ctx->cc->core_mem_read()
+ *
+ *	\param	ctx	gear engine context
+ *	\param	dest	the buffer to store the bytes read in
+ *	\param	source	the target memory address to read from
+ *	\param	nbytes	the number of bytes to read
+ *	\return	the status code of the memory read
+ */
+static enum GEAR_ENGINE_ERR_ENUM target_mem_read(struct gear_engine_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes)
+{
+	if (source < STACK_ADDR || source - STACK_ADDR > sizeof target_stack
+			|| * nbytes > sizeof target_stack - (source - STACK_ADDR))
+		return GEAR_ERR_GENERIC_ERROR;
+	memcpy(dest, (unsigned char *) target_stack + (source - STACK_ADDR), * nbytes);
+	return GEAR_ERR_NO_ERROR;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM target_mem_write(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes)
+ *	\brief	stub for the ctx->cc->core_mem_write() routine; never invoked
+ *
+ *	\return	always GEAR_ERR_GENERIC_ERROR
+ */
+static enum GEAR_ENGINE_ERR_ENUM target_mem_write(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes)
+{
+	return GEAR_ERR_GENERIC_ERROR;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM target_reg_read(struct gear_engine_context * ctx, unsigned mode, unsigned long mask, ARM_CORE_WORD buffer[])
+ *	\brief	reads the simulated target core registers; installed as ctx->cc->core_reg_read()
+ *
+ *	\param	ctx	gear engine context
+ *	\param	mode	ignored
+ *	\param	mask	a mask denoting which registers are read
+ *	\param	buffer	a buffer to hold the registers read
+ *	\return	always GEAR_ERR_NO_ERROR
+ */
+static enum GEAR_ENGINE_ERR_ENUM target_reg_read(struct gear_engine_context * ctx, unsigned mode, unsigned long mask, ARM_CORE_WORD buffer[])
+{
+int i, j;
+
+	for (i = j = 0; i < NR_TARGET_CORE_REGS; i++)
+		if (mask & (1 << i))
+			buffer[j++] = target_regs[i];
+	return GEAR_ERR_NO_ERROR;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM target_reg_write(struct gear_engine_context * ctx, unsigned mode, unsigned long mask, ARM_CORE_WORD buffer[])
+ *	\brief	stub for the ctx->cc->core_reg_write() routine; never invoked
+ *
+ *	\return	always GEAR_ERR_GENERIC_ERROR
+ */
+static enum GEAR_ENGINE_ERR_ENUM target_reg_write(struct gear_engine_context * ctx, unsigned mode, unsigned long mask, ARM_CORE_WORD buffer[])
+{
+	return GEAR_ERR_GENERIC_ERROR;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM get_halt_snapshot(struct gear_engine_context * ctx, struct core_halt_snapshot * snapshot)
+ *	\brief	stub for the ctx->cc->core_get_halt_snapshot() routine; never invoked
+ *
+ *	\return	always GEAR_ERR_GENERIC_ERROR
+ */
+static enum GEAR_ENGINE_ERR_ENUM get_halt_snapshot(struct gear_engine_context * ctx, struct core_halt_snapshot * snapshot)
+{
+	return GEAR_ERR_GENERIC_ERROR;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM register_state_change_callback(struct gear_engine_context * ctx, bool (*callback)(struct gear_engine_context * ctx, enum TARGET_CORE_STATE_ENUM state))
+ *	\brief	records the target state change callback; installed as ctx->cc->core_register_target_state_change_callback()
+ *
+ *	\return	always GEAR_ERR_NO_ERROR
+ */
+static enum GEAR_ENGINE_ERR_ENUM register_state_change_callback(struct gear_engine_context * ctx,
+		bool (*callback)(struct gear_engine_context * ctx, enum TARGET_CORE_STATE_ENUM state))
+{
+	state_change_callback = callback;
+	return GEAR_ERR_NO_ERROR;
+}
+
+static int get_nr_target_core_regs(struct gear_engine_context * ctx) { return NR_TARGET_CORE_REGS; }
+static int get_target_pc_reg_nr(struct gear_engine_context * ctx) { return PC_REG_NR; }
+static int get_target_sp_reg_nr(struct gear_engine_context * ctx) { return SP_REG_NR; }
+static bool is_dwarf_reg_nr_callee_saved(struct gear_engine_context * ctx, int dwarf_reg_nr)
+{
+	return (dwarf_reg_nr >= 4 && dwarf_reg_nr <= 11) || dwarf_reg_nr == LR_REG_NR;
+}
+static enum GEAR_ENGINE_ERR_ENUM translate_dwarf_reg_nr_to_target_reg_nr(struct gear_engine_context * ctx, int * inout_reg_nr) { return GEAR_ERR_NO_ERROR; }
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM unwind_frame(struct gear_engine_context * ctx, const struct tdesc_unwound_reg cur_regs[], struct tdesc_unwound_reg prev_regs[], ARM_CORE_WORD * cfa, bool * is_exception_frame, enum GEAR_ENGINE_ERR_ENUM (* read_stack_word)(struct gear_engine_context * ctx, ARM_CORE_WORD addr, ARM_CORE_WORD * val))
+ *	\brief	the simulated fallback frame unwinder; only unwinds exception frames, of which only the stacked program counter value is retrieved
+ *
+ *	for the parameters and the return value, see the comments about
+ *	the unwind_frame field in struct target_desc_struct, in
+ *	target-description.h */
+static enum GEAR_ENGINE_ERR_ENUM unwind_frame(struct gear_engine_context * ctx,
+		const struct tdesc_unwound_reg cur_regs[],
+		struct tdesc_unwound_reg prev_regs[],
+		ARM_CORE_WORD * cfa,
+		bool * is_exception_frame,
+		enum GEAR_ENGINE_ERR_ENUM (* read_stack_word)(struct gear_engine_context * ctx,
+			ARM_CORE_WORD addr, ARM_CORE_WORD * val))
+{
+int i;
+
+	if (cur_regs[PC_REG_NR].reg_val != EXC_RETURN_HANDLER)
+		return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
+	for (i = 0; i < NR_TARGET_CORE_REGS; i++)
+		prev_regs[i] = (struct tdesc_unwound_reg) { .is_valid = false, };
+	prev_regs[PC_REG_NR] = (struct tdesc_unwound_reg) { .is_valid = true, .is_stored_in_memory = true,
+		.reg_addr = cur_regs[SP_REG_NR].reg_val + EXCEPTION_FRAME_PC_IDX * sizeof(ARM_CORE_WORD), };
+	if (read_stack_word(ctx, prev_regs[PC_REG_NR].reg_addr, & prev_regs[PC_REG_NR].reg_val) != GEAR_ERR_NO_ERROR)
+		return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
+	* cfa = cur_regs[SP_REG_NR].reg_val + NR_EXCEPTION_FRAME_WORDS * sizeof(ARM_CORE_WORD);
+	* is_exception_frame = true;
+	return GEAR_ERR_NO_ERROR;
+}
+
+/*! the simulated target description */
+static struct target_desc_struct tdesc =
+{
+	.get_nr_target_core_regs = get_nr_target_core_regs,
+	.get_target_pc_reg_nr = get_target_pc_reg_nr,
+	.get_target_sp_reg_nr = get_target_sp_reg_nr,
+	.is_dwarf_reg_nr_callee_saved = is_dwarf_reg_nr_callee_saved,
+	.translate_dwarf_reg_nr_to_target_reg_nr = translate_dwarf_reg_nr_to_target_reg_nr,
+	.unwind_frame = unwind_frame,
+};
+
+/*!
+ *	\fn	static void run_unwind_case(struct gear_engine_context * ctx, const struct unwind_case * c)
+ *	\brief	halts the simulated target in the innermost function, unwinds the frames up to the outermost function, and checks the frame unwound last
+ *
+ *	\param	ctx	gear engine context
+ *	\param	c	the test case to run
+ *	\return	none
+ */
+static void run_unwind_case(struct gear_engine_context * ctx, const struct unwind_case * c)
+{
+ARM_CORE_WORD caller_sp, regs[2];
+int i, frame_nr, nr_frames;
+
+	/* the innermost function has pushed the return address */
+	for (i = 0; i < NR_STACK_WORDS; i++)
+		target_stack[i] = 0xdead0000 + i;
+	target_stack[functions[0].cfa_offset / 4 - 1] = c->ret_addr;
+	caller_sp = STACK_ADDR + functions[0].cfa_offset;
+	nr_frames = 2;
+	if (c->ret_addr == EXC_RETURN_HANDLER)
+	{
+		/* the core has stacked the program counter value of
+		 * the function interrupted, on exception entry */
+		target_stack[(caller_sp - STACK_ADDR) / 4 + EXCEPTION_FRAME_PC_IDX] = c->interrupted_pc;
+		caller_sp += NR_EXCEPTION_FRAME_WORDS * sizeof(ARM_CORE_WORD);
+		nr_frames ++;
+	}
+	/* the caller has pushed the return address into the outermost function */
+	target_stack[(caller_sp - STACK_ADDR + functions[c->caller].cfa_offset) / 4 - 1] = OUTERMOST_RET_ADDR;
+	memset(target_regs, 0, sizeof target_regs);
+	target_regs[SP_REG_NR] = STACK_ADDR;
+	target_regs[LR_REG_NR] = c->ret_addr;
+	target_regs[PC_REG_NR] = INNERMOST_PC;
+
+	state_change_callback(ctx, TARGET_CORE_STATE_HALTED);
+	if (frame_move_to_relative(ctx, - nr_frames, & frame_nr) != GEAR_ERR_NO_ERROR || frame_nr != nr_frames)
+	{
+		printf("FAIL: %s: cannot unwind the caller frame\n", c->what);
+		nr_failures ++;
+	}
+	else
+	{
+		ctx->cc->core_reg_read(ctx, 0, 1 << SP_REG_NR | 1 << PC_REG_NR, regs);
+		if (regs[0] != caller_sp + functions[c->caller].cfa_offset || regs[1] != OUTERMOST_RET_ADDR)
+		{
+			printf("FAIL: %s: wrong outermost frame unwound: sp == 0x%08x, pc == 0x%08x\n",
+					c->what, (unsigned) regs[0], (unsigned) regs[1]);
+			nr_failures ++;
+		}
+	}
+	state_change_callback(ctx, TARGET_CORE_STATE_RUNNING);
+}
+
+
+/*
+ *
+ * exported functions follow
+ *
+ */
+
+/*!
+ *	\fn	struct dwarf_frame_data * dwarf_frame_init(struct gear_engine_context * ctx)
+ *	\brief	stub for the call frame information reader, see dwarf-frame.c
+ *
+ *	\param	ctx	gear engine context
+ *	\return	a placeholder for the call frame information
+ */
+struct dwarf_frame_data * dwarf_frame_init(struct gear_engine_context * ctx)
+{
+	return (struct dwarf_frame_data *) & cfi_placeholder;
+}
+
+/*!
+ *	\fn	bool dwarf_frame_get_row(struct dwarf_frame_data * cfi, ARM_CORE_WORD pc, struct dwarf_frame_row * row)
+ *	\brief	retrieves the register unwinding rules for a target address, from the simulated functions table
+ *
+ *	\param	cfi	the call frame information placeholder
+ *	\param	pc	the target address to retrieve the rules for
+ *	\param	row	a pointer to where to store the rules
+ *	\return	true, if the address is inside a simulated function covered by call frame information, false otherwise
+ */
+bool dwarf_frame_get_row(struct dwarf_frame_data * cfi, ARM_CORE_WORD pc, struct dwarf_frame_row * row)
+{
+int i;
+
+	for (i = 0; i < sizeof functions / sizeof * functions; i++)
+		if (functions[i].start <= pc && pc < functions[i].end)
+			break;
+	if (i == sizeof functions / sizeof * functions)
+		return false;
+	memset(row, 0, sizeof * row);
+	row->cfa_rule = (struct dwarf_frame_rule) { .type = DWARF_FRAME_RULE_REGISTER,
+		.reg_nr = SP_REG_NR, .offset = functions[i].cfa_offset, };
+	for (i = 0; i < DWARF_FRAME_MAX_NR_REGS; i++)
+		row->rules[i].type = DWARF_FRAME_RULE_SAME_VALUE;
+	row->rules[LR_REG_NR] = (struct dwarf_frame_rule) { .type = DWARF_FRAME_RULE_OFFSET, .offset = -4, };
+	row->ret_addr_column = LR_REG_NR;
+	return true;
+}
+
+/*!
+ *	\fn	void dwarf_frame_dump_stats_mi(struct dwarf_frame_data * cfi)
+ *	\brief	stub for the call frame information statistics dumper; never invoked
+ *
+ *	\param	cfi	the call frame information placeholder
+ *	\return	none
+ */
+void dwarf_frame_dump_stats_mi(struct dwarf_frame_data * cfi)
+{
+}
+
+/*!
+ *	\fn	int write_to_frontends(const void * buf, size_t count)
+ *	\brief	stub for the gear engine frontend output routine used by miprintf.c; the output is discarded
+ *
+ *	\param	buf	the data to output
+ *	\param	count	the number of bytes to output
+ *	\return	the number of bytes output
+ */
+int write_to_frontends(const void * buf, size_t count)
+{
+	return count;
+}
+
+int main(int argc, char ** argv)
+{
+struct gear_engine_context ctx;
+struct core_control cc;
+int i;
+
+	memset(& ctx, 0, sizeof ctx);
+	memset(& cc, 0, sizeof cc);
+	cc.core_mem_read = target_mem_read;
+	cc.core_mem_write = target_mem_write;
+	cc.core_reg_read = target_reg_read;
+	cc.core_reg_write = target_reg_write;
+	cc.core_get_halt_snapshot = get_halt_snapshot;
+	cc.core_register_target_state_change_callback = register_state_change_callback;
+	ctx.cc = & cc;
+	ctx.tdesc = & tdesc;
+	ctx.settings.frame_unwind_limit = 16;
+	ctx.settings.stack_prefetch_size = sizeof target_stack;
+	ctx.settings.stack_prefetch_nr_frames = 1;
+	init_frame_reg_cache(& ctx);
+
+	for (i = 0; i < sizeof unwind_cases / sizeof * unwind_cases; i++)
+		run_unwind_case(& ctx, unwind_cases + i);
+
+	printf("%i failures\n", nr_failures);
+	return nr_failures ? 1 : 0;
+}
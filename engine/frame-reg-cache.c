@@ -219,7 +219,9 @@
 #include "engine-err.h"
 #include "core-access.h"
 #include "frame-reg-cache.h"
+#include "dwarf-frame.h"
 #include "gprintf.h"
+#include "miprintf.h"
 #include "util.h"
 
 #include "dwarf-loc.h"
@@ -235,14 +237,43 @@
 /*! the data structure holding dwarf frame unwind data for the executable being debugged */
 struct frame_data_struct
 {
-	/*! the array containing cies, returned by dwarf_get_fde_list */
-	Dwarf_Cie	* cie_data;
-	/*! the number of elements in the ::cie_data array */
-	Dwarf_Signed	cie_element_count;
-	/*! the array containing fdes, returned by dwarf_get_fde_list */
-	Dwarf_Fde	* fde_data;
-	/*! the number of elements in the ::fde_data array */
-	Dwarf_Signed	fde_element_count;
+	/*! the call frame information of the executable being debugged, see dwarf-frame.c */
+	struct dwarf_frame_data	* cfi;
+	/*! a cache of register unwinding rules, decoded for target addresses
+	 *
+	 * decoding the register unwinding rules for an address (by
+	 * dwarf_frame_get_row()) means interpreting the call
+	 * frame instructions of an fde; this is by far the most expensive
+	 * part of unwinding a frame that does not access the target, and
+	 * a backtrace usually goes through the same return addresses
+	 * every time the target halts, so the decoded rules are kept here,
+	 * keyed by target address; the cache entries form a list, ordered
+	 * from the most recently used to the least recently used one,
+	 * and the least recently used entry is reused when decoding the
+	 * rules for an address not in the cache; the rules depend only
+	 * on the executable being debugged, so the cache is never
+	 * invalidated; see get_unwind_rules() */
+	struct
+	{
+		/*! the most recently used cache entry - the list head */
+		struct unwind_rules_struct
+		{
+			/*! the target address the rules below have been decoded for */
+			ARM_CORE_WORD	pc;
+			/*! nonzero, if this entry holds decoded rules; zero, if this entry is unused */
+			bool		is_valid;
+			/*! the decoded register unwinding rules */
+			struct dwarf_frame_row	row;
+			/*! the next less recently used cache entry */
+			struct unwind_rules_struct * next;
+		}
+		* mru;
+		/*! the number of register unwinding rules lookups served from the cache */
+		int		nr_hits;
+		/*! the number of register unwinding rules lookups that needed decoding the rules */
+		int		nr_misses;
+	}
+	unwind_rules;
 	/*! the list head of the target call stack frames unwound so far
 	 * 
 	 * this points to the innermost (most recent) frame; if null,
@@ -290,6 +321,22 @@ struct frame_data_struct
 		 *
 		 * if this is null, then this is the innermost frame */
 		struct frame_reg_struct * younger;
+		/*! nonzero, if the program counter value in this frame is the address of the next instruction to execute
+		 *
+		 * this is the case for the innermost frame, for the
+		 * frames interrupted by a signal handler (i.e. the ones
+		 * unwound from a frame which the call frame information
+		 * marks as a signal handler frame - cie augmentation 'S'),
+		 * and for the frames interrupted by an exception (i.e. the
+		 * ones unwound from an exception frame by the target
+		 * specific fallback frame unwinder, see fallback_frame_unwind());
+		 * the program counter value of all other frames is a
+		 * return address, which may well be past the end of the
+		 * calling subroutine (e.g. after a call to a subroutine
+		 * that does not return), so the register unwinding rules
+		 * for such frames are looked up at the address preceding
+		 * the return address instead; see dwarf_frame_unwind() */
+		bool is_pc_exact;
 
 		/*! this structure denotes, for each register, where it is stored
 		 *
@@ -481,6 +528,42 @@ struct frame_data_struct
 	 * 		the selected_frame field above is null */
 	int	selected_frame_nr;
 
+	/*! a pool of frame register data structures, available for reuse
+	 *
+	 * frames are not freed when the register cache is destroyed,
+	 * they are put here instead (linked by their 'older' pointers)
+	 * and are handed out again by get_frame_reg_struct() */
+	struct frame_reg_struct *	free_frames;
+	/*! the target call stack frames unwound before the target has last been stepped
+	 *
+	 * stepping the target (by a machine instruction, or by a source
+	 * code line, stepping into or over calls) usually leaves all but
+	 * the innermost frame or two intact, so when the target is
+	 * resumed for stepping, the frame list is not destroyed, but is
+	 * moved here instead; when a frame unwound after the target halts
+	 * again turns out to be the same as one of the frames here, it is
+	 * replaced by the frame here, along with those of the older frames
+	 * already unwound after it whose saved registers are still
+	 * intact in the target stack; this saves unwinding these frames
+	 * again; the frames here are discarded when the target is resumed
+	 * other than for stepping, or when target memory is written by
+	 * the gear engine; see reuse_stale_frame() */
+	struct frame_reg_struct *	stale_frames;
+	/*! if true, the frame list is moved to the stale_frames list above when the target starts running
+	 *
+	 * this is set just before the target is resumed for stepping,
+	 * and is cleared when the target starts running; see
+	 * frame_reg_cache_keep_frames_on_resume() */
+	bool	must_keep_frames_on_resume;
+	/*! the number of target call stack frames unwound */
+	int	nr_unwound_frames;
+	/*! the number of target call stack frames reused from the stale_frames list above */
+	int	nr_reused_frames;
+	/*! the number of target call stack frames unwound by the target specific fallback frame unwinder
+	 *
+	 * see fallback_frame_unwind() */
+	int	nr_fallback_unwound_frames;
+
 	/*! original value of the ctx->cc->core_reg_read() function pointer
 	 *
 	 * this is overrriden by the reg_cache_core_reg_read() function within this module */
@@ -489,8 +572,67 @@ struct frame_data_struct
 	 *
 	 * this is overrriden by the xxx() function within this module */
 	enum GEAR_ENGINE_ERR_ENUM (*core_reg_write_prev)(struct gear_engine_context * ctx, unsigned mode, unsigned long mask, ARM_CORE_WORD buffer[]);
+	/*! original value of the ctx->cc->core_get_halt_snapshot() function pointer
+	 *
+	 * this is overridden by the reg_cache_core_get_halt_snapshot() function within this module */
+	enum GEAR_ENGINE_ERR_ENUM (*core_get_halt_snapshot_prev)(struct gear_engine_context * ctx, struct core_halt_snapshot * snapshot);
+	/*! original value of the ctx->cc->core_mem_write() function pointer
+	 *
+	 * this is overridden by the reg_cache_core_mem_write() function within this module */
+	enum GEAR_ENGINE_ERR_ENUM (*core_mem_write_prev)(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes);
+	/*! original value of the ctx->cc->core_insn_step() function pointer
+	 *
+	 * this is overridden by the reg_cache_core_insn_step() function within this module;
+	 * null, if the target does not support single stepping natively */
+	enum GEAR_ENGINE_ERR_ENUM (*core_insn_step_prev)(struct gear_engine_context * ctx);
+
+	/*! the target stack contents prefetched for unwinding the target call stack
+	 *
+	 * the target stack is fetched in bulk when the target halts,
+	 * so that the saved registers of the frames being unwound are
+	 * read from here, instead of reading them from the target one
+	 * at a time; this is only valid while the target is halted;
+	 * see prefetch_stack() and read_stack_word() */
+	struct
+	{
+		/*! the target address of the first byte in the buf array below */
+		ARM_CORE_WORD	addr;
+		/*! the number of valid bytes in the buf array below; zero, if nothing has been prefetched */
+		unsigned	len;
+		/*! the number of bytes allocated for the buf array below */
+		unsigned	size;
+		/*! the maximum number of valid bytes the prefetched contents may grow to
+		 *
+		 * this is MAX_STACK_PREFETCH_SIZE, unless a bulk target memory
+		 * read growing the prefetched contents has failed (e.g. because
+		 * it reached past the end of target memory) - in that case, it
+		 * is lowered below the end of the failed read, so that the
+		 * failing read is not reissued for every word read afterwards;
+		 * reset by prefetch_stack() */
+		unsigned	max_len;
+		/*! the target stack contents */
+		unsigned char	* buf;
+		/*! the number of bulk target memory reads made for prefetching the target stack */
+		int		nr_prefetches;
+		/*! the number of saved register reads served from the prefetched target stack contents */
+		int		nr_hits;
+		/*! the number of saved register reads passed to the target */
+		int		nr_misses;
+	}
+	stack_prefetch;
 };
 
+/*! the maximum number of bytes of the target stack prefetched for unwinding the target call stack
+ *
+ * saved registers farther than this from the target stack pointer
+ * are read from the target directly; see read_stack_word() */
+static const unsigned MAX_STACK_PREFETCH_SIZE = 0x10000;
+
+/*! the number of entries in the register unwinding rules cache
+ *
+ * see the comments about the unwind_rules field in struct frame_data_struct */
+static const int NR_CACHED_UNWIND_RULES = 64;
+
 /*
  *
  * exported functions follow
@@ -499,23 +641,88 @@ struct frame_data_struct
 
 /*!
  *	\fn	static struct frame_reg_struct * get_frame_reg_struct(struct gear_engine_context * ctx)
- *	\brief	allocates and returns a data structure of type frame_reg_struct
+ *	\brief	allocates and returns a zero-filled data structure of type frame_reg_struct
+ *
+ *	the data structure is taken from the pool of frames available
+ *	for reuse, if not empty; see release_frames()
  *
  *	\param	ctx	context to work in
  *	\return	the newly allocated struct frame_reg_struct */
 static struct frame_reg_struct * get_frame_reg_struct(struct gear_engine_context * ctx)
 {
-struct frame_reg_struct * p;
+struct frame_data_struct * p;
+struct frame_reg_struct * f;
 int i;
 
 	if (!(i = ctx->tdesc->get_nr_target_core_regs(ctx)))
 		panic("");
 
-	i = sizeof(struct frame_reg_struct [i]);
+	i = sizeof * f + sizeof(struct reg_info_struct [i]);
 
-	if (!(p = calloc(1, sizeof * p + i)))
+	p = ctx->frame_data;
+	if ((f = p->free_frames))
+	{
+		p->free_frames = f->older;
+		memset(f, 0, i);
+	}
+	else if (!(f = calloc(1, i)))
 		panic("");
-	return p;
+	return f;
+}
+
+/*!
+ *	\fn	static void release_frames(struct frame_data_struct * p, struct frame_reg_struct * frame)
+ *	\brief	puts a frame, and all of the frames older than it, in the pool of frames available for reuse
+ *
+ *	\param	p	the frame data to work in
+ *	\param	frame	the frame to release; may be null
+ *	\return	none */
+static void release_frames(struct frame_data_struct * p, struct frame_reg_struct * frame)
+{
+struct frame_reg_struct * older;
+
+	while (frame)
+	{
+		older = frame->older;
+		frame->older = p->free_frames;
+		p->free_frames = frame;
+		frame = older;
+	}
+}
+
+/*!
+ *	\fn	static bool is_same_frame(struct gear_engine_context * ctx, struct frame_reg_struct * f0, struct frame_reg_struct * f1)
+ *	\brief	determines if two frames hold the same register values, stored at the same locations, and have their program counter values interpreted the same way
+ *
+ *	\param	ctx	context to work in
+ *	\param	f0	the first frame to compare
+ *	\param	f1	the second frame to compare
+ *	\return	true, if the frames are the same, false otherwise */
+static bool is_same_frame(struct gear_engine_context * ctx, struct frame_reg_struct * f0, struct frame_reg_struct * f1)
+{
+struct reg_info_struct * r0, * r1;
+int i, nr_target_core_regs;
+
+	if (f0->is_pc_exact != f1->is_pc_exact)
+		return false;
+	nr_target_core_regs = ctx->tdesc->get_nr_target_core_regs(ctx);
+	for (i = 0; i < nr_target_core_regs; i++)
+	{
+		r0 = f0->reg_info + i;
+		r1 = f1->reg_info + i;
+		if (r0->reg_content_type != r1->reg_content_type)
+			return false;
+		if (r0->reg_content_type != ARM_CORE_REG_VALID)
+			continue;
+		if (r0->reg_val != r1->reg_val
+				|| r0->is_reg_addr_applicable != r1->is_reg_addr_applicable)
+			return false;
+		if (r0->is_reg_addr_applicable
+				&& (r0->is_reg_stored_in_memory != r1->is_reg_stored_in_memory
+					|| r0->reg_addr != r1->reg_addr))
+			return false;
+	}
+	return true;
 }
 
 /*!
@@ -538,7 +745,6 @@ static ARM_CORE_WORD get_reg_checked(struct gear_engine_context * ctx, struct fr
 {
 int i;
 
-	printf("%s(): reg_nr == %i\n", __func__, reg_nr);
 	if (!(i = ctx->tdesc->get_nr_target_core_regs(ctx)))
 		panic("");
 	if (reg_nr >= i
@@ -549,6 +755,454 @@ int i;
 	return frame->reg_info[reg_nr].reg_val;
 }
 
+/*!
+ *	\fn	static struct unwind_rules_struct * get_unwind_rules(struct gear_engine_context * ctx, ARM_CORE_WORD pc)
+ *	\brief	retrieves the register unwinding rules for a target address
+ *
+ *	the rules are looked up in the register unwinding rules cache
+ *	first, and are decoded (and cached) only if not found there;
+ *	see the comments about the unwind_rules field in
+ *	struct frame_data_struct
+ *
+ *	\param	ctx	context to work in
+ *	\param	pc	the target address to retrieve the rules for
+ *	\return	a pointer to the cache entry holding the rules,
+ *		null, if there is no unwind information for the address;
+ *		the entry is only valid until the next invocation of
+ *		this routine */
+static struct unwind_rules_struct * get_unwind_rules(struct gear_engine_context * ctx, ARM_CORE_WORD pc)
+{
+struct frame_data_struct * p;
+struct unwind_rules_struct * r, * prev;
+
+	p = ctx->frame_data;
+	/* look the address up; if it is not in the cache,
+	 * this stops at the least recently used entry */
+	prev = 0;
+	r = p->unwind_rules.mru;
+	while (!(r->is_valid && r->pc == pc) && r->next)
+		prev = r, r = r->next;
+
+	if (r->is_valid && r->pc == pc)
+		p->unwind_rules.nr_hits++;
+	else
+	{
+		/* not cached - decode the rules in the least recently used entry */
+		r->is_valid = false;
+		if (!dwarf_frame_get_row(p->cfi, pc, &r->row))
+			return 0;
+		r->pc = pc;
+		r->is_valid = true;
+		p->unwind_rules.nr_misses++;
+	}
+	/* move the entry to the front of the list */
+	if (prev)
+	{
+		prev->next = r->next;
+		r->next = p->unwind_rules.mru;
+		p->unwind_rules.mru = r;
+	}
+	return r;
+}
+
+/*!
+ *	\fn	static bool get_innermost_frame_cfa(struct gear_engine_context * ctx, struct frame_reg_struct * frame, ARM_CORE_WORD * cfa)
+ *	\brief	computes the canonical frame address of the innermost (most recent) target call stack frame
+ *
+ *	only the cfa rule for the frame is evaluated; as all of the target
+ *	core registers are known for the innermost frame, this does not
+ *	need any target memory accesses
+ *
+ *	\param	ctx	context to work in
+ *	\param	frame	the innermost target call stack frame
+ *	\param	cfa	a pointer to where to store the computed cfa
+ *	\return	true, if the cfa has been computed, false, if there is no
+ *		unwind information for the frame, or the cfa rule for the
+ *		frame is not a register-and-offset rule
+ */
+static bool get_innermost_frame_cfa(struct gear_engine_context * ctx, struct frame_reg_struct * frame, ARM_CORE_WORD * cfa)
+{
+struct unwind_rules_struct * rules;
+struct dwarf_frame_rule * cfa_rule;
+int translated_dwarf_regnum;
+
+	/* the rules retrieved here are cached, and are
+	 * reused when the innermost frame gets unwound */
+	if (!(rules = get_unwind_rules(ctx, get_reg_checked(ctx, frame, ctx->tdesc->get_target_pc_reg_nr(ctx)))))
+		return false;
+	cfa_rule = &rules->row.cfa_rule;
+	if (cfa_rule->type != DWARF_FRAME_RULE_REGISTER)
+		return false;
+	translated_dwarf_regnum = cfa_rule->reg_nr;
+	if (ctx->tdesc->translate_dwarf_reg_nr_to_target_reg_nr(ctx, &translated_dwarf_regnum) != GEAR_ERR_NO_ERROR
+			|| translated_dwarf_regnum >= ctx->tdesc->get_nr_target_core_regs(ctx))
+		return false;
+	* cfa = frame->reg_info[translated_dwarf_regnum].reg_val + cfa_rule->offset;
+	return true;
+}
+
+/*!
+ *	\fn	static bool fetch_stack_window(struct gear_engine_context * ctx, ARM_CORE_WORD addr, unsigned nbytes)
+ *	\brief	appends target stack contents to the target stack prefetch buffer, by a single target memory read
+ *
+ *	\param	ctx	context to work in
+ *	\param	addr	the target address to fetch from; must immediately
+ *			follow the contents already prefetched, if any
+ *	\param	nbytes	the number of bytes to fetch
+ *	\return	true, if any bytes have been fetched, false otherwise
+ */
+static bool fetch_stack_window(struct gear_engine_context * ctx, ARM_CORE_WORD addr, unsigned nbytes)
+{
+struct frame_data_struct * p;
+
+	p = ctx->frame_data;
+	if (!p->stack_prefetch.len)
+		p->stack_prefetch.addr = addr;
+	else if (addr != p->stack_prefetch.addr + p->stack_prefetch.len)
+		panic("");
+	if (p->stack_prefetch.len + nbytes > p->stack_prefetch.size)
+	{
+		p->stack_prefetch.size = p->stack_prefetch.len + nbytes;
+		if (!(p->stack_prefetch.buf = realloc(p->stack_prefetch.buf, p->stack_prefetch.size)))
+			panic("out of core");
+	}
+	p->stack_prefetch.nr_prefetches ++;
+	if (ctx->cc->core_mem_read(ctx, p->stack_prefetch.buf + p->stack_prefetch.len, addr, &nbytes)
+			!= GEAR_ERR_NO_ERROR)
+		return false;
+	p->stack_prefetch.len += nbytes;
+	return nbytes != 0;
+}
+
+/*!
+ *	\fn	static void prefetch_stack(struct gear_engine_context * ctx)
+ *	\brief	speculatively fetches the top of the target stack, for unwinding the target call stack
+ *
+ *	this is invoked when the target halts; the number of bytes
+ *	fetched is at least ctx->settings.stack_prefetch_size, and is
+ *	increased to cover ctx->settings.stack_prefetch_nr_frames frames
+ *	of the size of the innermost frame; the sizes of the frames
+ *	farther up the target call stack are not known at this time,
+ *	because their cfa rules depend on the return addresses saved
+ *	on the very stack being prefetched - if the unwinding goes past
+ *	the bytes prefetched here, more are fetched by read_stack_word()
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+static void prefetch_stack(struct gear_engine_context * ctx)
+{
+struct frame_data_struct * p;
+ARM_CORE_WORD sp, cfa;
+unsigned nbytes;
+
+	p = ctx->frame_data;
+	p->stack_prefetch.len = 0;
+	p->stack_prefetch.max_len = MAX_STACK_PREFETCH_SIZE;
+	if (!(nbytes = ctx->settings.stack_prefetch_size))
+		return;
+	sp = p->frame_list->reg_info[ctx->tdesc->get_target_sp_reg_nr(ctx)].reg_val & ~(sizeof(ARM_CORE_WORD) - 1);
+	if (get_innermost_frame_cfa(ctx, p->frame_list, &cfa)
+			&& cfa > sp && cfa - sp < MAX_STACK_PREFETCH_SIZE
+			&& (cfa - sp) * ctx->settings.stack_prefetch_nr_frames > nbytes)
+		nbytes = (cfa - sp) * ctx->settings.stack_prefetch_nr_frames;
+	if (nbytes > MAX_STACK_PREFETCH_SIZE)
+		nbytes = MAX_STACK_PREFETCH_SIZE;
+	/* do not wrap around the end of the target address space */
+	if (sp + nbytes < sp)
+		nbytes = - sp;
+	if (!nbytes)
+		return;
+	if (!fetch_stack_window(ctx, sp, nbytes) && nbytes > ctx->settings.stack_prefetch_size)
+	{
+		/* maybe the bytes estimated reach past the end
+		 * of target memory; retry with the minimum size */
+		p->stack_prefetch.max_len = nbytes - 1;
+		fetch_stack_window(ctx, sp, ctx->settings.stack_prefetch_size);
+	}
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM read_stack_word(struct gear_engine_context * ctx, ARM_CORE_WORD addr, ARM_CORE_WORD * val)
+ *	\brief	reads a saved register value from the target stack, when unwinding the target call stack
+ *
+ *	the value is read from the target stack contents prefetched;
+ *	if the address is above the contents prefetched, the prefetch
+ *	window is (at least) doubled by a single target memory read,
+ *	so that deep target call stacks are unwound by a few bulk
+ *	target memory reads; if such a read fails, it is retried with
+ *	halving sizes, down to the bytes actually needed, and the window
+ *	is never again grown as far as the failed read reached (see the
+ *	max_len field in the stack_prefetch structure); only if the
+ *	address is below the target stack pointer, or too far above it,
+ *	or the window cannot be grown to cover it, is the value read
+ *	from the target directly
+ *
+ *	\param	ctx	context to work in
+ *	\param	addr	the target address to read from
+ *	\param	val	a pointer to where to store the value read
+ *	\return	GEAR_ERR_NO_ERROR on success, GEAR_ERR_GENERIC_ERROR on failure
+ */
+static enum GEAR_ENGINE_ERR_ENUM read_stack_word(struct gear_engine_context * ctx, ARM_CORE_WORD addr, ARM_CORE_WORD * val)
+{
+struct frame_data_struct * p;
+unsigned offset, nbytes, needed;
+
+	p = ctx->frame_data;
+	if (p->stack_prefetch.len && addr >= p->stack_prefetch.addr)
+	{
+		offset = addr - p->stack_prefetch.addr;
+		if (offset + sizeof(ARM_CORE_WORD) > p->stack_prefetch.len
+				&& offset + sizeof(ARM_CORE_WORD) <= p->stack_prefetch.max_len)
+		{
+			nbytes = needed = offset + sizeof(ARM_CORE_WORD) - p->stack_prefetch.len;
+			if (nbytes < p->stack_prefetch.len)
+				nbytes = p->stack_prefetch.len;
+			if (p->stack_prefetch.len + nbytes > p->stack_prefetch.max_len)
+				nbytes = p->stack_prefetch.max_len - p->stack_prefetch.len;
+			if (p->stack_prefetch.addr + p->stack_prefetch.len + nbytes > p->stack_prefetch.addr)
+				while (!fetch_stack_window(ctx, p->stack_prefetch.addr + p->stack_prefetch.len, nbytes))
+				{
+					/* maybe the read reaches past the end of target
+					 * memory; never grow the window this far again,
+					 * and retry with halving sizes */
+					p->stack_prefetch.max_len = p->stack_prefetch.len + nbytes - 1;
+					if (nbytes == needed)
+						break;
+					if ((nbytes /= 2) < needed)
+						nbytes = needed;
+				}
+		}
+		if (offset + sizeof(ARM_CORE_WORD) <= p->stack_prefetch.len)
+		{
+			memcpy(val, p->stack_prefetch.buf + offset, sizeof(ARM_CORE_WORD));
+			p->stack_prefetch.nr_hits ++;
+			return GEAR_ERR_NO_ERROR;
+		}
+	}
+	p->stack_prefetch.nr_misses ++;
+	nbytes = sizeof(ARM_CORE_WORD);
+	if (ctx->cc->core_mem_read(ctx, val, addr, &nbytes) != GEAR_ERR_NO_ERROR
+			|| nbytes != sizeof(ARM_CORE_WORD))
+		return GEAR_ERR_GENERIC_ERROR;
+	return GEAR_ERR_NO_ERROR;
+}
+
+/*!
+ *	\fn	static bool are_saved_regs_intact(struct gear_engine_context * ctx, struct frame_reg_struct * frame)
+ *	\brief	determines if the registers of a stale frame that are saved in the target stack still hold the values recorded in the frame
+ *
+ *	\param	ctx	context to work in
+ *	\param	frame	the stale frame to check
+ *	\return	true, if all of the saved register slots of the frame
+ *		in the target stack still hold the register values in the
+ *		frame, false otherwise */
+static bool are_saved_regs_intact(struct gear_engine_context * ctx, struct frame_reg_struct * frame)
+{
+struct reg_info_struct * r;
+ARM_CORE_WORD val;
+int i, nr_target_core_regs;
+
+	nr_target_core_regs = ctx->tdesc->get_nr_target_core_regs(ctx);
+	for (i = 0; i < nr_target_core_regs; i++)
+	{
+		r = frame->reg_info + i;
+		if (r->reg_content_type != ARM_CORE_REG_VALID
+				|| !r->is_reg_addr_applicable || !r->is_reg_stored_in_memory)
+			continue;
+		if (read_stack_word(ctx, r->reg_addr, &val) != GEAR_ERR_NO_ERROR
+				|| val != r->reg_val)
+			return false;
+	}
+	return true;
+}
+
+/*!
+ *	\fn	static struct frame_reg_struct * reuse_stale_frame(struct gear_engine_context * ctx, struct frame_reg_struct * frame)
+ *	\brief	looks up a frame just unwound in the list of frames unwound before the target has last been stepped
+ *
+ *	the frames older than a frame depend on the register values
+ *	in it, and on the target stack contents above its cfa - the
+ *	registers saved by the frame and its callers; stepping the
+ *	target may well change these stack contents without changing
+ *	the frame itself (e.g. by storing through a pointer to a local
+ *	variable of a caller), so if a frame just unwound is the same
+ *	as a stale frame, the stale frame is reused, but each of the
+ *	older stale frames already unwound is only reused if its
+ *	registers saved in the target stack are still intact (see
+ *	are_saved_regs_intact()) - the first older stale frame that
+ *	fails this check is discarded, along with all of the frames
+ *	older than it, and these get unwound again when needed;
+ *	stale frames are ordered by their cfa (i.e. the stack pointer
+ *	value in their caller), so the search stops at the first
+ *	stale frame with a stack pointer value above the one of the
+ *	frame searched for; also see the comments about the
+ *	stale_frames field in struct frame_data_struct
+ *
+ *	\param	ctx	context to work in
+ *	\param	frame	the frame just unwound; its younger pointer
+ *			is expected to be null
+ *	\return	if a matching stale frame is found - the stale frame,
+ *		in which case the frame passed is released, and the stale
+ *		frames younger than the one returned (and the older ones
+ *		whose saved registers have been overwritten) are discarded;
+ *		otherwise the frame passed */
+static struct frame_reg_struct * reuse_stale_frame(struct gear_engine_context * ctx, struct frame_reg_struct * frame)
+{
+struct frame_data_struct * p;
+struct frame_reg_struct * s, * older;
+int sp_reg_nr;
+ARM_CORE_WORD sp;
+
+	p = ctx->frame_data;
+	sp_reg_nr = ctx->tdesc->get_target_sp_reg_nr(ctx);
+	sp = frame->reg_info[sp_reg_nr].reg_val;
+	for (s = p->stale_frames; s; s = s->older)
+	{
+		if (s->reg_info[sp_reg_nr].reg_content_type != ARM_CORE_REG_VALID
+				|| s->reg_info[sp_reg_nr].reg_val > sp)
+			break;
+		if (s->reg_info[sp_reg_nr].reg_val == sp && is_same_frame(ctx, s, frame))
+		{
+			/* the stale frames younger than this one
+			 * can no longer match, discard them */
+			if (s->younger)
+			{
+				s->younger->older = 0;
+				release_frames(p, p->stale_frames);
+				s->younger = 0;
+			}
+			p->stale_frames = 0;
+			release_frames(p, frame);
+			p->nr_reused_frames++;
+			/* validate the older frames already unwound */
+			for (older = s->older; older; older = older->older)
+				if (!are_saved_regs_intact(ctx, older))
+				{
+					older->younger->older = 0;
+					release_frames(p, older);
+					break;
+				}
+			return s;
+		}
+	}
+	return frame;
+}
+
+/*!
+ *	\fn	static int link_unwound_frame(struct gear_engine_context * ctx, struct frame_reg_struct * cur_frame, struct frame_reg_struct * prev_frame, ARM_CORE_WORD cfa_addr)
+ *	\brief	validates a target call stack frame just unwound, and links it in the list of frames unwound
+ *
+ *	\param	ctx	context to work in
+ *	\param	cur_frame	the frame that has been unwound
+ *	\param	prev_frame	the frame obtained by unwinding cur_frame;
+ *				this is released if not valid
+ *	\param	cfa_addr	the canonical frame address of cur_frame
+ *	\return	GEAR_ERR_NO_ERROR, if the frame obtained is valid,
+ *		GEAR_ERR_CANT_UNWIND_STACK_FRAME otherwise */
+static int link_unwound_frame(struct gear_engine_context * ctx, struct frame_reg_struct * cur_frame, struct frame_reg_struct * prev_frame, ARM_CORE_WORD cfa_addr)
+{
+struct frame_data_struct * p;
+int i;
+int target_core_pc_reg_nr;
+
+	p = ctx->frame_data;
+	target_core_pc_reg_nr = ctx->tdesc->get_target_pc_reg_nr(ctx);
+	/* if the program counter for this frame is invalid - say that
+	 * the unwinding failed; gcc 4.5.2 has been observed to generate
+	 * some garbage fdes... */
+	if (prev_frame->reg_info[target_core_pc_reg_nr].reg_content_type != ARM_CORE_REG_VALID)
+	{
+		release_frames(p, prev_frame);
+		return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
+	}
+	/* also say that the unwinding failed if it does not make progress
+	 * up the target stack - bogus unwind information must not be
+	 * allowed to make the unwinding go on all the way up to the
+	 * cap on the number of frames unwound (see frame_move_to_relative()) */
+	i = ctx->tdesc->get_target_sp_reg_nr(ctx);
+	if (cfa_addr < cur_frame->reg_info[i].reg_val
+			|| (cfa_addr == cur_frame->reg_info[i].reg_val
+				&& prev_frame->reg_info[target_core_pc_reg_nr].reg_val
+					== cur_frame->reg_info[target_core_pc_reg_nr].reg_val))
+	{
+		release_frames(p, prev_frame);
+		return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
+	}
+	else
+	{
+		p->nr_unwound_frames++;
+		cur_frame->cfa = cfa_addr;
+		cur_frame->ret_pc = prev_frame->reg_info[target_core_pc_reg_nr].reg_val;
+		/* see if the frame just unwound has already been
+		 * unwound before the target has been single stepped */
+		if (p->stale_frames)
+			prev_frame = reuse_stale_frame(ctx, prev_frame);
+		/* link nodes */
+		cur_frame->older = prev_frame;
+		prev_frame->younger = cur_frame;
+		/* frame successfully unwound */
+		return GEAR_ERR_NO_ERROR;
+	}
+}
+
+/*!
+ *	\fn	static int fallback_frame_unwind(struct gear_engine_context * ctx, struct frame_reg_struct * cur_frame)
+ *	\brief	unwinds a target call stack frame for which there is no call frame information, by means of the target specific fallback frame unwinder
+ *
+ *	see the comments about the unwind_frame field in struct
+ *	target_desc_struct, in target-description.h
+ *
+ *	\param	ctx	context to work in
+ *	\param	cur_frame	the frame to unwind; same as for
+ *				dwarf_frame_unwind()
+ *	\return	same as for dwarf_frame_unwind() */
+static int fallback_frame_unwind(struct gear_engine_context * ctx, struct frame_reg_struct * cur_frame)
+{
+struct tdesc_unwound_reg cur_regs[DWARF_FRAME_MAX_NR_REGS], prev_regs[DWARF_FRAME_MAX_NR_REGS];
+struct frame_data_struct * p;
+struct frame_reg_struct * prev_frame;
+ARM_CORE_WORD cfa_addr;
+bool is_exception_frame;
+int i, nr_target_core_regs;
+
+	p = ctx->frame_data;
+	if (!ctx->tdesc->unwind_frame)
+		return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
+	nr_target_core_regs = ctx->tdesc->get_nr_target_core_regs(ctx);
+	for (i = 0; i < nr_target_core_regs; i++)
+		cur_regs[i] = (struct tdesc_unwound_reg)
+			{ .is_valid = cur_frame->reg_info[i].reg_content_type == ARM_CORE_REG_VALID,
+				.is_stored_in_memory = cur_frame->reg_info[i].is_reg_stored_in_memory,
+				.reg_addr = cur_frame->reg_info[i].reg_addr,
+				.reg_val = cur_frame->reg_info[i].reg_val, };
+	is_exception_frame = false;
+	if (ctx->tdesc->unwind_frame(ctx, cur_regs, prev_regs, &cfa_addr, &is_exception_frame, read_stack_word) != GEAR_ERR_NO_ERROR)
+		return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
+
+	prev_frame = get_frame_reg_struct(ctx);
+	/* the frame interrupted by an exception resumes
+	 * execution at its pc, rather than returning to it */
+	prev_frame->is_pc_exact = is_exception_frame;
+	for (i = 0; i < nr_target_core_regs; i++)
+		prev_frame->reg_info[i] = (struct reg_info_struct)
+				{ .reg_content_type = prev_regs[i].is_valid ? ARM_CORE_REG_VALID : ARM_CORE_REG_UNDEFINED,
+					{ .is_reg_addr_applicable = prev_regs[i].is_stored_in_memory,
+					.is_reg_stored_in_memory = prev_regs[i].is_stored_in_memory, },
+					.reg_addr = prev_regs[i].reg_addr,
+					.reg_val = prev_regs[i].reg_val, };
+	/* make the stack pointer equal to the cfa */
+	i = ctx->tdesc->get_target_sp_reg_nr(ctx);
+	prev_frame->reg_info[i] = (struct reg_info_struct)
+			{ .reg_content_type = ARM_CORE_REG_VALID,
+				{ .is_reg_addr_applicable = 0,
+				.is_reg_stored_in_memory = 0, },
+				.reg_val = cfa_addr };
+	if ((i = link_unwound_frame(ctx, cur_frame, prev_frame, cfa_addr)) == GEAR_ERR_NO_ERROR)
+		p->nr_fallback_unwound_frames++;
+	return i;
+}
+
 /*!
  *	\fn	static int dwarf_frame_unwind(struct gear_engine_context * ctx, struct frame_reg_struct * cur_frame)
  *	\brief	unwinds a target call stack frame
@@ -577,25 +1231,17 @@ int i;
 
 static int dwarf_frame_unwind(struct gear_engine_context * ctx, struct frame_reg_struct * cur_frame)
 {
-/* these variables are unused */
-Dwarf_Addr unused0, unused1;
-Dwarf_Unsigned bytes_in_cie_unused;
-Dwarf_Error err;
-Dwarf_Fde fde;
-Dwarf_Cie cie;
-int res;
-Dwarf_Small cie_version;
-char * cie_augmenter;
-Dwarf_Half ret_addr_column;
-Dwarf_Regtable3 reg_tab;
+struct unwind_rules_struct * rules;
+int ret_addr_column;
+struct dwarf_frame_row * row;
 ARM_CORE_WORD cfa_addr;
 ARM_CORE_WORD reg_addr;
 int i, j;
-unsigned int nbytes;
 struct frame_data_struct * p;
 struct frame_reg_struct * prev_frame;
 int nr_target_core_regs;
 int target_core_pc_reg_nr;
+ARM_CORE_WORD pc;
 /* the translated value of a dwarf register number -
  * mapped from a dwarf register number to a target
  * core controller-ready-to-use register number;
@@ -606,166 +1252,56 @@ int translated_dwarf_regnum;
 	if (!cur_frame || cur_frame->older)
 		panic("");
 	p = ctx->frame_data;
-	if (p->selected_frame_nr >= MAX_NR_FRAMES_TO_UNWIND)
-		panic("");
 
-	/* first, obtain the fde for the pc requested */
+	/* first, obtain the register unwinding rules for the pc requested;
+	 * for frames whose pc is a return address, look them up at the
+	 * address of the calling instruction instead, see the comments
+	 * about the is_pc_exact field of struct frame_reg_struct; thumb
+	 * return addresses have bit 0 set, which must be discarded first -
+	 * otherwise, the address looked up would be the return address
+	 * itself, which may well be past the end of the calling subroutine */
 	target_core_pc_reg_nr = ctx->tdesc->get_target_pc_reg_nr(ctx);
-	res = dwarf_get_fde_at_pc(p->fde_data,
-			(Dwarf_Addr)get_reg_checked(ctx, cur_frame, target_core_pc_reg_nr),
-			&fde,
-			&unused0,
-			&unused1,
-			&err);
-	if (res == DW_DLV_ERROR)
-		panic("dwarf_get_fde_at_pc");
-	if (res == DW_DLV_NO_ENTRY)
-		/* cannot unwind */
-		return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
-
-	/* debugging - dump fde data */
-	{
-	Dwarf_Addr low_pc;
-	Dwarf_Unsigned func_length;
-	Dwarf_Ptr fde_bytes;
-	Dwarf_Unsigned fde_byte_length;
-	Dwarf_Off cie_offset;
-	Dwarf_Signed cie_index;
-	Dwarf_Off fde_offset;
-
-		if (dwarf_get_fde_range(
-			fde,
-			&low_pc,
-			&func_length,
-			&fde_bytes,
-			&fde_byte_length,
-			&cie_offset,
-			&cie_index,
-			&fde_offset,
-			&err) != DW_DLV_OK)
-		panic("");
-
-		printf("%s():\n", __func__);
-		printf("low_pc: 0x%08x\n", (unsigned int) low_pc);
-		printf("func_length: 0x%08x\n", (unsigned int) func_length);
-		printf("cie_offset: 0x%08x\n", (unsigned int) cie_offset);
-		printf("cie_index: 0x%08x\n", (unsigned int) cie_index);
-		printf("fde_offset: 0x%08x\n", (unsigned int) fde_offset);
-		
-	}
+	pc = get_reg_checked(ctx, cur_frame, target_core_pc_reg_nr);
+	if (!cur_frame->is_pc_exact)
+		pc = (pc & ~1) - 1;
+	if (!(rules = get_unwind_rules(ctx, pc)))
+		/* no call frame information for the frame - see if
+		 * the target can unwind it by some other means */
+		return fallback_frame_unwind(ctx, cur_frame);
 
-	/* ok, fde found, get its cie */
-	if (dwarf_get_cie_of_fde(fde, &cie, &err) != DW_DLV_OK)
-		panic("dwarf_get_cie_of_fde");
-	/* validate cie */
-	if (dwarf_get_cie_info(cie,
-			&bytes_in_cie_unused,
-			&cie_version,
-			&cie_augmenter,
-			0,
-			0,
-			&ret_addr_column,
-			0,
-			0,
-			&err) != DW_DLV_OK)
-		panic("dwarf_get_cie_info");
-	if (cie_version != 1)
-		panic("unknown dwarf cie version");
-	if (cie_augmenter && *cie_augmenter)
-		panic("cie augmenter string nonempty, doesnt know what to do");
-	/*!	\todo	maybe support this  
-	if (ret_addr_column != ARM_CORE_LR_REG_NR)
-		panic("unexpected cie return address column, doesnt know what to do");
-		*/
-	/* initialize reg_tab; dont forget to later deallocate the core for the register rules */
 	if (!(nr_target_core_regs = ctx->tdesc->get_nr_target_core_regs(ctx)))
 		panic("");
-	reg_tab.rt3_reg_table_size = nr_target_core_regs;
-
-	if (!(reg_tab.rt3_rules = (struct Dwarf_Regtable_Entry3_s *)
-		malloc(nr_target_core_regs * sizeof(struct Dwarf_Regtable_Entry3_s))))
-		panic("out of core");
-
-	/* the cie looks fine, unwind the registers */
-	if (dwarf_get_fde_info_for_all_regs3(fde,
-			(Dwarf_Addr)get_reg_checked(ctx, cur_frame, target_core_pc_reg_nr),
-			&reg_tab,
-			0,
-			&err) != DW_DLV_OK)
-		panic("dwarf_get_fde_info_for_all_regs3");
+	row = &rules->row;
+	ret_addr_column = row->ret_addr_column;
+
 	/* see if there is enough information to unwind */
 	/* first, compute the cfa address */
-	switch (reg_tab.rt3_cfa_rule.dw_regnum)
+	switch (row->cfa_rule.type)
 	{
-		case DW_FRAME_UNDEFINED_VAL:
-			/* it is by far not known if this is possible at all */
-			panic("");
-			/* no further unwinding possible */
-			/* cleanup */
-			free(reg_tab.rt3_rules);
-			return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
-			break;
-		case DW_FRAME_SAME_VAL:
-			/* it is by far not known if this is possible at all */
-			panic("bad cfa frame unwind information");
+		case DWARF_FRAME_RULE_REGISTER:
+			translated_dwarf_regnum = row->cfa_rule.reg_nr;
+			if (ctx->tdesc->translate_dwarf_reg_nr_to_target_reg_nr(ctx,
+						&translated_dwarf_regnum)
+					!= GEAR_ERR_NO_ERROR
+					|| translated_dwarf_regnum >= nr_target_core_regs)
+				/* bad cfa frame unwind information */
+				return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
+			cfa_addr = cur_frame->reg_info[translated_dwarf_regnum].reg_val + row->cfa_rule.offset;
 			break;
+		case DWARF_FRAME_RULE_VAL_EXPRESSION:
+			/*! \todo	evaluate dwarf expressions here */
 		default:
-			switch (reg_tab.rt3_cfa_rule.dw_value_type)
-			{
-				case DW_EXPR_OFFSET:
-					if (reg_tab.rt3_cfa_rule.dw_offset_relevant)
-					{
-						translated_dwarf_regnum = reg_tab.rt3_cfa_rule.dw_regnum;
-						gprintf("cfa rule: dwarf reg %i\n", translated_dwarf_regnum);
-						if (ctx->tdesc->translate_dwarf_reg_nr_to_target_reg_nr(ctx,
-									&translated_dwarf_regnum)
-								!= GEAR_ERR_NO_ERROR)
-							panic("");
-						gprintf("translated to core reg nr reg %i\n", translated_dwarf_regnum);
-						/* this is correct */
-						if (translated_dwarf_regnum >= nr_target_core_regs)
-							panic("bad cfa frame unwind information");
-						cfa_addr = cur_frame->reg_info[translated_dwarf_regnum].reg_val +
-							reg_tab.rt3_cfa_rule.dw_offset_or_block_len;
-						gprintf("reg_val(core reg %i) + dw_offset_or_block_len == 0x%08x + 0x%08x == cfa_addr == 0x%08x\n",
-								translated_dwarf_regnum,
-								cur_frame->reg_info[translated_dwarf_regnum].reg_val,
-								(ARM_CORE_WORD) reg_tab.rt3_cfa_rule.dw_offset_or_block_len,
-								cfa_addr);
-
-					}
-					else
-						panic("bad cfa frame unwind information");
-					break;
-				case DW_EXPR_VAL_OFFSET:
-					panic("bad cfa frame unwind information");
-					break;
-				case DW_EXPR_EXPRESSION:
-{
-	struct subprogram_data * subp;
-	ARM_CORE_WORD pc;
-	pc = get_reg_checked(ctx, cur_frame, target_core_pc_reg_nr);
-	srcfile_get_srcinfo_for_addr(ctx, pc, 0, &subp, 0, 0, 0);
-	gprintf("%s(): when unwinding for pc 0x%08x, for subprogram %s()\n", __func__, (int) pc, subp->name);
-}
-/*! \todo	fix this here... */
-		return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
-					panic("unsupported frame unwinding rule");
-					break;
-				case DW_EXPR_VAL_EXPRESSION:
-					panic("unsupported frame unwinding rule");
-					break;
-				default:
-					panic("");
-					break;
-			}
-			break;
+			/* no further unwinding possible */
+			return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
 	}
 
 	/* the cfa address is now known, now unwind other registers */
 	/* get a new frame register data structure and make
 	 * the registers' values undefined by default */
 	prev_frame = get_frame_reg_struct(ctx);
+	/* the frame interrupted by a signal handler resumes
+	 * execution at its pc, rather than returning to it */
+	prev_frame->is_pc_exact = row->is_signal_frame;
 	/* by default, copy the older frame's register
 	 * values into the younger's frame registers
 	 * for callee saved registers, and make callee destroyed
@@ -789,120 +1325,73 @@ int translated_dwarf_regnum;
 
 	for (i = 0; i < nr_target_core_regs; i++)
 	{
-		switch (reg_tab.rt3_rules[i].dw_regnum)
+		/* handle special register numbers */
+		if (i == ret_addr_column)
+			/* currently handling the program counter
+			 * (return address) register number */
+			translated_dwarf_regnum = target_core_pc_reg_nr;
+		else if (i == target_core_pc_reg_nr)
+			/* setting the program counter is devoid of meaning;
+			 * it *must* equal the dwarf program return address
+			 * column value */
+			continue;
+		else
 		{
-			case DW_FRAME_UNDEFINED_VAL:
-				break;
-			case DW_FRAME_SAME_VAL:
-				gprintf("register rule DW_FRAME_SAME_VAL for register %i\n", i);
+			/* non-special registers */
+			translated_dwarf_regnum = i;
+			if (ctx->tdesc->translate_dwarf_reg_nr_to_target_reg_nr(ctx,
+						&translated_dwarf_regnum)
+					!= GEAR_ERR_NO_ERROR)
+				panic("");
+		}
 
-				/* handle special register numbers */
-				if (i == ret_addr_column)
-				{
-					/* currently handling the program counter
-					 * (return address) register number */
-					TRACE();
-					translated_dwarf_regnum = target_core_pc_reg_nr;
-				}
-				else if (i == target_core_pc_reg_nr)
-					/* setting the program counter is devoid of meaning;
-					 * it *must* equal the dwarf program return address
-					 * column value */
-					continue;
-				else
+		switch (row->rules[i].type)
+		{
+			case DWARF_FRAME_RULE_UNDEFINED:
+				break;
+			case DWARF_FRAME_RULE_SAME_VALUE:
+				prev_frame->reg_info[translated_dwarf_regnum] = cur_frame->reg_info[i];
+				break;
+			case DWARF_FRAME_RULE_OFFSET:
+				reg_addr = cfa_addr + row->rules[i].offset;
+				prev_frame->reg_info[translated_dwarf_regnum] = (struct reg_info_struct)
+						{ .reg_content_type = ARM_CORE_REG_VALID,
+							{ .is_reg_addr_applicable = 1,
+							.is_reg_stored_in_memory = 1, },
+							.reg_addr = reg_addr };
+				if (read_stack_word(ctx, reg_addr,
+							&prev_frame->reg_info[translated_dwarf_regnum].reg_val) != GEAR_ERR_NO_ERROR)
 				{
-					/* non-special registers */
-					translated_dwarf_regnum = i;
-					if (ctx->tdesc->translate_dwarf_reg_nr_to_target_reg_nr(ctx,
-								&translated_dwarf_regnum)
-							!= GEAR_ERR_NO_ERROR)
-						panic("");
+					gprintf("error reading target memory at address 0x%08x\n", (unsigned int) reg_addr);
+					release_frames(p, prev_frame);
+					return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
 				}
-
-				prev_frame->reg_info[translated_dwarf_regnum] = cur_frame->reg_info[i];
 				break;
-			default:
-				switch (reg_tab.rt3_rules[i].dw_value_type)
+			case DWARF_FRAME_RULE_VAL_OFFSET:
+				prev_frame->reg_info[translated_dwarf_regnum] = (struct reg_info_struct)
+						{ .reg_content_type = ARM_CORE_REG_VALID,
+							{ .is_reg_addr_applicable = 0,
+							.is_reg_stored_in_memory = 0, },
+							.reg_val = cfa_addr + row->rules[i].offset };
+				break;
+			case DWARF_FRAME_RULE_REGISTER:
+				j = row->rules[i].reg_nr;
+				if (ctx->tdesc->translate_dwarf_reg_nr_to_target_reg_nr(ctx,
+							&j)
+						!= GEAR_ERR_NO_ERROR
+						|| j >= nr_target_core_regs)
 				{
-					case DW_EXPR_OFFSET:
-						if (reg_tab.rt3_rules[i].dw_offset_relevant)
-						{
-							gprintf("register number (%i) for rule DW_EXPR_OFFSET when unwinding register r%i\n", (int) reg_tab.rt3_rules[i].dw_regnum, i);
-							if (reg_tab.rt3_rules[i].dw_regnum != DW_FRAME_CFA_COL3)
-							{
-								gprintf("bad register number (%i) for rule DW_EXPR_OFFSET when unwinding register r%i\n", (int) reg_tab.rt3_rules[i].dw_regnum, i);
-								panic("bad cfa frame unwind information");
-							}
-							reg_addr = cfa_addr + reg_tab.rt3_rules[i].dw_offset_or_block_len;
-							gprintf("register %i: rule DW_EXPR_OFFSET, cfa_addr == 0x%08x, dw_offset_or_block_len == 0x%08x, reg_addr == 0x%08x\n", i, cfa_addr, (unsigned int) reg_tab.rt3_rules[i].dw_offset_or_block_len, reg_addr);
-							/* handle special register numbers */
-							if (i == ret_addr_column)
-							{
-								/* currently handling the program counter
-								 * (return address) register number */
-								TRACE();
-								translated_dwarf_regnum = target_core_pc_reg_nr;
-							}
-							else
-							{
-								/* non-special registers */
-								translated_dwarf_regnum = i;
-								if (ctx->tdesc->translate_dwarf_reg_nr_to_target_reg_nr(ctx,
-											&translated_dwarf_regnum)
-										!= GEAR_ERR_NO_ERROR)
-									panic("");
-							}
-							prev_frame->reg_info[translated_dwarf_regnum] = (struct reg_info_struct)
-									{ .reg_content_type = ARM_CORE_REG_VALID,
-										{ .is_reg_addr_applicable = 1,
-										.is_reg_stored_in_memory = 1, },
-										.reg_addr = reg_addr };
-							nbytes = sizeof(ARM_CORE_WORD);
-							if (ctx->cc->core_mem_read(ctx,
-										&prev_frame->reg_info[translated_dwarf_regnum].reg_val,
-										reg_addr, &nbytes) != GEAR_ERR_NO_ERROR
-									|| nbytes != sizeof(ARM_CORE_WORD))
-							{
-								printf("\n\n\nerror reading target memory at address 0x%08x\n\n\n", (unsigned int) reg_addr);
-								panic("");
-							}
-						}
-						else
-						{
-							panic("no test cases observed in detail - please inspect this carefully\n");
-							gprintf("register rule DW_EXPR_OFFSET offset not relevant for register %i\n", i);
-
-							translated_dwarf_regnum = i;
-							j = reg_tab.rt3_rules[i].dw_regnum;
-							if (ctx->tdesc->translate_dwarf_reg_nr_to_target_reg_nr(ctx,
-										&translated_dwarf_regnum)
-									!= GEAR_ERR_NO_ERROR)
-								panic("");
-							if (ctx->tdesc->translate_dwarf_reg_nr_to_target_reg_nr(ctx,
-										&j)
-									!= GEAR_ERR_NO_ERROR)
-								panic("");
-							prev_frame->reg_info[translated_dwarf_regnum] = cur_frame->reg_info[j];
-
-						}
-						break;
-					case DW_EXPR_VAL_OFFSET:
-						if (reg_tab.rt3_rules[i].dw_offset_relevant)
-						{
-							prev_frame->reg_info[i].reg_val = cfa_addr + reg_tab.rt3_rules[i].dw_offset_or_block_len;
-							panic("");
-						}
-						else
-							panic("unsupported frame unwinding rule");
-						break;
-					case DW_EXPR_EXPRESSION:
-						panic("unsupported frame unwinding rule");
-						break;
-					case DW_EXPR_VAL_EXPRESSION:
-						panic("unsupported frame unwinding rule");
-						break;
+					release_frames(p, prev_frame);
+					return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
 				}
+				prev_frame->reg_info[translated_dwarf_regnum] = cur_frame->reg_info[j];
 				break;
+			case DWARF_FRAME_RULE_EXPRESSION:
+			case DWARF_FRAME_RULE_VAL_EXPRESSION:
+			default:
+				/*! \todo	evaluate dwarf expressions here */
+				release_frames(p, prev_frame);
+				return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
 		}
 	}
 
@@ -927,27 +1416,7 @@ int translated_dwarf_regnum;
 				.reg_val = prev_frame->reg_info[ret_addr_column].reg_val};
 #endif
 
-	free(reg_tab.rt3_rules);
-	/* if the program counter for this frame is invalid - say that
-	 * the unwinding failed; gcc 4.5.2 has been observed to generate
-	 * some garbage fdes... */
-	if (prev_frame->reg_info[target_core_pc_reg_nr].reg_content_type != ARM_CORE_REG_VALID)
-	{
-		free(prev_frame);
-		return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
-	}
-	else
-	{
-
-		cur_frame->cfa = cfa_addr;
-		cur_frame->ret_pc = prev_frame->reg_info[ret_addr_column].reg_val;
-		/* link nodes */
-		cur_frame->older = prev_frame;
-		prev_frame->younger = cur_frame;
-		/* frame successfully unwound */
-		return GEAR_ERR_NO_ERROR;
-	}
-
+	return link_unwound_frame(ctx, cur_frame, prev_frame, cfa_addr);
 }
 
 
@@ -965,8 +1434,9 @@ int translated_dwarf_regnum;
  *	\param	buffer	a buffer to hold the registers read
  *	\return	GEAR_ERR_NO_ERROR on success, \todo	define other error codes here
  *
- *	\todo	decide what to do about registers holding undefined values
- *		(ARM_CORE_REG_UNDEFINED)
+ *	\note	the values read for registers holding undefined values
+ *		(ARM_CORE_REG_UNDEFINED) are meaningless; callers that
+ *		care should check frame_reg_cache_is_reg_defined()
  */
 static enum GEAR_ENGINE_ERR_ENUM reg_cache_core_reg_read(struct gear_engine_context * ctx, unsigned mode, unsigned long mask, ARM_CORE_WORD buffer[])
 {
@@ -1102,12 +1572,155 @@ int nr_target_core_regs;
 }
 
 
+/*!
+ *	\fn	static void build_innermost_frame(struct gear_engine_context * ctx, ARM_CORE_WORD * regs)
+ *	\brief	creates the register cache, consisting of the innermost (most recent) frame only
+ *
+ *	\param	ctx	context to work in
+ *	\param	regs	the values of all of the target core registers
+ *	\return	none
+ */
+static void build_innermost_frame(struct gear_engine_context * ctx, ARM_CORE_WORD * regs)
+{
+struct frame_data_struct * p;
+struct frame_reg_struct * r0;
+int i;
+int nr_target_core_regs;
+
+	p = ctx->frame_data;
+	r0 = get_frame_reg_struct(ctx);
+	nr_target_core_regs = ctx->tdesc->get_nr_target_core_regs(ctx);
+	for (i = 0; i < nr_target_core_regs; i++)
+	{
+		r0->reg_info[i] = (struct reg_info_struct)
+			{ .reg_content_type = ARM_CORE_REG_VALID,
+				{ .is_reg_addr_applicable = 1,
+				.is_reg_stored_in_memory = 0,
+				},
+			.reg_addr = i,
+			.reg_val = regs[i],
+			};
+	}
+	r0->is_pc_exact = true;
+	p->frame_list = p->selected_frame = r0;
+	/* make the innermost (most recent) frame the active one */
+	p->selected_frame_nr = 0;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM reg_cache_core_get_halt_snapshot(struct gear_engine_context * ctx, struct core_halt_snapshot * snapshot)
+ *	\brief	local override for the general ctx->cc->core_get_halt_snapshot() routine
+ *
+ *	if the target has just halted, and all of the target core
+ *	registers are present in the snapshot, the register cache
+ *	is created from the snapshot, so that the register cache
+ *	target state change callback need not read the target
+ *	core registers again
+ *
+ *	\param	ctx	context to work in
+ *	\param	snapshot	the halt snapshot to retrieve
+ *	\return	the status code of the overridden routine
+ */
+static enum GEAR_ENGINE_ERR_ENUM reg_cache_core_get_halt_snapshot(struct gear_engine_context * ctx, struct core_halt_snapshot * snapshot)
+{
+struct frame_data_struct * p;
+enum GEAR_ENGINE_ERR_ENUM err;
+unsigned long all_regs_mask;
+
+	p = ctx->frame_data;
+	err = p->core_get_halt_snapshot_prev(ctx, snapshot);
+	if (err != GEAR_ERR_NO_ERROR || snapshot->state != TARGET_CORE_STATE_HALTED || p->frame_list)
+		return err;
+	all_regs_mask = (1 << ctx->tdesc->get_nr_target_core_regs(ctx)) - 1;
+	if ((snapshot->reg_mask & all_regs_mask) == all_regs_mask)
+		/* as the snapshot register mask contains all of the target
+		 * core registers, their values are stored in register
+		 * number order at the start of the register values array */
+		build_innermost_frame(ctx, snapshot->regs);
+	return err;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM reg_cache_core_mem_write(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes)
+ *	\brief	local override for the general ctx->cc->core_mem_write() routine
+ *
+ *	this is here to keep the prefetched target stack contents
+ *	coherent with target memory, e.g. when a register saved on
+ *	the target stack is written by reg_cache_core_reg_write();
+ *	on success, the prefetched bytes overlapping the bytes written
+ *	are updated, otherwise, all of the prefetched bytes are discarded;
+ *	the frames unwound before the target has been single stepped
+ *	are discarded in any case, as they may no longer be reused
+ *
+ *	\param	ctx	context to work in
+ *	\param	dest	the target memory address to write to
+ *	\param	source	the buffer holding the bytes to write
+ *	\param	nbytes	on entry - the number of bytes to write; on
+ *			exit - the number of bytes actually written
+ *	\return	the status code of the overridden routine
+ */
+static enum GEAR_ENGINE_ERR_ENUM reg_cache_core_mem_write(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes)
+{
+struct frame_data_struct * p;
+enum GEAR_ENGINE_ERR_ENUM err;
+unsigned long long start, end;
+
+	p = ctx->frame_data;
+	err = p->core_mem_write_prev(ctx, dest, source, nbytes);
+	release_frames(p, p->stale_frames);
+	p->stale_frames = 0;
+	if (!p->stack_prefetch.len)
+		return err;
+	if (err != GEAR_ERR_NO_ERROR)
+	{
+		p->stack_prefetch.len = 0;
+		return err;
+	}
+	start = (dest > p->stack_prefetch.addr) ? dest : p->stack_prefetch.addr;
+	end = (unsigned long long) dest + * nbytes;
+	if (end > (unsigned long long) p->stack_prefetch.addr + p->stack_prefetch.len)
+		end = (unsigned long long) p->stack_prefetch.addr + p->stack_prefetch.len;
+	if (start < end)
+		memcpy(p->stack_prefetch.buf + (start - p->stack_prefetch.addr),
+				(const unsigned char *) source + (start - dest), end - start);
+	return err;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM reg_cache_core_insn_step(struct gear_engine_context * ctx)
+ *	\brief	local override for the general ctx->cc->core_insn_step() routine
+ *
+ *	this is here to let the register cache target state change
+ *	callback know that the target is being single stepped, so
+ *	that the frames unwound so far are kept for reuse when
+ *	the target halts again; stepping that is performed by
+ *	setting breakpoints and running the target is announced by
+ *	frame_reg_cache_keep_frames_on_resume() instead; see the
+ *	comments about the stale_frames field in struct frame_data_struct
+ *
+ *	\param	ctx	context to work in
+ *	\return	the status code of the overridden routine
+ */
+static enum GEAR_ENGINE_ERR_ENUM reg_cache_core_insn_step(struct gear_engine_context * ctx)
+{
+struct frame_data_struct * p;
+enum GEAR_ENGINE_ERR_ENUM err;
+
+	p = ctx->frame_data;
+	p->must_keep_frames_on_resume = true;
+	err = p->core_insn_step_prev(ctx);
+	p->must_keep_frames_on_resume = false;
+	return err;
+}
+
 /*!
  *	\fn	static bool frame_reg_cache_target_state_change_callback(struct gear_engine_context * ctx, enum TARGET_CORE_STATE_ENUM state)
  *	\brief	the register cache target state change callback
  *
  *	this routine determines if, depending on the new target state,
- *	the register cache should be created/destroyed
+ *	the register cache should be created/destroyed; when the
+ *	target is stepped, the frames unwound so far are
+ *	kept for reuse, instead of being destroyed
  *
  *	\param	ctx	context to work in
  *	\param	state	the new target state (may actually be the
@@ -1119,10 +1732,9 @@ int nr_target_core_regs;
 static bool frame_reg_cache_target_state_change_callback(struct gear_engine_context * ctx, enum TARGET_CORE_STATE_ENUM state)
 {
 struct frame_data_struct * p;
-struct frame_reg_struct * r0, * r1;
-int i;
 int nr_target_core_regs;
 ARM_CORE_WORD * regs;
+bool must_keep_frames;
 
 	p = ctx->frame_data;
 
@@ -1131,55 +1743,57 @@ ARM_CORE_WORD * regs;
 		case TARGET_CORE_STATE_DEAD:
 		case TARGET_CORE_STATE_RUNNING:
 			/* destroy the register cache (if appropriate) */
-			r0 = p->frame_list;
-			if (!r0)
-				break;
-			do
+			must_keep_frames = p->must_keep_frames_on_resume;
+			p->must_keep_frames_on_resume = false;
+			if (!p->frame_list)
 			{
-				r1 = r0->older;
-				free(r0);
-				r0 = r1;
+				/* the frames kept for reuse do not
+				 * outlive the target core */
+				if (state == TARGET_CORE_STATE_DEAD)
+				{
+					release_frames(p, p->stale_frames);
+					p->stale_frames = 0;
+				}
+				break;
 			}
-			while (r0);
+			release_frames(p, p->stale_frames);
+			p->stale_frames = 0;
+			if (state == TARGET_CORE_STATE_RUNNING && must_keep_frames)
+				p->stale_frames = p->frame_list;
+			else
+				release_frames(p, p->frame_list);
 			p->frame_list = p->selected_frame = 0;
 			p->selected_frame_nr = -1;
+			p->stack_prefetch.len = 0;
 			break;
 		case TARGET_CORE_STATE_HALTED:
 			/* create the register cache (if appropriate) */
-			if (p->frame_list)
-				/* nothing to do */
-				break;
-			r0 = get_frame_reg_struct(ctx);
-			if (!(nr_target_core_regs = ctx->tdesc->get_nr_target_core_regs(ctx)))
-				panic("");
-			if (!(regs = malloc(sizeof(ARM_CORE_WORD[nr_target_core_regs]))))
-				panic("");
-			if (p->core_reg_read_prev(ctx,
-					0,
-					(1 << nr_target_core_regs) - 1,
-					regs) != GEAR_ERR_NO_ERROR)
-				panic("");
-			for (i = 0; i < nr_target_core_regs; i++)
+			if (!p->frame_list)
 			{
-				r0->reg_info[i] = (struct reg_info_struct)
-					{ .reg_content_type = ARM_CORE_REG_VALID,
-						{ .is_reg_addr_applicable = 1,
-						.is_reg_stored_in_memory = 0,
-						},
-					.reg_addr = i,
-					.reg_val = regs[i],
-					};
+				/* most probably, the register cache has already been
+				 * created from the halt snapshot, see
+				 * reg_cache_core_get_halt_snapshot(); if not - do it now */
+				if (!(nr_target_core_regs = ctx->tdesc->get_nr_target_core_regs(ctx)))
+					panic("");
+				if (!(regs = malloc(sizeof(ARM_CORE_WORD[nr_target_core_regs]))))
+					panic("");
+				if (p->core_reg_read_prev(ctx,
+						0,
+						(1 << nr_target_core_regs) - 1,
+						regs) != GEAR_ERR_NO_ERROR)
+					panic("");
+				build_innermost_frame(ctx, regs);
+				free(regs);
 			}
-			free(regs);
-			p->frame_list = p->selected_frame = r0;
-			/* make the innermost (most recent) frame the active one */
-			p->selected_frame_nr = 0;
+			if (!p->stack_prefetch.len)
+				prefetch_stack(ctx);
 			break;
 		default:
 			panic("");
 	}
 	return true;
 }
+
 /*
  *
  * exported functions follow
@@ -1252,10 +1866,10 @@ bool move_to_older;
 				{
 					/* see if the stack unwinding
 					 * has gone too far */
-					if (p->selected_frame_nr == MAX_NR_FRAMES_TO_UNWIND)
+					if (p->selected_frame_nr + 1 >= ctx->settings.frame_unwind_limit)
 					{
 						/* do not unwind more */
-						gprintf("warning: attempted to unwind more than %i target call stack frames, giving up\n", MAX_NR_FRAMES_TO_UNWIND);
+						gprintf("warning: attempted to unwind more than %i target call stack frames, giving up\n", ctx->settings.frame_unwind_limit);
 						return GEAR_ERR_CANT_UNWIND_STACK_FRAME;
 					}
 					/* must unwind */
@@ -1291,6 +1905,80 @@ bool move_to_older;
 	return res;
 }
 
+/*!
+ *	\fn	void frame_reg_cache_keep_frames_on_resume(struct gear_engine_context * ctx)
+ *	\brief	requests that the target call stack frames unwound so far be kept for reuse when the target is next resumed
+ *
+ *	this is to be called just before resuming the target for
+ *	stepping it (e.g. by setting breakpoints and running the
+ *	target), so that the frames unwound so far are not destroyed
+ *	when the target starts running, but are kept for reuse when
+ *	the target halts again; the request only applies to the very
+ *	next time the target is resumed; see the comments about the
+ *	stale_frames field in struct frame_data_struct
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void frame_reg_cache_keep_frames_on_resume(struct gear_engine_context * ctx)
+{
+	ctx->frame_data->must_keep_frames_on_resume = true;
+}
+
+/*!
+ *	\fn	bool frame_reg_cache_is_reg_defined(struct gear_engine_context * ctx, int reg_nr)
+ *	\brief	determines if a target core register has a known value in the currently selected frame
+ *
+ *	registers that the callee does not preserve, or that the
+ *	unwind information does not describe, have undefined values
+ *	in frames other than the innermost one (see the comments about
+ *	the reg_content_type field of struct reg_info_struct); the
+ *	values that ctx->cc->core_reg_read() returns for such registers
+ *	are meaningless, and must not be used
+ *
+ *	\param	ctx	context to work in
+ *	\param	reg_nr	the target core register number of the register
+ *	\return	true, if the value of the register in the currently
+ *		selected frame is known, or if the register cache is not
+ *		active, false otherwise */
+bool frame_reg_cache_is_reg_defined(struct gear_engine_context * ctx, int reg_nr)
+{
+struct frame_data_struct * p;
+
+	p = ctx->frame_data;
+	if (!p->frame_list)
+		return true;
+	if (reg_nr >= ctx->tdesc->get_nr_target_core_regs(ctx))
+		panic("");
+	return p->selected_frame->reg_info[reg_nr].reg_content_type == ARM_CORE_REG_VALID;
+}
+
+/*!
+ *	\fn	void frame_reg_cache_dump_stats_mi(struct gear_engine_context * ctx)
+ *	\brief	dumps target stack prefetch, call frame information, register unwinding rules cache and frame unwinding statistics, in machine interface format
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void frame_reg_cache_dump_stats_mi(struct gear_engine_context * ctx)
+{
+struct frame_data_struct * p;
+
+	p = ctx->frame_data;
+	miprintf("STACK_PREFETCH = [MIN_SIZE = %u, NR_FRAMES = %i, PREFETCHED_BYTES = %u, "
+			"PREFETCHES = %i, HITS = %i, MISSES = %i,],",
+			ctx->settings.stack_prefetch_size, ctx->settings.stack_prefetch_nr_frames,
+			p->stack_prefetch.len,
+			p->stack_prefetch.nr_prefetches, p->stack_prefetch.nr_hits, p->stack_prefetch.nr_misses);
+	dwarf_frame_dump_stats_mi(p->cfi);
+	miprintf("UNWIND_RULES = [CACHE_SIZE = %i, HITS = %i, MISSES = %i,],",
+			NR_CACHED_UNWIND_RULES,
+			p->unwind_rules.nr_hits, p->unwind_rules.nr_misses);
+	miprintf("FRAMES = [LIMIT = %i, UNWOUND = %i, REUSED = %i, FALLBACK_UNWOUND = %i,],",
+			ctx->settings.frame_unwind_limit,
+			p->nr_unwound_frames, p->nr_reused_frames, p->nr_fallback_unwound_frames);
+}
+
 /*!
  *	\fn	void init_frame_reg_cache(struct gear_engine_context * ctx)
  *	\brief	initializes the dwarf frame access engine
@@ -1312,11 +2000,10 @@ bool move_to_older;
  */
 void init_frame_reg_cache(struct gear_engine_context * ctx)
 {
-Dwarf_Error err;
-Dwarf_Half dwhalf;
-int res;
 struct frame_data_struct * p;
 int nr_target_core_regs;
+struct unwind_rules_struct * r;
+int i;
 
 	/* allocate the private visible data in the current gear engine context */
 	if (!(p = calloc(1, sizeof * p)))
@@ -1327,7 +2014,11 @@ int nr_target_core_regs;
 	/* install register access override hooks */
 	p->core_reg_read_prev = ctx->cc->core_reg_read;
 	p->core_reg_write_prev = ctx->cc->core_reg_write;
-	if (!p->core_reg_read_prev || !p->core_reg_write_prev)
+	p->core_get_halt_snapshot_prev = ctx->cc->core_get_halt_snapshot;
+	p->core_mem_write_prev = ctx->cc->core_mem_write;
+	p->core_insn_step_prev = ctx->cc->core_insn_step;
+	if (!p->core_reg_read_prev || !p->core_reg_write_prev || !p->core_get_halt_snapshot_prev
+			|| !p->core_mem_write_prev)
 		panic("");
 	/* install the target state change callback */
 	if (ctx->cc->core_register_target_state_change_callback(ctx,
@@ -1336,103 +2027,27 @@ int nr_target_core_regs;
 
 	ctx->cc->core_reg_read = reg_cache_core_reg_read;
 	ctx->cc->core_reg_write = reg_cache_core_reg_write;
-
-	if (dwarf_get_fde_list(ctx->dbg,
-			&p->cie_data,
-			&p->cie_element_count,
-			&p->fde_data,
-			&p->fde_element_count,
-			&err) != DW_DLV_OK)
-		panic("dwarf_get_fde_list");
-
-	/* initialize the special libdwarf register numbers corresponding to
-	 * frame unwinding rules for dwarf unwinding rules 'undefined',
-	 * 'same value', 'offset(n)' - information about these rules
-	 * is passed by libdwarf using the special register number values
-	 * DW_FRAME_UNDEFINED_VAL, DW_FRAME_SAME_VAL, and
-	 * DW_FRAME_CFA_COL3 - the exact values for these registers
-	 * is adjustable at run time as of libdwarf-20090510 (or so);
-	 * set these register values here; this is obviously more flexible
-	 * than having the values hard-coded to some arbitrary constants,
-	 * large enough so that they do not equal any valid target
-	 * dwarf register; for more information, see the libdwarf
-	 * documentation
-	 *
-	 * follows a verbatim excerpt from the libdwarf-20090716 release
-	 * to make things more clear
-	 *
-	 * \todo	is copying source from libdwarf here violating
-	 *		something??? */
-
-#if 0 /* start of libdwarf-20090716 excerpt - clarification purposes */
-
-/* Taken as meaning 'undefined value', this is not
-   a column or register number.
-   Only present at libdwarf runtime. Never on disk.
-   DW_FRAME_* Values present on disk are in dwarf.h
-   Ensure this is > DW_REG_TABLE_SIZE.
-*/
-#define DW_FRAME_UNDEFINED_VAL          1034
-
-/* Taken as meaning 'same value' as caller had, not a column
-   or register number
-   Only present at libdwarf runtime. Never on disk.
-   DW_FRAME_* Values present on disk are in dwarf.h
-   Ensure this is > DW_REG_TABLE_SIZE.
-*/
-#define DW_FRAME_SAME_VAL               1035
-
-/* For DWARF3 interfaces, make the CFA a column with no
-   real table number.  This is what should have been done
-   for the DWARF2 interfaces.  This actually works for
-   both DWARF2 and DWARF3, but see the libdwarf documentation
-   on Dwarf_Regtable3 and  dwarf_get_fde_info_for_reg3()
-   and  dwarf_get_fde_info_for_all_regs3()  
-   Do NOT use this with the older dwarf_get_fde_info_for_reg()
-   or dwarf_get_fde_info_for_all_regs() consumer interfaces.
-   Must be higher than any register count for *any* ABI.
-   (an unfortunate consequence of a lack of any way
-   to set it at run time).
-*/
-#define DW_FRAME_CFA_COL3               1436
-
-#endif /* end of libdwarf-20090716 excerpt - clarification purposes */
-	/*! \todo	careful with setting these - these should work
-	 *		for any architecture currently supported, but
-	 *		be careful if adding a target with a (very)
-	 *		large register set */
-	dwhalf = dwarf_set_frame_undefined_value(ctx->dbg, DW_FRAME_UNDEFINED_VAL);
-	gprintf("previous dwarf frame unwinder UNDEFINED register number value: 0x%x\n", dwhalf);
-	dwhalf = dwarf_set_frame_same_value(ctx->dbg, DW_FRAME_SAME_VAL);
-	gprintf("previous dwarf frame unwinder SAME VALUE register number value: 0x%x\n", dwhalf);
-	dwhalf = dwarf_set_frame_cfa_value(ctx->dbg, DW_FRAME_CFA_COL3);
-	gprintf("previous dwarf frame unwinder CFA register number value: 0x%x\n", dwhalf);
-
-	/* initialize default register rules for stack unwinding */
-	res = dwarf_set_frame_rule_inital_value(ctx->dbg, DW_FRAME_UNDEFINED_VAL);
-	res = dwarf_set_frame_rule_inital_value(ctx->dbg, DW_FRAME_SAME_VAL);
-	gprintf("previos initial frame rule: ");
-	switch (res)
-	{
-		case DW_FRAME_SAME_VAL:
-			gprintf("DW_FRAME_SAME_VAL");
-			break;
-		case DW_FRAME_UNDEFINED_VAL:
-			gprintf("DW_FRAME_UNDEFINED_VAL");
-			break;
-		default:
-			gprintf("unknown");
-	}
-	/*! set the register rule table size
-	 *
-	 * \todo	this may be very wrong, it doesnt handle floating
-	 *		point registers at all; fix it when i(sgs) start coding
-	 *		the floating point support
-	 */
+	ctx->cc->core_get_halt_snapshot = reg_cache_core_get_halt_snapshot;
+	ctx->cc->core_mem_write = reg_cache_core_mem_write;
+	/* the target may not support single stepping natively */
+	if (p->core_insn_step_prev)
+		ctx->cc->core_insn_step = reg_cache_core_insn_step;
+
+	/* read the call frame information of the executable */
+	p->cfi = dwarf_frame_init(ctx);
+	/*! \todo	this doesnt handle floating point registers at all;
+	 *		fix it when i(sgs) start coding the floating point support */
 	if (!(nr_target_core_regs = ctx->tdesc->get_nr_target_core_regs(ctx)))
 		panic("");
-	res = dwarf_set_frame_rule_table_size(ctx->dbg, nr_target_core_regs);
-	gprintf("previous frame rule table size: %i\n", res);
+	if (nr_target_core_regs > DWARF_FRAME_MAX_NR_REGS)
+		panic("too many target core registers for the frame unwinder");
+
+	/* create the register unwinding rules cache */
+	if (!(r = calloc(NR_CACHED_UNWIND_RULES, sizeof * r)))
+		panic("");
+	for (i = 0; i < NR_CACHED_UNWIND_RULES; i++)
+		r[i].next = (i == NR_CACHED_UNWIND_RULES - 1) ? 0 : r + i + 1;
+	p->unwind_rules.mru = r;
 
 	gprintf("ok, dwarf frame processing module initialized\n");
 }
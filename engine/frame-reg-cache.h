@@ -22,5 +22,8 @@
  */
 
 enum GEAR_ENGINE_ERR_ENUM frame_move_to_relative(struct gear_engine_context * ctx, int amount, int * selected_frame_nr);
+void frame_reg_cache_dump_stats_mi(struct gear_engine_context * ctx);
+void frame_reg_cache_keep_frames_on_resume(struct gear_engine_context * ctx);
+bool frame_reg_cache_is_reg_defined(struct gear_engine_context * ctx, int reg_nr);
 void init_frame_reg_cache(struct gear_engine_context * ctx);
 
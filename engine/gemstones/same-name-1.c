@@ -0,0 +1,11 @@
+/* the second compilation unit for same-name.c, see symtab-test.c */
+
+struct point { int x, y; };
+struct point point1;
+
+enum color { red, green, blue };
+enum color color1;
+
+struct list { struct list * next; int data; } list1;
+
+int counter;
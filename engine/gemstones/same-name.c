@@ -0,0 +1,17 @@
+/* data objects and data types of the same name, see symtab-test.c */
+
+struct point { int x, y; };
+typedef struct point point_t;
+struct point point;
+
+enum color { red, green, blue } color;
+
+typedef int counter;
+counter c0;
+
+struct list { struct list * next; int data; } list;
+
+int main(void)
+{
+	return point.x + color + c0 + list.data;
+}
@@ -0,0 +1,297 @@
+/*!
+ *	\file	image-mem-test.c
+ *	\brief	image-backed target memory test
+ *	\author	shopov
+ *
+ *	this is a test program for the image-backed target memory
+ *	(see image-mem.c); it works on any executable having at least
+ *	one loadable non-writable program segment, e.g. one built from
+ *	gemstones/same-name.c and gemstones/same-name-1.c, by
+ *	'make image-mem-test-run'; the target is simulated by a memory
+ *	buffer holding a copy of the first such program segment, which
+ *	can then be overwritten, as if some other image got flashed
+ *
+ *	the test checks that:
+ *		- after the executable being debugged has been loaded in
+ *		the target, reads from its program segments are served
+ *		from the executable, without accessing the target
+ *		- after some other image has been loaded in the target,
+ *		reads return the target memory contents, and not the stale
+ *		contents of the executable - with and without program
+ *		segment verification enabled
+ *		- after some other image, which matches the executable,
+ *		has been loaded in the target, the program segments are
+ *		verified, and are then used again
+ *
+ *	the exit status is zero if all checks pass, and nonzero otherwise
+ *
+ *	Revision summary:
+ *
+ *	$Log: $
+ */
+
+/*
+ *
+ * include section follows
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <libelf.h>
+#include <gelf.h>
+
+int gprintf(const char * format, ...);
+
+#include "dwarf-common.h"
+#include "target-defs.h"
+#include "gear-engine-context.h"
+#include "engine-err.h"
+#include "core-access.h"
+#include "util.h"
+#include "image-mem.h"
+
+#ifndef O_BINARY
+#define O_BINARY	0
+#endif
+
+
+/*
+ *
+ * local definitions follow
+ *
+ */
+
+/*! the number of bytes read in a single check */
+#define READ_SIZE	4
+
+/*! the number of checks failed */
+static int nr_failures;
+
+/*! the simulated target memory, holding a copy of a program segment of the executable */
+static unsigned char * target_mem;
+/*! the address and size of the simulated target memory */
+static ARM_CORE_WORD target_mem_addr;
+static unsigned target_mem_size;
+/*! the number of reads of the simulated target memory so far */
+static int nr_target_reads;
+
+
+/*
+ *
+ * local functions follow
+ *
+ */
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM target_mem_read(struct gear_engine_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes)
+ *	\brief	reads the simulated target memory; installed as ctx->cc->core_mem_read()
+ *
+ *	\param	ctx	gear engine context
+ *	\param	dest	the buffer to store the bytes read in
+ *	\param	source	the target memory address to read from
+ *	\param	nbytes	the number of bytes to read
+ *	\return	the status code of the memory read
+ */
+static enum GEAR_ENGINE_ERR_ENUM target_mem_read(struct gear_engine_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes)
+{
+	nr_target_reads ++;
+	if (source < target_mem_addr || source - target_mem_addr > target_mem_size
+			|| * nbytes > target_mem_size - (source - target_mem_addr))
+		return GEAR_ERR_GENERIC_ERROR;
+	memcpy(dest, target_mem + (source - target_mem_addr), * nbytes);
+	return GEAR_ERR_NO_ERROR;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM target_mem_write(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes)
+ *	\brief	stub for the ctx->cc->core_mem_write() routine; never invoked
+ *
+ *	\return	always GEAR_ERR_GENERIC_ERROR
+ */
+static enum GEAR_ENGINE_ERR_ENUM target_mem_write(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes)
+{
+	return GEAR_ERR_GENERIC_ERROR;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM register_state_change_callback(struct gear_engine_context * ctx, bool (*callback)(struct gear_engine_context * ctx, enum TARGET_CORE_STATE_ENUM state))
+ *	\brief	stub for the ctx->cc->core_register_target_state_change_callback() routine; the target never changes state here
+ *
+ *	\return	always GEAR_ERR_NO_ERROR
+ */
+static enum GEAR_ENGINE_ERR_ENUM register_state_change_callback(struct gear_engine_context * ctx,
+		bool (*callback)(struct gear_engine_context * ctx, enum TARGET_CORE_STATE_ENUM state))
+{
+	return GEAR_ERR_NO_ERROR;
+}
+
+/*!
+ *	\fn	static void init_ctx(struct gear_engine_context * ctx, struct core_control * cc, Elf * elf, const char * elf_name, bool is_verify_enabled)
+ *	\brief	initializes a gear engine context with image-backed memory installed over the simulated target memory
+ *
+ *	\param	ctx	the context to initialize
+ *	\param	cc	the core control structure to use for the context
+ *	\param	elf	the libelf descriptor of the executable
+ *	\param	elf_name	the file name of the executable
+ *	\param	is_verify_enabled	true, if program segment verification is enabled
+ *	\return	none
+ */
+static void init_ctx(struct gear_engine_context * ctx, struct core_control * cc, Elf * elf, const char * elf_name, bool is_verify_enabled)
+{
+	memset(ctx, 0, sizeof * ctx);
+	memset(cc, 0, sizeof * cc);
+	cc->core_mem_read = target_mem_read;
+	cc->core_mem_write = target_mem_write;
+	cc->core_register_target_state_change_callback = register_state_change_callback;
+	ctx->cc = cc;
+	ctx->libelf_elf_desc = elf;
+	ctx->dbg_info_elf_disk_file_name = (char *) elf_name;
+	ctx->settings.is_image_mem_verify_enabled = is_verify_enabled;
+	init_image_mem(ctx);
+}
+
+/*!
+ *	\fn	static void check_read(struct gear_engine_context * ctx, const char * what, const unsigned char * expected, bool is_target_access_expected)
+ *	\brief	reads the first bytes of the simulated target memory, and checks the bytes read and whether the target was accessed
+ *
+ *	\param	ctx	gear engine context
+ *	\param	what	a description of the check, for failure reports
+ *	\param	expected	the bytes expected to be read
+ *	\param	is_target_access_expected	true, if the read is expected
+ *			to access the simulated target memory
+ *	\return	none
+ */
+static void check_read(struct gear_engine_context * ctx, const char * what, const unsigned char * expected, bool is_target_access_expected)
+{
+unsigned char buf[READ_SIZE];
+unsigned nbytes;
+int nr_reads;
+
+	nr_reads = nr_target_reads;
+	nbytes = sizeof buf;
+	if (ctx->cc->core_mem_read(ctx, buf, target_mem_addr, & nbytes) != GEAR_ERR_NO_ERROR
+			|| nbytes != sizeof buf)
+	{
+		printf("FAIL: %s: memory read failed\n", what);
+		nr_failures ++;
+		return;
+	}
+	if (memcmp(buf, expected, sizeof buf))
+	{
+		printf("FAIL: %s: wrong bytes read\n", what);
+		nr_failures ++;
+	}
+	if ((nr_target_reads != nr_reads) != is_target_access_expected)
+	{
+		printf("FAIL: %s: target memory %saccessed\n", what, is_target_access_expected ? "not " : "");
+		nr_failures ++;
+	}
+}
+
+
+/*
+ *
+ * exported functions follow
+ *
+ */
+
+/*!
+ *	\fn	int write_to_frontends(const void * buf, size_t count)
+ *	\brief	stub for the gear engine frontend output routine used by miprintf.c; the output is discarded
+ *
+ *	\param	buf	the data to output
+ *	\param	count	the number of bytes to output
+ *	\return	the number of bytes output
+ */
+int write_to_frontends(const void * buf, size_t count)
+{
+	return count;
+}
+
+int main(int argc, char ** argv)
+{
+struct gear_engine_context ctx, trusting_ctx;
+struct core_control cc, trusting_cc;
+unsigned char image_bytes[READ_SIZE], other_bytes[READ_SIZE];
+const unsigned char * img;
+size_t img_size;
+GElf_Ehdr ehdr;
+GElf_Phdr phdr;
+Elf * elf;
+int i, fd;
+
+	if (argc != 2)
+	{
+		printf("usage: %s <elf-file>\n", argv[0]);
+		printf("\t(e.g. an executable built from gemstones/same-name.c and gemstones/same-name-1.c)\n");
+		return 2;
+	}
+	if (elf_version(EV_CURRENT) == EV_NONE)
+		panic("");
+	if ((fd = open(argv[1], O_RDONLY | O_BINARY)) < 0)
+	{
+		printf("cannot open %s\n", argv[1]);
+		return 2;
+	}
+	if (!(elf = elf_begin(fd, ELF_C_READ, 0)) || !gelf_getehdr(elf, & ehdr)
+			|| !(img = (const unsigned char *) elf_rawfile(elf, & img_size)))
+		panic("");
+	/* simulate the target memory with the first program segment
+	 * used by the image-backed memory - see build_segments() in
+	 * image-mem.c */
+	for (i = 0; i < ehdr.e_phnum; i++)
+	{
+		if (!gelf_getphdr(elf, i, & phdr))
+			panic("");
+		if (phdr.p_type == PT_LOAD && !(phdr.p_flags & PF_W) && phdr.p_filesz >= READ_SIZE)
+			break;
+	}
+	if (i == ehdr.e_phnum)
+	{
+		printf("no loadable non-writable program segment found in %s\n", argv[1]);
+		return 2;
+	}
+	target_mem_addr = phdr.p_vaddr;
+	target_mem_size = phdr.p_filesz;
+	if (!(target_mem = malloc(target_mem_size)))
+		panic("out of core");
+	memcpy(target_mem, img + phdr.p_offset, target_mem_size);
+	memcpy(image_bytes, target_mem, READ_SIZE);
+	for (i = 0; i < READ_SIZE; i++)
+		other_bytes[i] = ~ image_bytes[i];
+
+	init_ctx(& ctx, & cc, elf, argv[1], true);
+	init_ctx(& trusting_ctx, & trusting_cc, elf, argv[1], false);
+
+	/* the executable being debugged is loaded */
+	image_mem_notify_image_loaded(& ctx, argv[1]);
+	image_mem_notify_image_loaded(& trusting_ctx, argv[1]);
+	check_read(& ctx, "executable loaded", image_bytes, false);
+	check_read(& trusting_ctx, "executable loaded, no verification", image_bytes, false);
+
+	/* some other image is loaded */
+	memcpy(target_mem, other_bytes, READ_SIZE);
+	image_mem_notify_image_loaded(& ctx, "other.elf");
+	image_mem_notify_image_loaded(& trusting_ctx, "other.elf");
+	check_read(& ctx, "other image loaded", other_bytes, true);
+	check_read(& ctx, "other image loaded, read again", other_bytes, true);
+	check_read(& trusting_ctx, "other image loaded, no verification", other_bytes, true);
+
+	/* some other image, matching the executable, is loaded */
+	memcpy(target_mem, image_bytes, READ_SIZE);
+	image_mem_notify_image_loaded(& ctx, "other.elf");
+	check_read(& ctx, "matching image loaded", image_bytes, true);
+	check_read(& ctx, "matching image loaded, read again", image_bytes, false);
+
+	printf("%i failures\n", nr_failures);
+	elf_end(elf);
+	close(fd);
+	free(target_mem);
+	return nr_failures ? 1 : 0;
+}
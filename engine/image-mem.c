@@ -0,0 +1,523 @@
+/*!
+ * \file	image-mem.c
+ * \brief	image-backed target memory
+ * \author	shopov
+ *
+ *	most of the target memory read by the gear engine when
+ *	the target halts is code - when disassembling (see
+ *	srcfile_disassemble_addr_range() in srcfile.c, and the
+ *	disassemblers under the disasm directory), when decoding
+ *	instructions for the purposes of single stepping, or when
+ *	scanning function prologues; these bytes are, however,
+ *	also available in the executable being debugged, and,
+ *	provided that the target actually runs this executable, there
+ *	is no need to read them from the target at all; this module
+ *	serves such target memory reads from the loadable non-writable
+ *	program segments (e.g. the ones holding .text, .rodata) of
+ *	the executable, so that e.g. disassembling a function
+ *	does not cost a single round trip to the target core controller
+ *
+ *	similar to the memory cache (see mem-cache.c), this is
+ *	transparent to other modules - it is achieved by intercepting
+ *	and overriding the calls to ctx->cc->core_mem_read() and
+ *	ctx->cc->core_mem_write(); the contents of the program segments
+ *	are retrieved by means of elf_rawfile(), so they are not copied
+ *	anywhere
+ *
+ *	\note	there are a couple of coding details
+ *		worth mentioning
+ *			- it is essential that the target really
+ *			runs the executable being debugged; this is
+ *			guaranteed when the executable has been loaded
+ *			in the target by the gear engine itself (see
+ *			target_img_load_elf() in target-img-load.c), which
+ *			notifies this module by invoking
+ *			image_mem_notify_image_loaded() (which also forces
+ *			verification when some other image has been loaded
+ *			in the target); otherwise, by
+ *			default, each program segment is verified before
+ *			its contents are first used - the segment contents
+ *			are read from the target once, and their crc32
+ *			checksum is compared against the checksum of
+ *			the segment contents in the executable; segments
+ *			that do not match are not used, and reads from them
+ *			are passed directly to the overridden routines;
+ *			whenever the target dies (e.g. because it has been
+ *			reset and possibly reprogrammed), the segments must
+ *			be verified again; verification can be turned off
+ *			by the user (see process_cmdline() in engine.c), in
+ *			which case the segments are always used, unless some
+ *			other image is loaded in the target by the gear engine
+ *			- only requests to read bytes residing entirely in a
+ *			single program segment are served by this module; all
+ *			other requests are passed to the overridden routines
+ *			- target memory writes are always passed to the
+ *			overridden routines; writing to a program segment means
+ *			that its contents in the target no longer match the
+ *			ones in the executable, so the segment is no longer used
+ *			- this module is installed before the memory cache
+ *			(see init_mem_cache() in mem-cache.c), so that the
+ *			target memory read when verifying program segments
+ *			does not flood the memory cache
+ *
+ * Revision summary:
+ *
+ * $Log: $
+ */
+
+/*
+ *
+ * include section follows
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <libelf.h>
+#include <gelf.h>
+
+#include "dwarf-common.h"
+#include "target-defs.h"
+#include "gear-engine-context.h"
+#include "core-access.h"
+#include "engine-err.h"
+#include "util.h"
+#include "gprintf.h"
+#include "miprintf.h"
+#include "image-mem.h"
+
+/*
+ *
+ * local definitions follow
+ *
+ */
+
+/*! the size of the chunks in which program segment contents are read from the target when verifying them, in bytes */
+#define IMAGE_MEM_VERIFY_CHUNK_SIZE	4096
+
+/*
+ *
+ * local data types follow
+ *
+ */
+
+/*! enumeration of the possible states of a program segment */
+enum IMAGE_SEG_STATE_ENUM
+{
+	/*! the segment contents have not yet been verified against target memory */
+	IMAGE_SEG_UNVERIFIED = 0,
+	/*! the segment contents match the target memory contents; reads are served from the segment */
+	IMAGE_SEG_VALID,
+	/*! the segment contents do not match (or may no longer match) the target memory contents; reads are passed to the target */
+	IMAGE_SEG_INVALID,
+};
+
+/*! the image-backed target memory data structure */
+struct image_mem_data
+{
+	/*! if true, program segments are verified against target memory before being used */
+	bool			is_verify_enabled;
+	/*! the number of program segments in the segments array below */
+	int			nr_segments;
+	/*! the loadable non-writable program segments of the executable being debugged */
+	struct
+	{
+		/*! the starting address of the segment */
+		ARM_CORE_WORD	start;
+		/*! the address just past the end of the segment contents present in the executable */
+		ARM_CORE_WORD	end;
+		/*! the contents of the segment, within the raw executable file image */
+		const unsigned char	* data;
+		/*! the crc32 checksum of the segment contents */
+		unsigned int	crc;
+		/*! the segment state */
+		enum IMAGE_SEG_STATE_ENUM	state;
+	}
+	* segments;
+	/*! image-backed target memory statistics */
+	struct
+	{
+		/*! the number of target memory reads served from the executable */
+		int	nr_image_reads;
+		/*! the number of bytes served from the executable */
+		int	nr_image_bytes;
+		/*! the number of target memory reads passed directly to the target */
+		int	nr_passed_reads;
+		/*! the number of program segments verified to match target memory */
+		int	nr_verified_segments;
+		/*! the number of program segments found not to match target memory */
+		int	nr_mismatched_segments;
+	}
+	stats;
+
+	/*! original value of the ctx->cc->core_mem_read() function pointer
+	 *
+	 * this is overridden by the image_mem_core_mem_read() function within this module */
+	enum GEAR_ENGINE_ERR_ENUM (*core_mem_read_prev)(struct gear_engine_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes);
+	/*! original value of the ctx->cc->core_mem_write() function pointer
+	 *
+	 * this is overridden by the image_mem_core_mem_write() function within this module */
+	enum GEAR_ENGINE_ERR_ENUM (*core_mem_write_prev)(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes);
+};
+
+/*
+ *
+ * local data follows
+ *
+ */
+
+/*! the crc32 lookup table; built by init_image_mem() */
+static unsigned int crc32_tab[256];
+
+/*
+ *
+ * local functions follow
+ *
+ */
+
+/*!
+ *	\fn	static unsigned int crc32_update(unsigned int crc, const unsigned char * buf, unsigned len)
+ *	\brief	updates a crc32 checksum (the one used by e.g. zlib and ethernet) with a block of bytes
+ *
+ *	\param	crc	the checksum so far; must be 0 for the first block
+ *	\param	buf	the bytes to add to the checksum
+ *	\param	len	the number of bytes in buf
+ *	\return	the updated checksum
+ */
+static unsigned int crc32_update(unsigned int crc, const unsigned char * buf, unsigned len)
+{
+	crc = ~ crc;
+	while (len --)
+		crc = crc32_tab[(crc ^ * buf ++) & 0xff] ^ (crc >> 8);
+	return ~ crc & 0xffffffff;
+}
+
+/*!
+ *	\fn	static int find_segment(struct image_mem_data * p, ARM_CORE_WORD start, unsigned nbytes)
+ *	\brief	locates the program segment that a target memory address range resides in
+ *
+ *	\param	p	the image-backed memory data to search
+ *	\param	start	the starting address of the range
+ *	\param	nbytes	the number of bytes in the range
+ *	\return	the index of the segment in the p->segments array, if
+ *		the range resides entirely in a single segment, -1 otherwise
+ */
+static int find_segment(struct image_mem_data * p, ARM_CORE_WORD start, unsigned nbytes)
+{
+int i;
+
+	if (start + nbytes < start)
+		/* address wraparound */
+		return -1;
+	for (i = 0; i < p->nr_segments; i++)
+		if (p->segments[i].start <= start && start + nbytes <= p->segments[i].end)
+			return i;
+	return -1;
+}
+
+/*!
+ *	\fn	static void verify_segment(struct gear_engine_context * ctx, int seg_idx)
+ *	\brief	verifies that the contents of a program segment match target memory
+ *
+ *	the segment contents are read from the target in chunks of
+ *	IMAGE_MEM_VERIFY_CHUNK_SIZE bytes, and their crc32 checksum
+ *	is compared to the checksum of the segment contents in the
+ *	executable; if target memory cannot be read at this time
+ *	(e.g. because the target is dead), the segment is left
+ *	unverified, and verification is retried later
+ *
+ *	\param	ctx	context to work in
+ *	\param	seg_idx	the index of the segment to verify in the segments array
+ *	\return	none
+ */
+static void verify_segment(struct gear_engine_context * ctx, int seg_idx)
+{
+struct image_mem_data * p;
+unsigned char buf[IMAGE_MEM_VERIFY_CHUNK_SIZE];
+ARM_CORE_WORD addr;
+unsigned len, nbytes;
+unsigned int crc;
+
+	p = ctx->image_mem;
+	crc = 0;
+	for (addr = p->segments[seg_idx].start; addr != p->segments[seg_idx].end; addr += len)
+	{
+		len = p->segments[seg_idx].end - addr;
+		if (len > IMAGE_MEM_VERIFY_CHUNK_SIZE)
+			len = IMAGE_MEM_VERIFY_CHUNK_SIZE;
+		nbytes = len;
+		if (p->core_mem_read_prev(ctx, buf, addr, &nbytes) != GEAR_ERR_NO_ERROR
+				|| nbytes != len)
+			return;
+		crc = crc32_update(crc, buf, len);
+	}
+	if (crc == p->segments[seg_idx].crc)
+	{
+		p->segments[seg_idx].state = IMAGE_SEG_VALID;
+		p->stats.nr_verified_segments ++;
+	}
+	else
+	{
+		p->segments[seg_idx].state = IMAGE_SEG_INVALID;
+		p->stats.nr_mismatched_segments ++;
+		gprintf("program segment at 0x%08x does not match target memory (crc32 0x%08x, expected 0x%08x), "
+				"reading it from the target\n", (unsigned) p->segments[seg_idx].start,
+				crc, p->segments[seg_idx].crc);
+	}
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM image_mem_core_mem_read(struct gear_engine_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes)
+ *	\brief	local override for the general ctx->cc->core_mem_read() routine
+ *
+ *	\param	ctx	context to work in
+ *	\param	dest	the buffer to store the bytes read in
+ *	\param	source	the target memory address to read from
+ *	\param	nbytes	on entry - the number of bytes to read; on
+ *			exit - the number of bytes actually read
+ *	\return	the status code of the memory read
+ */
+static enum GEAR_ENGINE_ERR_ENUM image_mem_core_mem_read(struct gear_engine_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes)
+{
+struct image_mem_data * p;
+int i;
+
+	p = ctx->image_mem;
+	/* sanity checks */
+	if (!dest || !nbytes || !*nbytes)
+		panic("");
+	if ((i = find_segment(p, source, *nbytes)) != -1)
+	{
+		if (p->segments[i].state == IMAGE_SEG_UNVERIFIED)
+			verify_segment(ctx, i);
+		if (p->segments[i].state == IMAGE_SEG_VALID)
+		{
+			memcpy(dest, p->segments[i].data + (source - p->segments[i].start), *nbytes);
+			p->stats.nr_image_reads ++;
+			p->stats.nr_image_bytes += *nbytes;
+			return GEAR_ERR_NO_ERROR;
+		}
+	}
+	p->stats.nr_passed_reads ++;
+	return p->core_mem_read_prev(ctx, dest, source, nbytes);
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM image_mem_core_mem_write(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes)
+ *	\brief	local override for the general ctx->cc->core_mem_write() routine
+ *
+ *	the write is always passed to the target; any program
+ *	segments overlapping the bytes written are no longer used
+ *
+ *	\param	ctx	context to work in
+ *	\param	dest	the target memory address to write to
+ *	\param	source	the buffer holding the bytes to write
+ *	\param	nbytes	on entry - the number of bytes to write; on
+ *			exit - the number of bytes actually written
+ *	\return	the status code of the memory write
+ */
+static enum GEAR_ENGINE_ERR_ENUM image_mem_core_mem_write(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes)
+{
+struct image_mem_data * p;
+int i;
+
+	p = ctx->image_mem;
+	/* sanity checks */
+	if (!source || !nbytes || !*nbytes)
+		panic("");
+	for (i = 0; i < p->nr_segments; i++)
+		if (dest < p->segments[i].end
+				&& (p->segments[i].start <= dest || p->segments[i].start - dest < *nbytes))
+			p->segments[i].state = IMAGE_SEG_INVALID;
+	return p->core_mem_write_prev(ctx, dest, source, nbytes);
+}
+
+/*!
+ *	\fn	static bool image_mem_target_state_change_callback(struct gear_engine_context * ctx, enum TARGET_CORE_STATE_ENUM state)
+ *	\brief	the image-backed target memory target state change callback
+ *
+ *	whenever the target dies, the program segments must be
+ *	verified again before being used, unless verification
+ *	has been turned off
+ *
+ *	\param	ctx	context to work in
+ *	\param	state	the new target state (may actually be the
+ *			same as the previous state)
+ *	\return	always true, denoting that any other target
+ *		state change callbacks should also be invoked */
+static bool image_mem_target_state_change_callback(struct gear_engine_context * ctx, enum TARGET_CORE_STATE_ENUM state)
+{
+struct image_mem_data * p;
+int i;
+
+	p = ctx->image_mem;
+	if (state == TARGET_CORE_STATE_DEAD && p->is_verify_enabled)
+		for (i = 0; i < p->nr_segments; i++)
+			p->segments[i].state = IMAGE_SEG_UNVERIFIED;
+	return true;
+}
+
+/*!
+ *	\fn	static void build_segments(struct gear_engine_context * ctx)
+ *	\brief	builds the list of program segments from the executable being debugged
+ *
+ *	only the loadable non-writable program segments are used;
+ *	of these, only the bytes actually present in the executable
+ *	file are used
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+static void build_segments(struct gear_engine_context * ctx)
+{
+struct image_mem_data * p;
+GElf_Ehdr ehdr;
+GElf_Phdr phdr;
+const unsigned char * img;
+size_t img_size;
+int i;
+
+	p = ctx->image_mem;
+	if (!ctx->libelf_elf_desc)
+		return;
+	if (!gelf_getehdr(ctx->libelf_elf_desc, &ehdr))
+		panic("");
+	if (!ehdr.e_phnum)
+		return;
+	if (!(img = (const unsigned char *) elf_rawfile(ctx->libelf_elf_desc, &img_size)))
+		panic("");
+	if (!(p->segments = malloc(ehdr.e_phnum * sizeof * p->segments)))
+		panic("out of core");
+	for (i = 0; i < ehdr.e_phnum; i++)
+	{
+		if (!gelf_getphdr(ctx->libelf_elf_desc, i, &phdr))
+			panic("");
+		if (phdr.p_type != PT_LOAD || (phdr.p_flags & PF_W) || !phdr.p_filesz)
+			continue;
+		if (phdr.p_offset + phdr.p_filesz > img_size
+				|| (ARM_CORE_WORD) (phdr.p_vaddr + phdr.p_filesz) < phdr.p_vaddr)
+			/* malformed program header */
+			panic("");
+		p->segments[p->nr_segments].start = phdr.p_vaddr;
+		p->segments[p->nr_segments].end = phdr.p_vaddr + phdr.p_filesz;
+		p->segments[p->nr_segments].data = img + phdr.p_offset;
+		p->segments[p->nr_segments].crc = crc32_update(0, img + phdr.p_offset, phdr.p_filesz);
+		p->segments[p->nr_segments].state = p->is_verify_enabled ? IMAGE_SEG_UNVERIFIED : IMAGE_SEG_VALID;
+		p->nr_segments ++;
+	}
+}
+
+/*
+ *
+ * exported functions follow
+ *
+ */
+
+/*!
+ *	\fn	void image_mem_notify_image_loaded(struct gear_engine_context * ctx, const char * elf_img_name)
+ *	\brief	notifies this module that an executable image has been loaded in the target
+ *
+ *	if the image loaded is the executable being debugged, the
+ *	program segments are known to match target memory, and are
+ *	used without verification; otherwise, target memory has been
+ *	overwritten with some other image, and the program segments
+ *	are verified again before being used - this is done even if
+ *	verification has been turned off, as there is no reason
+ *	to trust that the other image happens to match the
+ *	executable being debugged
+ *
+ *	\param	ctx	context to work in
+ *	\param	elf_img_name	the file name of the image loaded
+ *	\return	none
+ */
+void image_mem_notify_image_loaded(struct gear_engine_context * ctx, const char * elf_img_name)
+{
+struct image_mem_data * p;
+enum IMAGE_SEG_STATE_ENUM state;
+int i;
+
+	if (!(p = ctx->image_mem))
+		return;
+	if (!ctx->dbg_info_elf_disk_file_name || strcmp(elf_img_name, ctx->dbg_info_elf_disk_file_name))
+		state = IMAGE_SEG_UNVERIFIED;
+	else
+		state = IMAGE_SEG_VALID;
+	for (i = 0; i < p->nr_segments; i++)
+		p->segments[i].state = state;
+}
+
+/*!
+ *	\fn	void image_mem_dump_stats_mi(struct gear_engine_context * ctx)
+ *	\brief	dumps image-backed target memory statistics, in machine interface format
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void image_mem_dump_stats_mi(struct gear_engine_context * ctx)
+{
+struct image_mem_data * p;
+
+	if (!(p = ctx->image_mem))
+	{
+		miprintf("IMAGE_MEM = [ENABLED = 0,],");
+		return;
+	}
+	miprintf("IMAGE_MEM = [ENABLED = 1, VERIFY = %i, NR_SEGMENTS = %i, "
+			"IMAGE_READS = %i, IMAGE_BYTES = %i, PASSED_READS = %i, "
+			"VERIFIED_SEGMENTS = %i, MISMATCHED_SEGMENTS = %i,],",
+			p->is_verify_enabled ? 1 : 0, p->nr_segments,
+			p->stats.nr_image_reads, p->stats.nr_image_bytes, p->stats.nr_passed_reads,
+			p->stats.nr_verified_segments, p->stats.nr_mismatched_segments);
+}
+
+/*!
+ *	\fn	void init_image_mem(struct gear_engine_context * ctx)
+ *	\brief	initializes the image-backed target memory
+ *
+ *	\note	this routine installs hooks overriding the
+ *		current context core control routines for accessing
+ *		(reading and writing) target memory, namely
+ *		ctx->cc->core_mem_read() and ctx->cc->core_mem_write();
+ *		it must therefore be invoked after the core control
+ *		initialization, and before the memory cache
+ *		initialization (init_mem_cache()); also read the
+ *		comments at the start of this file
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void init_image_mem(struct gear_engine_context * ctx)
+{
+struct image_mem_data * p;
+unsigned int c;
+int i, j;
+
+	/* build the crc32 lookup table */
+	for (i = 0; i < 256; i++)
+	{
+		for (c = i, j = 0; j < 8; j++)
+			c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+		crc32_tab[i] = c;
+	}
+	/* allocate the private visible data in the current gear engine context */
+	if (!(p = calloc(1, sizeof * p)))
+		panic("out of core");
+	ctx->image_mem = p;
+	p->is_verify_enabled = ctx->settings.is_image_mem_verify_enabled;
+	build_segments(ctx);
+
+	/* install memory access override hooks */
+	p->core_mem_read_prev = ctx->cc->core_mem_read;
+	p->core_mem_write_prev = ctx->cc->core_mem_write;
+	if (!p->core_mem_read_prev || !p->core_mem_write_prev)
+		panic("");
+	/* install the target state change callback */
+	if (ctx->cc->core_register_target_state_change_callback(ctx,
+			image_mem_target_state_change_callback) != GEAR_ERR_NO_ERROR)
+		panic("");
+
+	ctx->cc->core_mem_read = image_mem_core_mem_read;
+	ctx->cc->core_mem_write = image_mem_core_mem_write;
+	gprintf("image-backed target memory installed, %i program segments%s\n", p->nr_segments,
+			p->is_verify_enabled ? ", verification enabled" : "");
+}
@@ -0,0 +1,19 @@
+/*!
+ * \file	image-mem.h
+ * \brief	image-backed target memory header
+ * \author	shopov
+ *
+ *
+ * Revision summary:
+ *
+ * $Log: $
+ */
+
+/*
+ *
+ * exported function prototypes follow
+ *
+ */
+void image_mem_notify_image_loaded(struct gear_engine_context * ctx, const char * elf_img_name);
+void image_mem_dump_stats_mi(struct gear_engine_context * ctx);
+void init_image_mem(struct gear_engine_context * ctx);
@@ -112,6 +112,23 @@ struct dwarf_head_struct
 void dwarf_util_set_parent(void * child, void * parent);
 
 
+/*! debug information node kinds, for the purposes of node allocation and statistics
+ *
+ * for details, see the comments in node-alloc.c */
+enum NODE_KIND_ENUM
+{
+	NODE_KIND_CU = 0,
+	NODE_KIND_SUBPROGRAM,
+	NODE_KIND_LEXBLOCK,
+	NODE_KIND_DOBJ,
+	NODE_KIND_DTYPE,
+	NODE_KIND_SYM,
+	NODE_KIND_SYMTAB_HASH,
+	NODE_KIND_TYPE_NAME,
+	/*! the number of node kinds, must be last */
+	NR_NODE_KINDS,
+};
+
 /*! \todo debugging/statistics only, remove this... */
 extern struct type_access_stats
 {
@@ -132,6 +149,19 @@ extern struct type_access_stats
 	int	nr_subprogram_nodes;
 	int	nr_lexblocks;
 	int	nr_subprogram_prototype_nodes;
+
+	/*! the number of data type nodes merged with identical ones, when data type deduplication is enabled */
+	int	nr_deduplicated_type_nodes;
+
+	/*! node allocation statistics, per node kind; maintained by the node allocator in node-alloc.c */
+	struct
+	{
+		/*! the number of nodes of this kind allocated */
+		int		nr_nodes;
+		/*! the number of bytes used by nodes of this kind */
+		unsigned long	nr_bytes;
+	}
+	node_alloc_stats[NR_NODE_KINDS];
 }
 type_access_stats;
 
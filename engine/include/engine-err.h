@@ -99,6 +99,28 @@ enum GEAR_ENGINE_ERR_ENUM
 	 *
 	 * such an error can occur e.g. when the target is unavailable or running */
 	GEAR_ERR_BACKTRACE_DATA_UNAVAILABLE,
+	/*
+	 *
+	 * target core controller communication related error codes
+	 *
+	 */
+	/*! an asynchronous target memory transfer has been cancelled before completion
+	 *
+	 * for details, see target_comm_cancel_xfer() in target-comm.c */
+	GEAR_ERR_TARGET_XFER_CANCELLED,
+	/*
+	 *
+	 * data object value retrieval related error codes
+	 *
+	 */
+	/*! the value of a data object is not available in the target call stack frame of interest
+	 *
+	 * this is returned when the data object has been optimized
+	 * out at the program counter value of the frame, or when it
+	 * resides in a register whose value in the frame cannot be
+	 * recovered by unwinding the target call stack; for details,
+	 * see dobj_locate() and dobj_fetch_value() in dobj-access.c */
+	GEAR_ERR_DOBJ_OPTIMIZED_OUT,
 	/*! number of error code constants */
 	GEAR_ERR_NR_ERR_CODES,
 
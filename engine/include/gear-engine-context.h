@@ -83,6 +83,23 @@
  */
 #include "target-defs.h"
 
+/*
+ *
+ * exported definitions follow
+ *
+ */
+
+/*! the maximum number of target memory windows retrieved whenever the target halts
+ *
+ * see the halt_snapshot_windows settings field below */
+#define MAX_HALT_SNAPSHOT_WINDOWS	4
+/*! a value for the base_reg_nr field of a halt snapshot window setting, denoting the target stack pointer
+ *
+ * the register number of the target stack pointer is not known
+ * when the settings are initialized, it is resolved when the
+ * halt snapshot is requested */
+#define HALT_SNAPSHOT_WINDOW_SP		(-2)
+
 /*
  *
  * exported data types follow
@@ -101,6 +118,75 @@ struct gear_engine_context
 		unsigned short target_ctl_port_nr;
 		/*! the file name of the executable to debug */
 		const char * dbg_process_disk_file_name;
+		/*! if nonzero, compilation unit trees are built on demand, instead of all of them being built at startup
+		 *
+		 * for details, see cu_build_all() in cu-access.c */
+		bool is_lazy_cu_build_enabled;
+		/*! if nonzero, identical data types described in different compilation units are merged
+		 *
+		 * for details, see dedup_type() in type-access.c */
+		bool is_type_dedup_enabled;
+		/*! if nonzero, the binary framed protocol is negotiated with the target core controller
+		 *
+		 * for details, see the comments in file target-comm-frame.h */
+		bool is_binary_target_protocol_enabled;
+		/*! the maximum number of target memory transfer requests that may be outstanding at any time
+		 *
+		 * only applicable when the binary target protocol
+		 * is in effect; for details, see frame_mem_read() in target-comm.c */
+		int target_xfer_window;
+		/*! the bitmap of the payload encodings offered to the target core controller for target memory transfers
+		 *
+		 * only applicable when the binary target protocol is in
+		 * effect; bit number n set means that encoding n (enum
+		 * TARGET_COMM_ENCODING_ENUM in target-comm-frame.h) is offered;
+		 * if zero, target memory is transferred unencoded; for details,
+		 * see negotiate_payload_encodings() in target-comm.c */
+		unsigned target_payload_encodings;
+		/*! if nonzero, target memory contents are cached by the gear engine
+		 *
+		 * for details, see mem-cache.c */
+		bool is_mem_cache_enabled;
+		/*! if nonzero, target memory reads from the non-writable program segments of the executable are served from the executable
+		 *
+		 * for details, see image-mem.c */
+		bool is_image_mem_enabled;
+		/*! if nonzero, the program segments described above are verified against target memory before being used
+		 *
+		 * for details, see image-mem.c */
+		bool is_image_mem_verify_enabled;
+		/*! the number of target memory windows in the halt_snapshot_windows array below
+		 *
+		 * if zero, only the target core registers are retrieved when the target halts */
+		int nr_halt_snapshot_windows;
+		/*! the target memory windows retrieved along with the target core registers whenever the target halts
+		 *
+		 * for details, see struct core_halt_snapshot in core-access.h */
+		struct
+		{
+			/*! the target core register holding the window base address, HALT_SNAPSHOT_WINDOW_SP, or CORE_MEM_WINDOW_ABSOLUTE (-1) */
+			int		base_reg_nr;
+			/*! the offset of the window from the base address */
+			ARM_CORE_WORD	offset;
+			/*! the number of bytes in the window */
+			unsigned	nbytes;
+		}
+		halt_snapshot_windows[MAX_HALT_SNAPSHOT_WINDOWS];
+		/*! the minimum number of bytes of the target stack prefetched when the target halts, for unwinding the target call stack
+		 *
+		 * if zero, the target stack is not prefetched; for details,
+		 * see prefetch_stack() in frame-reg-cache.c */
+		unsigned stack_prefetch_size;
+		/*! the number of target call stack frames that the target stack prefetch is sized to cover
+		 *
+		 * for details, see prefetch_stack() in frame-reg-cache.c */
+		int stack_prefetch_nr_frames;
+		/*! a hard cap on the number of target call stack frames unwound
+		 *
+		 * requests to unwind the target call stack past this many
+		 * frames fail; this is always at least 1; for details, see
+		 * frame_move_to_relative() in frame-reg-cache.c */
+		int frame_unwind_limit;
 	}
 	settings;
 	/*! the file name of the elf-format file from which to retrieve debug information about the process to debug
@@ -194,10 +280,22 @@ struct gear_engine_context
 	 *
 	 * for details, see the comments in type-access.c */
 	struct type_hash	* types;
+	/*! the debug information node allocator; opaque
+	 *
+	 * for details, see the comments in node-alloc.c */
+	struct node_arena	* node_arena;
 	/*! debuggee compilation units hash table pointer; opaque
 	 *
 	 * for details, see the comments in cu-access.c */
 	struct cu_hash		* cus;
+	/*! the table of compilation unit die offsets in the .debug_info section; opaque
+	 *
+	 * for details, see the comments in cu-access.c */
+	struct cu_die_offset_tab	* cu_die_offsets;
+	/*! the index of global identifier names to the compilation units defining them; opaque
+	 *
+	 * built on first use; for details, see the comments in dwarf-pubnames.c */
+	struct dwarf_name_index	* name_index;
 	/*! the debuggee symbol hash table; opaque
 	 *
 	 * see the comments in symtab.c for details */
@@ -230,6 +328,16 @@ struct gear_engine_context
 	 *
 	 * for details, see file frame-reg-cache.c */
 	struct frame_data_struct	* frame_data;
+	/*! target memory cache data
+	 *
+	 * null if the target memory cache is disabled; for
+	 * details, see file mem-cache.c */
+	struct mem_cache_data	* mem_cache;
+	/*! image-backed target memory data
+	 *
+	 * null if image-backed target memory is disabled; for
+	 * details, see file image-mem.c */
+	struct image_mem_data	* image_mem;
 };
 
 #endif /* __GEAR_ENGINE_CONTEXT_H__ */
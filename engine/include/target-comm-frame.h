@@ -0,0 +1,211 @@
+/*!
+ *	\file	target-comm-frame.h
+ *	\brief	binary framed gear engine - target core controller protocol definitions
+ *	\author	shopov
+ *
+ *	the gear engine and target core controllers normally talk in
+ *	a human readable ascii text protocol (see the comments in
+ *	file target-comm.c); this is handy when debugging, but is
+ *	quite wasteful for bulk data - e.g. each byte read from target
+ *	memory is transferred as a decimal number, and then has to be
+ *	recognized as a separate lexical token by the gear engine
+ *
+ *	for the requests that move bulk data (target memory and register
+ *	reads and writes), and for the target state request, a binary
+ *	framed protocol is also available; it must be negotiated first,
+ *	by means of the ascii request:
+ *
+ *		SET_PROTOCOL(TARGET_COMM_BINARY_PROTOCOL_VERSION)
+ *
+ *	to which a target core controller supporting the binary
+ *	protocol replies (in ascii) with:
+ *
+ *		GEAR_ERR_NO_ERROR,TARGET_COMM_BINARY_PROTOCOL_VERSION
+ *
+ *	a target core controller that does not support the version
+ *	requested replies with a version of zero; in this case, the
+ *	gear engine retries with older protocol versions, down to
+ *	TARGET_COMM_BINARY_PROTOCOL_MIN_VERSION; the frame types
+ *	available with each protocol version are noted in
+ *	enum TARGET_COMM_FRAME_ENUM below
+ *
+ *	after that, the requests listed in enum TARGET_COMM_FRAME_ENUM
+ *	below are sent (and replied to) as binary frames; all other
+ *	requests (e.g. running and halting the target core, setting
+ *	breakpoints, etc.) are still sent, and replied to, in ascii;
+ *	a target core controller tells the two apart by looking at
+ *	the first byte of a request - the frame type codes are
+ *	all control characters, which can never start an ascii
+ *	request; the ascii whitespace control characters (tab,
+ *	newline, vertical tab, form feed and carriage return) are
+ *	skipped when numbering the frame types, as these may well
+ *	precede an ascii request - use TARGET_COMM_IS_FRAME_TYPE()
+ *	below for telling frames and ascii requests apart
+ *
+ *	a frame consists of a fixed size header, followed by a
+ *	payload of variable length; the header layout is:
+ *		- byte 0 - the frame type, one of enum TARGET_COMM_FRAME_ENUM
+ *		- byte 1 - the status code (enum GEAR_ENGINE_ERR_ENUM) in
+ *		replies; zero in requests
+ *		- bytes 2 to 3 - the sequence id, little endian
+ *		- bytes 4 to 7 - the payload length, in bytes, little endian
+ *
+ *	the gear engine numbers the request frames it sends
+ *	consecutively, starting from zero right after the binary
+ *	protocol has been negotiated, and wrapping around at 0x10000;
+ *	the gear engine may send several request frames without
+ *	waiting for the replies to the previous ones (i.e. requests
+ *	may be pipelined) - a target core controller must serve
+ *	the requests strictly in the order received, and must copy
+ *	the sequence id of a request to the reply that answers it;
+ *	the gear engine uses the sequence ids to verify that no
+ *	replies have been lost or reordered
+ *
+ *	all multibyte numbers in payloads are 32 bit, little endian;
+ *	a reply carries the same frame type as the request it answers;
+ *	the payloads are:
+ *		- TARGET_COMM_FRAME_MEM_READ - request: the address and the
+ *		number of bytes to read; reply: the raw bytes read (nothing
+ *		if the status code is not GEAR_ERR_NO_ERROR)
+ *		- TARGET_COMM_FRAME_MEM_WRITE - request: the address, followed
+ *		by the raw bytes to write; reply: empty
+ *		- TARGET_COMM_FRAME_REGS_READ - request: the register bitmap,
+ *		encoded the same way as in the ascii REGS_READ request; reply:
+ *		the register values, one for each bit set in the bitmap,
+ *		in ascending bit order (nothing if the status code is not
+ *		GEAR_ERR_NO_ERROR)
+ *		- TARGET_COMM_FRAME_REGS_WRITE - request: the register bitmap,
+ *		followed by the register values, as above; reply: empty
+ *		- TARGET_COMM_FRAME_GET_STATE - request: empty; reply: a single
+ *		byte, the target core state (enum TARGET_CORE_STATE_ENUM)
+ *		- TARGET_COMM_FRAME_HALT_SNAPSHOT - request: the register
+ *		bitmap, encoded as for TARGET_COMM_FRAME_REGS_READ, the number
+ *		of memory windows (at most TARGET_COMM_FRAME_MAX_SNAPSHOT_WINDOWS),
+ *		followed by three numbers for each memory window - the number
+ *		of the register holding the base address of the window
+ *		(0xffffffff if the window address is absolute), the offset
+ *		of the window from the base address, and the number of
+ *		bytes in the window; the base register of a window must be
+ *		present in the register bitmap; reply: the target core state
+ *		(enum TARGET_CORE_STATE_ENUM); if the target core is halted,
+ *		the state is followed by the register values, as for
+ *		TARGET_COMM_FRAME_REGS_READ, and by the contents of each
+ *		memory window, in the order requested - the status code of
+ *		reading the window (enum GEAR_ENGINE_ERR_ENUM), the number of
+ *		bytes read (zero if the status code is not GEAR_ERR_NO_ERROR),
+ *		and the raw bytes read, padded with zeros to a multiple of
+ *		four bytes; nothing is sent if the status code of the reply
+ *		is not GEAR_ERR_NO_ERROR; this request is meant to retrieve
+ *		everything the gear engine usually needs when the target
+ *		halts in a single round trip
+ *		- TARGET_COMM_FRAME_SET_ENCODINGS - request: a bitmap of the
+ *		payload encodings (enum TARGET_COMM_ENCODING_ENUM, bit number
+ *		n set meaning encoding n) that the gear engine offers to use
+ *		for the rest of the session; reply: the bitmap of the encodings
+ *		offered that the target core controller also supports - only
+ *		these may be used in the packed frames below; this request
+ *		is optional - if it is never sent, or if the reply bitmap is
+ *		empty, the packed frames below are never sent
+ *		- TARGET_COMM_FRAME_MEM_READ_PACKED - request: the address, the
+ *		number of bytes to read, and a bitmap of the encodings
+ *		acceptable for the reply (a subset of the encodings agreed
+ *		upon with TARGET_COMM_FRAME_SET_ENCODINGS); reply: the encoding
+ *		the target core controller has chosen (this may always be
+ *		TARGET_COMM_ENCODING_RAW), followed by the bytes read, encoded
+ *		with it (nothing if the status code is not GEAR_ERR_NO_ERROR);
+ *		the bytes read must decode to exactly the number of bytes
+ *		requested
+ *		- TARGET_COMM_FRAME_MEM_WRITE_PACKED - request: the address, the
+ *		encoding used (one of the encodings agreed upon, or
+ *		TARGET_COMM_ENCODING_RAW), the number of bytes to write, followed
+ *		by the bytes to write, encoded; reply: empty
+ *
+ *	the payload encodings are meant for slow target connections
+ *	(e.g. serial lines, or jtag bridges), and for highly compressible
+ *	target memory contents (e.g. zero filled memory, padded flash
+ *	images); for the encoded data formats, see the comments in file
+ *	target-comm-pack.c
+ *
+ *	Revision summary:
+ *
+ *	$Log: $
+ */
+#ifndef __TARGET_COMM_FRAME_H__
+#define __TARGET_COMM_FRAME_H__
+
+/*
+ *
+ * exported declarations follow
+ *
+ */
+
+/*! the binary protocol version, as negotiated by the ascii SET_PROTOCOL request */
+#define TARGET_COMM_BINARY_PROTOCOL_VERSION	4
+/*! the oldest binary protocol version still supported */
+#define TARGET_COMM_BINARY_PROTOCOL_MIN_VERSION	2
+/*! the size of a frame header, in bytes */
+#define TARGET_COMM_FRAME_HEADER_SIZE		8
+/*! the maximum number of data bytes (target memory bytes, or register values) in a frame payload */
+#define TARGET_COMM_FRAME_MAX_DATA_SIZE		0x10000
+/*! the maximum size of a frame payload - the maximum data size, plus room for the address and length/bitmap fields */
+#define TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE	(TARGET_COMM_FRAME_MAX_DATA_SIZE + 8)
+/*! the maximum number of memory windows in a TARGET_COMM_FRAME_HALT_SNAPSHOT request */
+#define TARGET_COMM_FRAME_MAX_SNAPSHOT_WINDOWS	8
+/*! the maximum number of register values, plus memory window data bytes, in a TARGET_COMM_FRAME_HALT_SNAPSHOT reply
+ *
+ * this leaves room for the target state, and for the status code and
+ * length fields (and the padding) of each memory window, so that the
+ * reply fits in TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE bytes */
+#define TARGET_COMM_FRAME_MAX_SNAPSHOT_DATA_SIZE	(TARGET_COMM_FRAME_MAX_DATA_SIZE - 16 * TARGET_COMM_FRAME_MAX_SNAPSHOT_WINDOWS)
+
+/*! binary frame types */
+enum TARGET_COMM_FRAME_ENUM
+{
+	/*! invalid frame type, used for catching errors */
+	TARGET_COMM_FRAME_INVALID = 0,
+	/*! read target memory */
+	TARGET_COMM_FRAME_MEM_READ,
+	/*! write target memory */
+	TARGET_COMM_FRAME_MEM_WRITE,
+	/*! read target core registers */
+	TARGET_COMM_FRAME_REGS_READ,
+	/*! write target core registers */
+	TARGET_COMM_FRAME_REGS_WRITE,
+	/*! retrieve the target core state */
+	TARGET_COMM_FRAME_GET_STATE,
+	/*! retrieve the target core state, target core registers and target memory windows; available since protocol version 3 */
+	TARGET_COMM_FRAME_HALT_SNAPSHOT,
+	/*! select the payload encodings for the packed frames below; available since protocol version 4 */
+	TARGET_COMM_FRAME_SET_ENCODINGS,
+	/*! read target memory, the reply data may be encoded; available since protocol version 4 */
+	TARGET_COMM_FRAME_MEM_READ_PACKED,
+	/*! write target memory, the request data may be encoded; available since protocol version 4
+	 *
+	 * \note	frame type codes '\t' (9) to '\r' (13) are ascii
+	 *		whitespace, and are not used; see the comments at
+	 *		the start of this file */
+	TARGET_COMM_FRAME_MEM_WRITE_PACKED = '\r' + 1,
+	/*! the number of frame types, plus the number of unused frame type codes; must be last */
+	TARGET_COMM_NR_FRAME_TYPES,
+};
+
+/*! evaluates to nonzero if the first byte of a request is a binary frame type code, and zero if the request is an ascii request */
+#define TARGET_COMM_IS_FRAME_TYPE(c)	((c) < TARGET_COMM_NR_FRAME_TYPES && ((c) < '\t' || (c) > '\r'))
+
+/*! payload encodings, for the packed frames above
+ *
+ * for details, see the comments at the start of this file,
+ * and the comments in file target-comm-pack.c */
+enum TARGET_COMM_ENCODING_ENUM
+{
+	/*! no encoding - the data bytes are sent verbatim; this is always supported */
+	TARGET_COMM_ENCODING_RAW = 0,
+	/*! run length encoding - cheap, suitable for zero filled or padded memory areas */
+	TARGET_COMM_ENCODING_RLE,
+	/*! lempel-ziv encoding - also catches repeating patterns, at the expense of more processing */
+	TARGET_COMM_ENCODING_LZ,
+	/*! the number of payload encodings; must be last */
+	TARGET_COMM_NR_ENCODINGS,
+};
+
+#endif /* __TARGET_COMM_FRAME_H__ */
@@ -0,0 +1,379 @@
+/*!
+ * \file	index-cache.c
+ * \brief	on-disk debug information index cache
+ * \author	shopov
+ *
+ *	building the gear engine debug information indices requires
+ *	walking all of the .debug_info and .debug_aranges sections of
+ *	the debuggee executable, and the headers of all line number
+ *	programs in .debug_line, which, for large executables, takes
+ *	a long time; as the same executable is very commonly debugged
+ *	over and over again, the indices are stored in a file next
+ *	to the elf file (the file has the same name as the elf file,
+ *	with ".gear-index" appended), and are read back from this
+ *	file on subsequent gear engine startups, provided the elf
+ *	file has not changed in the meantime
+ *
+ *	an index cache file consists of a header (see struct
+ *	index_cache_header below), followed by the index data
+ *	contributed by the various gear engine modules, in this order:
+ *	- the compilation unit die offsets table (see cu_save_index()
+ *	in cu-access.c)
+ *	- the compilation unit address ranges table (see
+ *	aranges_save_index() in aranges-access.c)
+ *	- the compilation unit - source file correspondence lists
+ *	(see srcfile_save_index() in srcfile.c)
+ *
+ *	the elf file is considered unchanged if its size and
+ *	modification time match the ones recorded in the index cache
+ *	file header; the index data is also checksummed, so that
+ *	a damaged index cache file is detected, and ignored
+ *
+ *	the index cache file is read in core in one go, it is not
+ *	memory mapped (mingw, which the gear engine is built with,
+ *	does not provide mmap())
+ *
+ *	\note	only the three indices listed above are currently stored
+ *		here - these save the walk over all compilation unit
+ *		headers in .debug_info, the read of .debug_aranges,
+ *		and the retrieval of the source file names of every
+ *		compilation unit; the line number tables are not
+ *		stored - these are decoded on demand, for a single
+ *		compilation unit at a time, when first needed (see
+ *		get_cu_line_tab() in srcfile.c), and are not built
+ *		on startup; everything else - the global symbol table
+ *		(see symtab.c), the type indices (see type-access.c),
+ *		and the compilation unit trees themselves - is still
+ *		built from the elf file on every startup; for the
+ *		compilation unit trees, this can be avoided by enabling
+ *		lazy compilation unit building (the '--lazy-cus'
+ *		command line option), in which case the trees are
+ *		built on demand; the time taken by every startup phase
+ *		is reported by the gear engine on startup, so the
+ *		benefit of the index cache for a particular executable
+ *		can be readily assessed
+ *
+ * Revision summary:
+ *
+ * $Log: $
+ */
+
+/*
+ *
+ * include section follows
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "dwarf-common.h"
+#include "target-defs.h"
+#include "gear-engine-context.h"
+#include "cu-access.h"
+#include "aranges-access.h"
+#include "srcfile.h"
+#include "util.h"
+#include "gprintf.h"
+#include "index-cache.h"
+
+/*
+ *
+ * local definitions follow
+ *
+ */
+
+/*! the suffix appended to the elf file name to form the index cache file name */
+#define INDEX_CACHE_FILE_SUFFIX		".gear-index"
+/*! the index cache file format version; bump this whenever the format of any data stored in the index cache changes */
+#define INDEX_CACHE_VERSION		2
+/*! the initial size of the in-core image buffer, when building the image for writing to disk */
+#define INDEX_CACHE_INITIAL_BUF_SIZE	(64 * 1024)
+
+/*
+ *
+ * local data types follows
+ *
+ */
+
+/*! the index cache file header */
+struct index_cache_header
+{
+	/*! index cache file magic, must equal "gearidx" */
+	char			magic[8];
+	/*! the index cache file format version, must equal INDEX_CACHE_VERSION */
+	unsigned int		version;
+	/*! the sizes of the basic data types used in the index data; these must match the ones of the running gear engine */
+	unsigned char		sizeof_dwarf_off, sizeof_core_word, sizeof_int, reserved;
+	/*! the size of the elf file that the index data was built for */
+	long long		elf_file_size;
+	/*! the modification time of the elf file that the index data was built for */
+	long long		elf_file_mtime;
+	/*! the size of the index data following this header, in bytes */
+	unsigned int		data_len;
+	/*! checksum of the index data following this header */
+	unsigned int		data_checksum;
+};
+
+/*
+ *
+ * local functions follow
+ *
+ */
+
+/*!
+ *	\fn	static unsigned int index_cache_checksum(const unsigned char * data, unsigned int len)
+ *	\brief	computes a checksum (a 32 bit fnv-1a hash) of a block of data
+ *
+ *	\param	data	the data to checksum
+ *	\param	len	the length of the data, in bytes
+ *	\return	the checksum computed
+ */
+static unsigned int index_cache_checksum(const unsigned char * data, unsigned int len)
+{
+unsigned int h;
+
+	h = 2166136261U;
+	while (len--)
+		h = (h ^ * data ++) * 16777619U;
+	return h;
+}
+
+/*!
+ *	\fn	static char * get_index_cache_file_name(struct gear_engine_context * ctx)
+ *	\brief	returns the name of the index cache file for the elf file being debugged
+ *
+ *	\param	ctx	context to work in
+ *	\return	the name of the index cache file; the string
+ *		returned is allocated with malloc() and must
+ *		be freed by the caller
+ */
+static char * get_index_cache_file_name(struct gear_engine_context * ctx)
+{
+char * name;
+
+	if (!(name = malloc(strlen(ctx->dbg_info_elf_disk_file_name) + sizeof INDEX_CACHE_FILE_SUFFIX)))
+		panic("out of core");
+	strcpy(name, ctx->dbg_info_elf_disk_file_name);
+	strcat(name, INDEX_CACHE_FILE_SUFFIX);
+	return name;
+}
+
+/*!
+ *	\fn	static bool init_index_cache_header(struct gear_engine_context * ctx, struct index_cache_header * hdr)
+ *	\brief	initializes an index cache file header for the elf file being debugged
+ *
+ *	the data_len and data_checksum fields of the header
+ *	are not initialized here
+ *
+ *	\param	ctx	context to work in
+ *	\param	hdr	the header to initialize
+ *	\return	true, if the header was successfully initialized,
+ *		false, if the elf file could not be accessed
+ */
+static bool init_index_cache_header(struct gear_engine_context * ctx, struct index_cache_header * hdr)
+{
+struct stat statbuf;
+
+	if (stat(ctx->dbg_info_elf_disk_file_name, &statbuf))
+		return false;
+	memset(hdr, 0, sizeof * hdr);
+	strcpy(hdr->magic, "gearidx");
+	hdr->version = INDEX_CACHE_VERSION;
+	hdr->sizeof_dwarf_off = sizeof(Dwarf_Off);
+	hdr->sizeof_core_word = sizeof(ARM_CORE_WORD);
+	hdr->sizeof_int = sizeof(int);
+	hdr->elf_file_size = statbuf.st_size;
+	hdr->elf_file_mtime = statbuf.st_mtime;
+	return true;
+}
+
+/*
+ *
+ * exported functions follow
+ *
+ */
+
+/*!
+ *	\fn	void index_cache_put(struct index_cache_cursor * c, const void * data, unsigned int len)
+ *	\brief	appends data to an in-core index cache image
+ *
+ *	\param	c	the in-core index cache image to append to
+ *	\param	data	the data to append
+ *	\param	len	the length of the data, in bytes
+ *	\return	none
+ */
+void index_cache_put(struct index_cache_cursor * c, const void * data, unsigned int len)
+{
+	if (c->len + len > c->buf_size)
+	{
+		if (!c->buf_size)
+			c->buf_size = INDEX_CACHE_INITIAL_BUF_SIZE;
+		while (c->len + len > c->buf_size)
+			c->buf_size <<= 1;
+		if (!(c->buf = realloc(c->buf, c->buf_size)))
+			panic("out of core");
+	}
+	memcpy(c->buf + c->len, data, len);
+	c->len += len;
+}
+
+/*!
+ *	\fn	bool index_cache_get(struct index_cache_cursor * c, void * data, unsigned int len)
+ *	\brief	retrieves data from an in-core index cache image
+ *
+ *	\param	c	the in-core index cache image to retrieve data from
+ *	\param	data	a pointer to where to store the data retrieved
+ *	\param	len	the length of the data to retrieve, in bytes
+ *	\return	true, if the data was successfully retrieved, false,
+ *		if there is not enough data left in the image
+ */
+bool index_cache_get(struct index_cache_cursor * c, void * data, unsigned int len)
+{
+	if (len > c->len - c->pos)
+		return false;
+	memcpy(data, c->buf + c->pos, len);
+	c->pos += len;
+	return true;
+}
+
+/*!
+ *	\fn	bool index_cache_load(struct gear_engine_context * ctx)
+ *	\brief	attempts to restore the debug information indices from the index cache file
+ *
+ *	\note	this must be called before the debug information
+ *		indices are built from the elf file - i.e., before
+ *		dwarf_hacked_init(), init_aranges() and
+ *		srcfile_build_src_cu_tab() are invoked; these skip
+ *		building any indices that have been restored here
+ *
+ *	\param	ctx	context to work in
+ *	\return	true, if the debug information indices were
+ *		successfully restored from the index cache file, false
+ *		if the index cache file does not exist, is stale, or is
+ *		damaged - in this case, the indices must be built from
+ *		the elf file
+ */
+bool index_cache_load(struct gear_engine_context * ctx)
+{
+struct index_cache_header hdr, file_hdr;
+struct index_cache_cursor c;
+struct stat statbuf;
+char * name;
+int fd;
+bool res;
+
+	if (!init_index_cache_header(ctx, &hdr))
+		return false;
+	name = get_index_cache_file_name(ctx);
+	fd = open(name, O_RDONLY | O_BINARY, 0);
+	free(name);
+	if (fd < 0)
+		/* no index cache file */
+		return false;
+	memset(&c, 0, sizeof c);
+	res = false;
+	switch (0) default:
+	{
+		if (read(fd, &file_hdr, sizeof file_hdr) != sizeof file_hdr)
+			break;
+		if (memcmp(hdr.magic, file_hdr.magic, sizeof hdr.magic)
+				|| hdr.version != file_hdr.version
+				|| hdr.sizeof_dwarf_off != file_hdr.sizeof_dwarf_off
+				|| hdr.sizeof_core_word != file_hdr.sizeof_core_word
+				|| hdr.sizeof_int != file_hdr.sizeof_int
+				|| hdr.elf_file_size != file_hdr.elf_file_size
+				|| hdr.elf_file_mtime != file_hdr.elf_file_mtime)
+			/* stale index cache file */
+			break;
+		/* validate the index data length against the file size
+		 * before allocating any core for the index data - a
+		 * damaged length must not make the allocation fail */
+		if (fstat(fd, &statbuf)
+				|| statbuf.st_size != (off_t) sizeof file_hdr + file_hdr.data_len)
+			/* file truncated, or has trailing garbage */
+			break;
+		if (!(c.buf = malloc(c.buf_size = file_hdr.data_len + 1)))
+			panic("out of core");
+		if (read(fd, c.buf, file_hdr.data_len) != file_hdr.data_len)
+			break;
+		if (index_cache_checksum(c.buf, c.len = file_hdr.data_len) != file_hdr.data_checksum)
+			break;
+		if (!cu_restore_index(ctx, &c))
+			break;
+		if (!aranges_restore_index(ctx, &c))
+			break;
+		if (!srcfile_restore_index(ctx, &c))
+			break;
+		res = (c.pos == c.len);
+	}
+	close(fd);
+	free(c.buf);
+	if (!res)
+	{
+		/* drop any data restored before the failure, the
+		 * indices are then all built from the elf file */
+		srcfile_discard_index(ctx);
+		cu_discard_index(ctx);
+		aranges_discard_index(ctx);
+		gprintf("debug information index cache stale or damaged, rebuilding it\n");
+	}
+	else
+		gprintf("debug information indices restored from the index cache\n");
+	return res;
+}
+
+/*!
+ *	\fn	void index_cache_save(struct gear_engine_context * ctx)
+ *	\brief	stores the debug information indices in the index cache file
+ *
+ *	failing to write the index cache file is not an error,
+ *	a diagnostic message is printed, and the index cache file
+ *	is removed (so that a partially written file is never
+ *	left around)
+ *
+ *	\note	this must be called after the debug information
+ *		indices are built - i.e., after dwarf_hacked_init(),
+ *		init_aranges() and srcfile_build_src_cu_tab() have
+ *		been invoked
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void index_cache_save(struct gear_engine_context * ctx)
+{
+struct index_cache_header hdr;
+struct index_cache_cursor c;
+char * name;
+int fd;
+bool res;
+
+	if (!init_index_cache_header(ctx, &hdr))
+		return;
+	memset(&c, 0, sizeof c);
+	cu_save_index(ctx, &c);
+	aranges_save_index(ctx, &c);
+	srcfile_save_index(ctx, &c);
+	hdr.data_len = c.len;
+	hdr.data_checksum = index_cache_checksum(c.buf, c.len);
+
+	name = get_index_cache_file_name(ctx);
+	res = false;
+	if ((fd = open(name, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0644)) >= 0)
+	{
+		res = write(fd, &hdr, sizeof hdr) == sizeof hdr
+			&& write(fd, c.buf, c.len) == c.len;
+		if (close(fd))
+			res = false;
+	}
+	if (!res)
+	{
+		gprintf("failed to write debug information index cache file %s\n", name);
+		unlink(name);
+	}
+	free(name);
+	free(c.buf);
+}
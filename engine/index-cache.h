@@ -0,0 +1,59 @@
+/*!
+ * \file	index-cache.h
+ * \brief	on-disk debug information index cache header file
+ * \author	shopov
+ *
+ *
+ * Revision summary:
+ *
+ * $Log: $
+ */
+
+/*
+ *
+ * exported types follow
+ *
+ */
+
+/*! a cursor into an in-core debug information index cache image
+ *
+ * the modules which contribute data to the index cache
+ * serialize their data to, and deserialize it from, such an
+ * in-core image with the index_cache_put() and index_cache_get()
+ * routines; the image is read from (and written to) the disk in
+ * one go by the index cache module; for details, see the
+ * comments in index-cache.c */
+struct index_cache_cursor
+{
+	/*! the in-core image */
+	unsigned char	* buf;
+	/*! the number of bytes allocated for the buf array above */
+	unsigned int	buf_size;
+	/*! the number of valid bytes in the buf array above */
+	unsigned int	len;
+	/*! the current read position in the buf array above */
+	unsigned int	pos;
+};
+
+/*
+ *
+ * exported function prototypes follow
+ *
+ */
+void index_cache_put(struct index_cache_cursor * c, const void * data, unsigned int len);
+bool index_cache_get(struct index_cache_cursor * c, void * data, unsigned int len);
+bool index_cache_load(struct gear_engine_context * ctx);
+void index_cache_save(struct gear_engine_context * ctx);
+
+/* index data serialization routines of the modules
+ * contributing data to the index cache; these live in
+ * the modules owning the data */
+void cu_save_index(struct gear_engine_context * ctx, struct index_cache_cursor * c);
+bool cu_restore_index(struct gear_engine_context * ctx, struct index_cache_cursor * c);
+void aranges_save_index(struct gear_engine_context * ctx, struct index_cache_cursor * c);
+bool aranges_restore_index(struct gear_engine_context * ctx, struct index_cache_cursor * c);
+void srcfile_save_index(struct gear_engine_context * ctx, struct index_cache_cursor * c);
+bool srcfile_restore_index(struct gear_engine_context * ctx, struct index_cache_cursor * c);
+void cu_discard_index(struct gear_engine_context * ctx);
+void aranges_discard_index(struct gear_engine_context * ctx);
+void srcfile_discard_index(struct gear_engine_context * ctx);
@@ -32,6 +32,7 @@
 #include "dobj-access.h"
 #include "subprogram-access.h"
 #include "lexblock-access.h"
+#include "node-alloc.h"
 
 /*
  *
@@ -40,20 +41,16 @@
  */
 
 /*!
- *	\fn	static struct lexblock_data * get_lexblock_node(void)
+ *	\fn	static struct lexblock_data * get_lexblock_node(struct gear_engine_context * ctx)
  *	\brief	allocates memory for a lexblock_data structure and initializes it
  *
+ *	\param	ctx	context to work in
  *	\return	a pointer to the newly allocated lexblock_data data structure
  */
 
-static struct lexblock_data * get_lexblock_node(void)
+static struct lexblock_data * get_lexblock_node(struct gear_engine_context * ctx)
 {
-struct lexblock_data * p;
-
-	if (!(p = (struct lexblock_data * )malloc(sizeof(struct lexblock_data))))
-		panic("out of core");
-	memset(p, 0, sizeof(*p));
-	return p;
+	return node_alloc(ctx, NODE_KIND_LEXBLOCK, sizeof(struct lexblock_data));
 }
 
 
@@ -99,7 +96,7 @@ Dwarf_Bool flag;
 		panic("unsupported attribute found");
 
 	/* get core for the new node */
-	p = get_lexblock_node();
+	p = get_lexblock_node(ctx);
 	p->head.tag = tagval;
 
 	/* retrieve the address range(s) (if any) covered by this lexical block */
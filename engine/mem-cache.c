@@ -0,0 +1,901 @@
+/*!
+ * \file	mem-cache.c
+ * \brief	target memory cache
+ * \author	shopov
+ *
+ *	many gear engine modules read target memory - e.g. when
+ *	dumping strings, disassembling, unwinding the target call
+ *	stack, evaluating expressions, etc.; whenever the target
+ *	halts, the same bytes of target memory (most commonly - stack
+ *	and code bytes) are typically read over and over again, and
+ *	each of these reads is a round trip over the (possibly slow)
+ *	link to the target core controller; this module avoids
+ *	this by caching target memory contents
+ *
+ *	similar to the register cache (see frame-reg-cache.c), this
+ *	is transparent to other modules - it is achieved by intercepting
+ *	and overriding the calls to ctx->cc->core_mem_read() and
+ *	ctx->cc->core_mem_write(); target memory is cached in pages
+ *	of MEM_CACHE_PAGE_SIZE bytes, aligned on MEM_CACHE_PAGE_SIZE
+ *	boundaries; reading target memory fetches the whole pages
+ *	that the bytes requested reside in, writing target memory
+ *	is done in a write-through manner - the write is always passed
+ *	to the target, and the cached pages overlapping the bytes
+ *	written are updated
+ *
+ *	\note	there are a couple of coding details
+ *		worth mentioning
+ *			- only target memory known to be ordinary memory
+ *			is cached - this is the memory occupied by the
+ *			allocated sections of the executable being
+ *			debugged, and a window of MEM_CACHE_STACK_WINDOW_SIZE
+ *			bytes upwards from the target stack pointer at the
+ *			time the target halted; all other target memory
+ *			accesses (most notably - accesses to memory mapped
+ *			peripherals, which may have side effects, or
+ *			whose contents may change at any time) are passed
+ *			directly to the overridden routines
+ *			- the memory cache is operative only when
+ *			the target is halted, otherwise target memory may
+ *			change at any time; when the target is running or
+ *			is dead, requests to read target memory are passed
+ *			directly to the overridden ctx->cc->core_mem_read()
+ *			routine; in order to determine the target state,
+ *			this module installs a target state change callback
+ *			routine; whenever the target resumes execution, the
+ *			cached pages are discarded
+ *			- there is an exception to the above - the pages
+ *			residing entirely in the non-writable sections of
+ *			the executable being debugged (e.g. .text, .rodata -
+ *			which, for embedded targets, typically reside in flash
+ *			memory) are considered read-only, and are kept
+ *			across target runs; they are only discarded when
+ *			the target dies (e.g. because it has been reset
+ *			and possibly reprogrammed), or when
+ *			mem_cache_invalidate() is explicitly invoked
+ *
+ * Revision summary:
+ *
+ * $Log: $
+ */
+
+/*
+ *
+ * include section follows
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <libelf.h>
+#include <gelf.h>
+
+#include "dwarf-common.h"
+#include "target-defs.h"
+#include "gear-engine-context.h"
+#include "core-access.h"
+#include "target-description.h"
+#include "engine-err.h"
+#include "util.h"
+#include "gprintf.h"
+#include "miprintf.h"
+#include "mem-cache.h"
+
+/*
+ *
+ * local definitions follow
+ *
+ */
+
+/*! the size of a memory cache page, in bytes; must be a power of two */
+#define MEM_CACHE_PAGE_SIZE		256
+/*! the number of buckets in the memory cache page hash table; must be a power of two */
+#define MEM_CACHE_NR_BUCKETS		256
+/*! the maximum number of pages held in the memory cache
+ *
+ * when this is exceeded, the writable pages are discarded, and, if
+ * this does not help, all of the pages are discarded - except
+ * for the pages of the target memory range being fetched, see
+ * fetch_missing_pages(); target memory reads spanning more
+ * pages than this are not cached at all */
+#define MEM_CACHE_MAX_PAGES		1024
+/*! the size of the target stack memory window that is cached, in bytes
+ *
+ * this starts at the target stack pointer value at the time the
+ * target halted, and extends upwards (towards older stack frames) */
+#define MEM_CACHE_STACK_WINDOW_SIZE	0x4000
+
+/*
+ *
+ * local data types follow
+ *
+ */
+
+/*! a target memory cache page */
+struct mem_cache_page
+{
+	/*! link pointer for the hash bucket list */
+	struct mem_cache_page	* next;
+	/*! the target address of the page; aligned on a MEM_CACHE_PAGE_SIZE boundary */
+	ARM_CORE_WORD		addr;
+	/*! if true, the page resides in a read-only region, and survives target runs */
+	bool			is_read_only;
+	/*! the cached contents of the page */
+	unsigned char		data[MEM_CACHE_PAGE_SIZE];
+};
+
+/*! the target memory cache data structure */
+struct mem_cache_data
+{
+	/*! the hash table of the pages cached, hashed by page address */
+	struct mem_cache_page	* buckets[MEM_CACHE_NR_BUCKETS];
+	/*! the number of pages currently cached */
+	int			nr_pages;
+	/*! a flag denoting if the target is halted, and therefore the memory cache is operative */
+	bool			is_target_halted;
+	/*! the number of cacheable target memory regions in the regions array below */
+	int			nr_regions;
+	/*! cacheable target memory regions
+	 *
+	 * these are built from the allocated sections
+	 * of the executable being debugged */
+	struct
+	{
+		/*! the starting address of the region */
+		ARM_CORE_WORD	start;
+		/*! the address just past the end of the region */
+		ARM_CORE_WORD	end;
+		/*! if true, the region is read-only (it has been built from a non-writable section) */
+		bool		is_read_only;
+	}
+	* regions;
+	/*! the starting address of the cacheable target stack memory window; valid only when the target is halted */
+	ARM_CORE_WORD		stack_start;
+	/*! the address just past the end of the cacheable target stack memory window; valid only when the target is halted */
+	ARM_CORE_WORD		stack_end;
+	/*! if true, the pages from pinned_first to pinned_last (inclusive) are never discarded to make room for new pages
+	 *
+	 * this is set while the pages of a target memory range
+	 * are being fetched, see fetch_missing_pages() */
+	bool			is_range_pinned;
+	/*! the address of the first pinned page; valid only if is_range_pinned is true */
+	ARM_CORE_WORD		pinned_first;
+	/*! the address of the last pinned page; valid only if is_range_pinned is true */
+	ARM_CORE_WORD		pinned_last;
+	/*! memory cache statistics */
+	struct
+	{
+		/*! the number of pages found in the cache when reading target memory */
+		int	nr_hits;
+		/*! the number of pages not found in the cache when reading target memory, and fetched from the target */
+		int	nr_misses;
+		/*! the number of pages fetched from the target ahead of time, see mem_cache_prefetch() */
+		int	nr_prefetched_pages;
+		/*! the number of target memory reads passed directly to the target */
+		int	nr_bypassed_reads;
+		/*! the number of times the cache has been invalidated */
+		int	nr_invalidations;
+		/*! the number of pages put in the cache from halt snapshots */
+		int	nr_snapshot_pages;
+	}
+	stats;
+
+	/*! original value of the ctx->cc->core_mem_read() function pointer
+	 *
+	 * this is overridden by the mem_cache_core_mem_read() function within this module */
+	enum GEAR_ENGINE_ERR_ENUM (*core_mem_read_prev)(struct gear_engine_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes);
+	/*! original value of the ctx->cc->core_mem_write() function pointer
+	 *
+	 * this is overridden by the mem_cache_core_mem_write() function within this module */
+	enum GEAR_ENGINE_ERR_ENUM (*core_mem_write_prev)(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes);
+	/*! original value of the ctx->cc->core_get_halt_snapshot() function pointer
+	 *
+	 * this is overridden by the mem_cache_core_get_halt_snapshot() function within this module */
+	enum GEAR_ENGINE_ERR_ENUM (*core_get_halt_snapshot_prev)(struct gear_engine_context * ctx, struct core_halt_snapshot * snapshot);
+};
+
+/*
+ *
+ * local functions follow
+ *
+ */
+
+/*!
+ *	\fn	static int page_hash(ARM_CORE_WORD addr)
+ *	\brief	computes the hash table bucket index for a page address
+ *
+ *	\param	addr	the page address
+ *	\return	the hash table bucket index for the page
+ */
+static int page_hash(ARM_CORE_WORD addr)
+{
+	return (addr / MEM_CACHE_PAGE_SIZE) & (MEM_CACHE_NR_BUCKETS - 1);
+}
+
+/*!
+ *	\fn	static struct mem_cache_page * find_page(struct mem_cache_data * p, ARM_CORE_WORD addr)
+ *	\brief	locates a page in the memory cache
+ *
+ *	\param	p	the memory cache to search
+ *	\param	addr	the page address
+ *	\return	the page, if found in the cache, null otherwise
+ */
+static struct mem_cache_page * find_page(struct mem_cache_data * p, ARM_CORE_WORD addr)
+{
+struct mem_cache_page * page;
+
+	for (page = p->buckets[page_hash(addr)]; page; page = page->next)
+		if (page->addr == addr)
+			break;
+	return page;
+}
+
+/*!
+ *	\fn	static bool is_page_read_only(struct mem_cache_data * p, ARM_CORE_WORD addr)
+ *	\brief	determines if a page resides entirely in a read-only target memory region
+ *
+ *	\param	p	the memory cache to work on
+ *	\param	addr	the page address
+ *	\return	true, if the page is read-only, false otherwise
+ */
+static bool is_page_read_only(struct mem_cache_data * p, ARM_CORE_WORD addr)
+{
+int i;
+
+	for (i = 0; i < p->nr_regions; i++)
+		if (p->regions[i].is_read_only && p->regions[i].start <= addr
+				&& addr + MEM_CACHE_PAGE_SIZE <= p->regions[i].end)
+			return true;
+	return false;
+}
+
+/*!
+ *	\fn	static bool is_range_cacheable(struct mem_cache_data * p, ARM_CORE_WORD start, ARM_CORE_WORD end)
+ *	\brief	determines if a target memory address range resides entirely in cacheable target memory
+ *
+ *	the range is extended to page boundaries, as whole pages are
+ *	read from the target; the range must not straddle the boundary
+ *	between two cacheable regions
+ *
+ *	\param	p	the memory cache to work on
+ *	\param	start	the starting address of the range
+ *	\param	end	the address just past the end of the range
+ *	\return	true, if the range is cacheable, false otherwise
+ */
+static bool is_range_cacheable(struct mem_cache_data * p, ARM_CORE_WORD start, ARM_CORE_WORD end)
+{
+int i;
+
+	start &= ~ (MEM_CACHE_PAGE_SIZE - 1);
+	end = (end + MEM_CACHE_PAGE_SIZE - 1) & ~ (MEM_CACHE_PAGE_SIZE - 1);
+	if (p->stack_start <= start && end <= p->stack_end)
+		return true;
+	for (i = 0; i < p->nr_regions; i++)
+		if (p->regions[i].start <= start && end <= p->regions[i].end)
+			return true;
+	return false;
+}
+
+/*!
+ *	\fn	static bool is_page_pinned(struct mem_cache_data * p, ARM_CORE_WORD addr)
+ *	\brief	determines if a page must not be discarded to make room for new pages
+ *
+ *	\param	p	the memory cache to work on
+ *	\param	addr	the page address
+ *	\return	true, if the page is pinned, false otherwise
+ */
+static bool is_page_pinned(struct mem_cache_data * p, ARM_CORE_WORD addr)
+{
+	return p->is_range_pinned && p->pinned_first <= addr && addr <= p->pinned_last;
+}
+
+/*!
+ *	\fn	static void discard_pages(struct mem_cache_data * p, bool is_read_only_discarded)
+ *	\brief	discards pages from the memory cache
+ *
+ *	pinned pages (see is_page_pinned()) are not discarded
+ *
+ *	\param	p	the memory cache to work on
+ *	\param	is_read_only_discarded	if true, all pages are discarded,
+ *					otherwise, only the writable pages
+ *					are discarded
+ *	\return	none
+ */
+static void discard_pages(struct mem_cache_data * p, bool is_read_only_discarded)
+{
+struct mem_cache_page ** link, * page;
+int i;
+
+	for (i = 0; i < MEM_CACHE_NR_BUCKETS; i++)
+		for (link = p->buckets + i; (page = * link); )
+			if ((is_read_only_discarded || !page->is_read_only) && !is_page_pinned(p, page->addr))
+			{
+				* link = page->next;
+				free(page);
+				p->nr_pages --;
+			}
+			else
+				link = &page->next;
+	p->stats.nr_invalidations ++;
+}
+
+/*!
+ *	\fn	static struct mem_cache_page * new_page(struct mem_cache_data * p, ARM_CORE_WORD addr)
+ *	\brief	allocates a new page and puts it in the memory cache
+ *
+ *	the contents of the page must be filled in by the caller; if
+ *	the cache is full, unpinned pages are discarded to make room
+ *	for the new page
+ *
+ *	\param	p	the memory cache to work on
+ *	\param	addr	the page address
+ *	\return	the newly allocated page
+ */
+static struct mem_cache_page * new_page(struct mem_cache_data * p, ARM_CORE_WORD addr)
+{
+struct mem_cache_page * page;
+int i;
+
+	if (p->nr_pages >= MEM_CACHE_MAX_PAGES)
+	{
+		discard_pages(p, false);
+		if (p->nr_pages >= MEM_CACHE_MAX_PAGES)
+			discard_pages(p, true);
+	}
+	if (!(page = malloc(sizeof * page)))
+		panic("out of core");
+	page->addr = addr;
+	page->is_read_only = is_page_read_only(p, addr);
+	i = page_hash(addr);
+	page->next = p->buckets[i];
+	p->buckets[i] = page;
+	p->nr_pages ++;
+	return page;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM fetch_pages(struct gear_engine_context * ctx, ARM_CORE_WORD addr, int nr_pages)
+ *	\brief	reads a run of consecutive pages from the target and puts them in the memory cache
+ *
+ *	the pages are read by a single target memory read request, so
+ *	that the target core controller communication module is
+ *	able to transfer them as efficiently as possible
+ *
+ *	\param	ctx	context to work in
+ *	\param	addr	the address of the first page to read
+ *	\param	nr_pages	the number of pages to read
+ *	\return	GEAR_ERR_NO_ERROR on success, an error code otherwise; in
+ *		case of an error, no pages are put in the cache
+ */
+static enum GEAR_ENGINE_ERR_ENUM fetch_pages(struct gear_engine_context * ctx, ARM_CORE_WORD addr, int nr_pages)
+{
+struct mem_cache_data * p;
+unsigned char * buf;
+unsigned nbytes;
+enum GEAR_ENGINE_ERR_ENUM err;
+int i;
+
+	p = ctx->mem_cache;
+	if (!(buf = malloc(nbytes = nr_pages * MEM_CACHE_PAGE_SIZE)))
+		panic("out of core");
+	err = p->core_mem_read_prev(ctx, buf, addr, &nbytes);
+	if (err == GEAR_ERR_NO_ERROR)
+	{
+		if (nbytes != nr_pages * MEM_CACHE_PAGE_SIZE)
+			panic("");
+		for (i = 0; i < nr_pages; i++)
+			memcpy(new_page(p, addr + i * MEM_CACHE_PAGE_SIZE)->data,
+					buf + i * MEM_CACHE_PAGE_SIZE, MEM_CACHE_PAGE_SIZE);
+	}
+	free(buf);
+	return err;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM fetch_missing_pages(struct gear_engine_context * ctx, ARM_CORE_WORD first_page, ARM_CORE_WORD last_page, bool is_prefetch)
+ *	\brief	makes sure that all of the pages in a range of pages are present in the memory cache
+ *
+ *	the missing pages are fetched in runs of consecutive pages,
+ *	each run by a single target memory read request; while
+ *	fetching, the pages in the range are pinned, so that the pages
+ *	already cached (or fetched) are not discarded to make room for
+ *	the pages fetched later, and are all in the cache on return;
+ *	when prefetching, the pages already cached are not counted as
+ *	cache hits, and the pages fetched are not counted as cache
+ *	misses, as no target memory read has actually been requested
+ *	by a cache user yet
+ *
+ *	\note	the range must not span more than MEM_CACHE_MAX_PAGES pages
+ *
+ *	\param	ctx	context to work in
+ *	\param	first_page	the address of the first page in the range
+ *	\param	last_page	the address of the last page in the range
+ *	\param	is_prefetch	true, if the pages are being fetched by
+ *				mem_cache_prefetch(), false if they are being
+ *				fetched to satisfy a target memory read
+ *	\return	GEAR_ERR_NO_ERROR on success, an error code otherwise; in
+ *		case of an error, some of the pages may still be missing
+ */
+static enum GEAR_ENGINE_ERR_ENUM fetch_missing_pages(struct gear_engine_context * ctx, ARM_CORE_WORD first_page, ARM_CORE_WORD last_page, bool is_prefetch)
+{
+struct mem_cache_data * p;
+struct mem_cache_page * page;
+ARM_CORE_WORD addr, run_start;
+bool is_in_miss_run;
+enum GEAR_ENGINE_ERR_ENUM err;
+int nr_pages;
+
+	p = ctx->mem_cache;
+	if ((last_page - first_page) / MEM_CACHE_PAGE_SIZE >= MEM_CACHE_MAX_PAGES)
+		panic("");
+	p->is_range_pinned = true;
+	p->pinned_first = first_page;
+	p->pinned_last = last_page;
+	err = GEAR_ERR_NO_ERROR;
+	is_in_miss_run = false;
+	run_start = 0;
+	for (addr = first_page; ; addr += MEM_CACHE_PAGE_SIZE)
+	{
+		if ((page = find_page(p, addr)))
+		{
+			if (!is_prefetch)
+				p->stats.nr_hits ++;
+		}
+		else if (!is_in_miss_run)
+		{
+			is_in_miss_run = true;
+			run_start = addr;
+		}
+		if (is_in_miss_run && (page || addr == last_page))
+		{
+			/* a run of missing pages ends here */
+			nr_pages = (addr - run_start) / MEM_CACHE_PAGE_SIZE + (page ? 0 : 1);
+			if ((err = fetch_pages(ctx, run_start, nr_pages)) != GEAR_ERR_NO_ERROR)
+				break;
+			if (is_prefetch)
+				p->stats.nr_prefetched_pages += nr_pages;
+			else
+				p->stats.nr_misses += nr_pages;
+			is_in_miss_run = false;
+		}
+		if (addr == last_page)
+			break;
+	}
+	p->is_range_pinned = false;
+	return err;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM mem_cache_core_mem_read(struct gear_engine_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes)
+ *	\brief	local override for the general ctx->cc->core_mem_read() routine
+ *
+ *	the pages missing from the cache are fetched in runs of
+ *	consecutive pages; if fetching some pages fails (e.g. because
+ *	some of them are not accessible), the request is passed
+ *	directly to the overridden ctx->cc->core_mem_read() routine, so
+ *	that the caller sees exactly what it would have seen if the
+ *	memory cache were not present
+ *
+ *	\param	ctx	context to work in
+ *	\param	dest	the buffer to store the bytes read in
+ *	\param	source	the target memory address to read from
+ *	\param	nbytes	on entry - the number of bytes to read; on
+ *			exit - the number of bytes actually read
+ *	\return	the status code of the memory read
+ */
+static enum GEAR_ENGINE_ERR_ENUM mem_cache_core_mem_read(struct gear_engine_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes)
+{
+struct mem_cache_data * p;
+struct mem_cache_page * page;
+ARM_CORE_WORD first_page, last_page, addr;
+unsigned offset, len, bytes_remaining;
+unsigned char * d;
+
+	p = ctx->mem_cache;
+	/* sanity checks */
+	if (!dest || !nbytes || !*nbytes)
+		panic("");
+	first_page = source & ~ (MEM_CACHE_PAGE_SIZE - 1);
+	last_page = (source + *nbytes - 1) & ~ (MEM_CACHE_PAGE_SIZE - 1);
+	if (!p->is_target_halted || last_page < first_page
+			|| (last_page - first_page) / MEM_CACHE_PAGE_SIZE >= MEM_CACHE_MAX_PAGES
+			|| !is_range_cacheable(p, source, source + *nbytes))
+	{
+		/* memory cache inoperative, address wraparound, read
+		 * too large to be cached, or memory not cacheable */
+		p->stats.nr_bypassed_reads ++;
+		return p->core_mem_read_prev(ctx, dest, source, nbytes);
+	}
+
+	/* first, fetch all of the missing pages, in runs of consecutive pages */
+	if (fetch_missing_pages(ctx, first_page, last_page, false) != GEAR_ERR_NO_ERROR)
+	{
+		p->stats.nr_bypassed_reads ++;
+		return p->core_mem_read_prev(ctx, dest, source, nbytes);
+	}
+
+	/* now, all of the pages are in the cache - copy the bytes requested */
+	d = dest;
+	bytes_remaining = *nbytes;
+	addr = source;
+	while (bytes_remaining)
+	{
+		if (!(page = find_page(p, addr & ~ (MEM_CACHE_PAGE_SIZE - 1))))
+			panic("");
+		offset = addr & (MEM_CACHE_PAGE_SIZE - 1);
+		len = MEM_CACHE_PAGE_SIZE - offset;
+		if (len > bytes_remaining)
+			len = bytes_remaining;
+		memcpy(d, page->data + offset, len);
+		d += len;
+		addr += len;
+		bytes_remaining -= len;
+	}
+	return GEAR_ERR_NO_ERROR;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM mem_cache_core_mem_write(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes)
+ *	\brief	local override for the general ctx->cc->core_mem_write() routine
+ *
+ *	the write is always passed to the target; on success, the
+ *	cached pages overlapping the bytes written are updated,
+ *	otherwise, they are discarded, as it is not known what
+ *	has actually been written
+ *
+ *	\param	ctx	context to work in
+ *	\param	dest	the target memory address to write to
+ *	\param	source	the buffer holding the bytes to write
+ *	\param	nbytes	on entry - the number of bytes to write; on
+ *			exit - the number of bytes actually written
+ *	\return	the status code of the memory write
+ */
+static enum GEAR_ENGINE_ERR_ENUM mem_cache_core_mem_write(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes)
+{
+struct mem_cache_data * p;
+struct mem_cache_page * page, ** link;
+enum GEAR_ENGINE_ERR_ENUM err;
+ARM_CORE_WORD addr;
+unsigned offset, len, bytes_remaining;
+const unsigned char * s;
+
+	p = ctx->mem_cache;
+	/* sanity checks */
+	if (!source || !nbytes || !*nbytes)
+		panic("");
+	bytes_remaining = *nbytes;
+	err = p->core_mem_write_prev(ctx, dest, source, nbytes);
+
+	s = source;
+	addr = dest;
+	while (bytes_remaining)
+	{
+		offset = addr & (MEM_CACHE_PAGE_SIZE - 1);
+		len = MEM_CACHE_PAGE_SIZE - offset;
+		if (len > bytes_remaining)
+			len = bytes_remaining;
+		if ((page = find_page(p, addr - offset)))
+		{
+			if (err == GEAR_ERR_NO_ERROR)
+				memcpy(page->data + offset, s, len);
+			else
+			{
+				/* unlink and discard the page */
+				for (link = p->buckets + page_hash(page->addr); * link != page; link = &(* link)->next)
+					;
+				* link = page->next;
+				free(page);
+				p->nr_pages --;
+			}
+		}
+		s += len;
+		addr += len;
+		bytes_remaining -= len;
+	}
+	return err;
+}
+
+/*!
+ *	\fn	static void set_stack_window(struct mem_cache_data * p, ARM_CORE_WORD sp)
+ *	\brief	determines the cacheable target stack memory window
+ *
+ *	\param	p	the memory cache to work on
+ *	\param	sp	the target stack pointer value at the time the target halted
+ *	\return	none
+ */
+static void set_stack_window(struct mem_cache_data * p, ARM_CORE_WORD sp)
+{
+	p->stack_start = sp & ~ (MEM_CACHE_PAGE_SIZE - 1);
+	p->stack_end = p->stack_start + MEM_CACHE_STACK_WINDOW_SIZE;
+	if (p->stack_end < p->stack_start)
+		/* address wraparound */
+		p->stack_end = 0;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM mem_cache_core_get_halt_snapshot(struct gear_engine_context * ctx, struct core_halt_snapshot * snapshot)
+ *	\brief	local override for the general ctx->cc->core_get_halt_snapshot() routine
+ *
+ *	if the target has just halted, the memory cache is made
+ *	operative right away - the cacheable stack window is determined
+ *	from the target stack pointer value in the snapshot, and the
+ *	whole cacheable pages contained in the snapshot memory windows
+ *	are put in the cache; this saves reading them from the target
+ *	again when the target state change callbacks are invoked
+ *
+ *	\param	ctx	context to work in
+ *	\param	snapshot	the halt snapshot to retrieve
+ *	\return	the status code of the overridden routine
+ */
+static enum GEAR_ENGINE_ERR_ENUM mem_cache_core_get_halt_snapshot(struct gear_engine_context * ctx, struct core_halt_snapshot * snapshot)
+{
+struct mem_cache_data * p;
+struct core_mem_window * w;
+enum GEAR_ENGINE_ERR_ENUM err;
+ARM_CORE_WORD addr;
+unsigned offset;
+int i, sp_reg_nr, reg_idx;
+
+	p = ctx->mem_cache;
+	err = p->core_get_halt_snapshot_prev(ctx, snapshot);
+	if (err != GEAR_ERR_NO_ERROR || snapshot->state != TARGET_CORE_STATE_HALTED || p->is_target_halted)
+		return err;
+	sp_reg_nr = ctx->tdesc->get_target_sp_reg_nr(ctx);
+	if (!(snapshot->reg_mask & (1 << sp_reg_nr)))
+		/* the stack pointer value is not available, let
+		 * the target state change callback handle this */
+		return err;
+	for (i = reg_idx = 0; i < sp_reg_nr; i++)
+		if (snapshot->reg_mask & (1 << i))
+			reg_idx ++;
+	set_stack_window(p, snapshot->regs[reg_idx]);
+	p->is_target_halted = true;
+
+	for (i = 0; i < snapshot->nr_mem_windows; i++)
+	{
+		w = snapshot->mem_windows + i;
+		if (w->err != GEAR_ERR_NO_ERROR)
+			continue;
+		/* locate the first whole page in the window */
+		offset = (MEM_CACHE_PAGE_SIZE - (w->addr & (MEM_CACHE_PAGE_SIZE - 1))) & (MEM_CACHE_PAGE_SIZE - 1);
+		for (; offset + MEM_CACHE_PAGE_SIZE <= w->nbytes; offset += MEM_CACHE_PAGE_SIZE)
+		{
+			addr = w->addr + offset;
+			if (addr < w->addr)
+				/* address wraparound */
+				break;
+			if (find_page(p, addr) || !is_range_cacheable(p, addr, addr + MEM_CACHE_PAGE_SIZE))
+				continue;
+			memcpy(new_page(p, addr)->data, w->buf + offset, MEM_CACHE_PAGE_SIZE);
+			p->stats.nr_snapshot_pages ++;
+		}
+	}
+	return err;
+}
+
+/*!
+ *	\fn	static bool mem_cache_target_state_change_callback(struct gear_engine_context * ctx, enum TARGET_CORE_STATE_ENUM state)
+ *	\brief	the memory cache target state change callback
+ *
+ *	this routine determines if, depending on the new target state,
+ *	the memory cache should be made operative/inoperative, and
+ *	discards the cached pages that are no longer valid
+ *
+ *	\param	ctx	context to work in
+ *	\param	state	the new target state (may actually be the
+ *			same as the previous state)
+ *	\return	always true, denoting that any other target
+ *		state change callbacks should also be invoked */
+static bool mem_cache_target_state_change_callback(struct gear_engine_context * ctx, enum TARGET_CORE_STATE_ENUM state)
+{
+struct mem_cache_data * p;
+ARM_CORE_WORD sp;
+
+	p = ctx->mem_cache;
+
+	switch (state)
+	{
+		case TARGET_CORE_STATE_DEAD:
+			discard_pages(p, true);
+			p->is_target_halted = false;
+			break;
+		case TARGET_CORE_STATE_RUNNING:
+			/* keep the read-only pages */
+			if (p->is_target_halted)
+				discard_pages(p, false);
+			p->is_target_halted = false;
+			break;
+		case TARGET_CORE_STATE_HALTED:
+			if (p->is_target_halted)
+				/* nothing to do - most probably, the memory
+				 * cache has already been made operative by
+				 * mem_cache_core_get_halt_snapshot() */
+				break;
+			/* determine the cacheable stack window; this
+			 * callback is invoked before the register cache
+			 * one (see init_mem_cache()), so the register
+			 * read here is passed directly to the target */
+			p->stack_start = p->stack_end = 0;
+			if (ctx->cc->core_reg_read(ctx, 0,
+						1 << ctx->tdesc->get_target_sp_reg_nr(ctx), &sp)
+					== GEAR_ERR_NO_ERROR)
+				set_stack_window(p, sp);
+			p->is_target_halted = true;
+			break;
+		default:
+			panic("");
+	}
+	return true;
+}
+
+/*!
+ *	\fn	static void build_regions(struct gear_engine_context * ctx)
+ *	\brief	builds the list of cacheable target memory regions from the executable being debugged
+ *
+ *	the cacheable regions are the allocated sections of the
+ *	executable; the non-writable ones (e.g. .text, .rodata)
+ *	are read-only
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+static void build_regions(struct gear_engine_context * ctx)
+{
+struct mem_cache_data * p;
+Elf_Scn * scn;
+GElf_Shdr shdr;
+int nr_sections;
+
+	p = ctx->mem_cache;
+	if (!ctx->libelf_elf_desc)
+		return;
+	/* count the sections first */
+	for (nr_sections = 0, scn = 0; (scn = elf_nextscn(ctx->libelf_elf_desc, scn)); nr_sections ++)
+		;
+	if (!nr_sections)
+		return;
+	if (!(p->regions = malloc(nr_sections * sizeof * p->regions)))
+		panic("out of core");
+	for (scn = 0; (scn = elf_nextscn(ctx->libelf_elf_desc, scn)); )
+	{
+		if (!gelf_getshdr(scn, &shdr))
+			panic("");
+		if (!(shdr.sh_flags & SHF_ALLOC) || !shdr.sh_size)
+			continue;
+		p->regions[p->nr_regions].start = shdr.sh_addr;
+		p->regions[p->nr_regions].end = shdr.sh_addr + shdr.sh_size;
+		p->regions[p->nr_regions].is_read_only = !(shdr.sh_flags & SHF_WRITE);
+		p->nr_regions ++;
+	}
+}
+
+/*
+ *
+ * exported functions follow
+ *
+ */
+
+/*!
+ *	\fn	void mem_cache_invalidate(struct gear_engine_context * ctx)
+ *	\brief	discards all of the pages in the memory cache, including the read-only ones
+ *
+ *	this should be invoked whenever the read-only target memory
+ *	regions may have been changed behind the back of this module
+ *	(e.g. after target flash memory has been reprogrammed by
+ *	means of a flash loader)
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void mem_cache_invalidate(struct gear_engine_context * ctx)
+{
+	if (ctx->mem_cache)
+		discard_pages(ctx->mem_cache, true);
+}
+
+/*!
+ *	\fn	void mem_cache_prefetch(struct gear_engine_context * ctx, ARM_CORE_WORD start, ARM_CORE_WORD end)
+ *	\brief	fetches a range of target memory in the memory cache ahead of time
+ *
+ *	this is meant to be used by clients that are about to make
+ *	many small scattered reads in a known target memory range
+ *	(e.g. reading the data objects of all of the frames in a
+ *	backtrace) - the missing pages in the range are fetched
+ *	in as few target memory read requests as possible, and
+ *	the subsequent reads are then served from the cache;
+ *	if the range starts in the cacheable target stack window,
+ *	but extends past it, it is clipped to the window; otherwise,
+ *	if the range is not cacheable, or spans more than
+ *	MEM_CACHE_MAX_PAGES pages, this routine does nothing;
+ *	errors are ignored - the memory in question will
+ *	simply be read again, when needed
+ *
+ *	\param	ctx	context to work in
+ *	\param	start	the start address of the range
+ *	\param	end	the end address of the range (the first address
+ *			past the range)
+ *	\return	none
+ */
+void mem_cache_prefetch(struct gear_engine_context * ctx, ARM_CORE_WORD start, ARM_CORE_WORD end)
+{
+struct mem_cache_data * p;
+
+	if (!(p = ctx->mem_cache) || !p->is_target_halted || end <= start)
+		return;
+	if (p->stack_start <= start && start < p->stack_end && p->stack_end < end)
+		end = p->stack_end;
+	if (!is_range_cacheable(p, start, end)
+			|| ((end - 1) / MEM_CACHE_PAGE_SIZE - start / MEM_CACHE_PAGE_SIZE) >= MEM_CACHE_MAX_PAGES)
+		return;
+	fetch_missing_pages(ctx, start & ~ (MEM_CACHE_PAGE_SIZE - 1), (end - 1) & ~ (MEM_CACHE_PAGE_SIZE - 1), true);
+}
+
+/*!
+ *	\fn	void mem_cache_dump_stats_mi(struct gear_engine_context * ctx)
+ *	\brief	dumps memory cache statistics, in machine interface format
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void mem_cache_dump_stats_mi(struct gear_engine_context * ctx)
+{
+struct mem_cache_data * p;
+
+	if (!(p = ctx->mem_cache))
+	{
+		miprintf("MEM_CACHE = [ENABLED = 0,],");
+		return;
+	}
+	miprintf("MEM_CACHE = [ENABLED = 1, PAGE_SIZE = %i, NR_PAGES = %i, "
+			"HITS = %i, MISSES = %i, PREFETCHED_PAGES = %i, BYPASSED_READS = %i, INVALIDATIONS = %i, SNAPSHOT_PAGES = %i,],",
+			MEM_CACHE_PAGE_SIZE, p->nr_pages,
+			p->stats.nr_hits, p->stats.nr_misses, p->stats.nr_prefetched_pages,
+			p->stats.nr_bypassed_reads, p->stats.nr_invalidations,
+			p->stats.nr_snapshot_pages);
+}
+
+/*!
+ *	\fn	void init_mem_cache(struct gear_engine_context * ctx)
+ *	\brief	initializes the target memory cache
+ *
+ *	\note	this routine installs hooks overriding the
+ *		current context core control routines for accessing
+ *		(reading and writing) target memory, namely
+ *		ctx->cc->core_mem_read() and ctx->cc->core_mem_write();
+ *		it must therefore be invoked after the core control
+ *		initialization; it should also be invoked after all
+ *		other modules have installed their target state change
+ *		callbacks, so that the memory cache callback is invoked
+ *		first, and other callbacks do not see stale cached
+ *		target memory contents; also read the comments at
+ *		the start of this file
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void init_mem_cache(struct gear_engine_context * ctx)
+{
+struct mem_cache_data * p;
+
+	/* allocate the private visible data in the current gear engine context */
+	if (!(p = calloc(1, sizeof * p)))
+		panic("out of core");
+	ctx->mem_cache = p;
+	build_regions(ctx);
+
+	/* install memory access override hooks */
+	p->core_mem_read_prev = ctx->cc->core_mem_read;
+	p->core_mem_write_prev = ctx->cc->core_mem_write;
+	p->core_get_halt_snapshot_prev = ctx->cc->core_get_halt_snapshot;
+	if (!p->core_mem_read_prev || !p->core_mem_write_prev || !p->core_get_halt_snapshot_prev)
+		panic("");
+	/* install the target state change callback */
+	if (ctx->cc->core_register_target_state_change_callback(ctx,
+			mem_cache_target_state_change_callback) != GEAR_ERR_NO_ERROR)
+		panic("");
+
+	ctx->cc->core_mem_read = mem_cache_core_mem_read;
+	ctx->cc->core_mem_write = mem_cache_core_mem_write;
+	ctx->cc->core_get_halt_snapshot = mem_cache_core_get_halt_snapshot;
+	gprintf("target memory cache installed, %i cacheable regions\n", p->nr_regions);
+}
@@ -0,0 +1,20 @@
+/*!
+ * \file	mem-cache.h
+ * \brief	target memory cache header
+ * \author	shopov
+ *
+ *
+ * Revision summary:
+ *
+ * $Log: $
+ */
+
+/*
+ *
+ * exported function prototypes follow
+ *
+ */
+void mem_cache_invalidate(struct gear_engine_context * ctx);
+void mem_cache_prefetch(struct gear_engine_context * ctx, ARM_CORE_WORD start, ARM_CORE_WORD end);
+void mem_cache_dump_stats_mi(struct gear_engine_context * ctx);
+void init_mem_cache(struct gear_engine_context * ctx);
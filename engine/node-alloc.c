@@ -0,0 +1,342 @@
+/*!
+ * \file	node-alloc.c
+ * \brief	debug information node allocator
+ * \author	shopov
+ *
+ *	all of the debug information tree nodes (compilation units,
+ *	subprograms, lexical blocks, data objects, data types), and
+ *	the symbol table and type hash nodes, are allocated here;
+ *	these are very numerous, quite small, and are (for the
+ *	time being) never individually freed - so that allocating
+ *	them one by one with malloc() wastes a lot of memory (and time)
+ *	on heap housekeeping; instead, nodes are carved out of large
+ *	memory chunks, and all of them are freed at once (see
+ *	node_alloc_free_all()) when the debug information is discarded
+ *	(see dwarf_hacked_shutdown() in arena.c)
+ *
+ *	there is a separate pool of chunks for each kind of node
+ *	(see enum ::NODE_KIND_ENUM), so that nodes of the same kind
+ *	are kept together in memory, and so that the memory used
+ *	by each kind of node can be accounted for; the node
+ *	allocation statistics are kept in ::type_access_stats
+ *
+ * Revision summary:
+ *
+ * $Log: $
+ */
+
+/*
+ *
+ * include section follows
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "dwarf-common.h"
+#include "gear-engine-context.h"
+#include "util.h"
+#include "gprintf.h"
+#include "miprintf.h"
+#include "node-alloc.h"
+
+/*
+ *
+ * local definitions follow
+ *
+ */
+
+/*! the size of a memory chunk that nodes are carved from, in bytes */
+#define NODE_CHUNK_SIZE		(64 * 1024)
+/*! the alignment of the nodes allocated, in bytes; must be a power of two */
+#define NODE_ALIGN		8
+
+/*
+ *
+ * local data types follows
+ *
+ */
+
+/*! a memory chunk that nodes are carved from */
+struct node_chunk
+{
+	/*! link pointer for the chunk list of a node pool */
+	struct node_chunk	* next;
+	/*! the memory that nodes are carved from */
+	unsigned char		mem[];
+};
+
+/*! a node given back with node_unalloc(), kept for reuse
+ *
+ * the free node memory itself holds this structure */
+struct node_free
+{
+	/*! link pointer for the free node list of a node pool */
+	struct node_free	* next;
+	/*! the (aligned) size of the free node, in bytes */
+	unsigned int		size;
+};
+
+/*! the debug information node allocator data structure
+ *
+ * this holds one pool of memory chunks for each kind of node;
+ * nodes are allocated from the first chunk of the chunk list
+ * of a pool, and a new chunk is put in front of the list
+ * when this chunk is exhausted */
+struct node_arena
+{
+	/*! the node pools */
+	struct node_pool
+	{
+		/*! the list of chunks of this pool, the chunk that nodes are currently allocated from is the first one */
+		struct node_chunk	* chunks;
+		/*! the number of free bytes left in the first chunk of the chunks list above */
+		unsigned int		nr_free_bytes;
+		/*! the list of nodes given back with node_unalloc() that could not be returned to the first chunk; these are handed out again, most recently given back first */
+		struct node_free	* free_nodes;
+	}
+	pools[NR_NODE_KINDS];
+	/*! the total number of bytes allocated for chunks, for all pools */
+	unsigned long		nr_chunk_bytes;
+};
+
+/*
+ *
+ * local data follows
+ *
+ */
+
+/*! human readable names of the node kinds, in the order of enum ::NODE_KIND_ENUM */
+static const char * node_kind_names[NR_NODE_KINDS] =
+{
+	[NODE_KIND_CU]		= "compilation unit",
+	[NODE_KIND_SUBPROGRAM]	= "subprogram",
+	[NODE_KIND_LEXBLOCK]	= "lexical block",
+	[NODE_KIND_DOBJ]	= "data object",
+	[NODE_KIND_DTYPE]	= "data type",
+	[NODE_KIND_SYM]		= "symbol",
+	[NODE_KIND_SYMTAB_HASH]	= "symbol table hash",
+	[NODE_KIND_TYPE_NAME]	= "type name index",
+};
+
+/*! machine interface names of the node kinds, in the order of enum ::NODE_KIND_ENUM */
+static const char * node_kind_mi_names[NR_NODE_KINDS] =
+{
+	[NODE_KIND_CU]		= "CU",
+	[NODE_KIND_SUBPROGRAM]	= "SUBPROGRAM",
+	[NODE_KIND_LEXBLOCK]	= "LEXBLOCK",
+	[NODE_KIND_DOBJ]	= "DOBJ",
+	[NODE_KIND_DTYPE]	= "DTYPE",
+	[NODE_KIND_SYM]		= "SYM",
+	[NODE_KIND_SYMTAB_HASH]	= "SYMTAB_HASH",
+	[NODE_KIND_TYPE_NAME]	= "TYPE_NAME",
+};
+
+/*
+ *
+ * local functions follow
+ *
+ */
+
+/*!
+ *	\fn	static unsigned int node_align_size(unsigned int size)
+ *	\brief	rounds a node size up to the node alignment
+ *
+ *	\param	size	the node size to round up
+ *	\return	the rounded up node size
+ */
+static unsigned int node_align_size(unsigned int size)
+{
+	return (size + NODE_ALIGN - 1) & ~(NODE_ALIGN - 1);
+}
+
+/*
+ *
+ * exported functions follow
+ *
+ */
+
+/*!
+ *	\fn	void * node_alloc(struct gear_engine_context * ctx, enum NODE_KIND_ENUM kind, unsigned int size)
+ *	\brief	allocates a debug information node
+ *
+ *	\param	ctx	context to work in
+ *	\param	kind	the kind of the node to allocate
+ *	\param	size	the size of the node to allocate, in bytes
+ *	\return	a pointer to the newly allocated node; the node
+ *		is zero-initialized; this function never fails
+ */
+void * node_alloc(struct gear_engine_context * ctx, enum NODE_KIND_ENUM kind, unsigned int size)
+{
+struct node_pool * pool;
+struct node_chunk * chunk;
+struct node_free * node;
+unsigned int chunk_size;
+
+	if (kind < 0 || kind >= NR_NODE_KINDS)
+		panic("");
+	if (!ctx->node_arena && !(ctx->node_arena = calloc(1, sizeof * ctx->node_arena)))
+		panic("out of core");
+	pool = ctx->node_arena->pools + kind;
+	size = node_align_size(size);
+	if (pool->free_nodes && pool->free_nodes->size == size)
+	{
+		/* reuse a node given back; nodes of a kind are
+		 * (nearly) always of the same size, so only
+		 * the first free node is checked */
+		node = pool->free_nodes;
+		pool->free_nodes = pool->free_nodes->next;
+		memset(node, 0, size);
+		type_access_stats.node_alloc_stats[kind].nr_nodes ++;
+		type_access_stats.node_alloc_stats[kind].nr_bytes += size;
+		return node;
+	}
+	if (size > pool->nr_free_bytes)
+	{
+		/* get a new chunk; oversized nodes get
+		 * a chunk of their own */
+		chunk_size = size > NODE_CHUNK_SIZE ? size : NODE_CHUNK_SIZE;
+		if (!(chunk = calloc(1, sizeof * chunk + chunk_size)))
+			panic("out of core");
+		chunk->next = pool->chunks;
+		pool->chunks = chunk;
+		pool->nr_free_bytes = chunk_size;
+		ctx->node_arena->nr_chunk_bytes += sizeof * chunk + chunk_size;
+	}
+	/* nodes are carved from the end of a chunk */
+	pool->nr_free_bytes -= size;
+	type_access_stats.node_alloc_stats[kind].nr_nodes ++;
+	type_access_stats.node_alloc_stats[kind].nr_bytes += size;
+	return pool->chunks->mem + pool->nr_free_bytes;
+}
+
+/*!
+ *	\fn	void node_unalloc(struct gear_engine_context * ctx, enum NODE_KIND_ENUM kind, void * node, unsigned int size)
+ *	\brief	gives back a node of a given kind
+ *
+ *	this is used for dropping nodes that turn out to be duplicates
+ *	of already existing ones after they have been built (e.g. when
+ *	merging data types); if the node is the one most recently
+ *	carved from the first chunk of the pool of its kind, its memory
+ *	is returned to the chunk, otherwise the node is put on the
+ *	free node list of the pool, and is handed out again by
+ *	node_alloc() for the next node of the same size
+ *
+ *	\param	ctx	context to work in
+ *	\param	kind	the kind of the node to give back
+ *	\param	node	the node to give back
+ *	\param	size	the size of the node, as passed to node_alloc()
+ *	\return	none
+ */
+void node_unalloc(struct gear_engine_context * ctx, enum NODE_KIND_ENUM kind, void * node, unsigned int size)
+{
+struct node_pool * pool;
+
+	if (kind < 0 || kind >= NR_NODE_KINDS || !ctx->node_arena)
+		panic("");
+	pool = ctx->node_arena->pools + kind;
+	size = node_align_size(size);
+	type_access_stats.node_alloc_stats[kind].nr_nodes --;
+	type_access_stats.node_alloc_stats[kind].nr_bytes -= size;
+	if (pool->chunks && (unsigned char *) node == pool->chunks->mem + pool->nr_free_bytes)
+	{
+		memset(node, 0, size);
+		pool->nr_free_bytes += size;
+	}
+	else if (size >= sizeof(struct node_free))
+	{
+		((struct node_free *) node)->next = pool->free_nodes;
+		((struct node_free *) node)->size = size;
+		pool->free_nodes = node;
+	}
+}
+
+/*!
+ *	\fn	void node_alloc_free_all(struct gear_engine_context * ctx)
+ *	\brief	frees all debug information nodes at once
+ *
+ *	\note	this invalidates all of the debug information trees,
+ *		the symbol table and the type hash table; these must
+ *		all be discarded (and rebuilt, if needed) after
+ *		calling this
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void node_alloc_free_all(struct gear_engine_context * ctx)
+{
+struct node_chunk * chunk;
+int i;
+
+	if (!ctx->node_arena)
+		return;
+	for (i = 0; i < NR_NODE_KINDS; i++)
+	{
+		while ((chunk = ctx->node_arena->pools[i].chunks))
+		{
+			ctx->node_arena->pools[i].chunks = chunk->next;
+			free(chunk);
+		}
+		type_access_stats.node_alloc_stats[i].nr_nodes = 0;
+		type_access_stats.node_alloc_stats[i].nr_bytes = 0;
+	}
+	free(ctx->node_arena);
+	ctx->node_arena = 0;
+}
+
+/*!
+ *	\fn	unsigned long node_alloc_get_total_bytes(void)
+ *	\brief	returns the total number of bytes used by debug information nodes of all kinds
+ *
+ *	\return	the total number of bytes used by debug
+ *		information nodes of all kinds
+ */
+unsigned long node_alloc_get_total_bytes(void)
+{
+unsigned long nr_bytes;
+int i;
+
+	for (nr_bytes = i = 0; i < NR_NODE_KINDS; i++)
+		nr_bytes += type_access_stats.node_alloc_stats[i].nr_bytes;
+	return nr_bytes;
+}
+
+/*!
+ *	\fn	void node_alloc_dump_stats(struct gear_engine_context * ctx)
+ *	\brief	prints debug information node allocation statistics
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void node_alloc_dump_stats(struct gear_engine_context * ctx)
+{
+int i;
+
+	gprintf("debug information node memory usage:\n");
+	for (i = 0; i < NR_NODE_KINDS; i++)
+		gprintf("%s nodes: %i, %lu bytes\n", node_kind_names[i],
+				type_access_stats.node_alloc_stats[i].nr_nodes,
+				type_access_stats.node_alloc_stats[i].nr_bytes);
+	gprintf("total: %lu bytes in nodes, %lu bytes in chunks\n", node_alloc_get_total_bytes(),
+			ctx->node_arena ? ctx->node_arena->nr_chunk_bytes : 0);
+}
+
+/*!
+ *	\fn	void node_alloc_dump_mem_usage_mi(struct gear_engine_context * ctx)
+ *	\brief	dumps debug information node allocation statistics, in machine interface format
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void node_alloc_dump_mem_usage_mi(struct gear_engine_context * ctx)
+{
+int i;
+
+	miprintf("NODES = [CHUNK_BYTES = %lu, ", ctx->node_arena ? ctx->node_arena->nr_chunk_bytes : 0);
+	for (i = 0; i < NR_NODE_KINDS; i++)
+		miprintf("%s = [NR_NODES = %i, BYTES = %lu,],", node_kind_mi_names[i],
+				type_access_stats.node_alloc_stats[i].nr_nodes,
+				type_access_stats.node_alloc_stats[i].nr_bytes);
+	miprintf("],");
+}
@@ -0,0 +1,22 @@
+/*!
+ * \file	node-alloc.h
+ * \brief	debug information node allocator header file
+ * \author	shopov
+ *
+ *
+ * Revision summary:
+ *
+ * $Log: $
+ */
+
+/*
+ *
+ * exported function prototypes follow
+ *
+ */
+void * node_alloc(struct gear_engine_context * ctx, enum NODE_KIND_ENUM kind, unsigned int size);
+void node_unalloc(struct gear_engine_context * ctx, enum NODE_KIND_ENUM kind, void * node, unsigned int size);
+void node_alloc_free_all(struct gear_engine_context * ctx);
+unsigned long node_alloc_get_total_bytes(void);
+void node_alloc_dump_stats(struct gear_engine_context * ctx);
+void node_alloc_dump_mem_usage_mi(struct gear_engine_context * ctx);
@@ -0,0 +1,367 @@
+/*!
+ *	\file	scope-test.c
+ *	\brief	scope table torture test
+ *	\author	shopov
+ *
+ *	this is a test program for the per compilation unit scope
+ *	tables (see aranges_get_scope_chain_for_addr() in
+ *	aranges-access.c); it is meant to be run on an executable
+ *	built from gemstones/inline-tests.c (nested inline-expanded
+ *	subprograms, nested functions, lexical blocks, scopes
+ *	with noncontiguous address ranges, and scopes whose address
+ *	ranges are not contained in the address ranges of their
+ *	parent scopes), e.g. by 'make scope-test-run', but it works on
+ *	any executable with dwarf debug information
+ *
+ *	for every compilation unit, the test probes every address
+ *	covered by a top level subprogram, and also the addresses
+ *	around the start and the end of every address range of
+ *	every scope (i.e. low - 1, low, high - 1 and high), and
+ *	compares the chain of scopes returned by
+ *	aranges_get_scope_chain_for_addr() with the result of a
+ *	brute force walk of the debug information tree of the
+ *	compilation unit - the scope returned must be one of
+ *	the most deeply nested scopes containing the address probed,
+ *	and the parent links of the scope chain must match the
+ *	nesting of scopes in the debug information tree
+ *
+ *	the exit status is zero if no mismatches are found,
+ *	and nonzero otherwise
+ *
+ *	Revision summary:
+ *
+ *	$Log: $
+ */
+
+/*
+ *
+ * include section follows
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+
+int gprintf(const char * format, ...);
+
+#include "dwarf-common.h"
+#include "target-defs.h"
+#include "gear-engine-context.h"
+#include "engine-err.h"
+#include "core-access.h"
+#include "dwarf-expr.h"
+#include "dwarf-loc.h"
+#include "symtab.h"
+#include "type-access.h"
+#include "aranges-access.h"
+#include "util.h"
+#include "cu-access.h"
+#include "subprogram-access.h"
+#include "lexblock-access.h"
+#include "dwarf-ranges.h"
+
+
+/*
+ *
+ * local definitions follow
+ *
+ */
+
+/*! the maximum scope nesting depth supported by the reference walk */
+#define MAX_SCOPE_DEPTH		64
+
+/*! the state of the brute force reference walk for a single address */
+struct ref_walk_state
+{
+	/*! the address probed */
+	ARM_CORE_WORD		addr;
+	/*! the compilation unit walked */
+	struct cu_data		* cu;
+	/*! the scope found by the scope table lookup, can be null */
+	struct scope_chain_node	* found;
+	/*! the nesting depth of the most deeply nested scope containing ::addr, -1 if none */
+	int			max_depth;
+	/*! true, if ::found was located in the debug information tree, at the nesting given by its scope chain */
+	bool			is_found_in_tree;
+	/*! the path from the top level subprogram to the scope currently walked */
+	struct dwarf_head_struct	* path[MAX_SCOPE_DEPTH];
+};
+
+extern void dwarf_hacked_init(struct gear_engine_context * ctx);
+extern void dwarf_hacked_shutdown(struct gear_engine_context * ctx);
+
+/*! the number of addresses probed */
+static int nr_probes;
+/*! the number of mismatches found */
+static int nr_mismatches;
+
+
+/*
+ *
+ * local functions follow
+ *
+ */
+
+/*!
+ *	\fn	static const char * scope_name(struct dwarf_head_struct * scope)
+ *	\brief	returns a printable name for a scope, for diagnostics
+ *
+ *	\param	scope	the scope of interest
+ *	\return	the name of the scope
+ */
+static const char * scope_name(struct dwarf_head_struct * scope)
+{
+const char * name;
+
+	if (!scope)
+		return "<none>";
+	switch (scope->tag)
+	{
+		case DW_TAG_subprogram:
+		case DW_TAG_inlined_subroutine:
+			name = ((struct subprogram_data *) scope)->name;
+			return name ? name : "<anonymous subprogram>";
+		case DW_TAG_lexical_block:
+			return "<lexical block>";
+	}
+	return "<unknown scope>";
+}
+
+/*!
+ *	\fn	static bool is_addr_in_ranges(struct gear_engine_context * ctx, struct cu_data * cu, struct dwarf_ranges_struct * addr_ranges, ARM_CORE_WORD addr)
+ *	\brief	determines if an address is contained in a list of address ranges
+ *
+ *	\param	ctx	gear engine context
+ *	\param	cu	the compilation unit that the address ranges belong to
+ *	\param	addr_ranges	the address ranges to search
+ *	\param	addr	the address of interest
+ *	\return	true, if the address is contained in the address ranges, false otherwise
+ */
+static bool is_addr_in_ranges(struct gear_engine_context * ctx, struct cu_data * cu, struct dwarf_ranges_struct * addr_ranges, ARM_CORE_WORD addr)
+{
+ARM_CORE_WORD lo, hi;
+int i, nr_ranges;
+
+	nr_ranges = dwarf_ranges_get_range_count(ctx, addr_ranges);
+	for (i = 0; i < nr_ranges; i++)
+	{
+		dwarf_ranges_get_range_data_at_idx(ctx, addr_ranges, i,
+				cu->default_cu_base_address, &lo, &hi);
+		if (lo <= addr && addr < hi)
+			return true;
+	}
+	return false;
+}
+
+/*!
+ *	\fn	static void ref_walk(struct gear_engine_context * ctx, struct ref_walk_state * state, struct dwarf_head_struct * scope, struct dwarf_ranges_struct * addr_ranges, struct lexblock_data * lexblocks, struct subprogram_data * subps, int depth)
+ *	\brief	brute force reference walk of a scope subtree
+ *
+ *	all scopes in the subtree are visited, regardless of
+ *	whether their parents contain the address probed or not; the
+ *	deepest nesting level of a scope containing the address is
+ *	recorded, and if the scope found by the scope table lookup
+ *	is met, the path to it in the debug information tree is
+ *	checked against its scope chain
+ *
+ *	\param	ctx	gear engine context
+ *	\param	state	the reference walk state
+ *	\param	scope	the scope to walk
+ *	\param	addr_ranges	the address ranges of the scope
+ *	\param	lexblocks	the lexical blocks nested in the scope
+ *	\param	subps	the inline-expanded (and nested) subprograms in the scope
+ *	\param	depth	the nesting depth of the scope
+ *	\return	none
+ */
+static void ref_walk(struct gear_engine_context * ctx, struct ref_walk_state * state,
+		struct dwarf_head_struct * scope, struct dwarf_ranges_struct * addr_ranges,
+		struct lexblock_data * lexblocks, struct subprogram_data * subps, int depth)
+{
+struct lexblock_data * l;
+struct subprogram_data * s;
+struct scope_chain_node * node;
+bool is_in_scope;
+int i;
+
+	if (depth >= MAX_SCOPE_DEPTH)
+		panic("scope nesting too deep");
+	state->path[depth] = scope;
+	is_in_scope = is_addr_in_ranges(ctx, state->cu, addr_ranges, state->addr);
+	if (is_in_scope && depth > state->max_depth)
+		state->max_depth = depth;
+	if (is_in_scope && state->found && state->found->scope == scope
+			&& state->found->depth == depth)
+	{
+		/* match the scope chain against the path in the tree */
+		for (i = depth, node = state->found; node && i >= 0; i--, node = node->parent)
+			if (node->scope != state->path[i] || node->depth != i)
+				break;
+		if (!node && i < 0)
+			state->is_found_in_tree = true;
+	}
+	for (l = lexblocks; l; l = l->sib_ptr)
+		ref_walk(ctx, state, &l->head, l->addr_ranges, l->lexblocks, l->inlined_subprograms, depth + 1);
+	for (s = subps; s; s = s->sib_ptr)
+		ref_walk(ctx, state, &s->head, s->addr_ranges, s->lexblocks, s->inlined_subprograms, depth + 1);
+}
+
+/*!
+ *	\fn	static void probe_addr(struct gear_engine_context * ctx, struct cu_data * cu, ARM_CORE_WORD addr)
+ *	\brief	checks the scope chain returned for an address against the reference walk
+ *
+ *	\param	ctx	gear engine context
+ *	\param	cu	the compilation unit being tested
+ *	\param	addr	the address to probe
+ *	\return	none
+ */
+static void probe_addr(struct gear_engine_context * ctx, struct cu_data * cu, ARM_CORE_WORD addr)
+{
+struct ref_walk_state state;
+struct subprogram_data * subp;
+struct cu_data * found_cu;
+struct scope_chain_node * node;
+
+	nr_probes++;
+	memset(&state, 0, sizeof state);
+	state.addr = addr;
+	state.max_depth = -1;
+	state.found = aranges_get_scope_chain_for_addr(ctx, addr, &found_cu);
+	if (found_cu != cu)
+	{
+		/* the address is in a different compilation unit (or
+		 * in none at all) - e.g. when probing just past the
+		 * end of a range; this is tested when walking that
+		 * compilation unit */
+		nr_probes--;
+		return;
+	}
+	state.cu = cu;
+	for (subp = cu->subs; subp; subp = subp->sib_ptr)
+		ref_walk(ctx, &state, &subp->head, subp->addr_ranges, subp->lexblocks, subp->inlined_subprograms, 0);
+
+	if (state.max_depth == -1 && !state.found)
+		return;
+	if (state.found && state.found->depth == state.max_depth && state.is_found_in_tree)
+		return;
+
+	nr_mismatches++;
+	printf("MISMATCH at address 0x%08x in compilation unit %s:\n", (unsigned int) addr, cu->name);
+	printf("\texpected scope nesting depth %i, scope table returned depth %i%s\n",
+			state.max_depth, state.found ? state.found->depth : -1,
+			(state.found && !state.is_found_in_tree) ? " (scope chain does not match the debug information tree)" : "");
+	printf("\tscope chain returned:");
+	for (node = state.found; node; node = node->parent)
+		printf(" %s", scope_name(node->scope));
+	printf("\n");
+}
+
+/*!
+ *	\fn	static void probe_range_boundaries(struct gear_engine_context * ctx, struct cu_data * cu, struct dwarf_ranges_struct * addr_ranges, struct lexblock_data * lexblocks, struct subprogram_data * subps)
+ *	\brief	probes the addresses around the boundaries of all address ranges of all scopes in a scope subtree
+ *
+ *	\param	ctx	gear engine context
+ *	\param	cu	the compilation unit being tested
+ *	\param	addr_ranges	the address ranges of the scope
+ *	\param	lexblocks	the lexical blocks nested in the scope
+ *	\param	subps	the inline-expanded (and nested) subprograms in the scope
+ *	\return	none
+ */
+static void probe_range_boundaries(struct gear_engine_context * ctx, struct cu_data * cu,
+		struct dwarf_ranges_struct * addr_ranges,
+		struct lexblock_data * lexblocks, struct subprogram_data * subps)
+{
+struct lexblock_data * l;
+struct subprogram_data * s;
+ARM_CORE_WORD lo, hi;
+int i, nr_ranges;
+
+	nr_ranges = dwarf_ranges_get_range_count(ctx, addr_ranges);
+	for (i = 0; i < nr_ranges; i++)
+	{
+		dwarf_ranges_get_range_data_at_idx(ctx, addr_ranges, i,
+				cu->default_cu_base_address, &lo, &hi);
+		if (lo >= hi)
+			continue;
+		if (lo)
+			probe_addr(ctx, cu, lo - 1);
+		probe_addr(ctx, cu, lo);
+		probe_addr(ctx, cu, hi - 1);
+		probe_addr(ctx, cu, hi);
+	}
+	for (l = lexblocks; l; l = l->sib_ptr)
+		probe_range_boundaries(ctx, cu, l->addr_ranges, l->lexblocks, l->inlined_subprograms);
+	for (s = subps; s; s = s->sib_ptr)
+		probe_range_boundaries(ctx, cu, s->addr_ranges, s->lexblocks, s->inlined_subprograms);
+}
+
+/*!
+ *	\fn	static void test_cu(struct gear_engine_context * ctx, struct cu_data * cu)
+ *	\brief	runs the scope table tests for a compilation unit
+ *
+ *	\param	ctx	gear engine context
+ *	\param	cu	the compilation unit to test
+ *	\return	none
+ */
+static void test_cu(struct gear_engine_context * ctx, struct cu_data * cu)
+{
+struct subprogram_data * subp;
+ARM_CORE_WORD lo, hi, addr;
+int i, nr_ranges;
+
+	for (subp = cu->subs; subp; subp = subp->sib_ptr)
+	{
+		/* probe every address covered by the top level subprogram */
+		nr_ranges = dwarf_ranges_get_range_count(ctx, subp->addr_ranges);
+		for (i = 0; i < nr_ranges; i++)
+		{
+			dwarf_ranges_get_range_data_at_idx(ctx, subp->addr_ranges, i,
+					cu->default_cu_base_address, &lo, &hi);
+			for (addr = lo; addr < hi; addr++)
+				probe_addr(ctx, cu, addr);
+		}
+		/* probe the scope boundaries */
+		probe_range_boundaries(ctx, cu, subp->addr_ranges, subp->lexblocks, subp->inlined_subprograms);
+	}
+}
+
+
+/*
+ *
+ * exported functions follow
+ *
+ */
+
+int main(int argc, char ** argv)
+{
+struct gear_engine_context ctx;
+Dwarf_Off * cu_offsets;
+int i, nr_cus;
+
+	if (argc != 2)
+	{
+		printf("usage: %s <elf-file>\n", argv[0]);
+		printf("\t(e.g. an executable built from gemstones/inline-tests.c)\n");
+		return 2;
+	}
+	memset(& ctx, 0, sizeof ctx);
+
+	init_types(& ctx);
+	init_symtab(& ctx);
+
+	ctx.dbg_info_elf_disk_file_name = strdup(argv[1]);
+	dwarf_hacked_init(& ctx);
+	init_aranges(& ctx);
+
+	cu_offsets = cu_get_die_offsets(& ctx, & nr_cus);
+	for (i = 0; i < nr_cus; i++)
+		test_cu(& ctx, cu_process(& ctx, cu_offsets[i]));
+
+	printf("%i compilation units tested, %i addresses probed, %i mismatches\n",
+			nr_cus, nr_probes, nr_mismatches);
+	dwarf_hacked_shutdown(& ctx);
+	return nr_mismatches ? 1 : 0;
+}
+
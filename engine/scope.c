@@ -34,6 +34,7 @@
 #include "scope.h"
 #include "aranges-access.h"
 #include "dwarf-util.h"
+#include "dwarf-pubnames.h"
 
 /*
  *
@@ -50,6 +51,11 @@
  *	\fn	static struct dwarf_head_struct * deprecated_lookup_global_scope(struct gear_engine_context * ctx, const char * name, const struct scope_resolution_flags flags)
  *	\brief	performs identifier lookup using the global scope only
  *
+ *	only data object and subroutine symbols are considered;
+ *	if more than one of these is found for the name (e.g. static
+ *	data objects of the same name in different compilation
+ *	units), the first one found is returned
+ *
  *	\todo	properly handle duplicate (non-unique) symbols in the symbol table
  *
  *	\param	ctx	context to work in
@@ -60,24 +66,36 @@
  *		identifier (if one is found), null otherwise */
 static struct dwarf_head_struct * deprecated_lookup_global_scope(struct gear_engine_context * ctx, const char * name, const struct scope_resolution_flags flags)
 {
-struct sym_struct * sym;
+struct sym_struct * sym, * dup;
 	/* all of the global symbols must be in the
 	 * engine symbol table, so just look it up */
 	sym = symtab_find_sym(ctx, name);
-	if (!sym)
-		return 0;
+	/* if compilation unit trees are built on demand,
+	 * the symbol may be in a compilation unit which has
+	 * not been built yet - in this case, build just the
+	 * compilation unit(s) that the global identifier name
+	 * index knows to define the symbol, and retry the lookup;
+	 * if the index does not know the symbol, nothing is built */
+	if (!sym && ctx->settings.is_lazy_cu_build_enabled
+			&& dwarf_pubnames_build_cus_for_name(ctx, name))
+		sym = symtab_find_sym(ctx, name);
 	/*! \todo	properly determine (based on flag
 	 *		values) what kind of symbol is
 	 *		expected and properly handle
 	 *		the case with multiple symbols
 	 *		found */
-	if (sym->next || (sym->symclass != SYM_DATA_OBJECT && sym->symclass != SYM_SUBROUTINE))
-	{
-		panic("");
-	}
-	else
-		return sym->dobj;
-	panic("");
+	for (; sym; sym = sym->next)
+		if (sym->symclass == SYM_DATA_OBJECT || sym->symclass == SYM_SUBROUTINE)
+			break;
+	if (!sym)
+		return 0;
+	for (dup = sym->next; dup; dup = dup->next)
+		if (dup->symclass == SYM_DATA_OBJECT || dup->symclass == SYM_SUBROUTINE)
+		{
+			gprintf("%s(): identifier '%s' is not unique, using the first definition found\n", __func__, name);
+			break;
+		}
+	return sym->dobj;
 }
 
 
@@ -107,6 +125,7 @@ struct subprogram_data * subp;
 struct lexblock_data * lexblock;
 struct dobj_data * dobj;
 struct cu_data * cu;
+struct scope_chain_node * scope;
 void * lookup_node;
 ARM_CORE_WORD pc;
 
@@ -135,8 +154,13 @@ ARM_CORE_WORD pc;
 				(struct scope_resolution_flags) { .global_scope_only = 1, });
 	}
 
-	if (!(lookup_node = aranges_get_lexblock_for_addr(ctx, pc)))
-		lookup_node = aranges_get_subp_for_addr(ctx, pc);
+	/* start from the innermost scope containing the program
+	 * counter - this may well be a lexical block, or an
+	 * inline-expanded subprogram, nested in the subprogram
+	 * containing the program counter */
+	lookup_node = 0;
+	if ((scope = aranges_get_scope_chain_for_addr(ctx, pc, 0)))
+		lookup_node = scope->scope;
 
 	 /* it doesnt make much sense to look
 	  * at file (compilation unit) scope any further - even if
@@ -189,7 +213,7 @@ ARM_CORE_WORD pc;
 				dobj = subp->vars;
 				while (dobj)
 				{
-					if (!strcmp(name, dobj->name))
+					if (dobj->name && !strcmp(name, dobj->name))
 					{
 						return dobj;
 					}
@@ -61,6 +61,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
+/* for elf_hash()... */
+#include <libelf.h>
 
 #include "dwarf-common.h"
 #include "target-defs.h"
@@ -79,6 +81,7 @@
 #include "aranges-access.h"
 #include "dwarf-ranges.h"
 #include "engine-err.h"
+#include "index-cache.h"
 
 
 /*
@@ -99,6 +102,9 @@ enum LINE_CONTEXT_QUANTITY
 	ASSEMBLY_ONLY_OUTPUT = 15,
 };
 
+/*! the initial number of elements in the source file name hash table; the hash table doubles when grown */
+#define SRCNAME_HTAB_INITIAL_SIZE	256
+
 /*
  *
  * local data types follow
@@ -114,6 +120,81 @@ struct src_data
 	struct srclist_cu_node		* cus;
 	/*! source file names list head */
 	struct srclist_srcfile_node	* srcs;
+	/*! the number of nodes in the srcs list above */
+	int				nr_srcs;
+	/*! source file name hash table, used for quickly locating source file list nodes by name
+	 *
+	 * this is a chained hash table, the chains are linked by
+	 * the hash_next field of the source file list nodes; the hash
+	 * table is grown (and rehashed) whenever the number of source
+	 * files exceeds the hash table size; see locate_srcname() */
+	struct srclist_srcfile_node	** srcname_htab;
+	/*! the number of elements in the srcname_htab array above; always a power of two */
+	int				srcname_htab_size;
+	/*! the number of compilation unit line number tables decoded so far */
+	int				nr_line_tabs;
+	/*! the total number of rows in all line number tables decoded so far */
+	int				nr_line_tab_rows;
+	/*! the total core (in bytes) taken by all line number tables decoded so far */
+	unsigned long			line_tab_bytes;
+};
+
+/*! a single row of a decoded dwarf line number program
+ *
+ * the line number information for a compilation unit, as
+ * returned by libdwarf (in the cu_data linebuf array), is
+ * very slow to search - every single field of every single
+ * row must be retrieved by a separate libdwarf call; therefore,
+ * whenever the line number information for a compilation
+ * unit is first needed, it is decoded once into an array of
+ * these compact rows, sorted by target core address, which
+ * can be binary searched; see get_cu_line_tab() for details */
+struct line_tab_row
+{
+	/*! the target core address for this row */
+	ARM_CORE_WORD	addr;
+	/*! the source code line number for this row; zero if unknown */
+	unsigned int	line_nr;
+	/*! the dwarf source file number for this row; zero if unknown
+	 *
+	 * dwarf source file numbers start from 1, the source
+	 * file name is at index (srcfile_nr - 1) in the
+	 * srcfiles array of the compilation unit */
+	unsigned short	srcfile_nr;
+	/*! flags for this row - a combination of the enum LINE_TAB_ROW_FLAGS_ENUM constants below */
+	unsigned short	flags;
+};
+
+/*! line number table row flags */
+enum LINE_TAB_ROW_FLAGS_ENUM
+{
+	/*! the row terminates a sequence of addresses; its address is the first address past the sequence */
+	LINE_TAB_ROW_END_SEQUENCE	= 1 << 0,
+	/*! the dwarf 'is_stmt' line number program register is set for this row
+	 *
+	 * only such rows denote recommended breakpoint locations,
+	 * and only they are put in the source line number to address
+	 * indices; see index_cu_line_addrs() */
+	LINE_TAB_ROW_IS_STMT		= 1 << 1,
+};
+
+/*! the decoded line number table for a compilation unit
+ *
+ * the rows in the table are sorted by ascending target core
+ * address; sequences of addresses (as defined by the dwarf
+ * line number program) are kept intact, and are ordered by
+ * their starting addresses - this guarantees that the row
+ * terminating a sequence always precedes the first row of a
+ * sequence starting at the same address */
+struct srcfile_line_tab
+{
+	/*! the number of elements in the rows array below */
+	int			nr_rows;
+	/*! the rows of the line number table
+	 *
+	 * \note	this is a c99 flexible array member, it must
+	 *		go last in the structure */
+	struct line_tab_row	rows[];
 };
 
 /*! compilation unit list node */
@@ -138,6 +219,10 @@ struct srclist_cu_node
 	 * dumping source code line number information
 	 * via the machine interface */
 	int	idx;
+	/*! nonzero if the line number information for this compilation unit has already been merged in the line number to address indices of its source files
+	 *
+	 * see index_cu_line_addrs() for details */
+	bool	is_line_addr_indexed;
 
 };
 
@@ -155,6 +240,47 @@ struct srclist_srcfile_node
 	int		cu_cnt;
 	/*! the list of compilation units for this source code file */
 	struct srcnode	* cu_list_head;
+	/*! link pointer for the source file name hash table chains - see the comments about srcname_htab in struct src_data */
+	struct srclist_srcfile_node	* hash_next;
+	/*! the index number of this source file, in the order in which source files are put in the source file list; index numbers start from 0
+	 *
+	 * this is used for referring to source files when storing
+	 * the source file lists in the index cache; see srcfile_save_index() */
+	int		idx;
+
+	/*! the source line number to target core address index for this source code file
+	 *
+	 * this is a multimap, holding an entry for every entry point
+	 * into a source line (a statement starting row which begins a
+	 * contiguous address range of the line - see index_cu_line_addrs())
+	 * in the line number tables of all compilation units that
+	 * this source file contributes to; a single source line may
+	 * map to several addresses - this is a well known artifact
+	 * of c 'for' loops, and also happens for source files (e.g.
+	 * headers with inline functions) included in multiple
+	 * compilation units; this index is built incrementally -
+	 * the line number information of a compilation unit is only
+	 * merged in here when a lookup in some of the source files of
+	 * the compilation unit is first requested; see
+	 * srcfile_get_core_addrs_for_line_nr() for details
+	 *
+	 * when sorted (see the is_line_addrs_sorted field below),
+	 * the entries are ordered by ascending line number, and
+	 * then by ascending address, and contain no duplicates */
+	struct line_addr_struct
+	{
+		/*! the source line number */
+		unsigned int	line_nr;
+		/*! a target core address of machine code generated for the source line */
+		ARM_CORE_WORD	addr;
+	}
+	* line_addrs;
+	/*! the number of valid elements in the line_addrs array above */
+	int	nr_line_addrs;
+	/*! the number of allocated elements in the line_addrs array above */
+	int	line_addrs_size;
+	/*! nonzero if the line_addrs array above is sorted; entries are appended unsorted when compilation units get merged in the index */
+	bool	is_line_addrs_sorted;
 
 };
 
@@ -218,6 +344,169 @@ struct srcfile_data
  *
  */
 
+/*!
+ *	\fn	static struct srcfile_line_tab * get_cu_line_tab(struct gear_engine_context * ctx, struct cu_data * cu)
+ *	\brief	retrieves the decoded line number table for a compilation unit, decoding it first if necessary
+ *
+ *	the libdwarf line number information for the compilation unit
+ *	is walked once, and is decoded into an array of compact
+ *	rows (see struct line_tab_row), which is then sorted by
+ *	target core address; because the addresses in a single dwarf
+ *	line number program sequence are already nondecreasing, only
+ *	the sequences as a whole are sorted (and most commonly, they
+ *	are already in order, and nothing needs to be moved at all)
+ *
+ *	\param	ctx	context to work in
+ *	\param	cu	the compilation unit for which to retrieve
+ *			the line number table
+ *	\return	the decoded line number table for the compilation unit
+ */
+static struct srcfile_line_tab * get_cu_line_tab(struct gear_engine_context * ctx, struct cu_data * cu)
+{
+struct srcfile_line_tab * p, * sorted;
+struct line_tab_row * row;
+Dwarf_Error err;
+Dwarf_Bool flag;
+Dwarf_Addr addr;
+Dwarf_Unsigned t;
+int i, j, nr_seqs;
+bool is_sorted;
+/* a descriptor for a sequence of rows in the line number table */
+struct seq_desc
+{
+	/* the index of the first row of the sequence */
+	int	start;
+	/* the number of rows in the sequence */
+	int	len;
+}
+* seqs;
+ARM_CORE_WORD last_seq_addr;
+
+int seq_compare(const struct seq_desc * s1, const struct seq_desc * s2)
+{
+	if (p->rows[s1->start].addr == p->rows[s2->start].addr)
+		return s1->start - s2->start;
+	if (p->rows[s1->start].addr < p->rows[s2->start].addr)
+		return -1;
+	return 1;
+}
+
+	if (cu->line_tab)
+		return cu->line_tab;
+
+	if (!(p = malloc(sizeof * p + cu->linecount * sizeof * p->rows)))
+		panic("out of core");
+	p->nr_rows = cu->linecount;
+	/* every sequence has at least one row, so this is enough */
+	if (!(seqs = malloc((cu->linecount + 1) * sizeof * seqs)))
+		panic("out of core");
+	nr_seqs = 0;
+	is_sorted = true;
+	last_seq_addr = 0;
+
+	/* decode the rows, and record where sequences start */
+	for (i = 0; i < cu->linecount; i++)
+	{
+		row = p->rows + i;
+		if (dwarf_lineaddr(cu->linebuf[i], &addr, &err) != DW_DLV_OK)
+			panic("dwarf_lineaddr()");
+		row->addr = (ARM_CORE_WORD) addr;
+		if (dwarf_lineno(cu->linebuf[i], &t, &err) != DW_DLV_OK)
+			panic("dwarf_lineno()");
+		row->line_nr = t;
+		if (dwarf_line_srcfileno(cu->linebuf[i], &t, &err) != DW_DLV_OK)
+			panic("dwarf_line_srcfileno()");
+		if (t > cu->srccount)
+			/* a file defined with DW_LNE_define_file; these
+			 * are not returned by dwarf_srcfiles(), so there
+			 * is no name available for such files */
+			t = 0;
+		row->srcfile_nr = t;
+		row->flags = 0;
+		if (dwarf_lineendsequence(cu->linebuf[i], &flag, &err) != DW_DLV_OK)
+			panic("dwarf_lineendsequence()");
+		if (flag)
+			row->flags |= LINE_TAB_ROW_END_SEQUENCE;
+		if (dwarf_linebeginstatement(cu->linebuf[i], &flag, &err) != DW_DLV_OK)
+			panic("dwarf_linebeginstatement()");
+		if (flag)
+			row->flags |= LINE_TAB_ROW_IS_STMT;
+
+		if (!i || (p->rows[i - 1].flags & LINE_TAB_ROW_END_SEQUENCE))
+		{
+			/* a new sequence starts here */
+			if (nr_seqs && row->addr < last_seq_addr)
+				is_sorted = false;
+			last_seq_addr = row->addr;
+			seqs[nr_seqs].start = i;
+			seqs[nr_seqs++].len = 0;
+		}
+		seqs[nr_seqs - 1].len++;
+	}
+
+	if (!is_sorted)
+	{
+		/* reorder the sequences by their starting addresses */
+		qsort(seqs, nr_seqs, sizeof * seqs, (int (*)(const void *, const void *)) seq_compare);
+		if (!(sorted = malloc(sizeof * sorted + cu->linecount * sizeof * sorted->rows)))
+			panic("out of core");
+		sorted->nr_rows = p->nr_rows;
+		for (i = j = 0; i < nr_seqs; j += seqs[i++].len)
+			memcpy(sorted->rows + j, p->rows + seqs[i].start, seqs[i].len * sizeof * p->rows);
+		free(p);
+		p = sorted;
+	}
+	free(seqs);
+
+	cu->line_tab = p;
+	if (ctx->src_data)
+	{
+		ctx->src_data->nr_line_tabs++;
+		ctx->src_data->nr_line_tab_rows += p->nr_rows;
+		ctx->src_data->line_tab_bytes += sizeof * p + p->nr_rows * sizeof * p->rows;
+	}
+	return p;
+}
+
+/*!
+ *	\fn	static struct line_tab_row * line_tab_lookup(struct srcfile_line_tab * tab, ARM_CORE_WORD addr)
+ *	\brief	locates the line number table row describing a given target core address
+ *
+ *	the row describing an address is the last row in the
+ *	(address-sorted) table starting at, or below, the address,
+ *	provided that this row does not terminate a sequence
+ *	of addresses, and that there is a row following it (whose
+ *	address is then necessarily above the address of interest);
+ *	this exactly matches the original (linear) search over
+ *	the libdwarf line number information
+ *
+ *	\param	tab	the line number table to search
+ *	\param	addr	the address of interest
+ *	\return	a pointer to the row describing the address
+ *		of interest, or null, if no such row is found
+ */
+static struct line_tab_row * line_tab_lookup(struct srcfile_line_tab * tab, ARM_CORE_WORD addr)
+{
+int lo, hi, mid;
+
+	/* find the number of rows starting at, or below, addr */
+	lo = 0;
+	hi = tab->nr_rows;
+	while (lo < hi)
+	{
+		mid = lo + ((hi - lo) >> 1);
+		if (tab->rows[mid].addr <= addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (!lo || lo == tab->nr_rows)
+		return 0;
+	if (tab->rows[lo - 1].flags & LINE_TAB_ROW_END_SEQUENCE)
+		return 0;
+	return tab->rows + lo - 1;
+}
+
 /*!
  *	\fn	static struct srclist_srcfile_node * locate_srcname(struct gear_engine_context * ctx, const char * srcname)
  *	\brief	retrieves the compilation unit data for a given source file name
@@ -232,16 +521,214 @@ static struct srclist_srcfile_node * locate_srcname(struct gear_engine_context *
 {
 struct srclist_srcfile_node * p;
 
-	p = ctx->src_data->srcs;
+	if (!ctx->src_data->srcname_htab)
+		return 0;
+	p = ctx->src_data->srcname_htab[elf_hash(srcname) & (ctx->src_data->srcname_htab_size - 1)];
 	while (p)
 	{
 		if (!strcmp(p->name, srcname))
 			break;
-		p = p->next;
+		p = p->hash_next;
 	}
 	return p;
 }
 
+/*!
+ *	\fn	static void hash_put_srcname(struct gear_engine_context * ctx, struct srclist_srcfile_node * src)
+ *	\brief	inserts a source file list node in the source file name hash table
+ *
+ *	\note	it is expected that the node is not already in the hash table
+ *
+ *	\param	ctx	gear context to work into
+ *	\param	src	the source file list node to insert
+ *	\return	none
+ */ 
+static void hash_put_srcname(struct gear_engine_context * ctx, struct srclist_srcfile_node * src)
+{
+struct src_data * p;
+struct srclist_srcfile_node * s;
+unsigned int h;
+
+	p = ctx->src_data;
+	if (!p->srcname_htab)
+	{
+		p->srcname_htab_size = SRCNAME_HTAB_INITIAL_SIZE;
+		if (!(p->srcname_htab = calloc(p->srcname_htab_size, sizeof * p->srcname_htab)))
+			panic("out of core");
+	}
+	if (p->nr_srcs > p->srcname_htab_size)
+	{
+		/* grow the hash table; all source file nodes
+		 * are in the srcs list, so just rebuild the chains */
+		free(p->srcname_htab);
+		p->srcname_htab_size <<= 1;
+		if (!(p->srcname_htab = calloc(p->srcname_htab_size, sizeof * p->srcname_htab)))
+			panic("out of core");
+		for (s = p->srcs; s; s = s->next)
+			if (s != src)
+			{
+				h = elf_hash(s->name) & (p->srcname_htab_size - 1);
+				s->hash_next = p->srcname_htab[h];
+				p->srcname_htab[h] = s;
+			}
+	}
+	h = elf_hash(src->name) & (p->srcname_htab_size - 1);
+	src->hash_next = p->srcname_htab[h];
+	p->srcname_htab[h] = src;
+}
+
+/*!
+ *	\fn	static int line_addr_compare(const struct line_addr_struct * a1, const struct line_addr_struct * a2)
+ *	\brief	comparison routine for sorting source line number to address index entries with qsort()
+ *
+ *	\param	a1	first entry to compare
+ *	\param	a2	second entry to compare
+ *	\return	the result of the comparison, as qsort() expects it
+ */
+static int line_addr_compare(const struct line_addr_struct * a1, const struct line_addr_struct * a2)
+{
+	if (a1->line_nr != a2->line_nr)
+		return (a1->line_nr < a2->line_nr) ? -1 : 1;
+	if (a1->addr != a2->addr)
+		return (a1->addr < a2->addr) ? -1 : 1;
+	return 0;
+}
+
+/*!
+ *	\fn	static void index_cu_line_addrs(struct gear_engine_context * ctx, struct srclist_cu_node * cu_node)
+ *	\brief	merges the line number information of a compilation unit in the line number to address indices of its source files
+ *
+ *	every row of the (decoded) line number table of the compilation
+ *	unit, which is not terminating a sequence, which starts a
+ *	statement (i.e. has the dwarf 'is_stmt' register set - the other
+ *	rows are not recommended breakpoint locations), which does not
+ *	continue the address range of the same source line started by
+ *	the preceding row of the same sequence, and for which the
+ *	source file and line number are known, is appended to the
+ *	line number to address index of its source file; the indices
+ *	touched are marked as unsorted - they are sorted on demand
+ *	by srcfile_get_core_addrs_for_line_nr()
+ *
+ *	\param	ctx	context to work in
+ *	\param	cu_node	the compilation unit to process
+ *	\return	none
+ */
+static void index_cu_line_addrs(struct gear_engine_context * ctx, struct srclist_cu_node * cu_node)
+{
+struct cu_data * cu;
+struct srcfile_line_tab * tab;
+struct line_tab_row * row;
+struct srclist_srcfile_node ** srcs, * src;
+int i;
+
+	if (cu_node->is_line_addr_indexed)
+		return;
+	if (!(cu = cu_process(ctx, cu_node->cu_die_offset)))
+		panic("");
+	tab = get_cu_line_tab(ctx, cu);
+	/* map dwarf source file numbers to source file list nodes */
+	if (!(srcs = malloc((cu->srccount + 1) * sizeof * srcs)))
+		panic("out of core");
+	for (i = 0; i < cu->srccount; i++)
+		srcs[i] = locate_srcname(ctx, cu->srcfiles[i]);
+
+	for (i = 0, row = tab->rows; i < tab->nr_rows; i++, row++)
+	{
+		if ((row->flags & LINE_TAB_ROW_END_SEQUENCE)
+				|| !(row->flags & LINE_TAB_ROW_IS_STMT)
+				|| !row->srcfile_nr || !row->line_nr
+				|| !(src = srcs[row->srcfile_nr - 1]))
+			continue;
+		/* only index the first address of a contiguous address range
+		 * of a source line, so that there is a single breakpoint
+		 * (and thus a single stop) per entry into the line */
+		if (i && !(row[-1].flags & LINE_TAB_ROW_END_SEQUENCE)
+				&& row[-1].srcfile_nr == row->srcfile_nr
+				&& row[-1].line_nr == row->line_nr)
+			continue;
+		if (src->nr_line_addrs == src->line_addrs_size)
+		{
+			src->line_addrs_size = src->line_addrs_size ? src->line_addrs_size << 1 : 64;
+			if (!(src->line_addrs = realloc(src->line_addrs,
+						src->line_addrs_size * sizeof * src->line_addrs)))
+				panic("out of core");
+		}
+		src->line_addrs[src->nr_line_addrs].line_nr = row->line_nr;
+		src->line_addrs[src->nr_line_addrs++].addr = row->addr;
+		src->is_line_addrs_sorted = false;
+	}
+	free(srcs);
+	cu_node->is_line_addr_indexed = true;
+}
+
+/*!
+ *	\fn	static struct line_addr_struct * get_line_addrs(struct gear_engine_context * ctx, const char * srcname, int line_nr, int * nr_addrs)
+ *	\brief	locates the source line number to address index entries for a line number in a source code file
+ *
+ *	the index for the source file is first brought up to date
+ *	(by merging in it all compilation units of the source file that
+ *	have not yet been merged), and sorted, if necessary; the
+ *	entries for the line number are then located by a binary search
+ *
+ *	\param	ctx	context to work in
+ *	\param	srcname	the name of the source code file to get information for
+ *	\param	line_nr	the line number of interest
+ *	\param	nr_addrs	a pointer to where to store the number of
+ *				entries found
+ *	\return	a pointer to the first of the index entries for
+ *		the line number; the entries for the line number
+ *		are contiguous, and are sorted by ascending address;
+ *		null if no entries were found
+ */
+static struct line_addr_struct * get_line_addrs(struct gear_engine_context * ctx,
+		const char * srcname, int line_nr, int * nr_addrs)
+{
+struct srclist_srcfile_node * src;
+struct srcnode * s;
+int lo, hi, mid, i, j;
+
+	* nr_addrs = 0;
+	if (!ctx->src_data || line_nr <= 0)
+		/* source file module probably not initialized */
+		return 0;
+	if (!(src = locate_srcname(ctx, srcname)))
+		/* source file not found */
+		return 0;
+	/* make sure all compilation units of the source
+	 * file have been merged in the index */
+	for (s = src->cu_list_head; s; s = s->next)
+		index_cu_line_addrs(ctx, s->cu);
+	if (!src->nr_line_addrs)
+		return 0;
+	if (!src->is_line_addrs_sorted)
+	{
+		qsort(src->line_addrs, src->nr_line_addrs, sizeof * src->line_addrs,
+				(int (*)(const void *, const void *)) line_addr_compare);
+		/* remove duplicates */
+		for (i = j = 1; i < src->nr_line_addrs; i++)
+			if (line_addr_compare(src->line_addrs + i, src->line_addrs + j - 1))
+				src->line_addrs[j++] = src->line_addrs[i];
+		src->nr_line_addrs = j;
+		src->is_line_addrs_sorted = true;
+	}
+	/* locate the first entry for the line number */
+	lo = 0;
+	hi = src->nr_line_addrs;
+	while (lo < hi)
+	{
+		mid = lo + ((hi - lo) >> 1);
+		if (src->line_addrs[mid].line_nr < (unsigned int) line_nr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	for (i = lo; i < src->nr_line_addrs && src->line_addrs[i].line_nr == (unsigned int) line_nr; i++)
+		;
+	if (!(* nr_addrs = i - lo))
+		return 0;
+	return src->line_addrs + lo;
+}
+
 /*!
  *	\fn	static void print_escaped(const char * str)
  *	\brief	machine-interface-prints a string, escaping any double quotation marks it contains
@@ -273,6 +760,92 @@ char s[512];
 	miprintf("%s", s);
 }
 
+/*!
+ *	\fn	static struct srclist_cu_node * add_cu_node(struct gear_engine_context * ctx, Dwarf_Off cu_die_offset, int src_cnt)
+ *	\brief	puts a new node in the compilation unit list
+ *
+ *	the source files of the compilation unit must then be
+ *	put in its source file list by add_cu_srcfile()
+ *
+ *	\param	ctx	gear context to work into
+ *	\param	cu_die_offset	the offset of the compilation unit die in .debug_info
+ *	\param	src_cnt	the number of source files of the compilation unit
+ *	\return	the new compilation unit list node
+ */
+static struct srclist_cu_node * add_cu_node(struct gear_engine_context * ctx, Dwarf_Off cu_die_offset, int src_cnt)
+{
+struct srclist_cu_node * cu;
+
+	if (!(cu = calloc(1, sizeof * cu)))
+		panic("");
+	cu->next = ctx->src_data->cus;
+	cu->cu_die_offset = cu_die_offset;
+	ctx->src_data->cus = cu;
+	cu->src_cnt = src_cnt;
+	return cu;
+}
+
+/*!
+ *	\fn	static void add_cu_srcfile(struct gear_engine_context * ctx, struct srclist_cu_node * cu, const char * srcname)
+ *	\brief	makes a reference to a source file from a compilation unit, putting the source file in the source file list, if not already there
+ *
+ *	\param	ctx	gear context to work into
+ *	\param	cu	the compilation unit list node
+ *	\param	srcname	the name of the source file; this is copied
+ *	\return	none
+ */
+static void add_cu_srcfile(struct gear_engine_context * ctx, struct srclist_cu_node * cu, const char * srcname)
+{
+struct srclist_srcfile_node * src;
+struct srcnode * snode;
+struct cunode * cnode;
+
+	src = locate_srcname(ctx, srcname);
+	if (!src)
+	{
+		/* source file not yet in the list - put it there */
+		if (!(src = calloc(1, sizeof * src)))
+			panic("");
+		src->next = ctx->src_data->srcs;
+		ctx->src_data->srcs = src;
+		src->idx = ctx->src_data->nr_srcs++;
+		if (!(src->name = strdup(srcname)))
+			panic("");
+		hash_put_srcname(ctx, src);
+	}
+	src->cu_cnt++;
+	/* get core for list nodes */
+	if (!(snode = malloc(sizeof * snode)))
+		panic("");
+	if (!(cnode = malloc(sizeof * cnode)))
+		panic("");
+	/* update compilation unit list */
+	cnode->next = cu->src_list_head;
+	cu->src_list_head = cnode;
+	cnode->src = src;
+	/* update source file list */
+	snode->next = src->cu_list_head;
+	src->cu_list_head = snode;
+	snode->cu = cu;
+}
+
+/*!
+ *	\fn	static void number_cu_nodes(struct gear_engine_context * ctx)
+ *	\brief	sets up the index number fields of the nodes in the compilation unit list
+ *
+ *	\param	ctx	gear context to work into
+ *	\return	none
+ */
+static void number_cu_nodes(struct gear_engine_context * ctx)
+{
+struct srclist_cu_node * cu;
+int i;
+
+	for (i = /* indices start from 1, a value of zero is invalid */ 1,
+			cu = ctx->src_data->cus; cu; cu->idx = i++, cu = cu->next)
+		;
+}
+
 
 /*
  *
@@ -289,6 +862,9 @@ char s[512];
  *	contributing to an executable file; for details on the lists,
  *	see the comments in the start of this file
  *
+ *	if the lists have already been restored from the index cache
+ *	(see srcfile_restore_index()), nothing is done here
+ *
  *	\todo	should the representation of the lists change,
  *		fix the comments here
  *
@@ -302,88 +878,33 @@ char s[512];
 
 void srcfile_build_src_cu_tab(struct gear_engine_context * ctx)
 {
-int res;
-Dwarf_Unsigned	cur_cu_offset;
-Dwarf_Unsigned	next_cu_header_offset;
-Dwarf_Half	version_stamp;
+Dwarf_Off	cur_cu_offset;
+Dwarf_Off	* cu_offsets;
+int		nr_cus;
 Dwarf_Die	cu_die;
 Dwarf_Error	err;
 char ** srcfiles;
 Dwarf_Signed src_cnt;
-struct srclist_srcfile_node * src;
 struct srclist_cu_node * cu;
-int i;
+int i, j;
 
+	if (ctx->src_data)
+		/* restored from the index cache */
+		return;
 	/* initialize the table */
 	if (!(ctx->src_data = calloc(1, sizeof * ctx->src_data)))
 		panic("out of core");
 
-	/* move to the first compilation unit in the debugging
-	 * information section (.debug_info) of the executable
-	 * and process all compilation units */	 
-	/* this rewinding here is absolutely braindamaged; it
-	 * is probably my fault/misreading of the libdwarf
-	 * documentation, but it seems there is not a simple
-	 * way to move to the first compilation unit in an executable
-	 * and then process all compilation units in turn via calls to
-	 * dwarf_next_cu_header; such rewinding is evidently necessary
-	 * as comments in the libdwarf sources (namely in file
-	 * dwarf_die_deliv.c), before function dwarf_next_cu_header
-	 * state:
-/ *
-    Returns offset of next compilation-unit thru next_cu_offset
-	pointer.
-    It basically sequentially moves from one
-    cu to the next.  The current cu is recorded
-    internally by libdwarf.
-* /
-	* with the key word here being "internally";
-	* do this (braindamaged) rewinding in a "documented"
-	* manner - invoke dwarf_next_cu_header() until the
-	* beast fails with a DW_DLV_NO_ENTRY return code, which means
-	* we have arrived at the last compilation unit - and
-	* thus the next invocation of dwarf_next_cu_header()
-	* shall retrieve the offset of the first compilation
-	* unit; this is what we need and we then fall into
-	* the real processing loop */	 
-
-	while ((res = dwarf_next_cu_header(ctx->dbg,
-					/* dont need these */
-					0,
-					0,
-					0,
-					0,
-					&next_cu_header_offset,
-					&err)) == DW_DLV_OK)
-		/* kill time; as weve bloody got any of it to waste... */	 
-		;
-	if (res != DW_DLV_NO_ENTRY)
-		panic("");
-	/* start from offset 0 - the start of the debug information
-	 * (.dbg_info) section */	 
-	cur_cu_offset = 0;
-	/* at last, process all compilation units */
-	while ((res = dwarf_next_cu_header(ctx->dbg,
-					/* dont need this */
-					0,
-					&version_stamp,
-					/* dont need these */
-					0,
-					0,
-					&next_cu_header_offset,
-					&err)) == DW_DLV_OK)
+	/* process all compilation units; the compilation unit
+	 * die offsets have already been collected (in a single pass over
+	 * the compilation unit headers) when the dwarf engine got
+	 * initialized, so there is no need to rewind the libdwarf
+	 * compilation unit header 'cursor' here - see the comments
+	 * about cu_scan_die_offsets() in cu-access.c */	 
+	cu_offsets = cu_get_die_offsets(ctx, &nr_cus);
+	for (j = 0; j < nr_cus; j++)
 	{
-		/*! \todo	enable this; resolve how exactly to
-		 *		determine the dwarf version employed
-		 *		by the one true compiler (gcc) */	 
-	       /*
-		if (version_stamp != 3)
-			panic("");
-		*/	 
-		if (dwarf_get_cu_die_offset_given_cu_header_offset
-			(ctx->dbg, cur_cu_offset, &cur_cu_offset, &err)
-				!= DW_DLV_OK)
-			panic("");
+		cur_cu_offset = cu_offsets[j];
 		/* read cu die */
 		if (dwarf_offdie(ctx->dbg, cur_cu_offset,
 					&cu_die, &err) != DW_DLV_OK)
@@ -393,45 +914,13 @@ int i;
 			panic("");
 		dwarf_dealloc(ctx->dbg, cu_die, DW_DLA_DIE);
 		/* put the new compilation unit in the list */
-		if (!(cu = calloc(1, sizeof * cu)))
-			panic("");
-		cu->next = ctx->src_data->cus;
-		cu->cu_die_offset = cur_cu_offset;
-		ctx->src_data->cus = cu;
-		cu->src_cnt = src_cnt;
+		cu = add_cu_node(ctx, cur_cu_offset, src_cnt);
 		/* make references to the source file(s) for this
 		 * compilation unit (eventually inserting them
 	         * in the list of source files for the executable) */	 
 		for (i = 0; i < src_cnt; i++)
 		{
-			struct srcnode * snode;
-			struct cunode * cnode;
-
-			src = locate_srcname(ctx, srcfiles[i]);
-			if (!src)
-			{
-				/* source file not yet in the list - put it there */
-				if (!(src = calloc(1, sizeof * src)))
-					panic("");
-				src->next = ctx->src_data->srcs;
-				ctx->src_data->srcs = src;
-				if (!(src->name = strdup(srcfiles[i])))
-					panic("");
-			}
-			src->cu_cnt++;
-			/* get core for list nodes */
-			if (!(snode = malloc(sizeof * snode)))
-				panic("");
-			if (!(cnode = malloc(sizeof * cnode)))
-				panic("");
-			/* update compilation unit list */
-			cnode->next = cu->src_list_head;
-			cu->src_list_head = cnode;
-			cnode->src = src;
-			/* update source file list */
-			snode->next = src->cu_list_head;
-			src->cu_list_head = snode;
-			snode->cu = cu;
+			add_cu_srcfile(ctx, cu, srcfiles[i]);
 			/* deallocate libdwarf supplied source file name -
 			 * we have already stashed this ourselves */
 			dwarf_dealloc(ctx->dbg, srcfiles[i], DW_DLA_STRING);
@@ -439,16 +928,204 @@ int i;
 		/* we are done with this compilation unit - discard
 		 * the libdwarf supplied array of source file names */  
 		dwarf_dealloc(ctx->dbg, srcfiles, DW_DLA_LIST);
-		/* move to the next compilation unit */	 
-		cur_cu_offset = next_cu_header_offset;
 	}
-	/* see if everything went smooth */
-	if (res != DW_DLV_NO_ENTRY)
-		panic("");
 	/* set up the compilation unit index number fields */
-	for (i = /* indices start from 1, a value of zero is invalid */ 1,
-			cu = ctx->src_data->cus; cu; cu->idx = i++, cu = cu->next)
-		;
+	number_cu_nodes(ctx);
+}
+
+/*!
+ *	\fn	void srcfile_save_index(struct gear_engine_context * ctx, struct index_cache_cursor * c)
+ *	\brief	stores the compilation unit - source file correspondence lists in an in-core index cache image
+ *
+ *	the source file names are stored first, in the order in
+ *	which they were put in the source file list; then, for
+ *	every compilation unit, in .debug_info order, the index
+ *	numbers of its source files are stored, in the order in
+ *	which dwarf_srcfiles() returned them - replaying these
+ *	through add_cu_node() and add_cu_srcfile() rebuilds lists
+ *	identical to the ones built by srcfile_build_src_cu_tab();
+ *	for details, see the comments in index-cache.c
+ *
+ *	\param	ctx	context to work in
+ *	\param	c	the in-core index cache image to store the lists in
+ *	\return	none
+ */
+void srcfile_save_index(struct gear_engine_context * ctx, struct index_cache_cursor * c)
+{
+struct srclist_srcfile_node ** srcs, * src;
+struct srclist_cu_node ** cus, * cu;
+struct cunode * cnode;
+int * idxs;
+int i, j, nr_cus;
+unsigned int len;
+
+	if (!ctx->src_data)
+		panic("");
+	/* the lists are built by prepending nodes, walk them backwards */
+	if (!(srcs = malloc((ctx->src_data->nr_srcs + 1) * sizeof * srcs)))
+		panic("out of core");
+	for (i = ctx->src_data->nr_srcs, src = ctx->src_data->srcs; src; src = src->next)
+		srcs[--i] = src;
+	index_cache_put(c, &ctx->src_data->nr_srcs, sizeof ctx->src_data->nr_srcs);
+	for (i = 0; i < ctx->src_data->nr_srcs; i++)
+	{
+		len = strlen(srcs[i]->name);
+		index_cache_put(c, &len, sizeof len);
+		index_cache_put(c, srcs[i]->name, len);
+	}
+	free(srcs);
+
+	for (nr_cus = 0, cu = ctx->src_data->cus; cu; cu = cu->next, nr_cus++);
+	if (!(cus = malloc((nr_cus + 1) * sizeof * cus)))
+		panic("out of core");
+	for (i = nr_cus, cu = ctx->src_data->cus; cu; cu = cu->next)
+		cus[--i] = cu;
+	index_cache_put(c, &nr_cus, sizeof nr_cus);
+	for (i = 0; i < nr_cus; i++)
+	{
+		if (!(idxs = malloc((cus[i]->src_cnt + 1) * sizeof * idxs)))
+			panic("out of core");
+		for (j = cus[i]->src_cnt, cnode = cus[i]->src_list_head; cnode; cnode = cnode->next)
+			idxs[--j] = cnode->src->idx;
+		index_cache_put(c, &cus[i]->src_cnt, sizeof cus[i]->src_cnt);
+		index_cache_put(c, idxs, cus[i]->src_cnt * sizeof * idxs);
+		free(idxs);
+	}
+	free(cus);
+}
+
+/*!
+ *	\fn	bool srcfile_restore_index(struct gear_engine_context * ctx, struct index_cache_cursor * c)
+ *	\brief	restores the compilation unit - source file correspondence lists from an in-core index cache image
+ *
+ *	this is an alternative to srcfile_build_src_cu_tab(), and
+ *	saves the retrieval of the source files of every compilation
+ *	unit through libdwarf; on failure, nothing is changed
+ *
+ *	
+ote	the table of compilation unit die offsets must
+ *		already have been restored (see cu_restore_index())
+ *
+ *	\param	ctx	context to work in
+ *	\param	c	the in-core index cache image to restore the lists from
+ *	\return	true, if the lists were successfully restored, false otherwise
+ */
+bool srcfile_restore_index(struct gear_engine_context * ctx, struct index_cache_cursor * c)
+{
+Dwarf_Off * cu_offsets;
+struct srclist_cu_node * cu;
+char ** names;
+unsigned int len;
+int nr_srcs, nr_cus, src_cnt, idx;
+int i, j;
+bool res;
+
+	if (ctx->src_data)
+		panic("");
+	cu_offsets = cu_get_die_offsets(ctx, &nr_cus);
+	if (!index_cache_get(c, &nr_srcs, sizeof nr_srcs) || nr_srcs < 0
+			|| nr_srcs > (c->len - c->pos) / sizeof len)
+		return false;
+	if (!(names = calloc(nr_srcs + 1, sizeof * names)))
+		panic("out of core");
+	res = false;
+	switch (0) default:
+	{
+		for (i = 0; i < nr_srcs; i++)
+		{
+			if (!index_cache_get(c, &len, sizeof len) || len > c->len - c->pos)
+				break;
+			if (!(names[i] = malloc(len + 1)))
+				panic("out of core");
+			index_cache_get(c, names[i], len);
+			names[i][len] = 0;
+		}
+		if (i != nr_srcs)
+			break;
+		if (!index_cache_get(c, &i, sizeof i) || i != nr_cus)
+			break;
+		if (!(ctx->src_data = calloc(1, sizeof * ctx->src_data)))
+			panic("out of core");
+		for (j = 0; j < nr_cus; j++)
+		{
+			if (!index_cache_get(c, &src_cnt, sizeof src_cnt) || src_cnt < 0
+					|| src_cnt > (c->len - c->pos) / sizeof idx)
+				break;
+			cu = add_cu_node(ctx, cu_offsets[j], src_cnt);
+			for (i = 0; i < src_cnt; i++)
+			{
+				index_cache_get(c, &idx, sizeof idx);
+				if (idx < 0 || idx >= nr_srcs)
+					break;
+				add_cu_srcfile(ctx, cu, names[idx]);
+			}
+			if (i != src_cnt)
+				break;
+		}
+		if (j != nr_cus)
+			break;
+		number_cu_nodes(ctx);
+		res = true;
+	}
+	for (i = 0; i < nr_srcs; i++)
+		free(names[i]);
+	free(names);
+	if (!res)
+		srcfile_discard_index(ctx);
+	return res;
+}
+
+/*!
+ *	\fn	void srcfile_discard_index(struct gear_engine_context * ctx)
+ *	\brief	discards the compilation unit - source file correspondence lists restored by srcfile_restore_index()
+ *
+ *	this is used when restoring the index cache fails after
+ *	srcfile_restore_index() has succeeded, so that the lists
+ *	are then built from scratch by srcfile_build_src_cu_tab()
+ *
+ *	
+ote	no line number tables may have been decoded yet
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void srcfile_discard_index(struct gear_engine_context * ctx)
+{
+struct src_data * p;
+struct srclist_srcfile_node * src;
+struct srclist_cu_node * cu;
+struct srcnode * snode;
+struct cunode * cnode;
+
+	if (!(p = ctx->src_data))
+		return;
+	if (p->nr_line_tabs)
+		panic("");
+	while ((src = p->srcs))
+	{
+		p->srcs = src->next;
+		while ((snode = src->cu_list_head))
+		{
+			src->cu_list_head = snode->next;
+			free(snode);
+		}
+		free(src->line_addrs);
+		free(src->name);
+		free(src);
+	}
+	while ((cu = p->cus))
+	{
+		p->cus = cu->next;
+		while ((cnode = cu->src_list_head))
+		{
+			cu->src_list_head = cnode->next;
+			free(cnode);
+		}
+		free(cu);
+	}
+	free(p->srcname_htab);
+	free(p);
+	ctx->src_data = 0;
 }
 
 
@@ -508,14 +1185,12 @@ int i;
  *		resides at a program sequence point (in the c sense)
  *
  *	\note	gcc seems to toggle the dwarf line number flag 'is_stmt',
- *		at least this is the case with optimised code; i(sgs)
- *		am not at all sure if this flag is any good, this
- *		flag is currently ignored and not used anywhere in
- *		the gear
+ *		at least this is the case with optimised code; this
+ *		flag is ignored here, it is only used for selecting
+ *		breakpoint locations in the source line number to
+ *		address indices (see index_cu_line_addrs())
  *
  *	\return	none
- *
- *	\todo	cache the lookups here
  */
 void srcfile_get_srcinfo_for_addr(struct gear_engine_context * ctx, ARM_CORE_WORD addr,
 		struct cu_data ** cu, struct subprogram_data ** subp,
@@ -523,11 +1198,7 @@ void srcfile_get_srcinfo_for_addr(struct gear_engine_context * ctx, ARM_CORE_WOR
 {
 /* compilation unit pointer */	
 struct cu_data * cup;
-int i;
-Dwarf_Error err;
-Dwarf_Bool flag;
-Dwarf_Addr a1, a2;
-Dwarf_Unsigned tmp;
+struct line_tab_row * row;
 
 	/* sanity checks */
 	if (!ctx)
@@ -557,68 +1228,23 @@ Dwarf_Unsigned tmp;
 		/* nothing more we could do - there is probably no
 		 * debug information for the address supplied */
 		return;
-	/* search the compilation unit statement list for the halt address to
+	/* search the compilation unit line number table for the halt address to
 	 * see at which source line we stopped */
-	i = 0;
 	/* sanity check */
 	if (cup->linecount <= 1)
 		panic("malformed dwarf source statement program");
-	while (i < cup->linecount - 1)
-	{
-		/* if this is an end of sequence entry - skip to the
-		 * next one */
-		if (dwarf_lineendsequence(cup->linebuf[i], &flag, &err)
-				!= DW_DLV_OK)
-			panic("");
-		if (flag)
-		{
-			/* skip to the nexet sequence of addresses */
-			i++;
-			continue;
-		}
-		/* obtain the addresses of the two consecutive source line table
-		 * entries and use them to see if our halt address lies
-	         * between these source line table entries */	 
-		if (dwarf_lineaddr(cup->linebuf[i], &a1, &err)
-				!= DW_DLV_OK)
-			panic("");
-		if (dwarf_lineaddr(cup->linebuf[i + 1], &a2, &err)
-				!= DW_DLV_OK)
-			panic("");
-		if (a1 <= addr && addr < a2)
-			/* match found */
-			break;
-		/* skip to the next pair of lines */
-		i++;
-	}
-	/* see if a match was found */
-	if (i == cup->linecount - 1)
+	if (!(row = line_tab_lookup(get_cu_line_tab(ctx, cup), addr)))
 		/* no match found */
 		return;
-	if (srcname)
-	{
-		if (dwarf_line_srcfileno(cup->linebuf[i], &tmp, &err)
-				!= DW_DLV_OK)
-			panic("");
-		if (tmp)
-		{
-			if (tmp > cup->srccount)
-				panic("");
-			*srcname = cup->srcfiles[tmp - 1];
-		}
-	}
+	if (srcname && row->srcfile_nr)
+		*srcname = cup->srcfiles[row->srcfile_nr - 1];
 	if (srcline_nr)
-	{
-		if (dwarf_lineno(cup->linebuf[i], &tmp, &err)
-				!= DW_DLV_OK)
-			panic("");
-		*srcline_nr = tmp;
-	}
+		*srcline_nr = row->line_nr;
 	/* see if the halt address falls on a source line information
 	 * boundary */
 	if (is_addr_at_src_boundary)
 	{
-		if (addr == a1)
+		if (addr == row->addr)
 			*is_addr_at_src_boundary = true;
 	}
 }
@@ -628,102 +1254,77 @@ Dwarf_Unsigned tmp;
  *	\fn	enum GEAR_ENGINE_ERR_ENUM srcfile_get_core_addr_for_line_nr(struct gear_engine_context * ctx, char * srcname, int line_nr, ARM_CORE_WORD * addr)
  *	\brief	attempts to compute the target core address corresponding to a line number in a source code file
  *
+ *	\note	a single source code line may well have several target
+ *		core addresses corresponding to it - this is a well known
+ *		artifact of c 'for' loops, and also happens for source files
+ *		which are included in multiple compilation units; this
+ *		routine returns only the lowest of these addresses, use
+ *		srcfile_get_core_addrs_for_line_nr() to retrieve all of them
+ *
  *	\param	ctx	context to work in
  *	\param	srcname	the name of the source code file to get information for
  *	\param	line_nr	the line number in the file for which to retrieve
  *			the target core address (if any) of the machine code
  *			(if any) generated for this line number in the given
  *			source code file
- *	\param	addr	a pointer to where to store the target core address
- *			of the first machine code instruction (if any)
- *			generated for code residing at the given source code
+ *	\param	addr	a pointer to where to store the lowest target core address
+ *			of machine code generated for code residing at the given source code
  *			line number in the given source code file
  *	\return	GEAR_ERR_NO_ERROR, if the target core address was successfully computed - in
  *		this case the addr output parameter is also set; GEAR_ERR_GENERIC_ERROR, if
  *		no target core address of machine code generated for the supplied source code file/line
  *		number could be computed (probably because, the source file was not found, the
- *		line number was out of bounds, no machine code has been generated at all for
- *		the supplied source file/line number combination, or the result is ambiguous -
- *		e.g. more than one core addresses correspond to a single source file/
- *		line number combination - this is a well known artifact of 'for' c loops, and
- *		may also occur with source files which are included in multiple compilation
- *		units) - in this case, the addr output parameter is not touched
- *	\todo	provide more specific error return codes - while maybe not all of these may be
- *		useful, at least the 'for' c loop case mentioned above must be handled with
- *		greater care */
+ *		line number was out of bounds, or no machine code has been generated at all for
+ *		the supplied source file/line number combination) - in this case, the addr output
+ *		parameter is not touched
+ *	\todo	provide more specific error return codes */
 enum GEAR_ENGINE_ERR_ENUM srcfile_get_core_addr_for_line_nr(struct gear_engine_context * ctx,
 		char * srcname, int line_nr, ARM_CORE_WORD * addr)
 {
-struct srclist_srcfile_node * src;
-int i;
-int dwarf_srcfile_nr;
-struct cu_data * cu;
-Dwarf_Error err;
-Dwarf_Unsigned t;
-Dwarf_Addr ret_addr;
-
-	if (!ctx->src_data)
-		/* source file module probably not initialized */
-		return GEAR_ERR_GENERIC_ERROR;
-	src = ((struct src_data *) ctx->src_data)->srcs;
-	while (src && strcmp(src->name, srcname))
-		src = src->next;
-
-	if (src->cu_cnt > 1)
-	{
-		gprintf("diagnostic: multiple code address ranges for a source code file\n");
-	}
-	if (!src || src->cu_cnt > 1)
-		/* source file not found, or source file included
-		 * in multiple compilation units (implying the result
-		 * is probably ambiguous, but dont investigate any
-		 * further here) */
-		return GEAR_ERR_GENERIC_ERROR;
-	/* search the line number information of the compilation
-	 * unit corresponding to the supplied source code file */
-	if (!(cu = cu_process(ctx, src->cu_list_head->cu->cu_die_offset)))
-		/* compilation unit not found */
-		return GEAR_ERR_GENERIC_ERROR;
-	/* locate the source code file number in the dwarf debug line
-	 * information for this compilation unit */  
-	for (i = 0; i < cu->srccount; i ++)
-	{
-		if (!strcmp(srcname, cu->srcfiles[i]))
-			break;
-	}
-	if (i == cu->srccount)
-		panic("");
-	dwarf_srcfile_nr = i /* dwarf source file numbers start from 1, 0 is reserved */ + 1;
-	gprintf("cu name %s, srccount %i\n", cu->name, cu->srccount);
-	gprintf("dwarf file nr is %i\n", i);
-
-	for (i = 0; i < cu->linecount; i++)
-	{
-		if (dwarf_line_srcfileno(cu->linebuf[i], &t, &err) != DW_DLV_OK)
-			panic("");
+struct line_addr_struct * p;
+int nr_addrs;
 
-		if (dwarf_srcfile_nr != t)
-			/* current line number program entry
-			 * source code file number not for the
-			 * file we are interested in - skip to
-			 * the next entry */
-			continue;
-		if (dwarf_lineno(cu->linebuf[i], &t, &err)
-				!= DW_DLV_OK)
-			panic("dwarf_lineno()");
-		if (t == line_nr)
-			break;
-	}
-	if (i == cu->linecount)
+	if (!(p = get_line_addrs(ctx, srcname, line_nr, &nr_addrs)))
 		/* no code genereated for this source code line */
 		return GEAR_ERR_GENERIC_ERROR;
-	if (dwarf_lineaddr(cu->linebuf[i], &ret_addr, &err) == DW_DLV_ERROR)
-		panic("dwarf_lineaddr()");
-
-	*addr = ret_addr;
+	*addr = p->addr;
 	/* everything looks fine */
 	return GEAR_ERR_NO_ERROR;
+}
 
+/*!
+ *	\fn	int srcfile_get_core_addrs_for_line_nr(struct gear_engine_context * ctx, const char * srcname, int line_nr, ARM_CORE_WORD addrs[], int max_addrs)
+ *	\brief	retrieves all target core addresses corresponding to a line number in a source code file
+ *
+ *	a single source code line may well have several target core
+ *	addresses corresponding to it - this is a well known artifact
+ *	of c 'for' loops, and also happens for source files which are
+ *	included in multiple compilation units (e.g. headers containing
+ *	inline functions); all of these addresses are retrieved here
+ *
+ *	\param	ctx	context to work in
+ *	\param	srcname	the name of the source code file to get information for
+ *	\param	line_nr	the line number in the file for which to retrieve
+ *			the target core addresses
+ *	\param	addrs	an array in which to store the addresses found,
+ *			in ascending order; can be null if max_addrs is zero
+ *	\param	max_addrs	the number of elements in the addrs array;
+ *				at most this many addresses are stored
+ *	\return	the total number of addresses found (which may be
+ *		larger than max_addrs); zero if the source file is not
+ *		known, or if no machine code has been generated for the
+ *		source line number
+ */
+int srcfile_get_core_addrs_for_line_nr(struct gear_engine_context * ctx,
+		const char * srcname, int line_nr, ARM_CORE_WORD addrs[], int max_addrs)
+{
+struct line_addr_struct * p;
+int i, nr_addrs;
+
+	p = get_line_addrs(ctx, srcname, line_nr, &nr_addrs);
+	for (i = 0; i < nr_addrs && i < max_addrs; i++)
+		addrs[i] = p[i].addr;
+	return nr_addrs;
 }
 
 /*!
@@ -903,6 +1504,28 @@ ARM_CORE_WORD first_addr_past_disassembly;
 
 
 
+
+/*!
+ *	\fn	void srcfile_dump_mem_usage_mi(struct gear_engine_context * ctx)
+ *	\brief	machine-interface-prints memory usage statistics for the source file module
+ *
+ *	currently, this dumps the number and the memory usage of
+ *	the compilation unit line number tables decoded so far;
+ *	the output is a comma-terminated list of machine
+ *	interface fields, meant to be embedded in a larger record
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void srcfile_dump_mem_usage_mi(struct gear_engine_context * ctx)
+{
+	if (!ctx->src_data)
+		return;
+	miprintf("LINE_TABLES = [NR_DECODED = %i, NR_ROWS = %i, BYTES = %lu,],",
+			ctx->src_data->nr_line_tabs,
+			ctx->src_data->nr_line_tab_rows,
+			ctx->src_data->line_tab_bytes);
+}
 
 #if 1
 
@@ -26,7 +26,10 @@ void srcfile_get_srcinfo_for_addr(struct gear_engine_context * ctx, ARM_CORE_WOR
 void srcfile_dump_sources_info_mi(struct gear_engine_context * ctx);
 enum GEAR_ENGINE_ERR_ENUM srcfile_get_core_addr_for_line_nr(struct gear_engine_context * ctx,
 		char * srcname, int line_nr, ARM_CORE_WORD * addr);
+int srcfile_get_core_addrs_for_line_nr(struct gear_engine_context * ctx,
+		const char * srcname, int line_nr, ARM_CORE_WORD addrs[], int max_addrs);
 
+void srcfile_dump_mem_usage_mi(struct gear_engine_context * ctx);
 void srcfile_disassemble_addr_range(struct gear_engine_context * ctx,
 		bool is_disassembling_insn_count,
 		ARM_CORE_WORD start_addr,
@@ -36,6 +36,7 @@
 #include "lexblock-access.h"
 #include "dwarf-ranges.h"
 #include "dwarf-util.h"
+#include "node-alloc.h"
 
 /*
  *
@@ -44,19 +45,16 @@
  */
 
 /*!
- *	\fn	static struct subprogram_data * get_sub_node(void)
+ *	\fn	static struct subprogram_data * get_sub_node(struct gear_engine_context * ctx)
  *	\brief	allocates memory for a subprogram_node structure and initializes it
  *
+ *	\param	ctx	context to work in
  *	\return	a pointer to the newly allocated subprogram_node data structure
  */
 
-static struct subprogram_data * get_sub_node(void)
+static struct subprogram_data * get_sub_node(struct gear_engine_context * ctx)
 {
-struct subprogram_data * p;
-
-	if (!(p = (struct subprogram_data * ) calloc(1, sizeof * p)))
-		panic("out of core");
-	return p;
+	return node_alloc(ctx, NODE_KIND_SUBPROGRAM, sizeof(struct subprogram_data));
 }
 
 /*!
@@ -192,7 +190,7 @@ Dwarf_Half tagval;
 		panic("unsupported data object attribute found");
 
 	/* get core for the new node */
-	p = get_sub_node();
+	p = get_sub_node(ctx);
 
 	p->head.tag = tagval;
 	/* first of all, see if this subprogram die is a (concrete) inline
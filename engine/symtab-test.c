@@ -0,0 +1,183 @@
+/*!
+ *	\file	symtab-test.c
+ *	\brief	same name identifier lookup test
+ *	\author	shopov
+ *
+ *	this is a test program for identifier lookup in the global
+ *	scope (see deprecated_scope_locate_dobj() in scope.c) in the
+ *	presence of data types having the same names as data objects,
+ *	with data type deduplication enabled (see dedup_type() in
+ *	type-access.c); it is meant to be run on an executable built
+ *	from gemstones/same-name.c and gemstones/same-name-1.c, e.g.
+ *	by 'make symtab-test-run'
+ *
+ *	the test checks that:
+ *		- data objects are found, and no data types are returned,
+ *		for names shared by a data object and a data type
+ *		(structure tag, enumeration tag, typedef name)
+ *		- type names that do not name any data object are not found
+ *		- identical data types from different compilation
+ *		units have been merged into a single data type node,
+ *		including self-referential structures
+ *
+ *	the exit status is zero if all checks pass, and nonzero otherwise
+ *
+ *	Revision summary:
+ *
+ *	$Log: $
+ */
+
+/*
+ *
+ * include section follows
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+
+int gprintf(const char * format, ...);
+
+#include "dwarf-common.h"
+#include "target-defs.h"
+#include "gear-engine-context.h"
+#include "engine-err.h"
+#include "core-access.h"
+#include "dwarf-expr.h"
+#include "dwarf-loc.h"
+#include "symtab.h"
+#include "type-access.h"
+#include "aranges-access.h"
+#include "util.h"
+#include "cu-access.h"
+#include "dobj-access.h"
+#include "scope.h"
+
+
+/*
+ *
+ * local definitions follow
+ *
+ */
+
+extern void dwarf_hacked_init(struct gear_engine_context * ctx);
+extern void dwarf_hacked_shutdown(struct gear_engine_context * ctx);
+
+/*! the number of checks failed */
+static int nr_failures;
+
+
+/*
+ *
+ * local functions follow
+ *
+ */
+
+/*!
+ *	\fn	static struct dobj_data * lookup_dobj(struct gear_engine_context * ctx, const char * name)
+ *	\brief	looks up a data object in the global scope, and checks that it is a data object
+ *
+ *	\param	ctx	gear engine context
+ *	\param	name	the data object name
+ *	\return	the data object found, null if not found
+ */
+static struct dobj_data * lookup_dobj(struct gear_engine_context * ctx, const char * name)
+{
+struct dwarf_head_struct * p;
+
+	p = deprecated_scope_locate_dobj(ctx, name,
+			(struct scope_resolution_flags) { .global_scope_only = 1, });
+	if (!p)
+	{
+		printf("FAIL: data object '%s' not found\n", name);
+		nr_failures ++;
+		return 0;
+	}
+	if (p->tag != DW_TAG_variable)
+	{
+		printf("FAIL: '%s' found, but it is not a data object (tag 0x%x)\n", name, (int) p->tag);
+		nr_failures ++;
+		return 0;
+	}
+	return (struct dobj_data *) p;
+}
+
+/*!
+ *	\fn	static void check_same_type(struct gear_engine_context * ctx, const char * name1, const char * name2)
+ *	\brief	checks that two data objects of identical types share the same data type node
+ *
+ *	\param	ctx	gear engine context
+ *	\param	name1	the name of the first data object
+ *	\param	name2	the name of the second data object
+ *	\return	none
+ */
+static void check_same_type(struct gear_engine_context * ctx, const char * name1, const char * name2)
+{
+struct dobj_data * d1, * d2;
+
+	if (!(d1 = lookup_dobj(ctx, name1)) || !(d2 = lookup_dobj(ctx, name2)))
+		return;
+	if (d1->type != d2->type)
+	{
+		printf("FAIL: the types of '%s' and '%s' have not been merged\n", name1, name2);
+		nr_failures ++;
+	}
+}
+
+
+/*
+ *
+ * exported functions follow
+ *
+ */
+
+int main(int argc, char ** argv)
+{
+struct gear_engine_context ctx;
+Dwarf_Off * cu_offsets;
+int i, nr_cus;
+
+	if (argc != 2)
+	{
+		printf("usage: %s <elf-file>\n", argv[0]);
+		printf("\t(e.g. an executable built from gemstones/same-name.c and gemstones/same-name-1.c)\n");
+		return 2;
+	}
+	memset(& ctx, 0, sizeof ctx);
+	ctx.settings.is_type_dedup_enabled = true;
+
+	init_types(& ctx);
+	init_symtab(& ctx);
+
+	ctx.dbg_info_elf_disk_file_name = strdup(argv[1]);
+	dwarf_hacked_init(& ctx);
+	init_aranges(& ctx);
+
+	cu_offsets = cu_get_die_offsets(& ctx, & nr_cus);
+	for (i = 0; i < nr_cus; i++)
+		cu_process(& ctx, cu_offsets[i]);
+
+	/* names shared by data objects and data types */
+	lookup_dobj(& ctx, "point");
+	lookup_dobj(& ctx, "color");
+	lookup_dobj(& ctx, "counter");
+	lookup_dobj(& ctx, "list");
+	/* type names only */
+	if (deprecated_scope_locate_dobj(& ctx, "point_t",
+			(struct scope_resolution_flags) { .global_scope_only = 1, }))
+	{
+		printf("FAIL: type name 'point_t' found as a data object\n");
+		nr_failures ++;
+	}
+	/* merged data types */
+	check_same_type(& ctx, "point", "point1");
+	check_same_type(& ctx, "color", "color1");
+	check_same_type(& ctx, "list", "list1");
+
+	printf("%i compilation units, %i failures\n", nr_cus, nr_failures);
+	dwarf_hacked_shutdown(& ctx);
+	return nr_failures ? 1 : 0;
+}
@@ -70,6 +70,7 @@
 #include "gprintf.h"
 #include "util.h"
 #include "symtab.h"
+#include "node-alloc.h"
 
 /*
  *
@@ -110,36 +111,29 @@ struct symtab_hash_table
  */
 
 /*!
- *	\fn		static struct symtab_hash_node * get_hash_node(void)
+ *	\fn		static struct symtab_hash_node * get_hash_node(struct gear_engine_context * ctx)
  *	\brief	allocates a symtab_hash_node structure
  *
+ *	\param	ctx	context to work in
  *	\return	a pointer to the newly allocated node
  */
 
-static struct symtab_hash_node * get_hash_node(void)
+static struct symtab_hash_node * get_hash_node(struct gear_engine_context * ctx)
 {
-struct symtab_hash_node * p;
-
-	if (!(p = calloc(1, sizeof * p)))
-		panic("out of core");
-	return p;
+	return node_alloc(ctx, NODE_KIND_SYMTAB_HASH, sizeof(struct symtab_hash_node));
 }
 
 /*!
- * \fn		static struct sym_struct* get_sym_node(void)
+ * \fn		static struct sym_struct* get_sym_node(struct gear_engine_context * ctx)
  * \brief	allocates a sym_struct data structure
  *
+ * \param	ctx	context to work in
  * \return	a pointer to the newly allocated node
  */
 
-static struct sym_struct * get_sym_node(void)
+static struct sym_struct * get_sym_node(struct gear_engine_context * ctx)
 {
-struct sym_struct * p;
-
-	if (!(p = malloc(sizeof(*p))))
-		panic("out of core");
-	memset(p, 0, sizeof(*p));
-	return p;
+	return node_alloc(ctx, NODE_KIND_SYM, sizeof(struct sym_struct));
 }
 
 /*!
@@ -216,7 +210,7 @@ struct sym_struct * sym;
 	/*! \todo	always allocate and initialize a new sym_struct node; once
 	 *		type merging is done (see the todo section at the beginning of this
 	 *		file), this will no longer be the case */
-	sym = get_sym_node();
+	sym = get_sym_node(ctx);
 	/* validate the symbol class */
 	printf("%s(): storing symbol \"%s\" into the symbol table\n", __func__, name);
 	switch (symclass)
@@ -247,7 +241,7 @@ struct sym_struct * sym;
 	{
 	unsigned long h;	
 		/* symbol not found create and insert new hash node */
-		p = get_hash_node();
+		p = get_hash_node(ctx);
 		/*! \todo	this can be a *very* serious problem
 		 *		but right now name strings should never
 		 *		get deallocated in a debugging session */
@@ -293,3 +287,20 @@ int size;
 	ctx->symtab->htab_size = HTAB_SIZE;
 }
 
+/*!
+ *	\fn	void discard_symtab(struct gear_engine_context * ctx)
+ *	\brief	deallocates the symbol table
+ *
+ *	the symbol table nodes themselves are owned by the node
+ *	allocator, and are deallocated by node_alloc_free_all()
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+
+void discard_symtab(struct gear_engine_context * ctx)
+{
+	free(ctx->symtab);
+	ctx->symtab = 0;
+}
+
@@ -34,6 +34,12 @@
  *	scope are accounted for by
  *	SYM_ENUM_CONSTANT symbol table entries
  *
+ * \note	the data type engine does not currently put any
+ *	SYM_TYPE entries in the symbol table - named data types
+ *	are recorded in a separate index of its own (see dedup_type()
+ *	in type-access.c), so that type names never hide the
+ *	data objects of the same name
+ *
  * also, identifiers in c have 4 scopes:
  *	- function - labels are the only identifiers with
  *	function scope; these (as already said) are not
@@ -169,6 +175,7 @@ struct sym_struct
 
 
 void init_symtab(struct gear_engine_context * ctx);
+void discard_symtab(struct gear_engine_context * ctx);
 struct sym_struct * symtab_find_sym(struct gear_engine_context * ctx, const char * name);
 void symtab_store_sym(struct gear_engine_context * ctx, const char * name, enum SYM_CLASS_ENUM symclass, void * payload);
 
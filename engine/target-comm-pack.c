@@ -0,0 +1,357 @@
+/*!
+ *	\file	target-comm-pack.c
+ *	\brief	binary framed protocol payload encoding routines
+ *	\author	shopov
+ *
+ *	this module encodes (packs) and decodes (unpacks) the data
+ *	carried in the packed frames of the binary framed gear engine -
+ *	target core controller protocol (see the comments in file
+ *	target-comm-frame.h); it is used both by the gear engine (see
+ *	target-comm.c), and by the target core controllers - which
+ *	simply include this source file, so that they do not need
+ *	to be linked to anything from the gear engine
+ *
+ *	the encodings are byte oriented, and simple enough to be
+ *	implemented on a small microcontroller acting as a target
+ *	core controller (a debug probe); the encoded data formats are:
+ *		- TARGET_COMM_ENCODING_RLE - a sequence of runs, each run
+ *		starting with a control byte c; if c is less than 0x80, it
+ *		is followed by (c + 1) literal bytes; otherwise, it is
+ *		followed by a single byte, which is to be repeated
+ *		(c - 0x80 + RLE_MIN_RUN) times
+ *		- TARGET_COMM_ENCODING_LZ - a sequence of runs, each run
+ *		starting with a control byte c; if c is less than 0x80, it
+ *		is followed by (c + 1) literal bytes; otherwise, it is
+ *		followed by a 16 bit number, little endian - the match
+ *		distance minus one; (c - 0x80 + LZ_MIN_MATCH) bytes are to
+ *		be copied, one at a time, starting from that many bytes
+ *		back in the data already decoded - so that the match may
+ *		overlap the bytes being decoded, which is how runs of
+ *		repeating bytes, or repeating patterns, are encoded
+ *
+ *	Revision summary:
+ *
+ *	$Log: $
+ */
+
+/*
+ *
+ * include section follows
+ *
+ */
+
+#include <string.h>
+
+#include "target-comm-frame.h"
+#include "target-comm-pack.h"
+
+/*
+ *
+ * local constants follow
+ *
+ */
+
+/*! the maximum number of literal bytes in a single run, for both encodings */
+#define MAX_LITERAL_RUN		0x80
+/*! the minimum number of repeated bytes encoded as a repeat run by the run length encoding */
+#define RLE_MIN_RUN		3
+/*! the maximum number of repeated bytes in a single repeat run of the run length encoding */
+#define RLE_MAX_RUN		(RLE_MIN_RUN + 0x7f)
+/*! the minimum length of a match encoded by the lempel-ziv encoding */
+#define LZ_MIN_MATCH		4
+/*! the maximum length of a single match of the lempel-ziv encoding */
+#define LZ_MAX_MATCH		(LZ_MIN_MATCH + 0x7f)
+/*! the maximum match distance of the lempel-ziv encoding */
+#define LZ_MAX_DISTANCE		0x10000
+/*! the number of bits in the hash used for finding matches when lempel-ziv encoding */
+#define LZ_HASH_BITS		12
+
+/*
+ *
+ * local functions follow
+ *
+ */
+
+/*!
+ *	\fn	static int flush_literals(unsigned char * dest, int dest_idx, int dest_size, const unsigned char * literals, int nr_literals)
+ *	\brief	emits literal runs, common to both encodings
+ *
+ *	\param	dest	the buffer to store the encoded data in
+ *	\param	dest_idx	the number of bytes already stored in dest
+ *	\param	dest_size	the size of dest, in bytes
+ *	\param	literals	the literal bytes to emit
+ *	\param	nr_literals	the number of literal bytes to emit
+ *	\return	the updated number of bytes stored in dest, or -1 if dest overflows
+ */
+static int flush_literals(unsigned char * dest, int dest_idx, int dest_size, const unsigned char * literals, int nr_literals)
+{
+int len;
+
+	while (nr_literals)
+	{
+		len = (nr_literals > MAX_LITERAL_RUN) ? MAX_LITERAL_RUN : nr_literals;
+		if (dest_idx + 1 + len > dest_size)
+			return -1;
+		dest[dest_idx ++] = len - 1;
+		memcpy(dest + dest_idx, literals, len);
+		dest_idx += len;
+		literals += len;
+		nr_literals -= len;
+	}
+	return dest_idx;
+}
+
+/*!
+ *	\fn	static int rle_pack(unsigned char * dest, int dest_size, const unsigned char * src, int src_len)
+ *	\brief	run length encodes data
+ *
+ *	\param	dest	the buffer to store the encoded data in
+ *	\param	dest_size	the size of dest, in bytes
+ *	\param	src	the data to encode
+ *	\param	src_len	the number of bytes to encode
+ *	\return	the number of encoded bytes, or -1 if they do not fit in dest
+ */
+static int rle_pack(unsigned char * dest, int dest_size, const unsigned char * src, int src_len)
+{
+int i, j, literal_start, dest_idx;
+
+	dest_idx = 0;
+	literal_start = 0;
+	i = 0;
+	while (i < src_len)
+	{
+		for (j = i + 1; j < src_len && j - i < RLE_MAX_RUN && src[j] == src[i]; j ++)
+			;
+		if (j - i < RLE_MIN_RUN)
+		{
+			i = j;
+			continue;
+		}
+		if ((dest_idx = flush_literals(dest, dest_idx, dest_size, src + literal_start, i - literal_start)) == -1)
+			return -1;
+		if (dest_idx + 2 > dest_size)
+			return -1;
+		dest[dest_idx ++] = 0x80 + j - i - RLE_MIN_RUN;
+		dest[dest_idx ++] = src[i];
+		i = literal_start = j;
+	}
+	return flush_literals(dest, dest_idx, dest_size, src + literal_start, src_len - literal_start);
+}
+
+/*!
+ *	\fn	static int rle_unpack(unsigned char * dest, int dest_len, const unsigned char * src, int src_len)
+ *	\brief	decodes run length encoded data
+ *
+ *	\param	dest	the buffer to store the decoded data in
+ *	\param	dest_len	the number of bytes the data must decode to
+ *	\param	src	the encoded data
+ *	\param	src_len	the number of encoded bytes
+ *	\return	zero if the data has been decoded successfully, -1 if the encoded data is malformed
+ */
+static int rle_unpack(unsigned char * dest, int dest_len, const unsigned char * src, int src_len)
+{
+int i, j, len;
+
+	i = j = 0;
+	while (i < src_len)
+	{
+		if (src[i] < 0x80)
+		{
+			len = src[i ++] + 1;
+			if (i + len > src_len || j + len > dest_len)
+				return -1;
+			memcpy(dest + j, src + i, len);
+			i += len;
+		}
+		else
+		{
+			len = src[i ++] - 0x80 + RLE_MIN_RUN;
+			if (i == src_len || j + len > dest_len)
+				return -1;
+			memset(dest + j, src[i ++], len);
+		}
+		j += len;
+	}
+	return (j == dest_len) ? 0 : -1;
+}
+
+/*!
+ *	\fn	static int lz_pack(unsigned char * dest, int dest_size, const unsigned char * src, int src_len)
+ *	\brief	lempel-ziv encodes data
+ *
+ *	matches are searched for greedily, by hashing the next
+ *	LZ_MIN_MATCH bytes of the data, and looking up the most
+ *	recent position at which the same hash has been seen; this
+ *	does not find the longest matches possible, but is fast, and
+ *	is good enough for the data usually found in target memory
+ *
+ *	\param	dest	the buffer to store the encoded data in
+ *	\param	dest_size	the size of dest, in bytes
+ *	\param	src	the data to encode
+ *	\param	src_len	the number of bytes to encode
+ *	\return	the number of encoded bytes, or -1 if they do not fit in dest
+ */
+static int lz_pack(unsigned char * dest, int dest_size, const unsigned char * src, int src_len)
+{
+int hash_table[1 << LZ_HASH_BITS];
+int i, j, len, h, match, literal_start, dest_idx;
+unsigned long x;
+
+	for (i = 0; i < 1 << LZ_HASH_BITS; i ++)
+		hash_table[i] = -1;
+	dest_idx = 0;
+	literal_start = 0;
+	i = 0;
+	while (i + LZ_MIN_MATCH <= src_len)
+	{
+		x = src[i] | (src[i + 1] << 8) | (src[i + 2] << 16) | ((unsigned long) src[i + 3] << 24);
+		h = ((x * 2654435761UL) & 0xffffffff) >> (32 - LZ_HASH_BITS);
+		match = hash_table[h];
+		hash_table[h] = i;
+		if (match == -1 || i - match > LZ_MAX_DISTANCE
+				|| memcmp(src + match, src + i, LZ_MIN_MATCH))
+		{
+			i ++;
+			continue;
+		}
+		for (len = LZ_MIN_MATCH; i + len < src_len && len < LZ_MAX_MATCH
+				&& src[match + len] == src[i + len]; len ++)
+			;
+		if ((dest_idx = flush_literals(dest, dest_idx, dest_size, src + literal_start, i - literal_start)) == -1)
+			return -1;
+		if (dest_idx + 3 > dest_size)
+			return -1;
+		dest[dest_idx ++] = 0x80 + len - LZ_MIN_MATCH;
+		dest[dest_idx ++] = (i - match - 1);
+		dest[dest_idx ++] = (i - match - 1) >> 8;
+		/* record the positions within the match, so that
+		 * later data can refer to them */
+		for (j = i + 1; j < i + len && j + LZ_MIN_MATCH <= src_len; j ++)
+		{
+			x = src[j] | (src[j + 1] << 8) | (src[j + 2] << 16) | ((unsigned long) src[j + 3] << 24);
+			hash_table[((x * 2654435761UL) & 0xffffffff) >> (32 - LZ_HASH_BITS)] = j;
+		}
+		i = literal_start = i + len;
+	}
+	return flush_literals(dest, dest_idx, dest_size, src + literal_start, src_len - literal_start);
+}
+
+/*!
+ *	\fn	static int lz_unpack(unsigned char * dest, int dest_len, const unsigned char * src, int src_len)
+ *	\brief	decodes lempel-ziv encoded data
+ *
+ *	\param	dest	the buffer to store the decoded data in
+ *	\param	dest_len	the number of bytes the data must decode to
+ *	\param	src	the encoded data
+ *	\param	src_len	the number of encoded bytes
+ *	\return	zero if the data has been decoded successfully, -1 if the encoded data is malformed
+ */
+static int lz_unpack(unsigned char * dest, int dest_len, const unsigned char * src, int src_len)
+{
+int i, j, len, distance;
+
+	i = j = 0;
+	while (i < src_len)
+	{
+		if (src[i] < 0x80)
+		{
+			len = src[i ++] + 1;
+			if (i + len > src_len || j + len > dest_len)
+				return -1;
+			memcpy(dest + j, src + i, len);
+			i += len;
+			j += len;
+		}
+		else
+		{
+			len = src[i ++] - 0x80 + LZ_MIN_MATCH;
+			if (i + 2 > src_len || j + len > dest_len)
+				return -1;
+			distance = (src[i] | (src[i + 1] << 8)) + 1;
+			i += 2;
+			if (distance > j)
+				return -1;
+			/* the match may overlap the bytes being
+			 * decoded, so copy one byte at a time */
+			for (; len; len --, j ++)
+				dest[j] = dest[j - distance];
+		}
+	}
+	return (j == dest_len) ? 0 : -1;
+}
+
+/*
+ *
+ * exported functions follow
+ *
+ */
+
+/*!
+ *	\fn	int target_comm_pack(unsigned encodings, unsigned char * dest, int dest_size, const unsigned char * src, int src_len, enum TARGET_COMM_ENCODING_ENUM * encoding)
+ *	\brief	encodes data, by using the most effective of the encodings allowed
+ *
+ *	the encoded data must be shorter than dest_size bytes;
+ *	normally, dest_size is the same as src_len, so that encoding
+ *	is only used when it saves something - the caller is expected
+ *	to send the data unencoded (TARGET_COMM_ENCODING_RAW) if
+ *	this routine fails
+ *
+ *	\param	encodings	a bitmap of the encodings allowed, in the format
+ *				used by the TARGET_COMM_FRAME_SET_ENCODINGS frame
+ *	\param	dest	the buffer to store the encoded data in
+ *	\param	dest_size	the size of dest, in bytes
+ *	\param	src	the data to encode
+ *	\param	src_len	the number of bytes to encode
+ *	\param	encoding	the encoding used is stored here
+ *	\return	the number of encoded bytes, or -1 if no encoding
+ *		allowed is supported, or the data cannot be encoded
+ *		in less than dest_size bytes
+ */
+int target_comm_pack(unsigned encodings, unsigned char * dest, int dest_size, const unsigned char * src, int src_len, enum TARGET_COMM_ENCODING_ENUM * encoding)
+{
+	/* leave room for making sure the encoded data is shorter */
+	dest_size --;
+	if (encodings & (1 << TARGET_COMM_ENCODING_LZ))
+	{
+		* encoding = TARGET_COMM_ENCODING_LZ;
+		return lz_pack(dest, dest_size, src, src_len);
+	}
+	if (encodings & (1 << TARGET_COMM_ENCODING_RLE))
+	{
+		* encoding = TARGET_COMM_ENCODING_RLE;
+		return rle_pack(dest, dest_size, src, src_len);
+	}
+	return -1;
+}
+
+/*!
+ *	\fn	int target_comm_unpack(enum TARGET_COMM_ENCODING_ENUM encoding, unsigned char * dest, int dest_len, const unsigned char * src, int src_len)
+ *	\brief	decodes data encoded by target_comm_pack()
+ *
+ *	\param	encoding	the encoding of the data
+ *	\param	dest	the buffer to store the decoded data in
+ *	\param	dest_len	the number of bytes the data must decode to
+ *	\param	src	the encoded data
+ *	\param	src_len	the number of encoded bytes
+ *	\return	zero if the data has been decoded successfully, -1 if
+ *		the encoding is not supported, or the encoded data is
+ *		malformed, or does not decode to exactly dest_len bytes
+ */
+int target_comm_unpack(enum TARGET_COMM_ENCODING_ENUM encoding, unsigned char * dest, int dest_len, const unsigned char * src, int src_len)
+{
+	switch (encoding)
+	{
+		case TARGET_COMM_ENCODING_RAW:
+			if (src_len != dest_len)
+				return -1;
+			memcpy(dest, src, dest_len);
+			return 0;
+		case TARGET_COMM_ENCODING_RLE:
+			return rle_unpack(dest, dest_len, src, src_len);
+		case TARGET_COMM_ENCODING_LZ:
+			return lz_unpack(dest, dest_len, src, src_len);
+		default:
+			return -1;
+	}
+}
+
@@ -0,0 +1,27 @@
+/*!
+ *	\file	target-comm-pack.h
+ *	\brief	binary framed protocol payload encoding module header
+ *	\author	shopov
+ *
+ *	Revision summary:
+ *
+ *	$Log: $
+ */
+
+/*
+ *
+ * exported declarations follow
+ *
+ */
+
+/*! the bitmap of the payload encodings supported by this module, in the format used by the TARGET_COMM_FRAME_SET_ENCODINGS frame */
+#define TARGET_COMM_PACK_ENCODINGS	((1 << TARGET_COMM_ENCODING_RLE) | (1 << TARGET_COMM_ENCODING_LZ))
+
+/*
+ *
+ * exported function prototypes follow
+ *
+ */
+int target_comm_pack(unsigned encodings, unsigned char * dest, int dest_size, const unsigned char * src, int src_len, enum TARGET_COMM_ENCODING_ENUM * encoding);
+int target_comm_unpack(enum TARGET_COMM_ENCODING_ENUM encoding, unsigned char * dest, int dest_len, const unsigned char * src, int src_len);
+
@@ -83,6 +83,42 @@
  *		if interested in how incoming data from a
  *		target core controller is buffered and processed
  *
+ *	\note	when the binary framed protocol is in effect, the
+ *		communication with the target core controller is
+ *		driven by a simple state machine, so that it is not
+ *		necessary to block waiting for the reply to a request;
+ *		each request frame sent is recorded (see the
+ *		outstanding_frames field in struct core_connection_data
+ *		below), and it is either synchronous - in which case
+ *		the requester blocks until its reply arrives (see
+ *		recv_frame()), or asynchronous - in which case a
+ *		completion routine is recorded, and is invoked
+ *		whenever the reply arrives (see dispatch_async_frame());
+ *		incoming frames are assembled piecemeal, as data becomes
+ *		available (see assemble_frame()); the gear engine main
+ *		loop monitors the target core controller connection
+ *		for incoming data along with the frontend connections
+ *		(see target_comm_get_input_fd() and target_comm_process_input()),
+ *		so that the target core state polling requests, and
+ *		long target memory transfers (see target_comm_start_mem_read())
+ *		do not block the servicing of frontend requests; a
+ *		synchronous request can be issued at any time - the replies
+ *		to any asynchronous requests sent before it are dispatched
+ *		to their completion routines while waiting for its reply;
+ *		the callbacks of asynchronous target memory transfers, however,
+ *		are never invoked from there - completed transfers are queued,
+ *		and their callbacks are only invoked from the gear engine main
+ *		loop, between frontend requests (see
+ *		target_comm_dispatch_completed_xfers()), so that the callbacks
+ *		are free to produce machine interface output
+ *
+ *	\note	with version 4 of the binary protocol, target memory
+ *		contents may be transferred encoded (compressed), if the
+ *		target core controller agrees on it (see negotiate_payload_encodings());
+ *		this is meant for slow target connections, and for highly
+ *		compressible target memory contents (e.g. zero filled memory,
+ *		padded flash images); for the encodings, see file target-comm-pack.c
+ *
  *	\todo	write here some notes regarding buffer usage
  *
  *	\todo	provide a reference to the documentation files
@@ -112,26 +148,42 @@ extern int frontend_fds[2];
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #ifdef __LINUX__
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <net/if.h>
 #else
 #include <winsock2.h>
 #endif
 #include <stdarg.h>
+#include <stdbool.h>
+
+/* only pointers to these are needed (in struct gear_engine_context);
+ * they are declared here, so that this module builds without the
+ * libdwarf and libelf headers - see the benchmark in directory bench */
+typedef struct Elf Elf;
+typedef struct Dwarf_Debug_s * Dwarf_Debug;
 
-#include "dwarf-common.h"
 #include "target-defs.h"
 #include "gear-engine-context.h"
 #include "engine-err.h"
 #include "core-access.h"
+#include "target-description.h"
 #include "util.h"
 #include "fdprintf.h"
 #include "gprintf.h"
+#include "miprintf.h"
+#include "target-comm.h"
+#include "target-comm-frame.h"
+#include "target-comm-pack.h"
 
 /*
  *
@@ -170,6 +222,52 @@ enum LEX_TOKEN_TYPE_ENUM
 	LEX_TOKEN_CSTR,
 };
 
+/*! an enumeration of the protocols available for talking to a target core controller
+ *
+ * for details, see the comments in file target-comm-frame.h */
+enum TARGET_COMM_PROTOCOL_ENUM
+{
+	/*! the human readable, ascii text protocol */
+	TARGET_COMM_PROTOCOL_ASCII = 0,
+	/*! the binary framed protocol */
+	TARGET_COMM_PROTOCOL_BINARY,
+	/*! the number of protocols; must be last */
+	NR_TARGET_COMM_PROTOCOLS,
+};
+
+/*! an asynchronous target memory transfer
+ *
+ * for details, see target_comm_start_mem_read() */
+struct target_comm_xfer
+{
+	/*! link pointer for the list of asynchronous transfers in progress */
+	struct target_comm_xfer	* next;
+	/*! the transfer identifier, as returned by target_comm_start_mem_read() */
+	int			id;
+	/*! the buffer to store the bytes read in */
+	unsigned char		* dest;
+	/*! the target memory address of the next chunk to request */
+	ARM_CORE_WORD		addr;
+	/*! the number of bytes not yet requested */
+	unsigned		bytes_to_request;
+	/*! the number of bytes requested, whose replies have not yet been received */
+	unsigned		bytes_to_receive;
+	/*! the number of bytes successfully read so far */
+	unsigned		nbytes;
+	/*! the number of chunk requests outstanding */
+	int			nr_outstanding;
+	/*! the status code of the first chunk that failed, GEAR_ERR_NO_ERROR if none failed */
+	enum GEAR_ENGINE_ERR_ENUM	result;
+	/*! if true, the transfer has been cancelled, and no more chunks are requested */
+	bool			is_cancelled;
+	/*! the time at which the transfer was started; used for the transfer statistics */
+	struct timeval		start;
+	/*! the routine to invoke when the transfer completes */
+	void (*callback)(struct gear_engine_context * ctx, void * cookie, int xfer_id, enum GEAR_ENGINE_ERR_ENUM result, unsigned nbytes);
+	/*! an arbitrary value passed back to the callback routine */
+	void			* cookie;
+};
+
 /*! a data structure to hold target core and target core controller connection parameters */
 struct core_connection_data
 {
@@ -211,6 +309,145 @@ struct core_connection_data
 	/*! target core controller internet address, in case communications is via sockets */
 	struct sockaddr_in	core_inet_addr;
 
+	/*! a flag to denote whether the binary framed protocol has been negotiated with the target core controller
+	 *
+	 * when set, target memory and register access requests, as well
+	 * as target core state requests, are sent as binary frames
+	 * instead of ascii text records; for details, see the comments
+	 * in file target-comm-frame.h */
+	bool	is_binary_protocol_enabled;
+	/*! the binary protocol version negotiated; only valid if is_binary_protocol_enabled is set
+	 *
+	 * this determines the binary frame types that may be sent to
+	 * the target core controller; see enum TARGET_COMM_FRAME_ENUM
+	 * in file target-comm-frame.h */
+	int	binary_protocol_version;
+	/*! a buffer for assembling outgoing binary frames; TARGET_COMM_FRAME_HEADER_SIZE + TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE bytes in size */
+	unsigned char	* frame_buf;
+	/*! the sequence id of the next binary request frame to be sent */
+	unsigned short	tx_frame_seq;
+	/*! the sequence id of the next binary reply frame expected
+	 *
+	 * as replies arrive in the order in which requests have
+	 * been sent, this is the sequence id of the oldest request
+	 * not yet replied to; the number of requests outstanding
+	 * is (tx_frame_seq - rx_frame_seq) */
+	unsigned short	rx_frame_seq;
+	/*! the bitmap of the payload encodings agreed upon with the target core controller
+	 *
+	 * if nonzero, target memory is transferred by means of
+	 * the packed frames, and the encodings in the bitmap may
+	 * be used; for details, see negotiate_payload_encodings() and
+	 * the comments in file target-comm-frame.h */
+	unsigned	payload_encodings;
+	/*! a buffer for receiving the encoded payloads of the packed frames; TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE bytes in size */
+	unsigned char	* packed_buf;
+	/*! the maximum number of target memory transfer request frames that may be outstanding at any time
+	 *
+	 * for details, see frame_mem_read() and frame_mem_write() */
+	int	xfer_window;
+	/*! a buffer for assembling incoming binary frames; TARGET_COMM_FRAME_HEADER_SIZE + TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE bytes in size
+	 *
+	 * frames are assembled piecemeal, as data from the target
+	 * core controller becomes available; see assemble_frame() */
+	unsigned char	* rx_buf;
+	/*! the number of bytes of the incoming frame currently assembled in rx_buf */
+	int	rx_len;
+	/*! bookkeeping for the request frames outstanding, indexed by the frame sequence id, modulo MAX_OUTSTANDING_FRAMES
+	 *
+	 * for synchronous requests, the completion field is null, and
+	 * the reply is received by the requester itself (see recv_frame());
+	 * for asynchronous requests, the completion routine is invoked
+	 * whenever the reply arrives (see dispatch_async_frame()) */
+	struct
+	{
+/*! the maximum number of request frames that may be outstanding at any time
+ *
+ * this must be a power of two, and must not exceed 65536, so that
+ * the frame sequence id wraparound is handled properly; it must be
+ * large enough to accommodate the request windows of a synchronous
+ * target memory transfer and of MAX_ASYNC_XFERS asynchronous target
+ * memory transfers, plus a target core state request */
+#define MAX_OUTSTANDING_FRAMES	64
+		/*! the type of the request frame */
+		enum TARGET_COMM_FRAME_ENUM	frame_type;
+		/*! the completion routine for an asynchronous request, null for a synchronous one
+		 *
+		 * the payload passed is only valid until the
+		 * completion routine itself receives another frame */
+		void (*completion)(struct gear_engine_context * ctx, void * cookie,
+				enum GEAR_ENGINE_ERR_ENUM status, const unsigned char * payload, int payload_len);
+		/*! an arbitrary value passed back to the completion routine */
+		void	* cookie;
+	}
+	outstanding_frames[MAX_OUTSTANDING_FRAMES];
+	/*! a flag denoting if a target core state request has been sent, and its reply has not yet been processed
+	 *
+	 * see target_comm_issue_core_status_request() */
+	bool	is_status_request_pending;
+	/*! the target core state, as most recently reported by the target core controller */
+	enum TARGET_CORE_STATE_ENUM	last_reported_state;
+	/*! the target core state most recently passed to the target state change callbacks
+	 *
+	 * this is used for detecting when the target halts, so that a
+	 * halt snapshot is retrieved; see invoke_target_state_change_callback() */
+	enum TARGET_CORE_STATE_ENUM	notified_state;
+	/*! halt snapshot statistics; see target_comm_dump_xfer_stats_mi() */
+	struct
+	{
+		/*! the number of halt snapshots retrieved by a single binary request */
+		int	nr_single_request;
+		/*! the number of halt snapshots put together from separate requests */
+		int	nr_fallback;
+	}
+	halt_snapshot_stats;
+	/*! the list of asynchronous target memory transfers in progress */
+	struct target_comm_xfer	* xfers;
+	/*! the queue of completed asynchronous target memory transfers, whose callbacks have not yet been invoked, oldest first
+	 *
+	 * see target_comm_dispatch_completed_xfers() */
+	struct target_comm_xfer	* completed_xfers;
+	/*! the identifier to assign to the next asynchronous target memory transfer */
+	int	next_xfer_id;
+	/*! target memory transfer statistics, one entry for each of the protocols in enum TARGET_COMM_PROTOCOL_ENUM
+	 *
+	 * these are used for measuring the throughput of the target memory
+	 * transfers; see target_comm_dump_xfer_stats_mi() */
+	struct
+	{
+		/*! the number of target memory read and write requests served */
+		int			nr_requests;
+		/*! the number of target memory bytes read */
+		unsigned long long	nr_bytes_read;
+		/*! the number of target memory bytes written */
+		unsigned long long	nr_bytes_written;
+		/*! the total time spent in target memory transfers, in microseconds */
+		unsigned long long	nr_usecs;
+	}
+	xfer_stats[NR_TARGET_COMM_PROTOCOLS];
+	/*! binary protocol input/output statistics
+	 *
+	 * these are used for measuring the system call and data copying
+	 * overhead of the binary protocol; see target_comm_dump_xfer_stats_mi() */
+	struct
+	{
+		/*! the number of system calls made for sending binary frames */
+		int			nr_write_calls;
+		/*! the number of system calls made for receiving binary frames */
+		int			nr_read_calls;
+		/*! the number of select() calls made when waiting for binary frames */
+		int			nr_select_calls;
+		/*! the number of payload bytes copied between intermediate buffers */
+		unsigned long long	nr_bytes_copied;
+		/*! the number of payload bytes sent directly from, or received directly into, the caller buffers */
+		unsigned long long	nr_bytes_direct;
+		/*! the number of target memory bytes transferred in packed frames, as sent over the connection */
+		unsigned long long	nr_bytes_packed;
+		/*! the number of target memory bytes transferred in packed frames, after decoding */
+		unsigned long long	nr_bytes_unpacked;
+	}
+	io_stats;
+
 	/*! the target core state change callback function stack/list
 	 *
 	 * for more details, read the comments about 
@@ -399,6 +636,7 @@ struct core_connection_data
  *
  */ 
 static enum GEAR_ENGINE_ERR_ENUM must_be_only_called_from_yylex_wait_incoming_data(struct gear_engine_context * ctx);
+static void take_halt_snapshot(struct gear_engine_context * ctx);
 
 
 /* directly include the lexer source - after the struct core_connection_data
@@ -437,6 +675,22 @@ static const int CORE_CONTROLLER_READ_TIMEOUT_MS = 10000/*0*/;
  *		phase so that bugs show themselves easier; once
  *		debugging is finished, make this bigger */
 static const int MEM_XFER_CHUNK_SIZE = 64;
+/*! the number of bytes to transfer (read or write) in one chunk when accessing target memory with the binary protocol
+ *
+ * this must not exceed TARGET_COMM_FRAME_MAX_DATA_SIZE; it is much larger
+ * than MEM_XFER_CHUNK_SIZE above, because there is no per byte overhead
+ * in the binary protocol, but it is still kept moderate, so that there
+ * is a chance to report progress during large transfers */
+static const int MEM_XFER_FRAME_CHUNK_SIZE = 4096;
+/*! the maximum number of asynchronous target memory transfers that may be in progress at any time
+ *
+ * also see the comments about MAX_OUTSTANDING_FRAMES */
+static const int MAX_ASYNC_XFERS = 2;
+/*! the size of the socket send and receive buffers requested for the target core controller connection, in bytes
+ *
+ * this is large enough to hold the replies to a full window of
+ * pipelined target memory read requests (see frame_mem_read()) */
+static const int TARGET_COMM_SOCKET_BUFFER_SIZE = 0x40000;
 
 /*
  *
@@ -453,6 +707,12 @@ static const int MEM_XFER_CHUNK_SIZE = 64;
  *	stack, if it returns true (nonzero), then the callback
  *	further down the stack is invoked, and so on until either a
  *	callback returns false (zero), or the stack is exhausted
+ *
+ *	if the target has just halted, a halt snapshot is retrieved
+ *	before invoking the callbacks, so that the modules overriding
+ *	ctx->cc->core_get_halt_snapshot() have a chance to populate
+ *	their caches before the callbacks start accessing the target
+ *	(see take_halt_snapshot())
  *	
  *	\param	ctx	context to work in
  *	\param	state	current target state to pass to the callback
@@ -463,8 +723,13 @@ static void invoke_target_state_change_callback(struct gear_engine_context * ctx
 struct core_connection_data * p;
 int i;
 bool res;
+enum TARGET_CORE_STATE_ENUM prev_state;
 
 	p = ctx->core_comm;
+	prev_state = p->notified_state;
+	p->notified_state = state;
+	if (state == TARGET_CORE_STATE_HALTED && prev_state != TARGET_CORE_STATE_HALTED)
+		take_halt_snapshot(ctx);
 	/* see if the callback stack is empty */
 	i = p->target_state_change_callback_stack.stack_ptr;
 	if (i == 0)
@@ -495,150 +760,748 @@ static void sync_target_lexer(struct gear_engine_context * ctx)
 		;
 }
 
+/*!
+ *	\fn	static void put_frame_word(unsigned char * buf, ARM_CORE_WORD word)
+ *	\brief	stores a 32 bit number in a binary frame payload, in little endian byte order
+ *
+ *	\param	buf	the location in the frame payload to store the number at
+ *	\param	word	the number to store
+ *	\return	none
+ */
+static void put_frame_word(unsigned char * buf, ARM_CORE_WORD word)
+{
+	buf[0] = word;
+	buf[1] = word >> 8;
+	buf[2] = word >> 16;
+	buf[3] = word >> 24;
+}
+
+/*!
+ *	\fn	static ARM_CORE_WORD get_frame_word(const unsigned char * buf)
+ *	\brief	retrieves a 32 bit number from a binary frame payload, stored in little endian byte order
+ *
+ *	\param	buf	the location in the frame payload to fetch the number from
+ *	\return	the number fetched
+ */
+static ARM_CORE_WORD get_frame_word(const unsigned char * buf)
+{
+	return buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((ARM_CORE_WORD) buf[3] << 24);
+}
 
 /*!
- *	\fn	static bool is_connected(struct gear_engine_context * ctx)
- *	\brief	determines if a connection to a target core controller is currently established
+ *	\fn	static void write_frame_bytes(struct gear_engine_context * ctx, const unsigned char * head, int head_len, const unsigned char * data, int data_len)
+ *	\brief	sends two consecutive runs of bytes to the target core controller
+ *
+ *	on linux, the two runs are gathered by the kernel (by means of
+ *	writev()), so that a frame header and a frame payload residing
+ *	in different buffers are sent without first copying them
+ *	together, and, most commonly, by a single system call
  *
  *	\param	ctx	context to work in
- *	\return	true if a connection to a target core controller is currently established, false otherwise
+ *	\param	head	the first run of bytes to send
+ *	\param	head_len	the number of bytes in the first run
+ *	\param	data	the second run of bytes to send; may be null if data_len is zero
+ *	\param	data_len	the number of bytes in the second run
+ *	\return	none
  */
-static bool is_connected(struct gear_engine_context * ctx)
+static void write_frame_bytes(struct gear_engine_context * ctx, const unsigned char * head, int head_len, const unsigned char * data, int data_len)
 {
 struct core_connection_data * p;
+int res;
+#ifdef __LINUX__
+struct iovec iov[2];
+int i;
 
 	p = ctx->core_comm;
-	return p->is_core_controller_connected ? true : false;
+	iov[0].iov_base = (void *) head;
+	iov[0].iov_len = head_len;
+	iov[1].iov_base = (void *) data;
+	iov[1].iov_len = data_len;
+	i = 0;
+	while (i < 2)
+	{
+		if (!iov[i].iov_len)
+		{
+			i ++;
+			continue;
+		}
+		res = writev(p->write_core_fd, iov + i, 2 - i);
+		p->io_stats.nr_write_calls ++;
+		if (res <= 0)
+			panic("");
+		/* skip the bytes written */
+		for (; i < 2 && (size_t) res >= iov[i].iov_len; i ++)
+		{
+			res -= iov[i].iov_len;
+			iov[i].iov_len = 0;
+		}
+		if (res)
+		{
+			iov[i].iov_base = (unsigned char *) iov[i].iov_base + res;
+			iov[i].iov_len -= res;
+		}
+	}
+#else
+
+	p = ctx->core_comm;
+	while (head_len || data_len)
+	{
+		if (!head_len)
+		{
+			head = data;
+			head_len = data_len;
+			data_len = 0;
+		}
+		res = send(p->write_core_fd, head, head_len, 0);
+		p->io_stats.nr_write_calls ++;
+		if (res <= 0)
+			panic("");
+		head += res;
+		head_len -= res;
+	}
+#endif
 }
 
+/*!
+ *	\fn	static void send_frame_data(struct gear_engine_context * ctx, enum TARGET_COMM_FRAME_ENUM frame_type, int payload_len, const void * data, int data_len)
+ *	\brief	sends a synchronous binary request frame, the payload of which ends with bulk data residing in a caller supplied buffer
+ *
+ *	the leading part of the frame payload must already have
+ *	been stored in the frame buffer (the frame_buf field of struct
+ *	core_connection_data), right after the space reserved for the
+ *	frame header; the header is filled in here; the bulk data is
+ *	sent directly from the caller supplied buffer, and is not
+ *	copied to the frame buffer; the frame is assigned the next
+ *	request sequence id - the reply to it must be received with
+ *	recv_frame() before any replies to synchronous requests sent
+ *	after this one
+ *
+ *	\param	ctx	context to work in
+ *	\param	frame_type	the type of the frame to send
+ *	\param	payload_len	the length of the leading part of the payload,
+ *				residing in the frame buffer, in bytes
+ *	\param	data	the bulk data to append to the payload; may be
+ *			null if data_len is zero
+ *	\param	data_len	the length of the bulk data, in bytes
+ *	\return	none
+ */
+static void send_frame_data(struct gear_engine_context * ctx, enum TARGET_COMM_FRAME_ENUM frame_type, int payload_len, const void * data, int data_len)
+{
+struct core_connection_data * p;
+unsigned char * buf;
+
+	p = ctx->core_comm;
+	if (payload_len < 0 || data_len < 0
+			|| payload_len + data_len > TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE)
+		panic("");
+	if ((unsigned short) (p->tx_frame_seq - p->rx_frame_seq) >= MAX_OUTSTANDING_FRAMES)
+		panic("");
+	p->outstanding_frames[p->tx_frame_seq % MAX_OUTSTANDING_FRAMES].frame_type = frame_type;
+	p->outstanding_frames[p->tx_frame_seq % MAX_OUTSTANDING_FRAMES].completion = 0;
+	p->outstanding_frames[p->tx_frame_seq % MAX_OUTSTANDING_FRAMES].cookie = 0;
+	buf = p->frame_buf;
+	buf[0] = frame_type;
+	buf[1] = 0;
+	buf[2] = p->tx_frame_seq;
+	buf[3] = p->tx_frame_seq >> 8;
+	p->tx_frame_seq ++;
+	put_frame_word(buf + 4, payload_len + data_len);
+	write_frame_bytes(ctx, buf, TARGET_COMM_FRAME_HEADER_SIZE + payload_len, data, data_len);
+	p->io_stats.nr_bytes_direct += data_len;
+}
 
 /*!
- *	\fn	static enum GEAR_ENGINE_ERR_ENUM core_open(struct gear_engine_context * ctx, const char ** errmsg_hint)
- *	\brief	establishes a connection to a target core
+ *	\fn	static void send_frame(struct gear_engine_context * ctx, enum TARGET_COMM_FRAME_ENUM frame_type, int payload_len)
+ *	\brief	sends a synchronous binary request frame to the target core controller
  *
- *	\note	it is important to invoke the core_open()
- *		routine to connect to a target core prior
- *		to invoking any other target core related
- *		routines
+ *	the frame payload must already have been stored in the
+ *	frame buffer (the frame_buf field of struct core_connection_data),
+ *	right after the space reserved for the frame header; for
+ *	details, see send_frame_data()
  *
  *	\param	ctx	context to work in
- *	\param	errmsg_hint	in case of an error, it is possible that
- *				an informative error message is available;
- *				e.g. in the case a connection to a target
- *				core controller was successfully established,
- *				but there is an error communicating with
- *				the target core (e.g. the target core is
- *				not powered, there is no functional debug probe
- *				connected to the target core, etc.), the
- *				target core controller is allowed to return
- *				an error message hint; this is purely an
- *				informative message that is not in any way
- *				processed by the gear engine, and it is
- *				intended to be delivered verbatim to a gear
- *				engine frontend in order to be presented
- *				to a debugger user so that (s)he can
- *				perform corrective actions; in case
- *				an error message hint is available
- *				(e.g. is provided a target core controller),
- *				a ponter to it
- *				is stored in this variable, and it is the
- *				caller's responsibility to free() this
- *				error message string when no longer
- *				needed; in case this error message is
- *				not needed, this parameter can be null
- *	\return	for definitions of error codes, see the GEAR_ENGINE_ERR_ENUM
- *		documentation; this routine returns one of:
- *		- GEAR_ERR_NO_ERROR - if everything is fine and a 
- *		connection to a target core was succesfully established
- *		- GEAR_ERR_TARGET_CORE_CONNECTION_FAILED - if a connection
- *		to a target core controller could not be established
- *		- GEAR_ERR_GENERIC_ERROR - if a connection to a target
- *		core controller was established, but there is an error
- *		communicating with the target core (e.g. the target core is
- *		not powered, there is no functional debug probe
- *		connected to the target core, etc.); in this case, if
- *		the 'errmsg_hint' parameter is not null and the
- *		target core controller provided an error message hint,
- *		the 'errmsg_hint' variable will be set to the error
- *		message hint provided by the target core controller
- *		and it is the caller's responsibility to free() this
- *		error message hint when no longer needed
+ *	\param	frame_type	the type of the frame to send
+ *	\param	payload_len	the length of the payload, in bytes
+ *	\return	none
  */
-static enum GEAR_ENGINE_ERR_ENUM core_open(struct gear_engine_context * ctx, const char ** errmsg_hint)
+static void send_frame(struct gear_engine_context * ctx, enum TARGET_COMM_FRAME_ENUM frame_type, int payload_len)
+{
+	send_frame_data(ctx, frame_type, payload_len, 0, 0);
+}
+
+/*!
+ *	\fn	static void send_async_frame(struct gear_engine_context * ctx, enum TARGET_COMM_FRAME_ENUM frame_type, int payload_len, void (*completion)(struct gear_engine_context * ctx, void * cookie, enum GEAR_ENGINE_ERR_ENUM status, const unsigned char * payload, int payload_len), void * cookie)
+ *	\brief	sends an asynchronous binary request frame to the target core controller
+ *
+ *	this is the same as send_frame(), except that the reply
+ *	is not received by the caller - instead, the completion
+ *	routine passed is invoked when the reply arrives
+ *
+ *	\param	ctx	context to work in
+ *	\param	frame_type	the type of the frame to send
+ *	\param	payload_len	the length of the payload, in bytes
+ *	\param	completion	the routine to invoke when the reply arrives
+ *	\param	cookie	an arbitrary value to pass to the completion routine
+ *	\return	none
+ */
+static void send_async_frame(struct gear_engine_context * ctx, enum TARGET_COMM_FRAME_ENUM frame_type, int payload_len,
+		void (*completion)(struct gear_engine_context * ctx, void * cookie,
+			enum GEAR_ENGINE_ERR_ENUM status, const unsigned char * payload, int payload_len),
+		void * cookie)
 {
-int fd;
 struct core_connection_data * p;
-enum GEAR_ENGINE_ERR_ENUM err;
-enum LEX_TOKEN_TYPE_ENUM token;
+int i;
 
-	/* sanity checks */
 	p = ctx->core_comm;
-	if (!p)
-		panic("");
-	if (errmsg_hint)
-		* errmsg_hint = 0;
-	if (!p->is_core_controller_connected)
+	i = p->tx_frame_seq % MAX_OUTSTANDING_FRAMES;
+	send_frame(ctx, frame_type, payload_len);
+	p->outstanding_frames[i].completion = completion;
+	p->outstanding_frames[i].cookie = cookie;
+}
+
+/*!
+ *	\fn	static bool read_frame_bytes(struct gear_engine_context * ctx, unsigned char * buf, int * len, int total_len, bool is_blocking)
+ *	\brief	receives bytes from the target core controller into a buffer, until the buffer holds a given number of bytes
+ *
+ *	the bytes are received directly into the buffer passed, by
+ *	as few system calls as possible; when blocking, the same timeout
+ *	as in must_be_only_called_from_yylex_wait_incoming_data() is
+ *	applied when waiting for data; when not blocking, only the data
+ *	already available is received
+ *
+ *	\param	ctx	context to work in
+ *	\param	buf	the buffer to receive the bytes in
+ *	\param	len	on entry - the number of bytes already in the buffer;
+ *			on exit - updated with the number of bytes received
+ *	\param	total_len	the number of bytes the buffer should hold
+ *	\param	is_blocking	if true, wait until the buffer holds total_len bytes
+ *	\return	true, if the buffer holds total_len bytes, false otherwise
+ */
+static bool read_frame_bytes(struct gear_engine_context * ctx, unsigned char * buf, int * len, int total_len, bool is_blocking)
+{
+struct core_connection_data * p;
+fd_set read_fds;
+int cc_fd;
+struct timeval timeout;
+int res;
+
+	p = ctx->core_comm;
+	cc_fd = p->read_core_fd;
+	while (* len < total_len)
 	{
-		/* first, create the socket */
-		fd = socket(AF_INET, SOCK_STREAM, 0);
-		if (fd == -1)
+		FD_ZERO(&read_fds);
+		FD_SET(cc_fd, &read_fds);
+		timeout.tv_sec = is_blocking ? CORE_CONTROLLER_READ_TIMEOUT_MS / 1000 : 0;
+		timeout.tv_usec = 0;
+		res = select(cc_fd + 1, &read_fds, 0, 0, &timeout);
+		p->io_stats.nr_select_calls ++;
+		if (res == -1)
 			panic("");
-		if (connect(fd, (const struct sockaddr *) &ctx->core_comm->core_inet_addr,
-					sizeof ctx->core_comm->core_inet_addr) == -1)
+		if (!FD_ISSET(cc_fd, &read_fds))
 		{
-			invoke_target_state_change_callback(ctx, TARGET_CORE_STATE_DEAD);
-			if (errmsg_hint)
-				* errmsg_hint = strdup("unable to connect to a target core controller");
-			return GEAR_ERR_TARGET_CORE_CONNECTION_FAILED;
+			if (is_blocking)
+				panic("");
+			return false;
 		}
-		p->write_core_fd = p->read_core_fd = fd;
 #ifdef __LINUX__
-		p->write_core_file = fdopen(fd, "w+");
-		if (!p->write_core_file)
-			panic("");
+		res = read(cc_fd, buf + * len, total_len - * len);
 #else
+		res = recv(cc_fd, buf + * len, total_len - * len, 0);
 #endif
-		p->is_core_controller_connected = 1;
-		gprintf("ok, established a connection to a target controller\n");
+		p->io_stats.nr_read_calls ++;
+		if (res == -1)
+			panic("");
+		if (!res)
+			/* connection dropped in the middle of a frame */
+			panic("");
+		* len += res;
 	}
-#ifdef __LINUX__
-	fprintf(p->write_core_file, "CORE_OPEN\n");
-	fflush(p->write_core_file);
-#else
-	sockprintf(p->write_core_fd, "CORE_OPEN\n");
-#endif
+	return true;
+}
 
-	init_lexer_state(ctx);
-	/* parse data record header */
-	/* read error status */
-	token = target_lex(p->lex_state.yyscanner);
-	if (p->lex_state.lex_err_code != GEAR_ERR_NO_ERROR)
-		panic("");
-	if (token != LEX_TOKEN_STATUS_CODE)
+/*!
+ *	\fn	static bool assemble_frame(struct gear_engine_context * ctx, bool is_blocking)
+ *	\brief	receives bytes of an incoming binary frame from the target core controller, until the frame is complete
+ *
+ *	this bypasses the lexical scanner buffering, and is only
+ *	to be used when the binary protocol is in effect; the frame
+ *	is assembled in the rx_buf field of struct core_connection_data;
+ *	when blocking, the same timeout as in
+ *	must_be_only_called_from_yylex_wait_incoming_data() is applied
+ *	when waiting for data; when not blocking, only the data
+ *	already available is received, and the assembly of the
+ *	frame is resumed on the next invocation
+ *
+ *	\param	ctx	context to work in
+ *	\param	is_blocking	if true, wait until the frame is complete
+ *	\return	true, if a whole frame has been assembled, false otherwise
+ */
+static bool assemble_frame(struct gear_engine_context * ctx, bool is_blocking)
+{
+struct core_connection_data * p;
+ARM_CORE_WORD len;
+
+	p = ctx->core_comm;
+	/* first, receive the header, then - the payload */
+	if (!read_frame_bytes(ctx, p->rx_buf, &p->rx_len, TARGET_COMM_FRAME_HEADER_SIZE, is_blocking))
+		return false;
+	len = get_frame_word(p->rx_buf + 4);
+	if (len > TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE)
 		panic("");
+	return read_frame_bytes(ctx, p->rx_buf, &p->rx_len, TARGET_COMM_FRAME_HEADER_SIZE + len, is_blocking);
+}
 
-	/* expect a comma */
-	token = target_lex(p->lex_state.yyscanner);
-	if (p->lex_state.lex_err_code != GEAR_ERR_NO_ERROR)
+/*!
+ *	\fn	static int accept_frame(struct gear_engine_context * ctx)
+ *	\brief	validates a binary reply frame assembled by assemble_frame(), and marks it as received
+ *
+ *	the reply must answer the oldest request frame not yet
+ *	replied to; this is verified by means of the frame
+ *	sequence ids; the frame contents are left intact in the
+ *	rx_buf field of struct core_connection_data, until another
+ *	frame is assembled there
+ *
+ *	\param	ctx	context to work in
+ *	\return	the length of the frame payload, in bytes
+ */
+static int accept_frame(struct gear_engine_context * ctx)
+{
+struct core_connection_data * p;
+unsigned short seq;
+int frame_type;
+
+	p = ctx->core_comm;
+	if (p->rx_frame_seq == p->tx_frame_seq)
+		/* no requests outstanding */
 		panic("");
-	if (token != ',')
+	frame_type = p->outstanding_frames[p->rx_frame_seq % MAX_OUTSTANDING_FRAMES].frame_type;
+	if (p->rx_buf[0] != frame_type)
 	{
-		gprintf("unexpected token: %c (%i)\n", token, token);
+		gprintf("unexpected frame type: %i, expected: %i\n", p->rx_buf[0], frame_type);
+		panic("");
+	}
+	seq = p->rx_buf[2] | (p->rx_buf[3] << 8);
+	if (seq != p->rx_frame_seq)
+	{
+		gprintf("unexpected frame sequence id: %i, expected: %i\n", seq, p->rx_frame_seq);
 		panic("");
 	}
+	p->rx_frame_seq ++;
+	p->rx_len = 0;
+	return get_frame_word(p->rx_buf + 4);
+}
 
-	err = p->lex_state.yylval.status_code;
+/*!
+ *	\fn	static void dispatch_async_frame(struct gear_engine_context * ctx)
+ *	\brief	passes a binary reply frame assembled by assemble_frame() to the completion routine of its asynchronous request
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+static void dispatch_async_frame(struct gear_engine_context * ctx)
+{
+struct core_connection_data * p;
+void (*completion)(struct gear_engine_context * ctx, void * cookie,
+		enum GEAR_ENGINE_ERR_ENUM status, const unsigned char * payload, int payload_len);
+void * cookie;
+int len;
 
-	token = target_lex(p->lex_state.yyscanner);
-	if (p->lex_state.lex_err_code != GEAR_ERR_NO_ERROR)
+	p = ctx->core_comm;
+	completion = p->outstanding_frames[p->rx_frame_seq % MAX_OUTSTANDING_FRAMES].completion;
+	cookie = p->outstanding_frames[p->rx_frame_seq % MAX_OUTSTANDING_FRAMES].cookie;
+	if (!completion)
+		/* the reply to a synchronous request must be received by the requester */
 		panic("");
+	len = accept_frame(ctx);
+	completion(ctx, cookie, p->rx_buf[1], p->rx_buf + TARGET_COMM_FRAME_HEADER_SIZE, len);
+}
 
-	if (err == GEAR_ERR_GENERIC_ERROR) switch (0)
-	{
-		default:
-			/* check for an optional 'ERRMSG_HINT' error message hint */
-			if (token != LEX_TOKEN_ERRMSG_HINT_KW)
-				break;
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM recv_frame(struct gear_engine_context * ctx, enum TARGET_COMM_FRAME_ENUM frame_type, void * payload, int max_payload_len, int * payload_len)
+ *	\brief	receives the binary reply frame to a synchronous request from the target core controller
+ *
+ *	the reply received must answer the oldest synchronous request
+ *	frame not yet replied to; any replies to asynchronous requests
+ *	sent before it are dispatched to their completion routines
+ *	while waiting for it
+ *
+ *	only the frame header is assembled in the rx_buf field of
+ *	struct core_connection_data - the payload is received directly
+ *	in the buffer passed, so that bulk data (e.g. target memory
+ *	contents) is not copied around
+ *
+ *	\param	ctx	context to work in
+ *	\param	frame_type	the expected type of the reply frame; this
+ *				must be the same as the type of the request frame
+ *				that the reply frame is answering
+ *	\param	payload	the buffer to store the frame payload in; may
+ *			be null if max_payload_len is zero
+ *	\param	max_payload_len	the size of the payload buffer, in bytes;
+ *				it is a fatal error if the frame payload
+ *				does not fit in the buffer
+ *	\param	payload_len	the length of the payload received is
+ *				stored here; may be null
+ *	\return	the status code carried in the reply frame
+ */
+static enum GEAR_ENGINE_ERR_ENUM recv_frame(struct gear_engine_context * ctx, enum TARGET_COMM_FRAME_ENUM frame_type, void * payload, int max_payload_len, int * payload_len)
+{
+struct core_connection_data * p;
+int len, nbytes_received;
+
+	p = ctx->core_comm;
+	/* the replies to requests are received strictly in
+	 * the order the requests have been sent, so it is
+	 * known in advance whether the next reply is for
+	 * an asynchronous request */
+	while (1)
+	{
+		if (p->rx_frame_seq == p->tx_frame_seq)
+			/* no requests outstanding */
+			panic("");
+		if (!p->outstanding_frames[p->rx_frame_seq % MAX_OUTSTANDING_FRAMES].completion)
+			break;
+		assemble_frame(ctx, true);
+		dispatch_async_frame(ctx);
+	}
+	if (p->outstanding_frames[p->rx_frame_seq % MAX_OUTSTANDING_FRAMES].frame_type != frame_type)
+		panic("");
+	read_frame_bytes(ctx, p->rx_buf, &p->rx_len, TARGET_COMM_FRAME_HEADER_SIZE, true);
+	len = get_frame_word(p->rx_buf + 4);
+	if (len > max_payload_len)
+		panic("");
+	/* some of the payload may already have been received in
+	 * rx_buf, when assembling frames without blocking (see
+	 * target_comm_process_input()) */
+	nbytes_received = p->rx_len - TARGET_COMM_FRAME_HEADER_SIZE;
+	if (nbytes_received > len)
+		panic("");
+	if (nbytes_received)
+	{
+		memcpy(payload, p->rx_buf + TARGET_COMM_FRAME_HEADER_SIZE, nbytes_received);
+		p->io_stats.nr_bytes_copied += nbytes_received;
+	}
+	read_frame_bytes(ctx, payload, &nbytes_received, len, true);
+	p->io_stats.nr_bytes_direct += len - (p->rx_len - TARGET_COMM_FRAME_HEADER_SIZE);
+	accept_frame(ctx);
+	if (payload_len)
+		* payload_len = len;
+	return p->rx_buf[1];
+}
+
+/*!
+ *	\fn	static int request_binary_protocol(struct gear_engine_context * ctx, int version)
+ *	\brief	requests the target core controller to switch to a given version of the binary framed protocol
+ *
+ *	\param	ctx	context to work in
+ *	\param	version	the binary protocol version requested
+ *	\return	the protocol version selected by the target core
+ *		controller - this is either the version requested, or
+ *		zero if the target core controller does not support the
+ *		version requested; -1 if the target core controller refuses
+ *		the binary protocol altogether
+ */
+static int request_binary_protocol(struct gear_engine_context * ctx, int version)
+{
+struct core_connection_data * p;
+enum LEX_TOKEN_TYPE_ENUM token;
+int selected_version;
+
+	p = ctx->core_comm;
+#ifdef __LINUX__
+	fprintf(p->write_core_file, "SET_PROTOCOL(%i)\n", version);
+	fflush(p->write_core_file);
+#else
+	sockprintf(p->write_core_fd, "SET_PROTOCOL(%i)\n", version);
+#endif
+
+	init_lexer_state(ctx);
+	token = target_lex(p->lex_state.yyscanner);
+	if (p->lex_state.lex_err_code != GEAR_ERR_NO_ERROR)
+		panic("");
+	if (token != LEX_TOKEN_STATUS_CODE)
+		panic("");
+	if (p->lex_state.yylval.status_code != GEAR_ERR_NO_ERROR)
+	{
+		sync_target_lexer(ctx);
+		selected_version = -1;
+	}
+	else
+	{
+		/* after the error code, a comma should follow,
+		 * followed by the protocol version selected */
+		token = target_lex(p->lex_state.yyscanner);
+		if (p->lex_state.lex_err_code != GEAR_ERR_NO_ERROR)
+			panic("");
+		if (token != ',')
+			panic("");
+		token = target_lex(p->lex_state.yyscanner);
+		if (p->lex_state.lex_err_code != GEAR_ERR_NO_ERROR)
+			panic("");
+		if (token != LEX_TOKEN_NUMBER)
+			panic("");
+		selected_version = p->lex_state.yylval.n;
+		/* make sure the input from the target controller
+		 * is exhausted */
+		token = target_lex(p->lex_state.yyscanner);
+		if (p->lex_state.lex_err_code != GEAR_ERR_NO_ERROR)
+			panic("");
+		if (token != LEX_TOKEN_NO_MORE_TOKENS)
+			panic("");
+		if (selected_version && selected_version != version)
+			panic("");
+	}
+	/* zero this out to help catch errors */
+	target_set_extra(0, p->lex_state.yyscanner);
+	return selected_version;
+}
+
+/*!
+ *	\fn	static void negotiate_payload_encodings(struct gear_engine_context * ctx)
+ *	\brief	agrees on the payload encodings to use for target memory transfers with the target core controller
+ *
+ *	the encodings offered are the ones requested in the gear
+ *	engine settings, that are also supported by target-comm-pack.c;
+ *	this must only be invoked right after the binary protocol
+ *	has been negotiated, and only if the protocol version
+ *	negotiated supports the packed frames
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+static void negotiate_payload_encodings(struct gear_engine_context * ctx)
+{
+struct core_connection_data * p;
+unsigned char reply[4];
+int len;
+
+	p = ctx->core_comm;
+	put_frame_word(p->frame_buf + TARGET_COMM_FRAME_HEADER_SIZE,
+			ctx->settings.target_payload_encodings & TARGET_COMM_PACK_ENCODINGS);
+	send_frame(ctx, TARGET_COMM_FRAME_SET_ENCODINGS, 4);
+	if (recv_frame(ctx, TARGET_COMM_FRAME_SET_ENCODINGS, reply, sizeof reply, &len) != GEAR_ERR_NO_ERROR
+			|| len != sizeof reply)
+	{
+		gprintf("target core controller refused the payload encodings, target memory is transferred unencoded\n");
+		return;
+	}
+	/* do not trust the target core controller to only
+	 * select among the encodings offered */
+	p->payload_encodings = get_frame_word(reply) & ctx->settings.target_payload_encodings & TARGET_COMM_PACK_ENCODINGS;
+	if (p->payload_encodings)
+		gprintf("using the payload encodings 0x%x for target memory transfers\n", p->payload_encodings);
+	else
+		gprintf("the target core controller supports none of the payload encodings requested, target memory is transferred unencoded\n");
+}
+
+/*!
+ *	\fn	static void negotiate_binary_protocol(struct gear_engine_context * ctx)
+ *	\brief	attempts to switch the target core controller connection to the binary framed protocol
+ *
+ *	the newest protocol version supported by both the gear engine
+ *	and the target core controller is selected; if the target
+ *	core controller does not agree on using the binary protocol,
+ *	the ascii protocol remains in effect; for details, see the
+ *	comments in file target-comm-frame.h
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+static void negotiate_binary_protocol(struct gear_engine_context * ctx)
+{
+struct core_connection_data * p;
+int version, selected_version;
+
+	p = ctx->core_comm;
+	/* try the newest protocol version first; older target
+	 * core controllers reply with a version of zero to the
+	 * versions they do not know about */
+	for (version = TARGET_COMM_BINARY_PROTOCOL_VERSION;
+			version >= TARGET_COMM_BINARY_PROTOCOL_MIN_VERSION; version --)
+	{
+		selected_version = request_binary_protocol(ctx, version);
+		if (selected_version == version)
+		{
+			p->is_binary_protocol_enabled = true;
+			p->binary_protocol_version = version;
+			p->tx_frame_seq = p->rx_frame_seq = 0;
+			break;
+		}
+		if (selected_version == -1)
+		{
+			gprintf("target core controller refused the binary protocol, staying with the ascii protocol\n");
+			return;
+		}
+	}
+	if (p->is_binary_protocol_enabled)
+	{
+		gprintf("using the binary protocol, version %i, for talking to the target core controller\n",
+				p->binary_protocol_version);
+		if (p->binary_protocol_version >= 4 && ctx->settings.target_payload_encodings)
+			negotiate_payload_encodings(ctx);
+	}
+	else
+		gprintf("using the ascii protocol for talking to the target core controller\n");
+}
+
+
+/*!
+ *	\fn	static bool is_connected(struct gear_engine_context * ctx)
+ *	\brief	determines if a connection to a target core controller is currently established
+ *
+ *	\param	ctx	context to work in
+ *	\return	true if a connection to a target core controller is currently established, false otherwise
+ */
+static bool is_connected(struct gear_engine_context * ctx)
+{
+struct core_connection_data * p;
+
+	p = ctx->core_comm;
+	return p->is_core_controller_connected ? true : false;
+}
+
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM core_open(struct gear_engine_context * ctx, const char ** errmsg_hint)
+ *	\brief	establishes a connection to a target core
+ *
+ *	\note	it is important to invoke the core_open()
+ *		routine to connect to a target core prior
+ *		to invoking any other target core related
+ *		routines
+ *
+ *	\param	ctx	context to work in
+ *	\param	errmsg_hint	in case of an error, it is possible that
+ *				an informative error message is available;
+ *				e.g. in the case a connection to a target
+ *				core controller was successfully established,
+ *				but there is an error communicating with
+ *				the target core (e.g. the target core is
+ *				not powered, there is no functional debug probe
+ *				connected to the target core, etc.), the
+ *				target core controller is allowed to return
+ *				an error message hint; this is purely an
+ *				informative message that is not in any way
+ *				processed by the gear engine, and it is
+ *				intended to be delivered verbatim to a gear
+ *				engine frontend in order to be presented
+ *				to a debugger user so that (s)he can
+ *				perform corrective actions; in case
+ *				an error message hint is available
+ *				(e.g. is provided a target core controller),
+ *				a ponter to it
+ *				is stored in this variable, and it is the
+ *				caller's responsibility to free() this
+ *				error message string when no longer
+ *				needed; in case this error message is
+ *				not needed, this parameter can be null
+ *	\return	for definitions of error codes, see the GEAR_ENGINE_ERR_ENUM
+ *		documentation; this routine returns one of:
+ *		- GEAR_ERR_NO_ERROR - if everything is fine and a 
+ *		connection to a target core was succesfully established
+ *		- GEAR_ERR_TARGET_CORE_CONNECTION_FAILED - if a connection
+ *		to a target core controller could not be established
+ *		- GEAR_ERR_GENERIC_ERROR - if a connection to a target
+ *		core controller was established, but there is an error
+ *		communicating with the target core (e.g. the target core is
+ *		not powered, there is no functional debug probe
+ *		connected to the target core, etc.); in this case, if
+ *		the 'errmsg_hint' parameter is not null and the
+ *		target core controller provided an error message hint,
+ *		the 'errmsg_hint' variable will be set to the error
+ *		message hint provided by the target core controller
+ *		and it is the caller's responsibility to free() this
+ *		error message hint when no longer needed
+ */
+static enum GEAR_ENGINE_ERR_ENUM core_open(struct gear_engine_context * ctx, const char ** errmsg_hint)
+{
+int fd, opt;
+struct core_connection_data * p;
+enum GEAR_ENGINE_ERR_ENUM err;
+enum LEX_TOKEN_TYPE_ENUM token;
+enum TARGET_CORE_STATE_ENUM state;
+
+	/* sanity checks */
+	p = ctx->core_comm;
+	if (!p)
+		panic("");
+	if (errmsg_hint)
+		* errmsg_hint = 0;
+	if (!p->is_core_controller_connected)
+	{
+		/* first, create the socket */
+		fd = socket(AF_INET, SOCK_STREAM, 0);
+		if (fd == -1)
+			panic("");
+		if (connect(fd, (const struct sockaddr *) &ctx->core_comm->core_inet_addr,
+					sizeof ctx->core_comm->core_inet_addr) == -1)
+		{
+			invoke_target_state_change_callback(ctx, TARGET_CORE_STATE_DEAD);
+			if (errmsg_hint)
+				* errmsg_hint = strdup("unable to connect to a target core controller");
+			return GEAR_ERR_TARGET_CORE_CONNECTION_FAILED;
+		}
+		/* bulk transfers are pipelined, so there is no point in
+		 * delaying small frames - e.g. status requests - to coalesce them;
+		 * failing to tune the socket is not fatal */
+		opt = 1;
+		if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (const char *) &opt, sizeof opt) == -1)
+			gprintf("warning: failed to disable the nagle algorithm on the target core controller connection\n");
+		opt = TARGET_COMM_SOCKET_BUFFER_SIZE;
+		if (setsockopt(fd, SOL_SOCKET, SO_SNDBUF, (const char *) &opt, sizeof opt) == -1
+				|| setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (const char *) &opt, sizeof opt) == -1)
+			gprintf("warning: failed to set the socket buffer sizes of the target core controller connection\n");
+		p->write_core_fd = p->read_core_fd = fd;
+		p->is_binary_protocol_enabled = false;
+		p->payload_encodings = 0;
+		p->is_status_request_pending = false;
+		p->rx_len = 0;
+#ifdef __LINUX__
+		p->write_core_file = fdopen(fd, "w+");
+		if (!p->write_core_file)
+			panic("");
+#else
+#endif
+		p->is_core_controller_connected = 1;
+		gprintf("ok, established a connection to a target controller\n");
+	}
+#ifdef __LINUX__
+	fprintf(p->write_core_file, "CORE_OPEN\n");
+	fflush(p->write_core_file);
+#else
+	sockprintf(p->write_core_fd, "CORE_OPEN\n");
+#endif
+
+	init_lexer_state(ctx);
+	/* parse data record header */
+	/* read error status */
+	token = target_lex(p->lex_state.yyscanner);
+	if (p->lex_state.lex_err_code != GEAR_ERR_NO_ERROR)
+		panic("");
+	if (token != LEX_TOKEN_STATUS_CODE)
+		panic("");
+
+	/* expect a comma */
+	token = target_lex(p->lex_state.yyscanner);
+	if (p->lex_state.lex_err_code != GEAR_ERR_NO_ERROR)
+		panic("");
+	if (token != ',')
+	{
+		gprintf("unexpected token: %c (%i)\n", token, token);
+		panic("");
+	}
+
+	err = p->lex_state.yylval.status_code;
+
+	token = target_lex(p->lex_state.yyscanner);
+	if (p->lex_state.lex_err_code != GEAR_ERR_NO_ERROR)
+		panic("");
+
+	if (err == GEAR_ERR_GENERIC_ERROR) switch (0)
+	{
+		default:
+			/* check for an optional 'ERRMSG_HINT' error message hint */
+			if (token != LEX_TOKEN_ERRMSG_HINT_KW)
+				break;
 
 			token = target_lex(p->lex_state.yyscanner);
 			if (p->lex_state.lex_err_code != GEAR_ERR_NO_ERROR)
@@ -692,11 +1555,19 @@ enum LEX_TOKEN_TYPE_ENUM token;
 		panic("");
 	if (token != LEX_TOKEN_NO_MORE_TOKENS)
 		panic("");
-	/* propagate any eventual target state change
-	 * to interested parties */
-	invoke_target_state_change_callback(ctx, p->lex_state.yylval.state);
+	state = p->lex_state.yylval.state;
 	/* zero this out to help catch errors */
 	target_set_extra(0, p->lex_state.yyscanner);
+	/* switch to the binary protocol, if requested; this
+	 * must be done before notifying interested parties
+	 * about the target state, as they may immediately
+	 * start accessing the target */
+	if (err == GEAR_ERR_NO_ERROR && ctx->settings.is_binary_target_protocol_enabled
+			&& !p->is_binary_protocol_enabled)
+		negotiate_binary_protocol(ctx);
+	/* propagate any eventual target state change
+	 * to interested parties */
+	invoke_target_state_change_callback(ctx, state);
 	return err;
 }
 
@@ -758,7 +1629,7 @@ int res;
 /*! \todo	document this */
 /*! \todo	document the expected incoming data records format, as well
  *		as the generated data request records format */
-static enum GEAR_ENGINE_ERR_ENUM core_mem_read(struct gear_engine_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes)
+static enum GEAR_ENGINE_ERR_ENUM ascii_mem_read(struct gear_engine_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes)
 {
 struct core_connection_data * p;
 int bytes_remaining;
@@ -853,7 +1724,7 @@ enum GEAR_ENGINE_ERR_ENUM result;
 /*! \todo	document this */
 /*! \todo	document the expected incoming data records format, as well
  *		as the generated data request records format */
-static enum GEAR_ENGINE_ERR_ENUM core_mem_write(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes)
+static enum GEAR_ENGINE_ERR_ENUM ascii_mem_write(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes)
 {
 struct core_connection_data * p;
 int bytes_remaining;
@@ -898,36 +1769,534 @@ enum LEX_TOKEN_TYPE_ENUM token;
 		i = bytes_this_run;
 		while (i--)
 		{
-			sockprintf(p->write_core_fd, "0x%02x ", (int)*(unsigned char *)source);
-			source = (void *)((int) source + 1);
+			sockprintf(p->write_core_fd, "0x%02x ", (int)*(unsigned char *)source);
+			source = (void *)((int) source + 1);
+		}
+		sockprintf(p->write_core_fd, ")\n");
+#endif
+
+		init_lexer_state(ctx);
+		/* parse data record header */
+		/* read error status */
+		token = target_lex(p->lex_state.yyscanner);
+		if (p->lex_state.lex_err_code != GEAR_ERR_NO_ERROR)
+			panic("");
+		if (token != LEX_TOKEN_STATUS_CODE)
+			panic("");
+		if (p->lex_state.yylval.status_code != GEAR_ERR_NO_ERROR)
+			panic("");
+		/* make sure the input from the target controller
+		 * is exhausted */
+		token = target_lex(p->lex_state.yyscanner);
+		if (p->lex_state.lex_err_code != GEAR_ERR_NO_ERROR)
+			panic("");
+		if (token != LEX_TOKEN_NO_MORE_TOKENS)
+			panic("");
+		*nbytes += bytes_this_run;
+		addr += bytes_this_run;
+		bytes_remaining -= bytes_this_run;
+	}
+
+	/* zero this out to help catch errors */
+	target_set_extra(0, p->lex_state.yyscanner);
+	return GEAR_ERR_NO_ERROR;
+}
+
+/*!
+ *	\fn	static enum TARGET_COMM_FRAME_ENUM put_mem_read_request(struct gear_engine_context * ctx, ARM_CORE_WORD addr, int nbytes, int * payload_len)
+ *	\brief	stores the payload of a target memory chunk read request in the frame buffer
+ *
+ *	if payload encodings have been agreed upon with the target
+ *	core controller, a packed request is made, otherwise - a plain one
+ *
+ *	\param	ctx	context to work in
+ *	\param	addr	the target memory address of the chunk
+ *	\param	nbytes	the number of bytes in the chunk
+ *	\param	payload_len	the length of the request payload is stored here
+ *	\return	the type of the request frame to send
+ */
+static enum TARGET_COMM_FRAME_ENUM put_mem_read_request(struct gear_engine_context * ctx, ARM_CORE_WORD addr, int nbytes, int * payload_len)
+{
+struct core_connection_data * p;
+unsigned char * payload;
+
+	p = ctx->core_comm;
+	payload = p->frame_buf + TARGET_COMM_FRAME_HEADER_SIZE;
+	put_frame_word(payload, addr);
+	put_frame_word(payload + 4, nbytes);
+	if (!p->payload_encodings)
+	{
+		* payload_len = 8;
+		return TARGET_COMM_FRAME_MEM_READ;
+	}
+	put_frame_word(payload + 8, p->payload_encodings);
+	* payload_len = 12;
+	return TARGET_COMM_FRAME_MEM_READ_PACKED;
+}
+
+/*!
+ *	\fn	static void unpack_mem_read_reply(struct gear_engine_context * ctx, unsigned char * dest, int nbytes, const unsigned char * payload, int payload_len)
+ *	\brief	decodes the payload of a successful reply to a packed target memory chunk read request
+ *
+ *	it is a fatal error if the payload is malformed
+ *
+ *	\param	ctx	context to work in
+ *	\param	dest	the buffer to store the decoded bytes in
+ *	\param	nbytes	the number of bytes in the chunk
+ *	\param	payload	the reply frame payload - the encoding, followed by the encoded chunk
+ *	\param	payload_len	the length of the reply frame payload
+ *	\return	none
+ */
+static void unpack_mem_read_reply(struct gear_engine_context * ctx, unsigned char * dest, int nbytes, const unsigned char * payload, int payload_len)
+{
+struct core_connection_data * p;
+ARM_CORE_WORD encoding;
+
+	p = ctx->core_comm;
+	if (payload_len < 4)
+		panic("");
+	encoding = get_frame_word(payload);
+	if (encoding >= TARGET_COMM_NR_ENCODINGS
+			|| (encoding != TARGET_COMM_ENCODING_RAW && !(p->payload_encodings & (1 << encoding))))
+		panic("");
+	if (target_comm_unpack(encoding, dest, nbytes, payload + 4, payload_len - 4))
+	{
+		gprintf("malformed target memory read reply, encoding %i\n", encoding);
+		panic("");
+	}
+	p->io_stats.nr_bytes_packed += payload_len - 4;
+	p->io_stats.nr_bytes_unpacked += nbytes;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM frame_mem_read(struct gear_engine_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes)
+ *	\brief	reads target memory, by using the binary protocol
+ *
+ *	the parameters and return value are the same as for
+ *	core_mem_read(); for the format of the frames exchanged, see
+ *	the comments in file target-comm-frame.h
+ *
+ *	the transfer is still broken into chunks, as described in the
+ *	comments about the lex_state field of struct core_connection_data,
+ *	and the chunks are still completed (and accounted for in *nbytes)
+ *	one at a time, in ascending address order; however, up to
+ *	xfer_window (a field in struct core_connection_data) chunk
+ *	requests are sent ahead, without waiting for the replies to
+ *	the previous ones, so that the link round trip latency is
+ *	paid once per transfer, instead of once per chunk
+ *
+ *	if a chunk read fails, no more requests are sent, the replies
+ *	to the requests already outstanding are received and discarded,
+ *	and the status code of the first failed chunk is returned
+ *
+ *	if payload encodings are in effect, the replies are received
+ *	in an intermediate buffer, and decoded to the destination buffer
+ */
+static enum GEAR_ENGINE_ERR_ENUM frame_mem_read(struct gear_engine_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes)
+{
+struct core_connection_data * p;
+int bytes_to_request;
+int bytes_to_receive;
+int bytes_this_run;
+int nr_outstanding;
+int len;
+unsigned char * payload;
+enum GEAR_ENGINE_ERR_ENUM result, err;
+enum TARGET_COMM_FRAME_ENUM frame_type;
+
+	p = ctx->core_comm;
+	payload = p->frame_buf + TARGET_COMM_FRAME_HEADER_SIZE;
+	bytes_to_request = bytes_to_receive = *nbytes;
+	*nbytes = 0;
+	nr_outstanding = 0;
+
+	result = GEAR_ERR_NO_ERROR;
+	while (bytes_to_receive)
+	{
+		/* fill the request window */
+		while (result == GEAR_ERR_NO_ERROR && bytes_to_request
+				&& nr_outstanding < p->xfer_window)
+		{
+			bytes_this_run = (bytes_to_request > MEM_XFER_FRAME_CHUNK_SIZE) ?
+				MEM_XFER_FRAME_CHUNK_SIZE : bytes_to_request;
+			frame_type = put_mem_read_request(ctx, source, bytes_this_run, &len);
+			send_frame(ctx, frame_type, len);
+			source += bytes_this_run;
+			bytes_to_request -= bytes_this_run;
+			nr_outstanding ++;
+		}
+		if (!nr_outstanding)
+			break;
+		/* receive the reply to the oldest chunk request outstanding */
+		bytes_this_run = (bytes_to_receive > MEM_XFER_FRAME_CHUNK_SIZE) ?
+			MEM_XFER_FRAME_CHUNK_SIZE : bytes_to_receive;
+		if (result != GEAR_ERR_NO_ERROR)
+		{
+			/* a previous chunk failed - drain the reply; the
+			 * frame buffer is not needed for sending anymore,
+			 * so use it as a scratch buffer */
+			recv_frame(ctx, frame_type, payload,
+					TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE, 0);
+		}
+		else if ((err = p->payload_encodings ?
+					recv_frame(ctx, TARGET_COMM_FRAME_MEM_READ_PACKED, p->packed_buf,
+						TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE, &len)
+					/* the data bytes are stored directly in the destination buffer */
+					: recv_frame(ctx, TARGET_COMM_FRAME_MEM_READ, dest,
+						bytes_this_run, &len)) != GEAR_ERR_NO_ERROR)
+			result = err;
+		else
+		{
+			if (p->payload_encodings)
+				unpack_mem_read_reply(ctx, dest, bytes_this_run, p->packed_buf, len);
+			else if (len != bytes_this_run)
+				panic("");
+			/* a chunk has been completed */
+			dest = (unsigned char *) dest + bytes_this_run;
+			*nbytes += bytes_this_run;
+		}
+		bytes_to_receive -= bytes_this_run;
+		nr_outstanding --;
+	}
+	if (nr_outstanding)
+		panic("");
+	return result;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM frame_mem_write(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes)
+ *	\brief	writes target memory, by using the binary protocol
+ *
+ *	the parameters and return value are the same as for
+ *	core_mem_write(); for the format of the frames exchanged, see
+ *	the comments in file target-comm-frame.h
+ *
+ *	just like in frame_mem_read(), up to xfer_window chunk
+ *	write requests are kept outstanding, and the chunks are
+ *	completed one at a time, in ascending address order
+ *
+ *	if payload encodings are in effect, each chunk is encoded
+ *	in the frame buffer; chunks that do not shrink when encoded
+ *	are sent unencoded, directly from the source buffer
+ */
+static enum GEAR_ENGINE_ERR_ENUM frame_mem_write(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes)
+{
+struct core_connection_data * p;
+int bytes_to_request;
+int bytes_to_receive;
+int bytes_this_run;
+int nr_outstanding;
+int len;
+unsigned char * payload;
+enum TARGET_COMM_FRAME_ENUM frame_type;
+enum TARGET_COMM_ENCODING_ENUM encoding;
+
+	p = ctx->core_comm;
+	payload = p->frame_buf + TARGET_COMM_FRAME_HEADER_SIZE;
+	frame_type = p->payload_encodings ? TARGET_COMM_FRAME_MEM_WRITE_PACKED : TARGET_COMM_FRAME_MEM_WRITE;
+	bytes_to_request = bytes_to_receive = *nbytes;
+	*nbytes = 0;
+	nr_outstanding = 0;
+
+	while (bytes_to_receive)
+	{
+		/* fill the request window */
+		while (bytes_to_request && nr_outstanding < p->xfer_window)
+		{
+			bytes_this_run = (bytes_to_request > MEM_XFER_FRAME_CHUNK_SIZE) ?
+				MEM_XFER_FRAME_CHUNK_SIZE : bytes_to_request;
+			put_frame_word(payload, dest);
+			if (!p->payload_encodings)
+				/* the data bytes are sent directly from the source buffer */
+				send_frame_data(ctx, TARGET_COMM_FRAME_MEM_WRITE, 4, source, bytes_this_run);
+			else
+			{
+				put_frame_word(payload + 8, bytes_this_run);
+				if ((len = target_comm_pack(p->payload_encodings, payload + 12, bytes_this_run,
+								source, bytes_this_run, &encoding)) != -1)
+				{
+					put_frame_word(payload + 4, encoding);
+					send_frame(ctx, TARGET_COMM_FRAME_MEM_WRITE_PACKED, 12 + len);
+				}
+				else
+				{
+					len = bytes_this_run;
+					put_frame_word(payload + 4, TARGET_COMM_ENCODING_RAW);
+					send_frame_data(ctx, TARGET_COMM_FRAME_MEM_WRITE_PACKED, 12, source, bytes_this_run);
+				}
+				p->io_stats.nr_bytes_packed += len;
+				p->io_stats.nr_bytes_unpacked += bytes_this_run;
+			}
+			source = (const unsigned char *) source + bytes_this_run;
+			dest += bytes_this_run;
+			bytes_to_request -= bytes_this_run;
+			nr_outstanding ++;
+		}
+		/* receive the acknowledgement for the oldest chunk request outstanding */
+		if (recv_frame(ctx, frame_type, 0, 0, 0) != GEAR_ERR_NO_ERROR)
+			panic("");
+		/* a chunk has been completed */
+		bytes_this_run = (bytes_to_receive > MEM_XFER_FRAME_CHUNK_SIZE) ?
+			MEM_XFER_FRAME_CHUNK_SIZE : bytes_to_receive;
+		*nbytes += bytes_this_run;
+		bytes_to_receive -= bytes_this_run;
+		nr_outstanding --;
+	}
+	return GEAR_ERR_NO_ERROR;
+}
+
+/*!
+ *	\fn	static void account_mem_xfer(struct gear_engine_context * ctx, struct timeval * start, unsigned nbytes_read, unsigned nbytes_written)
+ *	\brief	updates the target memory transfer statistics for the protocol currently in effect
+ *
+ *	\param	ctx	context to work in
+ *	\param	start	the time at which the transfer was started
+ *	\param	nbytes_read	the number of target memory bytes read
+ *	\param	nbytes_written	the number of target memory bytes written
+ *	\return	none
+ */
+static void account_mem_xfer(struct gear_engine_context * ctx, struct timeval * start, unsigned nbytes_read, unsigned nbytes_written)
+{
+struct core_connection_data * p;
+struct timeval tv;
+int i;
+
+	p = ctx->core_comm;
+	if (gettimeofday(&tv, 0) < 0)
+		panic("");
+	i = p->is_binary_protocol_enabled ? TARGET_COMM_PROTOCOL_BINARY : TARGET_COMM_PROTOCOL_ASCII;
+	p->xfer_stats[i].nr_requests ++;
+	p->xfer_stats[i].nr_bytes_read += nbytes_read;
+	p->xfer_stats[i].nr_bytes_written += nbytes_written;
+	p->xfer_stats[i].nr_usecs += (tv.tv_sec - start->tv_sec) * 1000000LL
+		+ (tv.tv_usec - start->tv_usec);
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM core_mem_read(struct gear_engine_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes)
+ *	\brief	reads target memory, by using the protocol currently in effect
+ *
+ *	\param	ctx	context to work in
+ *	\param	dest	the buffer to store the bytes read in
+ *	\param	source	the target memory address to read from
+ *	\param	nbytes	on entry - the number of bytes to read; on
+ *			exit - the number of bytes actually read
+ *	\return	the status code of the memory read
+ */
+static enum GEAR_ENGINE_ERR_ENUM core_mem_read(struct gear_engine_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes)
+{
+struct timeval start;
+enum GEAR_ENGINE_ERR_ENUM result;
+
+	/* sanity checks */
+	if (!ctx || !dest || !nbytes || !*nbytes || !ctx->core_comm)
+		panic("");
+	if (!ctx->core_comm->is_core_controller_connected)
+		return GEAR_ERR_TARGET_CORE_DEAD;
+	if (gettimeofday(&start, 0) < 0)
+		panic("");
+	if (ctx->core_comm->is_binary_protocol_enabled)
+		result = frame_mem_read(ctx, dest, source, nbytes);
+	else
+		result = ascii_mem_read(ctx, dest, source, nbytes);
+	account_mem_xfer(ctx, &start, *nbytes, 0);
+	return result;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM core_mem_write(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes)
+ *	\brief	writes target memory, by using the protocol currently in effect
+ *
+ *	\param	ctx	context to work in
+ *	\param	dest	the target memory address to write to
+ *	\param	source	the buffer holding the bytes to write
+ *	\param	nbytes	on entry - the number of bytes to write; on
+ *			exit - the number of bytes actually written
+ *	\return	the status code of the memory write
+ */
+static enum GEAR_ENGINE_ERR_ENUM core_mem_write(struct gear_engine_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes)
+{
+struct timeval start;
+enum GEAR_ENGINE_ERR_ENUM result;
+
+	/* sanity checks */
+	if (!ctx || !source || !nbytes || !*nbytes || !ctx->core_comm)
+		panic("");
+	if (!ctx->core_comm->is_core_controller_connected)
+		return GEAR_ERR_TARGET_CORE_DEAD;
+	if (gettimeofday(&start, 0) < 0)
+		panic("");
+	if (ctx->core_comm->is_binary_protocol_enabled)
+		result = frame_mem_write(ctx, dest, source, nbytes);
+	else
+		result = ascii_mem_write(ctx, dest, source, nbytes);
+	account_mem_xfer(ctx, &start, 0, *nbytes);
+	return result;
+}
+
+/*!
+ *	\fn	static void service_xfer(struct gear_engine_context * ctx, struct target_comm_xfer * xfer)
+ *	\brief	advances an asynchronous target memory transfer
+ *
+ *	chunk requests are sent, until the request window of the
+ *	transfer is full; if the transfer has completed (because
+ *	all chunks have been read, some chunk has failed, or the transfer
+ *	has been cancelled), and there are no chunk requests outstanding,
+ *	the transfer is moved to the queue of completed transfers - its
+ *	callback is invoked later, by target_comm_dispatch_completed_xfers()
+ *
+ *	\param	ctx	context to work in
+ *	\param	xfer	the transfer to advance
+ *	\return	none
+ */
+static void service_xfer(struct gear_engine_context * ctx, struct target_comm_xfer * xfer);
+
+/*!
+ *	\fn	static void xfer_chunk_completion(struct gear_engine_context * ctx, void * cookie, enum GEAR_ENGINE_ERR_ENUM status, const unsigned char * payload, int payload_len)
+ *	\brief	completion routine for the chunk requests of asynchronous target memory transfers
+ *
+ *	just like in frame_mem_read(), chunks complete one at a time,
+ *	in ascending address order
+ *
+ *	\param	ctx	context to work in
+ *	\param	cookie	the transfer that the chunk belongs to
+ *	\param	status	the status code carried in the reply frame
+ *	\param	payload	the reply frame payload - the chunk data bytes, encoded
+ *			if payload encodings are in effect
+ *	\param	payload_len	the length of the reply frame payload
+ *	\return	none
+ */
+static void xfer_chunk_completion(struct gear_engine_context * ctx, void * cookie, enum GEAR_ENGINE_ERR_ENUM status, const unsigned char * payload, int payload_len)
+{
+struct target_comm_xfer * xfer;
+unsigned len;
+
+	xfer = cookie;
+	len = (xfer->bytes_to_receive > MEM_XFER_FRAME_CHUNK_SIZE) ?
+		MEM_XFER_FRAME_CHUNK_SIZE : xfer->bytes_to_receive;
+	xfer->bytes_to_receive -= len;
+	xfer->nr_outstanding --;
+	if (xfer->result == GEAR_ERR_NO_ERROR && !xfer->is_cancelled)
+	{
+		if (status != GEAR_ERR_NO_ERROR)
+			xfer->result = status;
+		else
+		{
+			if (ctx->core_comm->payload_encodings)
+				unpack_mem_read_reply(ctx, xfer->dest + xfer->nbytes, len, payload, payload_len);
+			else
+			{
+				if (payload_len != len)
+					panic("");
+				memcpy(xfer->dest + xfer->nbytes, payload, len);
+				ctx->core_comm->io_stats.nr_bytes_copied += len;
+			}
+			xfer->nbytes += len;
+		}
+	}
+	service_xfer(ctx, xfer);
+}
+
+static void service_xfer(struct gear_engine_context * ctx, struct target_comm_xfer * xfer)
+{
+struct core_connection_data * p;
+struct target_comm_xfer ** link;
+unsigned len;
+int payload_len;
+enum TARGET_COMM_FRAME_ENUM frame_type;
+
+	p = ctx->core_comm;
+	/* fill the request window */
+	while (xfer->result == GEAR_ERR_NO_ERROR && !xfer->is_cancelled
+			&& xfer->bytes_to_request && xfer->nr_outstanding < p->xfer_window)
+	{
+		len = (xfer->bytes_to_request > MEM_XFER_FRAME_CHUNK_SIZE) ?
+			MEM_XFER_FRAME_CHUNK_SIZE : xfer->bytes_to_request;
+		frame_type = put_mem_read_request(ctx, xfer->addr, len, &payload_len);
+		send_async_frame(ctx, frame_type, payload_len, xfer_chunk_completion, xfer);
+		xfer->addr += len;
+		xfer->bytes_to_request -= len;
+		xfer->bytes_to_receive += len;
+		xfer->nr_outstanding ++;
+	}
+	if (xfer->nr_outstanding)
+		return;
+	/* the transfer is complete - unlink it, and append
+	 * it to the queue of completed transfers */
+	for (link = &p->xfers; * link != xfer; link = &(* link)->next)
+		if (!* link)
+			panic("");
+	* link = xfer->next;
+	account_mem_xfer(ctx, &xfer->start, xfer->nbytes, 0);
+	for (link = &p->completed_xfers; * link; link = &(* link)->next)
+		;
+	xfer->next = 0;
+	* link = xfer;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM frame_reg_read(struct gear_engine_context * ctx, unsigned long mask, ARM_CORE_WORD buffer[])
+ *	\brief	reads target core registers, by using the binary protocol
+ *
+ *	\param	ctx	context to work in
+ *	\param	mask	the bitmap of the registers to read
+ *	\param	buffer	the register values are stored here, one for each bit set in mask
+ *	\return	the status code of the register read
+ */
+static enum GEAR_ENGINE_ERR_ENUM frame_reg_read(struct gear_engine_context * ctx, unsigned long mask, ARM_CORE_WORD buffer[])
+{
+struct core_connection_data * p;
+unsigned char * payload;
+enum GEAR_ENGINE_ERR_ENUM err;
+int i, len;
+
+	p = ctx->core_comm;
+	payload = p->frame_buf + TARGET_COMM_FRAME_HEADER_SIZE;
+	put_frame_word(payload, mask);
+	send_frame(ctx, TARGET_COMM_FRAME_REGS_READ, 4);
+	if ((err = recv_frame(ctx, TARGET_COMM_FRAME_REGS_READ, payload,
+					TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE, &len)) != GEAR_ERR_NO_ERROR)
+		return err;
+	for (i = 0; mask; mask >>= 1)
+		if (mask & 1)
+		{
+			if ((i + 1) * 4 > len)
+				panic("");
+			buffer[i] = get_frame_word(payload + i * 4);
+			i ++;
+		}
+	if (i * 4 != len)
+		panic("");
+	return GEAR_ERR_NO_ERROR;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM frame_reg_write(struct gear_engine_context * ctx, unsigned long mask, ARM_CORE_WORD buffer[])
+ *	\brief	writes target core registers, by using the binary protocol
+ *
+ *	\param	ctx	context to work in
+ *	\param	mask	the bitmap of the registers to write
+ *	\param	buffer	the register values to write, one for each bit set in mask
+ *	\return	the status code of the register write
+ */
+static enum GEAR_ENGINE_ERR_ENUM frame_reg_write(struct gear_engine_context * ctx, unsigned long mask, ARM_CORE_WORD buffer[])
+{
+struct core_connection_data * p;
+unsigned char * payload;
+int i;
+
+	p = ctx->core_comm;
+	payload = p->frame_buf + TARGET_COMM_FRAME_HEADER_SIZE;
+	put_frame_word(payload, mask);
+	for (i = 0; mask; mask >>= 1)
+		if (mask & 1)
+		{
+			put_frame_word(payload + 4 + i * 4, buffer[i]);
+			i ++;
 		}
-		sockprintf(p->write_core_fd, ")\n");
-#endif
-
-		init_lexer_state(ctx);
-		/* parse data record header */
-		/* read error status */
-		token = target_lex(p->lex_state.yyscanner);
-		if (p->lex_state.lex_err_code != GEAR_ERR_NO_ERROR)
-			panic("");
-		if (token != LEX_TOKEN_STATUS_CODE)
-			panic("");
-		if (p->lex_state.yylval.status_code != GEAR_ERR_NO_ERROR)
-			panic("");
-		/* make sure the input from the target controller
-		 * is exhausted */
-		token = target_lex(p->lex_state.yyscanner);
-		if (p->lex_state.lex_err_code != GEAR_ERR_NO_ERROR)
-			panic("");
-		if (token != LEX_TOKEN_NO_MORE_TOKENS)
-			panic("");
-		*nbytes += bytes_this_run;
-		addr += bytes_this_run;
-		bytes_remaining -= bytes_this_run;
-	}
-
-	/* zero this out to help catch errors */
-	target_set_extra(0, p->lex_state.yyscanner);
+	send_frame(ctx, TARGET_COMM_FRAME_REGS_WRITE, 4 + i * 4);
+	if (recv_frame(ctx, TARGET_COMM_FRAME_REGS_WRITE, 0, 0, 0) != GEAR_ERR_NO_ERROR)
+		panic("");
 	return GEAR_ERR_NO_ERROR;
 }
 
@@ -949,6 +2318,8 @@ enum LEX_TOKEN_TYPE_ENUM token;
 	p = ctx->core_comm;
 	if (!p->is_core_controller_connected)
 		return GEAR_ERR_TARGET_CORE_DEAD;
+	if (p->is_binary_protocol_enabled)
+		return frame_reg_read(ctx, mask, buffer);
 
 	/* issue a register read request */
 #ifdef __LINUX__
@@ -1021,6 +2392,8 @@ enum LEX_TOKEN_TYPE_ENUM token;
 	p = ctx->core_comm;
 	if (!p->is_core_controller_connected)
 		return GEAR_ERR_TARGET_CORE_DEAD;
+	if (p->is_binary_protocol_enabled)
+		return frame_reg_write(ctx, mask, buffer);
 
 	/* issue a register read request */
 #ifdef __LINUX__
@@ -1062,6 +2435,48 @@ enum LEX_TOKEN_TYPE_ENUM token;
 
 }
 
+/*!
+ *	\fn	static void status_request_completion(struct gear_engine_context * ctx, void * cookie, enum GEAR_ENGINE_ERR_ENUM status, const unsigned char * payload, int payload_len)
+ *	\brief	completion routine for the asynchronous binary target core state requests
+ *
+ *	the target state received is propagated to the target
+ *	state change callbacks
+ *
+ *	\param	ctx	context to work in
+ *	\param	cookie	unused
+ *	\param	status	the status code carried in the reply frame
+ *	\param	payload	the reply frame payload - the target state
+ *	\param	payload_len	the length of the reply frame payload
+ *	\return	none
+ */
+static void status_request_completion(struct gear_engine_context * ctx, void * cookie, enum GEAR_ENGINE_ERR_ENUM status, const unsigned char * payload, int payload_len)
+{
+struct core_connection_data * p;
+
+	p = ctx->core_comm;
+	if (status != GEAR_ERR_NO_ERROR || payload_len != 1)
+		panic("");
+	/* this must be cleared before invoking the callbacks,
+	 * as they are allowed to issue further target state requests */
+	p->is_status_request_pending = false;
+	p->last_reported_state = payload[0];
+	invoke_target_state_change_callback(ctx, p->last_reported_state);
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM core_get_status(struct gear_engine_context * ctx, enum TARGET_CORE_STATE_ENUM * status)
+ *	\brief	retrieves the target core state
+ *
+ *	if a target core state request is not already outstanding
+ *	(see target_comm_issue_core_status_request()), one is issued;
+ *	this routine then blocks until the reply arrives, and the
+ *	target state change callbacks are invoked
+ *
+ *	\param	ctx	context to work in
+ *	\param	status	the target core state is stored here
+ *	\return	GEAR_ERR_NO_ERROR on success, GEAR_ERR_TARGET_CORE_DEAD if
+ *		not connected to a target core controller
+ */
 static enum GEAR_ENGINE_ERR_ENUM core_get_status(struct gear_engine_context * ctx, enum TARGET_CORE_STATE_ENUM * status)
 {
 enum LEX_TOKEN_TYPE_ENUM token;
@@ -1070,6 +2485,21 @@ struct core_connection_data * p;
 	p = ctx->core_comm;
 	if (!p->is_core_controller_connected)
 		return GEAR_ERR_TARGET_CORE_DEAD;
+	if (!p->is_status_request_pending)
+		target_comm_issue_core_status_request(ctx);
+	if (p->is_binary_protocol_enabled)
+	{
+		/* the reply is processed by status_request_completion();
+		 * the replies to any other asynchronous requests sent
+		 * before the target state request are dispatched as well */
+		while (p->is_status_request_pending)
+		{
+			assemble_frame(ctx, true);
+			dispatch_async_frame(ctx);
+		}
+		*status = p->last_reported_state;
+		return GEAR_ERR_NO_ERROR;
+	}
 
 	init_lexer_state(ctx);
 
@@ -1103,6 +2533,10 @@ struct core_connection_data * p;
 		panic("");
 	if (token != LEX_TOKEN_NO_MORE_TOKENS)
 		panic("");
+	/* this must be cleared before invoking the callbacks,
+	 * as they are allowed to issue further target state requests */
+	p->is_status_request_pending = false;
+	p->last_reported_state = p->lex_state.yylval.state;
 	/* propagate any eventual target state change
 	 * to interested parties */
 	invoke_target_state_change_callback(ctx, p->lex_state.yylval.state);
@@ -1112,6 +2546,248 @@ struct core_connection_data * p;
 	return GEAR_ERR_NO_ERROR;
 }
 
+/*!
+ *	\fn	static void resolve_snapshot_window_addresses(struct core_halt_snapshot * snapshot)
+ *	\brief	computes the target addresses of the memory windows of a halt snapshot
+ *
+ *	the register values of the snapshot must already be retrieved
+ *
+ *	\param	snapshot	the halt snapshot to work on
+ *	\return	none
+ */
+static void resolve_snapshot_window_addresses(struct core_halt_snapshot * snapshot)
+{
+struct core_mem_window * w;
+int i, j, reg_idx;
+
+	for (i = 0; i < snapshot->nr_mem_windows; i++)
+	{
+		w = snapshot->mem_windows + i;
+		if (w->base_reg_nr == CORE_MEM_WINDOW_ABSOLUTE)
+		{
+			w->addr = w->offset;
+			continue;
+		}
+		if (!(snapshot->reg_mask & (1 << w->base_reg_nr)))
+			panic("");
+		/* locate the base register value in the register values retrieved */
+		for (j = reg_idx = 0; j < w->base_reg_nr; j++)
+			if (snapshot->reg_mask & (1 << j))
+				reg_idx ++;
+		w->addr = snapshot->regs[reg_idx] + w->offset;
+	}
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM frame_get_halt_snapshot(struct gear_engine_context * ctx, struct core_halt_snapshot * snapshot)
+ *	\brief	retrieves a halt snapshot by a single binary request
+ *
+ *	\param	ctx	context to work in
+ *	\param	snapshot	the halt snapshot to retrieve
+ *	\return	the status code of the request
+ */
+static enum GEAR_ENGINE_ERR_ENUM frame_get_halt_snapshot(struct gear_engine_context * ctx, struct core_halt_snapshot * snapshot)
+{
+struct core_connection_data * p;
+unsigned char * payload;
+enum GEAR_ENGINE_ERR_ENUM err;
+struct core_mem_window * w;
+unsigned long mask;
+unsigned nbytes;
+int i, len, pos;
+
+	p = ctx->core_comm;
+	payload = p->frame_buf + TARGET_COMM_FRAME_HEADER_SIZE;
+	put_frame_word(payload, snapshot->reg_mask);
+	put_frame_word(payload + 4, snapshot->nr_mem_windows);
+	for (i = 0; i < snapshot->nr_mem_windows; i++)
+	{
+		w = snapshot->mem_windows + i;
+		put_frame_word(payload + 8 + 12 * i,
+				(w->base_reg_nr == CORE_MEM_WINDOW_ABSOLUTE) ? 0xffffffff : w->base_reg_nr);
+		put_frame_word(payload + 12 + 12 * i, w->offset);
+		put_frame_word(payload + 16 + 12 * i, w->nbytes);
+	}
+	send_frame(ctx, TARGET_COMM_FRAME_HALT_SNAPSHOT, 8 + 12 * snapshot->nr_mem_windows);
+	if ((err = recv_frame(ctx, TARGET_COMM_FRAME_HALT_SNAPSHOT, payload,
+					TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE, &len)) != GEAR_ERR_NO_ERROR)
+		return err;
+	if (len < 4)
+		panic("");
+	snapshot->state = get_frame_word(payload);
+	if (snapshot->state != TARGET_CORE_STATE_HALTED)
+	{
+		/* nothing else is sent */
+		if (len != 4)
+			panic("");
+		return GEAR_ERR_NO_ERROR;
+	}
+	pos = 4;
+	for (i = 0, mask = snapshot->reg_mask; mask; mask >>= 1)
+		if (mask & 1)
+		{
+			if (pos + 4 > len)
+				panic("");
+			snapshot->regs[i ++] = get_frame_word(payload + pos);
+			pos += 4;
+		}
+	resolve_snapshot_window_addresses(snapshot);
+	for (i = 0; i < snapshot->nr_mem_windows; i++)
+	{
+		w = snapshot->mem_windows + i;
+		if (pos + 8 > len)
+			panic("");
+		w->err = get_frame_word(payload + pos);
+		nbytes = get_frame_word(payload + pos + 4);
+		pos += 8;
+		if (nbytes > w->nbytes || pos + ((nbytes + 3) & ~ 3) > len)
+			panic("");
+		if (w->err != GEAR_ERR_NO_ERROR && nbytes)
+			panic("");
+		memcpy(w->buf, payload + pos, nbytes);
+		w->nbytes = nbytes;
+		pos += (nbytes + 3) & ~ 3;
+	}
+	if (pos != len)
+		panic("");
+	return GEAR_ERR_NO_ERROR;
+}
+
+/*!
+ *	\fn	static enum GEAR_ENGINE_ERR_ENUM core_get_halt_snapshot(struct gear_engine_context * ctx, struct core_halt_snapshot * snapshot)
+ *	\brief	retrieves a halt snapshot - the target core state, target core registers and target memory windows
+ *
+ *	if the binary protocol negotiated supports it, the snapshot
+ *	is retrieved by a single request; otherwise, the snapshot is
+ *	put together from a register read request and a memory read
+ *	request for each memory window - in this case, the target
+ *	state is not queried, and the one most recently passed to
+ *	the target state change callbacks is used instead; for
+ *	details, see struct core_halt_snapshot in core-access.h
+ *
+ *	\param	ctx	context to work in
+ *	\param	snapshot	the halt snapshot to retrieve
+ *	\return	GEAR_ERR_NO_ERROR on success, GEAR_ERR_TARGET_CORE_DEAD if
+ *		not connected to a target core controller, or the status code
+ *		of the register read request; errors reading the memory
+ *		windows are reported in the windows themselves
+ */
+static enum GEAR_ENGINE_ERR_ENUM core_get_halt_snapshot(struct gear_engine_context * ctx, struct core_halt_snapshot * snapshot)
+{
+struct core_connection_data * p;
+struct core_mem_window * w;
+enum GEAR_ENGINE_ERR_ENUM err;
+unsigned long mask;
+int i, data_size;
+
+	/* sanity checks */
+	if (!ctx || !ctx->core_comm || !snapshot
+			|| (snapshot->reg_mask && !snapshot->regs)
+			|| snapshot->nr_mem_windows < 0
+			|| (snapshot->nr_mem_windows && !snapshot->mem_windows))
+		panic("");
+
+	p = ctx->core_comm;
+	if (!p->is_core_controller_connected)
+		return GEAR_ERR_TARGET_CORE_DEAD;
+
+	/* see if the snapshot fits in a single reply frame */
+	for (data_size = 0, mask = snapshot->reg_mask; mask; mask >>= 1)
+		if (mask & 1)
+			data_size += 4;
+	for (i = 0; i < snapshot->nr_mem_windows; i++)
+		data_size += (snapshot->mem_windows[i].nbytes + 3) & ~ 3;
+
+	if (p->is_binary_protocol_enabled && p->binary_protocol_version >= 3
+			&& snapshot->nr_mem_windows <= TARGET_COMM_FRAME_MAX_SNAPSHOT_WINDOWS
+			&& data_size <= TARGET_COMM_FRAME_MAX_SNAPSHOT_DATA_SIZE)
+	{
+		p->halt_snapshot_stats.nr_single_request ++;
+		return frame_get_halt_snapshot(ctx, snapshot);
+	}
+
+	/* the target core controller does not support halt
+	 * snapshots - put the snapshot together from separate requests */
+	p->halt_snapshot_stats.nr_fallback ++;
+	snapshot->state = p->notified_state;
+	if (snapshot->state != TARGET_CORE_STATE_HALTED)
+		return GEAR_ERR_NO_ERROR;
+	if (snapshot->reg_mask && (err = core_reg_read(ctx, 0, snapshot->reg_mask, snapshot->regs)) != GEAR_ERR_NO_ERROR)
+		return err;
+	resolve_snapshot_window_addresses(snapshot);
+	for (i = 0; i < snapshot->nr_mem_windows; i++)
+	{
+		w = snapshot->mem_windows + i;
+		if ((w->err = core_mem_read(ctx, w->buf, w->addr, &w->nbytes)) != GEAR_ERR_NO_ERROR)
+			w->nbytes = 0;
+	}
+	return GEAR_ERR_NO_ERROR;
+}
+
+/*!
+ *	\fn	static void take_halt_snapshot(struct gear_engine_context * ctx)
+ *	\brief	retrieves a halt snapshot when the target has just halted
+ *
+ *	the snapshot is retrieved through ctx->cc->core_get_halt_snapshot(),
+ *	so that the modules overriding it get a chance to populate their
+ *	caches from the snapshot (see the comments at the start of file
+ *	core-access.h); the snapshot consists of all of the target core
+ *	registers, and the target memory windows specified in the
+ *	gear engine settings
+ *
+ *	the target memory windows are only of use to the memory
+ *	cache (see mem-cache.c), so they are only requested if the
+ *	memory cache is active, and if the target core controller
+ *	is able to retrieve the whole snapshot in a single request -
+ *	otherwise, reading the windows would take separate target
+ *	memory read requests, and they are better left for the memory
+ *	cache to fetch if and when they are actually needed
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+static void take_halt_snapshot(struct gear_engine_context * ctx)
+{
+struct core_halt_snapshot snapshot;
+struct core_mem_window windows[MAX_HALT_SNAPSHOT_WINDOWS];
+int i, nr_target_core_regs, nr_windows;
+
+	if (!ctx->tdesc || !ctx->cc || !ctx->cc->core_get_halt_snapshot)
+		/* too early, the gear engine is still initializing */
+		return;
+	if (!(nr_target_core_regs = ctx->tdesc->get_nr_target_core_regs(ctx)))
+		panic("");
+	if (!(snapshot.regs = malloc(nr_target_core_regs * sizeof * snapshot.regs)))
+		panic("out of core");
+	snapshot.reg_mask = (1 << nr_target_core_regs) - 1;
+	snapshot.mem_windows = windows;
+	snapshot.nr_mem_windows = 0;
+	nr_windows = 0;
+	if (ctx->mem_cache && ctx->core_comm->is_binary_protocol_enabled
+			&& ctx->core_comm->binary_protocol_version >= 3)
+		nr_windows = ctx->settings.nr_halt_snapshot_windows;
+	for (i = 0; i < nr_windows; i++)
+	{
+		windows[snapshot.nr_mem_windows].base_reg_nr = ctx->settings.halt_snapshot_windows[i].base_reg_nr;
+		if (windows[snapshot.nr_mem_windows].base_reg_nr == HALT_SNAPSHOT_WINDOW_SP)
+			windows[snapshot.nr_mem_windows].base_reg_nr = ctx->tdesc->get_target_sp_reg_nr(ctx);
+		if (windows[snapshot.nr_mem_windows].base_reg_nr >= nr_target_core_regs)
+			/* not a target core register, ignore the window */
+			continue;
+		windows[snapshot.nr_mem_windows].offset = ctx->settings.halt_snapshot_windows[i].offset;
+		windows[snapshot.nr_mem_windows].nbytes = ctx->settings.halt_snapshot_windows[i].nbytes;
+		if (!(windows[snapshot.nr_mem_windows].buf = malloc(windows[snapshot.nr_mem_windows].nbytes)))
+			panic("out of core");
+		snapshot.nr_mem_windows ++;
+	}
+
+	ctx->cc->core_get_halt_snapshot(ctx, &snapshot);
+
+	for (i = 0; i < snapshot.nr_mem_windows; i++)
+		free(windows[i].buf);
+	free(snapshot.regs);
+}
+
 static enum GEAR_ENGINE_ERR_ENUM core_set_break(struct gear_engine_context * ctx, ARM_CORE_WORD address)
 {
 struct core_connection_data * p;
@@ -1490,6 +3166,15 @@ struct core_connection_data * p;
 	if (!(p->lex_state.buf = malloc(CORE_CONTROLLER_BUFFER_SIZE)))
 		panic("");
 	p->lex_state.buf_size = CORE_CONTROLLER_BUFFER_SIZE;
+	if (!(p->frame_buf = malloc(TARGET_COMM_FRAME_HEADER_SIZE + TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE)))
+		panic("");
+	if (!(p->rx_buf = malloc(TARGET_COMM_FRAME_HEADER_SIZE + TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE)))
+		panic("");
+	if (!(p->packed_buf = malloc(TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE)))
+		panic("");
+	p->xfer_window = ctx->settings.target_xfer_window;
+	if (p->xfer_window < 1)
+		p->xfer_window = 1;
 	/* create the lexer state variables */
 	/*! \todo	provide a mechanism for invoking a
 	 *		corresponding yylex_destroy() */
@@ -1500,17 +3185,251 @@ struct core_connection_data * p;
 
 	ctx->core_comm = p;
 }
-/*! \todo	document this, define error codes */
+/*!
+ *	\fn	void target_comm_issue_core_status_request(struct gear_engine_context * ctx)
+ *	\brief	sends a target core state request to the target core controller, without waiting for the reply
+ *
+ *	if a target core state request is already outstanding, nothing
+ *	is done; the reply is processed either by target_comm_process_input()
+ *	when it arrives, or by ctx->cc->core_get_status(), which blocks
+ *	until it arrives
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
 void target_comm_issue_core_status_request(struct gear_engine_context * ctx)
 {
+struct core_connection_data * p;
+
+	p = ctx->core_comm;
+	if (p->is_status_request_pending)
+		return;
+	p->is_status_request_pending = true;
+	if (p->is_binary_protocol_enabled)
+	{
+		send_async_frame(ctx, TARGET_COMM_FRAME_GET_STATE, 0, status_request_completion, 0);
+		return;
+	}
 #ifdef __LINUX__
-	fprintf(ctx->core_comm->write_core_file, "GET_STATE\n");
-	fflush(ctx->core_comm->write_core_file);
+	fprintf(p->write_core_file, "GET_STATE\n");
+	fflush(p->write_core_file);
 #else
-	sockprintf(ctx->core_comm->write_core_fd, "GET_STATE\n");
+	sockprintf(p->write_core_fd, "GET_STATE\n");
 #endif
 }
 
+/*!
+ *	\fn	void target_comm_sync(struct gear_engine_context * ctx)
+ *	\brief	waits for the reply to an outstanding target core state request, if any
+ *
+ *	this must be invoked before issuing requests to the target
+ *	core controller by means of the ascii protocol, so that the
+ *	reply does not interfere with the replies to these requests;
+ *	asynchronous target memory transfers are not waited for
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void target_comm_sync(struct gear_engine_context * ctx)
+{
+enum TARGET_CORE_STATE_ENUM unused;
+
+	if (ctx->core_comm->is_core_controller_connected && ctx->core_comm->is_status_request_pending)
+		if (core_get_status(ctx, &unused) != GEAR_ERR_NO_ERROR)
+			panic("");
+}
+
+/*!
+ *	\fn	int target_comm_get_input_fd(struct gear_engine_context * ctx)
+ *	\brief	returns the file descriptor to monitor for incoming data from the target core controller
+ *
+ *	when this file descriptor becomes readable, target_comm_process_input()
+ *	should be invoked
+ *
+ *	\param	ctx	context to work in
+ *	\return	the file descriptor, or -1 if no replies from the
+ *		target core controller are currently expected
+ */
+int target_comm_get_input_fd(struct gear_engine_context * ctx)
+{
+struct core_connection_data * p;
+
+	p = ctx->core_comm;
+	if (!p->is_core_controller_connected)
+		return -1;
+	if (p->is_binary_protocol_enabled)
+		return (p->rx_frame_seq != p->tx_frame_seq) ? p->read_core_fd : -1;
+	return p->is_status_request_pending ? p->read_core_fd : -1;
+}
+
+/*!
+ *	\fn	void target_comm_process_input(struct gear_engine_context * ctx)
+ *	\brief	processes the incoming data from the target core controller, without blocking
+ *
+ *	when the binary protocol is in effect, all of the
+ *	replies received are dispatched to the completion routines
+ *	of their requests; when the ascii protocol is in effect, the
+ *	reply to an outstanding target core state request is only
+ *	processed if it has been received completely, as the lexical
+ *	scanner cannot be suspended in the middle of a reply
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void target_comm_process_input(struct gear_engine_context * ctx)
+{
+struct core_connection_data * p;
+enum TARGET_CORE_STATE_ENUM unused;
+char buf[64];
+int res;
+
+	p = ctx->core_comm;
+	if (!p->is_core_controller_connected)
+		return;
+	if (p->is_binary_protocol_enabled)
+	{
+		/* synchronous replies are received by recv_frame() */
+		while (p->rx_frame_seq != p->tx_frame_seq
+				&& p->outstanding_frames[p->rx_frame_seq % MAX_OUTSTANDING_FRAMES].completion
+				&& assemble_frame(ctx, false))
+			dispatch_async_frame(ctx);
+		return;
+	}
+	if (!p->is_status_request_pending)
+		return;
+	res = recv(p->read_core_fd, buf, sizeof buf, MSG_PEEK);
+	if (res == -1)
+		panic("");
+	if (!res)
+		/* connection dropped */
+		panic("");
+	if (memchr(buf, '\n', res))
+		if (core_get_status(ctx, &unused) != GEAR_ERR_NO_ERROR)
+			panic("");
+}
+
+/*!
+ *	\fn	int target_comm_start_mem_read(struct gear_engine_context * ctx, void * dest, ARM_CORE_WORD source, unsigned nbytes, void (*callback)(struct gear_engine_context * ctx, void * cookie, int xfer_id, enum GEAR_ENGINE_ERR_ENUM result, unsigned nbytes), void * cookie)
+ *	\brief	starts an asynchronous target memory read
+ *
+ *	this returns immediately; the transfer proceeds as the replies
+ *	from the target core controller are processed - most commonly,
+ *	by target_comm_process_input() from the gear engine main loop, but
+ *	also by any synchronous requests issued in the meantime; when
+ *	the transfer completes, it is queued, and the callback routine
+ *	is invoked by the next target_comm_dispatch_completed_xfers() call
+ *	from the gear engine main loop - i.e., never in the middle
+ *	of servicing a frontend request; the callback receives the
+ *	status code of the transfer (GEAR_ERR_TARGET_XFER_CANCELLED,
+ *	if the transfer has been cancelled by target_comm_cancel_xfer()),
+ *	and the number of bytes actually read
+ *
+ *	\param	ctx	context to work in
+ *	\param	dest	the buffer to store the bytes read in; it must
+ *			remain valid until the callback routine is invoked
+ *	\param	source	the target memory address to read from
+ *	\param	nbytes	the number of bytes to read
+ *	\param	callback	the routine to invoke when the transfer completes
+ *	\param	cookie	an arbitrary value to pass to the callback routine
+ *	\return	the identifier of the transfer started, or -1 if
+ *		an asynchronous transfer is not possible (not connected to a
+ *		target core controller, the binary protocol is not in effect,
+ *		or MAX_ASYNC_XFERS transfers are already in progress)
+ */
+int target_comm_start_mem_read(struct gear_engine_context * ctx, void * dest, ARM_CORE_WORD source, unsigned nbytes,
+		void (*callback)(struct gear_engine_context * ctx, void * cookie, int xfer_id, enum GEAR_ENGINE_ERR_ENUM result, unsigned nbytes),
+		void * cookie)
+{
+struct core_connection_data * p;
+struct target_comm_xfer * xfer;
+int i;
+
+	p = ctx->core_comm;
+	/* sanity checks */
+	if (!dest || !nbytes || !callback)
+		panic("");
+	if (!p->is_core_controller_connected || !p->is_binary_protocol_enabled)
+		return -1;
+	for (i = 0, xfer = p->xfers; xfer; xfer = xfer->next, i++)
+		;
+	if (i >= MAX_ASYNC_XFERS)
+		return -1;
+	if (!(xfer = calloc(1, sizeof * xfer)))
+		panic("out of core");
+	xfer->id = p->next_xfer_id ++;
+	xfer->dest = dest;
+	xfer->addr = source;
+	xfer->bytes_to_request = nbytes;
+	xfer->result = GEAR_ERR_NO_ERROR;
+	xfer->callback = callback;
+	xfer->cookie = cookie;
+	if (gettimeofday(&xfer->start, 0) < 0)
+		panic("");
+	xfer->next = p->xfers;
+	p->xfers = xfer;
+	service_xfer(ctx, xfer);
+	return xfer->id;
+}
+
+/*!
+ *	\fn	bool target_comm_cancel_xfer(struct gear_engine_context * ctx, int xfer_id)
+ *	\brief	cancels an asynchronous target memory transfer
+ *
+ *	no more chunk requests are sent for the transfer; the transfer
+ *	callback is invoked when the replies to the chunk requests
+ *	already outstanding have been received
+ *
+ *	\param	ctx	context to work in
+ *	\param	xfer_id	the identifier of the transfer to cancel, as
+ *			returned by target_comm_start_mem_read(); if -1, all
+ *			transfers in progress are cancelled
+ *	\return	true, if a transfer has been cancelled, false if no
+ *		transfer with the identifier given is in progress
+ */
+bool target_comm_cancel_xfer(struct gear_engine_context * ctx, int xfer_id)
+{
+struct target_comm_xfer * xfer;
+bool res;
+
+	res = false;
+	for (xfer = ctx->core_comm->xfers; xfer; xfer = xfer->next)
+		if (xfer_id == -1 || xfer->id == xfer_id)
+		{
+			if (!xfer->nr_outstanding)
+				panic("");
+			xfer->is_cancelled = true;
+			res = true;
+		}
+	return res;
+}
+
+/*!
+ *	\fn	void target_comm_dispatch_completed_xfers(struct gear_engine_context * ctx)
+ *	\brief	invokes the callbacks of the completed asynchronous target memory transfers
+ *
+ *	the callbacks are invoked in the order the transfers have
+ *	completed, and the transfers are then discarded; this must
+ *	only be invoked from the gear engine main loop, between
+ *	frontend requests
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void target_comm_dispatch_completed_xfers(struct gear_engine_context * ctx)
+{
+struct core_connection_data * p;
+struct target_comm_xfer * xfer;
+
+	p = ctx->core_comm;
+	while ((xfer = p->completed_xfers))
+	{
+		p->completed_xfers = xfer->next;
+		xfer->callback(ctx, xfer->cookie, xfer->id,
+				xfer->is_cancelled ? GEAR_ERR_TARGET_XFER_CANCELLED : xfer->result, xfer->nbytes);
+		free(xfer);
+	}
+}
+
 /*! \todo	clean these up */
 static struct core_control target_cc =
 {
@@ -1530,6 +3449,7 @@ static struct core_control target_cc =
 	core_insn_step,
 	io_ctl,
 	core_get_status,
+	core_get_halt_snapshot,
 	core_register_target_state_change_callback,
 	core_unregister_target_state_change_callback,
 };
@@ -1540,3 +3460,49 @@ int target_comm_get_core_access(struct core_control * cc)
 	return 0;
 }
 
+/*!
+ *	\fn	void target_comm_dump_xfer_stats_mi(struct gear_engine_context * ctx)
+ *	\brief	dumps target memory transfer statistics, in machine interface format
+ *
+ *	statistics are dumped separately for the ascii and the binary
+ *	protocols, so that their throughput can be compared; the throughput
+ *	is given in bytes per second, for reads and writes taken together
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void target_comm_dump_xfer_stats_mi(struct gear_engine_context * ctx)
+{
+struct core_connection_data * p;
+static const char * protocol_names[NR_TARGET_COMM_PROTOCOLS] =
+{
+	[TARGET_COMM_PROTOCOL_ASCII]	= "ASCII",
+	[TARGET_COMM_PROTOCOL_BINARY]	= "BINARY",
+};
+unsigned long long nbytes;
+int i;
+
+	p = ctx->core_comm;
+	miprintf("MEM_XFER = [PROTOCOL = %s, WINDOW = %i, ",
+			p->is_binary_protocol_enabled ? "BINARY" : "ASCII", p->xfer_window);
+	miprintf("HALT_SNAPSHOTS = [SINGLE_REQUEST = %i, FALLBACK = %i,],",
+			p->halt_snapshot_stats.nr_single_request, p->halt_snapshot_stats.nr_fallback);
+	for (i = 0; i < NR_TARGET_COMM_PROTOCOLS; i++)
+	{
+		nbytes = p->xfer_stats[i].nr_bytes_read + p->xfer_stats[i].nr_bytes_written;
+		miprintf("%s = [NR_REQUESTS = %i, BYTES_READ = %llu, BYTES_WRITTEN = %llu, USECS = %llu, BYTES_PER_SEC = %llu,],",
+				protocol_names[i],
+				p->xfer_stats[i].nr_requests,
+				p->xfer_stats[i].nr_bytes_read,
+				p->xfer_stats[i].nr_bytes_written,
+				p->xfer_stats[i].nr_usecs,
+				p->xfer_stats[i].nr_usecs ? nbytes * 1000000 / p->xfer_stats[i].nr_usecs : 0);
+	}
+	miprintf("IO = [WRITE_CALLS = %i, READ_CALLS = %i, SELECT_CALLS = %i, BYTES_COPIED = %llu, BYTES_DIRECT = %llu,],",
+			p->io_stats.nr_write_calls, p->io_stats.nr_read_calls, p->io_stats.nr_select_calls,
+			p->io_stats.nr_bytes_copied, p->io_stats.nr_bytes_direct);
+	miprintf("PACKING = [ENCODINGS = %i, BYTES_PACKED = %llu, BYTES_UNPACKED = %llu,],",
+			p->payload_encodings, p->io_stats.nr_bytes_packed, p->io_stats.nr_bytes_unpacked);
+	miprintf("],");
+}
+
@@ -14,4 +14,13 @@
  *
  */
 void target_comm_issue_core_status_request(struct gear_engine_context * ctx);
+void target_comm_sync(struct gear_engine_context * ctx);
+int target_comm_get_input_fd(struct gear_engine_context * ctx);
+void target_comm_process_input(struct gear_engine_context * ctx);
+int target_comm_start_mem_read(struct gear_engine_context * ctx, void * dest, ARM_CORE_WORD source, unsigned nbytes,
+		void (*callback)(struct gear_engine_context * ctx, void * cookie, int xfer_id, enum GEAR_ENGINE_ERR_ENUM result, unsigned nbytes),
+		void * cookie);
+bool target_comm_cancel_xfer(struct gear_engine_context * ctx, int xfer_id);
+void target_comm_dispatch_completed_xfers(struct gear_engine_context * ctx);
+void target_comm_dump_xfer_stats_mi(struct gear_engine_context * ctx);
 
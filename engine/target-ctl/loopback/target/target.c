@@ -0,0 +1,210 @@
+/* loopback target core controller target specific code
+ *
+ * this is an in-memory model of a target core - a single ram
+ * region and a register file - used for benchmarking the communication
+ * between the gear engine and target core controllers without any
+ * target hardware; running and single stepping the target core
+ * complete immediately - the target core is reported halted by the
+ * next target state request, as if a breakpoint has been hit; the
+ * latency and bandwidth of a real target connection can be modelled
+ * by the '--reply-latency' and '--reply-bandwidth' command line
+ * options of the target core controller */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "typedefs.h"
+#include "util.h"
+#include "engine-err.h"
+#include "target.h"
+#include "constants.h"
+
+enum
+{
+	/* the target address of the ram model */
+	LOOPBACK_RAM_BASE	= 0x20000000,
+	/* the size of the ram model, in bytes */
+	LOOPBACK_RAM_SIZE	= 0x100000,
+	/* the number of registers in the register file model - the
+	 * core registers, the program counter, the cpsr and the spsr;
+	 * for the register numbering, see the comments about register
+	 * reading requests in file target-ctl-parse.y */
+	LOOPBACK_NR_REGS	= 19,
+	/* the register numbers of the stack pointer and the program counter */
+	LOOPBACK_SP_REG_NR	= 13,
+	LOOPBACK_PC_REG_NR	= 15,
+	/* the initial stack pointer value - leave some room above
+	 * it, so that the memory windows retrieved above the stack
+	 * pointer when the target halts are within the ram model */
+	LOOPBACK_INITIAL_SP	= LOOPBACK_RAM_BASE + LOOPBACK_RAM_SIZE - 0x2000,
+	/* the initial program counter value */
+	LOOPBACK_INITIAL_PC	= 0x08000000,
+};
+
+static unsigned char ram[LOOPBACK_RAM_SIZE];
+static ARM_CORE_WORD regs[LOOPBACK_NR_REGS];
+/* nonzero if the target core has been run (or single stepped),
+ * and the next target state request has not yet been served */
+static int is_running;
+
+static int is_ram_range(ARM_CORE_WORD addr, unsigned nbytes)
+{
+	return addr >= LOOPBACK_RAM_BASE
+		&& nbytes <= LOOPBACK_RAM_SIZE
+		&& addr - LOOPBACK_RAM_BASE <= LOOPBACK_RAM_SIZE - nbytes;
+}
+
+static enum GEAR_ENGINE_ERR_ENUM core_open(struct target_ctl_context * ctx, const char * executable_fname, int argc, const char ** argv, const char ** errmsg_hint)
+{
+	memset(regs, 0, sizeof regs);
+	regs[LOOPBACK_SP_REG_NR] = LOOPBACK_INITIAL_SP;
+	regs[LOOPBACK_PC_REG_NR] = LOOPBACK_INITIAL_PC;
+	is_running = 0;
+	return GEAR_ERR_NO_ERROR;
+}
+static enum GEAR_ENGINE_ERR_ENUM core_close(struct target_ctl_context * ctx)
+{
+	return GEAR_ERR_NO_ERROR;
+}
+static enum GEAR_ENGINE_ERR_ENUM core_mem_read(struct target_ctl_context * ctx, void *dest, ARM_CORE_WORD source, unsigned *nbytes)
+{
+	if (target_is_core_running(ctx))
+		panic("");
+	if (!is_ram_range(source, * nbytes))
+		return GEAR_ERR_GENERIC_ERROR;
+	memcpy(dest, ram + (source - LOOPBACK_RAM_BASE), * nbytes);
+	return GEAR_ERR_NO_ERROR;
+}
+static enum GEAR_ENGINE_ERR_ENUM core_mem_write(struct target_ctl_context * ctx, ARM_CORE_WORD dest, const void *source, unsigned *nbytes)
+{
+	if (target_is_core_running(ctx))
+		panic("");
+	if (!is_ram_range(dest, * nbytes))
+		return GEAR_ERR_GENERIC_ERROR;
+	memcpy(ram + (dest - LOOPBACK_RAM_BASE), source, * nbytes);
+	return GEAR_ERR_NO_ERROR;
+}
+/*! \todo	handle mode here */
+static enum GEAR_ENGINE_ERR_ENUM core_reg_read(struct target_ctl_context * ctx, unsigned mode, unsigned thread_id, unsigned long mask, ARM_CORE_WORD buffer[])
+{
+int i, j;
+
+	if (target_is_core_running(ctx))
+		panic("");
+	if (!mask)
+		panic("");
+	for (i = j = 0; i < LOOPBACK_NR_REGS && mask; i++, mask >>= 1)
+		if (mask & 1)
+			buffer[j++] = regs[i];
+	return GEAR_ERR_NO_ERROR;
+}
+/*! \todo	handle mode here */
+static enum GEAR_ENGINE_ERR_ENUM core_reg_write(struct target_ctl_context * ctx, unsigned mode, unsigned thread_id, unsigned long mask, ARM_CORE_WORD buffer[])
+{
+int i, j;
+
+	if (target_is_core_running(ctx))
+		panic("");
+	if (!mask)
+		panic("");
+	for (i = j = 0; i < LOOPBACK_NR_REGS && mask; i++, mask >>= 1)
+		if (mask & 1)
+			regs[i] = buffer[j++];
+	return GEAR_ERR_NO_ERROR;
+}
+static enum GEAR_ENGINE_ERR_ENUM core_cop_read(struct target_ctl_context * ctx, unsigned CPnum, unsigned long mask, ARM_CORE_WORD buffer[])
+{
+	panic("");
+	return GEAR_ERR_GENERIC_ERROR;
+}
+static enum GEAR_ENGINE_ERR_ENUM core_cop_write(struct target_ctl_context * ctx, unsigned CPnum, unsigned long mask, ARM_CORE_WORD buffer[])
+{
+	panic("");
+	return GEAR_ERR_GENERIC_ERROR;
+}
+/* breakpoints are accepted, but have no effect - running the
+ * target core always completes immediately */
+static enum GEAR_ENGINE_ERR_ENUM core_set_break(struct target_ctl_context * ctx, ARM_CORE_WORD address)
+{
+	return GEAR_ERR_NO_ERROR;
+}
+static enum GEAR_ENGINE_ERR_ENUM core_clear_break(struct target_ctl_context * ctx, ARM_CORE_WORD address)
+{
+	return GEAR_ERR_NO_ERROR;
+}
+static enum GEAR_ENGINE_ERR_ENUM core_run(struct target_ctl_context * ctx, unsigned thread_id/*ARM_CORE_WORD * halt_addr*/)
+{
+	is_running = 1;
+	return GEAR_ERR_NO_ERROR;
+}
+static enum GEAR_ENGINE_ERR_ENUM core_halt(struct target_ctl_context * ctx, unsigned thread_id)
+{
+	is_running = 0;
+	return GEAR_ERR_NO_ERROR;
+}
+static enum GEAR_ENGINE_ERR_ENUM core_insn_step(struct target_ctl_context * ctx, unsigned thread_id/*ARM_CORE_WORD * halt_addr*/)
+{
+	/* model a thumb instruction */
+	regs[LOOPBACK_PC_REG_NR] += 2;
+	is_running = 1;
+	return GEAR_ERR_NO_ERROR;
+}
+static enum GEAR_ENGINE_ERR_ENUM core_ioctl(struct target_ctl_context * ctx, int request_len, ARM_CORE_WORD * request, int * response_len, ARM_CORE_WORD ** response)
+{
+	panic("");
+	return GEAR_ERR_GENERIC_ERROR;
+}
+
+static enum GEAR_ENGINE_ERR_ENUM core_get_status(struct target_ctl_context * ctx, enum TARGET_CORE_STATE_ENUM * status)
+{
+	/* whenever the target core is run, it halts immediately */
+	is_running = 0;
+	* status = TARGET_CORE_STATE_HALTED;
+	return GEAR_ERR_NO_ERROR;
+}
+
+static struct core_access_struct core_funcs =
+{
+	/* core_open */
+	core_open,
+	/* core_close */
+	core_close,
+	/* core_mem_read */
+	core_mem_read,
+	/* core_mem_write */
+	core_mem_write,
+	/* core_reg_read */
+	core_reg_read,
+	/* core_reg_write */
+	core_reg_write,
+	/* core_cop_read */
+	core_cop_read,
+	/* core_cop_write */
+	core_cop_write,
+	/* core_set_break */
+	core_set_break,
+	/* core_clear_break */
+	core_clear_break,
+	/* core_run */
+	core_run,
+	/* core_halt */
+	core_halt,
+	/* core_insn_step */
+	core_insn_step,
+	/* io_ctl */
+	core_ioctl,
+	/* core_get_status */
+	core_get_status,
+};
+
+int target_is_core_running(struct target_ctl_context * ctx)
+{
+	return is_running;
+}
+
+enum GEAR_ENGINE_ERR_ENUM target_get_core_access(struct target_ctl_context * ctx)
+{
+	ctx->cc = &core_funcs;
+	return GEAR_ERR_NO_ERROR;
+}
+
@@ -77,6 +77,7 @@ abort_scanning:\
 "BKPT_CLEAR"		{ return BKPT_CLEAR_KW; }
 "GET_STATE"		{ return GET_STATE_KW; }
 "IOCTL"			{ return IOCTL_KW; }
+"SET_PROTOCOL"		{ return SET_PROTOCOL_KW; }
 
 0[xX]{H}+{IS}?	{
 			/*! \todo	process conversion errors here */
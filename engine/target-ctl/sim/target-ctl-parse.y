@@ -23,6 +23,7 @@
 #include <arpa/inet.h>
 #include <net/if.h>
 #include <stdarg.h>
+#include <string.h>
 
 #include <pthread.h>
 
@@ -30,6 +31,9 @@
 #include "util.h"
 
 #include "engine-err.h"
+#include "target-comm-frame.h"
+/* the payload encoding routines are shared with the gear engine */
+#include "target-comm-pack.c"
 
 #include "target.h"
 
@@ -42,6 +46,17 @@ static const int COMM_BUF_SIZE = 0x1000;
 
 static FILE * gear_comm_file;
 static int gear_comm_fd;
+/* nonzero if the binary framed protocol has been negotiated with the gear engine */
+static int is_binary_protocol_enabled;
+/* buffer for binary frames, both incoming and outgoing */
+static unsigned char frame_buf[TARGET_COMM_FRAME_HEADER_SIZE + TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE];
+/* the bitmap of the payload encodings agreed upon with the gear engine, for the packed frames */
+static unsigned payload_encodings;
+/* buffer for the unencoded data bytes of the packed frames */
+static unsigned char unpacked_buf[TARGET_COMM_FRAME_MAX_DATA_SIZE];
+
+static int is_frame_pending(void);
+static void serve_frame(struct target_ctl_context * ctx);
 
 static struct
 {
@@ -102,6 +117,7 @@ static int core_req_ack_flag;
 %token BKPT_CLEAR_KW
 %token GET_STATE_KW
 %token IOCTL_KW
+%token SET_PROTOCOL_KW
 %token NUM
 %type <num>	NUM
 
@@ -308,6 +324,21 @@ gear_engine_request
 			xprintf(gear_comm_file, "\n");
 			fflush(gear_comm_file);
 		}
+		| SET_PROTOCOL_KW '(' NUM ')'
+		{
+			/* the gear engine requests switching to the binary
+			 * framed protocol, the argument ($3) is the protocol
+			 * version requested; reply with the protocol version
+			 * selected, or zero if the protocol is not supported -
+			 * then the ascii protocol remains in effect; for details,
+			 * see the comments in file target-comm-frame.h from the
+			 * gear engine source code package */
+			is_binary_protocol_enabled = ($3 >= TARGET_COMM_BINARY_PROTOCOL_MIN_VERSION
+					&& $3 <= TARGET_COMM_BINARY_PROTOCOL_VERSION);
+			xprintf(gear_comm_file, "GEAR_ERR_NO_ERROR,%i\n",
+					is_binary_protocol_enabled ? $3 : 0);
+			fflush(gear_comm_file);
+		}
 		;
 reg_write_data
 		:	NUM ','
@@ -393,6 +424,299 @@ int res;
 	return res;
 }
 
+/* binary frame support follows; for the format of the frames,
+ * see the comments in file target-comm-frame.h from the gear
+ * engine source code package */
+
+static void recv_all(unsigned char * buf, int len)
+{
+int res;
+
+	while (len)
+	{
+		res = read(gear_comm_fd, buf, len);
+		if (res <= 0)
+			panic("connection dropped in the middle of a frame");
+		buf += res;
+		len -= res;
+	}
+}
+
+static void put_word(unsigned char * buf, ARM_CORE_WORD word)
+{
+	buf[0] = word;
+	buf[1] = word >> 8;
+	buf[2] = word >> 16;
+	buf[3] = word >> 24;
+}
+
+static ARM_CORE_WORD get_word(const unsigned char * buf)
+{
+	return buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((ARM_CORE_WORD) buf[3] << 24);
+}
+
+/* sends a reply frame; the payload must already have been
+ * stored in frame_buf, right after the frame header; the sequence
+ * id of the request being replied to is copied to the reply */
+static void send_frame(int frame_type, enum GEAR_ENGINE_ERR_ENUM status, int seq, int payload_len)
+{
+	frame_buf[0] = frame_type;
+	frame_buf[1] = status;
+	frame_buf[2] = seq;
+	frame_buf[3] = seq >> 8;
+	put_word(frame_buf + 4, payload_len);
+	if (fwrite(frame_buf, 1, TARGET_COMM_FRAME_HEADER_SIZE + payload_len, gear_comm_file)
+			!= TARGET_COMM_FRAME_HEADER_SIZE + payload_len)
+		panic("");
+	fflush(gear_comm_file);
+}
+
+/* returns nonzero if the next request from the gear engine is
+ * a binary frame; frame types are control characters other
+ * than whitespace, which never start an ascii request; this
+ * blocks until the gear
+ * engine sends a request, or shuts down the connection - in the
+ * latter case, zero is returned, so that the connection shutdown
+ * is handled by the ascii request parser */
+static int is_frame_pending(void)
+{
+unsigned char c;
+
+	if (recv(gear_comm_fd, (char *) &c, 1, MSG_PEEK) != 1)
+		return 0;
+	return TARGET_COMM_IS_FRAME_TYPE(c);
+}
+
+/* receives and serves a single binary request frame; the gear
+ * engine may send further requests before this one is replied
+ * to (see the comments about request pipelining in file
+ * target-comm-frame.h) - these simply wait in the socket buffers */
+static void serve_frame(struct target_ctl_context * ctx)
+{
+unsigned char * payload;
+int frame_type, seq;
+ARM_CORE_WORD len, addr, mask, reg;
+unsigned nbytes;
+int i, nregs, nwindows;
+enum GEAR_ENGINE_ERR_ENUM err;
+enum TARGET_CORE_STATE_ENUM state;
+enum TARGET_COMM_ENCODING_ENUM encoding;
+ARM_CORE_WORD regs[19];
+struct
+{
+	ARM_CORE_WORD	base_reg;
+	ARM_CORE_WORD	offset;
+	ARM_CORE_WORD	nbytes;
+}
+windows[TARGET_COMM_FRAME_MAX_SNAPSHOT_WINDOWS];
+
+	payload = frame_buf + TARGET_COMM_FRAME_HEADER_SIZE;
+	recv_all(frame_buf, TARGET_COMM_FRAME_HEADER_SIZE);
+	frame_type = frame_buf[0];
+	seq = frame_buf[2] | (frame_buf[3] << 8);
+	len = get_word(frame_buf + 4);
+	if (len > TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE)
+		panic("frame payload too long");
+	recv_all(payload, len);
+
+	switch (frame_type)
+	{
+		case TARGET_COMM_FRAME_MEM_READ:
+			/* payload: address, number of bytes to read */
+			if (len != 8)
+				panic("");
+			addr = get_word(payload);
+			nbytes = get_word(payload + 4);
+			if (!nbytes || nbytes > TARGET_COMM_FRAME_MAX_DATA_SIZE)
+				panic("");
+			i = nbytes;
+			err = ctx->cc->core_mem_read(ctx, payload, addr, &nbytes);
+			if (err == GEAR_ERR_NO_ERROR && nbytes != i)
+				panic("");
+			send_frame(frame_type, err, seq, (err == GEAR_ERR_NO_ERROR) ? nbytes : 0);
+			break;
+		case TARGET_COMM_FRAME_MEM_WRITE:
+			/* payload: address, data bytes to write */
+			if (len <= 4)
+				panic("");
+			addr = get_word(payload);
+			nbytes = len - 4;
+			err = ctx->cc->core_mem_write(ctx, addr, payload + 4, &nbytes);
+			if (err == GEAR_ERR_NO_ERROR && nbytes != len - 4)
+				panic("");
+			send_frame(frame_type, err, seq, 0);
+			break;
+		case TARGET_COMM_FRAME_REGS_READ:
+			/* payload: register bitmap; for the bitmap format,
+			 * see the comments for the ascii register reading
+			 * request above */
+			if (len != 4)
+				panic("");
+			mask = get_word(payload);
+			if (!mask)
+				panic("");
+			err = GEAR_ERR_NO_ERROR;
+			for (i = nregs = 0; i < 19 && err == GEAR_ERR_NO_ERROR; i++)
+				if (mask & (1 << i))
+				{
+					if ((err = ctx->cc->core_reg_read(ctx, 255, 1 << i, &reg)) == GEAR_ERR_NO_ERROR)
+						put_word(payload + 4 * nregs++, reg);
+				}
+			send_frame(frame_type, err, seq, (err == GEAR_ERR_NO_ERROR) ? 4 * nregs : 0);
+			break;
+		case TARGET_COMM_FRAME_REGS_WRITE:
+			/* payload: register bitmap, register values, one
+			 * for each bit set in the bitmap */
+			if (len < 4)
+				panic("");
+			mask = get_word(payload);
+			if (!mask)
+				panic("");
+			err = GEAR_ERR_NO_ERROR;
+			for (i = nregs = 0; i < 19 && err == GEAR_ERR_NO_ERROR; i++)
+				if (mask & (1 << i))
+				{
+					if (4 + 4 * nregs >= len)
+						panic("");
+					reg = get_word(payload + 4 + 4 * nregs++);
+					err = ctx->cc->core_reg_write(ctx, 255, 1 << i, &reg);
+				}
+			send_frame(frame_type, err, seq, 0);
+			break;
+		case TARGET_COMM_FRAME_GET_STATE:
+			if (len)
+				panic("");
+			if ((err = ctx->cc->core_get_status(ctx, &state)) == GEAR_ERR_NO_ERROR)
+				payload[0] = state;
+			send_frame(frame_type, err, seq, (err == GEAR_ERR_NO_ERROR) ? 1 : 0);
+			break;
+		case TARGET_COMM_FRAME_SET_ENCODINGS:
+			/* payload: the bitmap of the payload encodings offered
+			 * by the gear engine; reply with the ones supported */
+			if (len != 4)
+				panic("");
+			payload_encodings = get_word(payload) & TARGET_COMM_PACK_ENCODINGS;
+			put_word(payload, payload_encodings);
+			send_frame(frame_type, GEAR_ERR_NO_ERROR, seq, 4);
+			break;
+		case TARGET_COMM_FRAME_MEM_READ_PACKED:
+			/* payload: address, number of bytes to read, bitmap of
+			 * the encodings acceptable for the reply; the bytes read
+			 * are sent unencoded if encoding does not shrink them */
+			if (len != 12)
+				panic("");
+			addr = get_word(payload);
+			nbytes = get_word(payload + 4);
+			if (!nbytes || nbytes > TARGET_COMM_FRAME_MAX_DATA_SIZE)
+				panic("");
+			i = nbytes;
+			err = ctx->cc->core_mem_read(ctx, unpacked_buf, addr, &nbytes);
+			if (err != GEAR_ERR_NO_ERROR)
+			{
+				send_frame(frame_type, err, seq, 0);
+				break;
+			}
+			if (nbytes != i)
+				panic("");
+			if ((i = target_comm_pack(get_word(payload + 8) & payload_encodings, payload + 4, nbytes,
+							unpacked_buf, nbytes, &encoding)) == -1)
+			{
+				encoding = TARGET_COMM_ENCODING_RAW;
+				memcpy(payload + 4, unpacked_buf, i = nbytes);
+			}
+			put_word(payload, encoding);
+			send_frame(frame_type, GEAR_ERR_NO_ERROR, seq, 4 + i);
+			break;
+		case TARGET_COMM_FRAME_MEM_WRITE_PACKED:
+			/* payload: address, encoding, number of bytes to
+			 * write, data bytes to write, encoded */
+			if (len < 12)
+				panic("");
+			addr = get_word(payload);
+			encoding = get_word(payload + 4);
+			nbytes = get_word(payload + 8);
+			if (!nbytes || nbytes > TARGET_COMM_FRAME_MAX_DATA_SIZE
+					|| encoding >= TARGET_COMM_NR_ENCODINGS
+					|| (encoding != TARGET_COMM_ENCODING_RAW && !(payload_encodings & (1 << encoding)))
+					|| target_comm_unpack(encoding, unpacked_buf, nbytes, payload + 12, len - 12))
+				panic("malformed packed frame");
+			i = nbytes;
+			err = ctx->cc->core_mem_write(ctx, addr, unpacked_buf, &nbytes);
+			if (err == GEAR_ERR_NO_ERROR && nbytes != i)
+				panic("");
+			send_frame(frame_type, err, seq, 0);
+			break;
+		case TARGET_COMM_FRAME_HALT_SNAPSHOT:
+			/* payload: register bitmap, number of memory windows,
+			 * memory window descriptors; for details, see the
+			 * comments in file target-comm-frame.h from the gear
+			 * engine source code package */
+			if (len < 8)
+				panic("");
+			mask = get_word(payload);
+			nwindows = get_word(payload + 4);
+			if (nwindows > TARGET_COMM_FRAME_MAX_SNAPSHOT_WINDOWS || len != 8 + 12 * nwindows)
+				panic("");
+			/* the reply is built in the same buffer as the
+			 * request, so save the window descriptors first */
+			for (i = 0; i < nwindows; i++)
+			{
+				windows[i].base_reg = get_word(payload + 8 + 12 * i);
+				windows[i].offset = get_word(payload + 12 + 12 * i);
+				windows[i].nbytes = get_word(payload + 16 + 12 * i);
+			}
+			if ((err = ctx->cc->core_get_status(ctx, &state)) != GEAR_ERR_NO_ERROR)
+			{
+				send_frame(frame_type, err, seq, 0);
+				break;
+			}
+			put_word(payload, state);
+			len = 4;
+			if (state == TARGET_CORE_STATE_HALTED)
+			{
+				for (i = 0; i < 19 && err == GEAR_ERR_NO_ERROR; i++)
+					if (mask & (1 << i))
+					{
+						if ((err = ctx->cc->core_reg_read(ctx, 255, 1 << i, regs + i)) == GEAR_ERR_NO_ERROR)
+						{
+							put_word(payload + len, regs[i]);
+							len += 4;
+						}
+					}
+				if (err != GEAR_ERR_NO_ERROR)
+				{
+					send_frame(frame_type, err, seq, 0);
+					break;
+				}
+				for (i = 0; i < nwindows; i++)
+				{
+					if (windows[i].base_reg == 0xffffffff)
+						addr = windows[i].offset;
+					else if (windows[i].base_reg < 19 && (mask & (1 << windows[i].base_reg)))
+						addr = regs[windows[i].base_reg] + windows[i].offset;
+					else
+						panic("");
+					nbytes = windows[i].nbytes;
+					if (!nbytes || len + 8 + ((nbytes + 3) & ~ 3) > TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE)
+						panic("");
+					err = ctx->cc->core_mem_read(ctx, payload + len + 8, addr, &nbytes);
+					if (err == GEAR_ERR_NO_ERROR && nbytes != windows[i].nbytes)
+						panic("");
+					if (err != GEAR_ERR_NO_ERROR)
+						nbytes = 0;
+					put_word(payload + len, err);
+					put_word(payload + len + 4, nbytes);
+					memset(payload + len + 8 + nbytes, 0, ((nbytes + 3) & ~ 3) - nbytes);
+					len += 8 + ((nbytes + 3) & ~ 3);
+				}
+			}
+			send_frame(frame_type, GEAR_ERR_NO_ERROR, seq, len);
+			break;
+		default:
+			panic("bad frame type");
+	}
+}
+
 static void * target_monitor_thread(void * ctx_ptr)
 {
 struct target_ctl_context * ctx;
@@ -530,6 +854,9 @@ struct target_ctl_context * ctx;
 			panic("");
 		i = ntohl(addr.sin_addr.s_addr);
 		printf("ok, connection request accepted from %s\n", inet_ntoa(addr.sin_addr));
+		/* a new connection always starts with the ascii protocol */
+		is_binary_protocol_enabled = 0;
+		payload_encodings = 0;
 		printf("invoking core_open()");
 
 		if (ctx->cc->core_open(ctx) != GEAR_ERR_NO_ERROR)
@@ -541,6 +868,12 @@ struct target_ctl_context * ctx;
 			lex_vars.lex_idx = lex_vars.comm_buf_idx = 0;
 			lex_vars.mem_write_len = 0;
 			lex_vars.regmask = lex_vars.reg_nr = 0;
+			/* binary frames bypass the request parser */
+			if (is_binary_protocol_enabled && is_frame_pending())
+			{
+				serve_frame(ctx);
+				continue;
+			}
 			if (yyparse(ctx))
 			{
 				if (lex_vars.is_scanner_aborted)
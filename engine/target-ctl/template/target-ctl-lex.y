@@ -133,10 +133,13 @@ abort_scanning:\
 "REGS_READ"		{ return REGS_READ_KW; }
 "REGS_WRITE"		{ return REGS_WRITE_KW; }
 "CORE_RUN"		{ return CORE_RUN_KW; }
+"CORE_HALT"		{ return CORE_HALT_KW; }
+"CORE_INSN_STEP"	{ return CORE_INSN_STEP_KW; }
 "BKPT_SET"		{ return BKPT_SET_KW; }
 "BKPT_CLEAR"		{ return BKPT_CLEAR_KW; }
 "GET_STATE"		{ return GET_STATE_KW; }
 "IOCTL"			{ return IOCTL_KW; }
+"SET_PROTOCOL"		{ return SET_PROTOCOL_KW; }
 
 0[xX]{H}+{IS}?	{
 			/*! \todo	process conversion errors here */
@@ -16,6 +16,9 @@
  * from the gear engine source code package */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #ifdef __LINUX__
@@ -23,6 +26,7 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <net/if.h>
+#include <unistd.h>
 #else
 #include <winsock2.h>
 #endif
@@ -34,17 +38,74 @@
 #include "util.h"
 
 #include "engine-err.h"
+#include "target-comm-frame.h"
+/* the payload encoding routines are shared with the gear engine */
+#include "target-comm-pack.c"
 
 #include "target.h"
 
 
 #define TARGET_CTL_DEFAULT_PORT		0x1111
 
-static int xprintf(int sock_fd, const char * format, ...);
-
 static const int COMM_BUF_SIZE = 0x1000;
 
 static int gear_comm_fd;
+/* nonzero if the binary framed protocol has been negotiated with the gear engine */
+static int is_binary_protocol_enabled;
+/* buffer for binary frames, both incoming and outgoing */
+static unsigned char frame_buf[TARGET_COMM_FRAME_HEADER_SIZE + TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE];
+/* the bitmap of the payload encodings agreed upon with the gear engine, for the packed frames */
+static unsigned payload_encodings;
+/* buffer for the unencoded data bytes of the packed frames */
+static unsigned char unpacked_buf[TARGET_COMM_FRAME_MAX_DATA_SIZE];
+
+static int is_frame_pending(void);
+static void serve_frame(struct target_ctl_context * ctx);
+
+/* artificial delay, in milliseconds, of each reply sent to the gear
+ * engine; this is set with the '--reply-latency' command line option,
+ * and is useful for turning this stub into a stand-in for a slow
+ * target (e.g. a remote debug probe), so that the asynchronous
+ * target communication handling in the gear engine can be exercised
+ * without real hardware; ascii replies are delayed by sleeping before
+ * sending them, binary replies are queued instead (see struct
+ * delayed_reply below), so that the requests following them can be
+ * served in the meantime */
+static int reply_latency_ms;
+/* nonzero if the reply to the ascii request currently being served
+ * has already been delayed; used to delay only the first chunk of
+ * a reply, which is output piecemeal by the request parser */
+static int is_reply_delayed;
+/* artificial bandwidth limit, in bytes per second, for the replies
+ * sent to the gear engine; this is set with the '--reply-bandwidth'
+ * command line option - zero means no limit; together with the
+ * reply latency above, this makes it possible to model the
+ * throughput of a slow target connection (e.g. jtag) */
+static unsigned long reply_bandwidth;
+
+/* a binary reply frame that has been produced, but has not yet been
+ * delivered to the gear engine; when modelling the reply latency,
+ * each binary reply is delivered reply_latency_ms after it has been
+ * produced, while the requests following it are being served - just
+ * like on a real target connection, the latencies of the requests
+ * pipelined by the gear engine then overlap */
+struct delayed_reply
+{
+	struct delayed_reply	* next;
+	/* the time at which to deliver the reply, see get_usecs() */
+	unsigned long long	due_usecs;
+	/* the number of bytes in the data array below */
+	int			len;
+	/* the reply frame */
+	unsigned char		data[];
+};
+/* the queue of binary replies to deliver, in the order produced */
+static struct delayed_reply * delayed_replies;
+static struct delayed_reply ** delayed_replies_tail = &delayed_replies;
+
+static void inject_reply_latency(void);
+static void throttle_reply(int nbytes);
+static void deliver_delayed_replies(int wait_all);
 
 static struct
 {
@@ -87,10 +148,13 @@ void yyerror (struct target_ctl_context * ctx, char const * s)
 %token REGS_READ_KW
 %token REGS_WRITE_KW
 %token CORE_RUN_KW
+%token CORE_HALT_KW
+%token CORE_INSN_STEP_KW
 %token BKPT_SET_KW
 %token BKPT_CLEAR_KW
 %token GET_STATE_KW
 %token IOCTL_KW
+%token SET_PROTOCOL_KW
 %token NUM
 %type <num>	NUM
 
@@ -240,6 +304,22 @@ gear_engine_request
 				panic("");
 			xprintf(gear_comm_fd, "GEAR_ERR_NO_ERROR\n");
 		}
+		| CORE_HALT_KW
+		{
+			/* halt the target core */
+			if (ctx->cc->core_halt(ctx, 0) !=
+					GEAR_ERR_NO_ERROR)
+				panic("");
+			xprintf(gear_comm_fd, "GEAR_ERR_NO_ERROR\n");
+		}
+		| CORE_INSN_STEP_KW
+		{
+			/* instruction-wise single step the target core */
+			if (ctx->cc->core_insn_step(ctx, 0) !=
+					GEAR_ERR_NO_ERROR)
+				panic("");
+			xprintf(gear_comm_fd, "GEAR_ERR_NO_ERROR\n");
+		}
 		| BKPT_SET_KW '(' NUM ')'
 		{
 			/* set a breakpoint at the address specified
@@ -284,6 +364,20 @@ gear_engine_request
 			}
 			xprintf(gear_comm_fd, "\n");
 		}
+		| SET_PROTOCOL_KW '(' NUM ')'
+		{
+			/* the gear engine requests switching to the binary
+			 * framed protocol, the argument ($3) is the protocol
+			 * version requested; reply with the protocol version
+			 * selected, or zero if the protocol is not supported -
+			 * then the ascii protocol remains in effect; for details,
+			 * see the comments in file target-comm-frame.h from the
+			 * gear engine source code package */
+			is_binary_protocol_enabled = ($3 >= TARGET_COMM_BINARY_PROTOCOL_MIN_VERSION
+					&& $3 <= TARGET_COMM_BINARY_PROTOCOL_VERSION);
+			xprintf(gear_comm_fd, "GEAR_ERR_NO_ERROR,%i\n",
+					is_binary_protocol_enabled ? $3 : 0);
+		}
 		;
 reg_write_data
 		:	NUM ','
@@ -357,22 +451,474 @@ ioctl_data
 %%
 
 
-static int xprintf(int sock_fd, const char * format, ...)
+int xprintf(int sock_fd, const char * format, ...)
 {
 va_list ap;
 int res;
 char buf[256];
 
+	if (!is_reply_delayed)
+	{
+		/* keep the replies in order */
+		deliver_delayed_replies(1);
+		inject_reply_latency();
+		is_reply_delayed = 1;
+	}
 	va_start(ap, format);
 	res = vsnprintf(buf, sizeof buf, format, ap);
 	if (send(sock_fd, buf, res, 0) != res)
 		panic("");
+	throttle_reply(res);
 	/* vfprintf(stdout, format, ap);*/
 	va_end(ap);
 	return res;
 }
 
-int main(void)
+static void inject_reply_latency(void)
+{
+	if (!reply_latency_ms)
+		return;
+#ifdef __LINUX__
+	usleep(reply_latency_ms * 1000);
+#else
+	Sleep(reply_latency_ms);
+#endif
+}
+
+/* returns a monotonic timestamp, in microseconds */
+static unsigned long long get_usecs(void)
+{
+#ifdef __LINUX__
+struct timespec t;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &t))
+		panic("");
+	return t.tv_sec * 1000000ULL + t.tv_nsec / 1000;
+#else
+	return GetTickCount() * 1000ULL;
+#endif
+}
+
+/* delays for the time that sending a number of bytes of a
+ * reply would take at the bandwidth given by reply_bandwidth */
+static void throttle_reply(int nbytes)
+{
+unsigned long long usecs;
+
+	if (!reply_bandwidth)
+		return;
+	usecs = nbytes * 1000000ULL / reply_bandwidth;
+	if (!usecs)
+		return;
+#ifdef __LINUX__
+	usleep(usecs);
+#else
+	Sleep((usecs + 999) / 1000);
+#endif
+}
+
+/* binary frame support follows; for the format of the frames,
+ * see the comments in file target-comm-frame.h from the gear
+ * engine source code package */
+
+static void recv_all(unsigned char * buf, int len)
+{
+int res;
+
+	while (len)
+	{
+		res = recv(gear_comm_fd, (char *) buf, len, 0);
+		if (res <= 0)
+			panic("connection dropped in the middle of a frame");
+		buf += res;
+		len -= res;
+	}
+}
+
+static void put_word(unsigned char * buf, ARM_CORE_WORD word)
+{
+	buf[0] = word;
+	buf[1] = word >> 8;
+	buf[2] = word >> 16;
+	buf[3] = word >> 24;
+}
+
+static ARM_CORE_WORD get_word(const unsigned char * buf)
+{
+	return buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((ARM_CORE_WORD) buf[3] << 24);
+}
+
+/* sends a reply frame; the payload must already have been
+ * stored in frame_buf, right after the frame header; the sequence
+ * id of the request being replied to is copied to the reply */
+static void send_frame(int frame_type, enum GEAR_ENGINE_ERR_ENUM status, int seq, int payload_len)
+{
+unsigned char * buf;
+int len, res;
+struct delayed_reply * r;
+
+	frame_buf[0] = frame_type;
+	frame_buf[1] = status;
+	frame_buf[2] = seq;
+	frame_buf[3] = seq >> 8;
+	put_word(frame_buf + 4, payload_len);
+	buf = frame_buf;
+	len = TARGET_COMM_FRAME_HEADER_SIZE + payload_len;
+	if (reply_latency_ms)
+	{
+		/* queue the reply, see deliver_delayed_replies() */
+		if (!(r = malloc(sizeof * r + len)))
+			panic("out of core");
+		r->next = 0;
+		r->due_usecs = get_usecs() + reply_latency_ms * 1000ULL;
+		r->len = len;
+		memcpy(r->data, buf, len);
+		* delayed_replies_tail = r;
+		delayed_replies_tail = & r->next;
+		return;
+	}
+	while (len)
+	{
+		res = send(gear_comm_fd, (char *) buf, len, 0);
+		if (res <= 0)
+			panic("");
+		buf += res;
+		len -= res;
+	}
+	throttle_reply(TARGET_COMM_FRAME_HEADER_SIZE + payload_len);
+}
+
+/* delivers the queued binary replies that are due; if wait_all
+ * is nonzero, waits for all queued replies to become due, and
+ * delivers them all */
+static void deliver_delayed_replies(int wait_all)
+{
+struct delayed_reply * r;
+unsigned long long now;
+unsigned char * buf;
+int len, res;
+
+	while ((r = delayed_replies))
+	{
+		now = get_usecs();
+		if (now < r->due_usecs)
+		{
+			if (!wait_all)
+				break;
+#ifdef __LINUX__
+			usleep(r->due_usecs - now);
+#else
+			Sleep((r->due_usecs - now + 999) / 1000);
+#endif
+		}
+		buf = r->data;
+		len = r->len;
+		while (len)
+		{
+			res = send(gear_comm_fd, (char *) buf, len, 0);
+			if (res <= 0)
+				panic("");
+			buf += res;
+			len -= res;
+		}
+		throttle_reply(r->len);
+		if (!(delayed_replies = r->next))
+			delayed_replies_tail = &delayed_replies;
+		free(r);
+	}
+}
+
+/* discards the queued binary replies; used when the connection
+ * to the gear engine has been shut down */
+static void discard_delayed_replies(void)
+{
+struct delayed_reply * r;
+
+	while ((r = delayed_replies))
+	{
+		delayed_replies = r->next;
+		free(r);
+	}
+	delayed_replies_tail = &delayed_replies;
+}
+
+/* waits until the next request from the gear engine arrives (or
+ * the connection is shut down), meanwhile delivering the queued
+ * binary replies as they become due; returns immediately if there
+ * are no queued replies - the request parser then simply blocks
+ * reading the request */
+static void wait_request(void)
+{
+unsigned long long now, usecs;
+struct timeval tv;
+fd_set fds;
+int res;
+
+	deliver_delayed_replies(0);
+	while (delayed_replies)
+	{
+		now = get_usecs();
+		usecs = (delayed_replies->due_usecs > now) ? delayed_replies->due_usecs - now : 0;
+		tv.tv_sec = usecs / 1000000;
+		tv.tv_usec = usecs % 1000000;
+		FD_ZERO(&fds);
+		FD_SET(gear_comm_fd, &fds);
+		if ((res = select(gear_comm_fd + 1, &fds, 0, 0, &tv)) < 0)
+			panic("");
+		if (res)
+			/* a request is pending */
+			return;
+		deliver_delayed_replies(0);
+	}
+}
+
+/* returns nonzero if the next request from the gear engine is
+ * a binary frame; frame types are control characters other
+ * than whitespace, which never start an ascii request; this
+ * blocks until the gear
+ * engine sends a request, or shuts down the connection - in the
+ * latter case, zero is returned, so that the connection shutdown
+ * is handled by the ascii request parser */
+static int is_frame_pending(void)
+{
+unsigned char c;
+
+	if (recv(gear_comm_fd, (char *) &c, 1, MSG_PEEK) != 1)
+		return 0;
+	return TARGET_COMM_IS_FRAME_TYPE(c);
+}
+
+/* receives and serves a single binary request frame; the gear
+ * engine may send further requests before this one is replied
+ * to (see the comments about request pipelining in file
+ * target-comm-frame.h) - these simply wait in the socket buffers */
+static void serve_frame(struct target_ctl_context * ctx)
+{
+unsigned char * payload;
+int frame_type, seq;
+ARM_CORE_WORD len, addr, mask, reg;
+unsigned nbytes;
+int i, nregs, nwindows;
+enum GEAR_ENGINE_ERR_ENUM err;
+enum TARGET_CORE_STATE_ENUM state;
+enum TARGET_COMM_ENCODING_ENUM encoding;
+ARM_CORE_WORD regs[19];
+struct
+{
+	ARM_CORE_WORD	base_reg;
+	ARM_CORE_WORD	offset;
+	ARM_CORE_WORD	nbytes;
+}
+windows[TARGET_COMM_FRAME_MAX_SNAPSHOT_WINDOWS];
+
+	payload = frame_buf + TARGET_COMM_FRAME_HEADER_SIZE;
+	recv_all(frame_buf, TARGET_COMM_FRAME_HEADER_SIZE);
+	frame_type = frame_buf[0];
+	seq = frame_buf[2] | (frame_buf[3] << 8);
+	len = get_word(frame_buf + 4);
+	if (len > TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE)
+		panic("frame payload too long");
+	recv_all(payload, len);
+
+	switch (frame_type)
+	{
+		case TARGET_COMM_FRAME_MEM_READ:
+			/* payload: address, number of bytes to read */
+			if (len != 8)
+				panic("");
+			addr = get_word(payload);
+			nbytes = get_word(payload + 4);
+			if (!nbytes || nbytes > TARGET_COMM_FRAME_MAX_DATA_SIZE)
+				panic("");
+			i = nbytes;
+			err = ctx->cc->core_mem_read(ctx, payload, addr, &nbytes);
+			if (err == GEAR_ERR_NO_ERROR && nbytes != i)
+				panic("");
+			send_frame(frame_type, err, seq, (err == GEAR_ERR_NO_ERROR) ? nbytes : 0);
+			break;
+		case TARGET_COMM_FRAME_MEM_WRITE:
+			/* payload: address, data bytes to write */
+			if (len <= 4)
+				panic("");
+			addr = get_word(payload);
+			nbytes = len - 4;
+			err = ctx->cc->core_mem_write(ctx, addr, payload + 4, &nbytes);
+			if (err == GEAR_ERR_NO_ERROR && nbytes != len - 4)
+				panic("");
+			send_frame(frame_type, err, seq, 0);
+			break;
+		case TARGET_COMM_FRAME_REGS_READ:
+			/* payload: register bitmap; for the bitmap format,
+			 * see the comments for the ascii register reading
+			 * request above */
+			if (len != 4)
+				panic("");
+			mask = get_word(payload);
+			if (!mask)
+				panic("");
+			err = GEAR_ERR_NO_ERROR;
+			for (i = nregs = 0; i < 19 && err == GEAR_ERR_NO_ERROR; i++)
+				if (mask & (1 << i))
+				{
+					if ((err = ctx->cc->core_reg_read(ctx, 0, 255, 1 << i, &reg)) == GEAR_ERR_NO_ERROR)
+						put_word(payload + 4 * nregs++, reg);
+				}
+			send_frame(frame_type, err, seq, (err == GEAR_ERR_NO_ERROR) ? 4 * nregs : 0);
+			break;
+		case TARGET_COMM_FRAME_REGS_WRITE:
+			/* payload: register bitmap, register values, one
+			 * for each bit set in the bitmap */
+			if (len < 4)
+				panic("");
+			mask = get_word(payload);
+			if (!mask)
+				panic("");
+			err = GEAR_ERR_NO_ERROR;
+			for (i = nregs = 0; i < 19 && err == GEAR_ERR_NO_ERROR; i++)
+				if (mask & (1 << i))
+				{
+					if (4 + 4 * nregs >= len)
+						panic("");
+					reg = get_word(payload + 4 + 4 * nregs++);
+					err = ctx->cc->core_reg_write(ctx, 0, 255, 1 << i, &reg);
+				}
+			send_frame(frame_type, err, seq, 0);
+			break;
+		case TARGET_COMM_FRAME_GET_STATE:
+			if (len)
+				panic("");
+			if ((err = ctx->cc->core_get_status(ctx, &state)) == GEAR_ERR_NO_ERROR)
+				payload[0] = state;
+			send_frame(frame_type, err, seq, (err == GEAR_ERR_NO_ERROR) ? 1 : 0);
+			break;
+		case TARGET_COMM_FRAME_SET_ENCODINGS:
+			/* payload: the bitmap of the payload encodings offered
+			 * by the gear engine; reply with the ones supported */
+			if (len != 4)
+				panic("");
+			payload_encodings = get_word(payload) & TARGET_COMM_PACK_ENCODINGS;
+			put_word(payload, payload_encodings);
+			send_frame(frame_type, GEAR_ERR_NO_ERROR, seq, 4);
+			break;
+		case TARGET_COMM_FRAME_MEM_READ_PACKED:
+			/* payload: address, number of bytes to read, bitmap of
+			 * the encodings acceptable for the reply; the bytes read
+			 * are sent unencoded if encoding does not shrink them */
+			if (len != 12)
+				panic("");
+			addr = get_word(payload);
+			nbytes = get_word(payload + 4);
+			if (!nbytes || nbytes > TARGET_COMM_FRAME_MAX_DATA_SIZE)
+				panic("");
+			i = nbytes;
+			err = ctx->cc->core_mem_read(ctx, unpacked_buf, addr, &nbytes);
+			if (err != GEAR_ERR_NO_ERROR)
+			{
+				send_frame(frame_type, err, seq, 0);
+				break;
+			}
+			if (nbytes != i)
+				panic("");
+			if ((i = target_comm_pack(get_word(payload + 8) & payload_encodings, payload + 4, nbytes,
+							unpacked_buf, nbytes, &encoding)) == -1)
+			{
+				encoding = TARGET_COMM_ENCODING_RAW;
+				memcpy(payload + 4, unpacked_buf, i = nbytes);
+			}
+			put_word(payload, encoding);
+			send_frame(frame_type, GEAR_ERR_NO_ERROR, seq, 4 + i);
+			break;
+		case TARGET_COMM_FRAME_MEM_WRITE_PACKED:
+			/* payload: address, encoding, number of bytes to
+			 * write, data bytes to write, encoded */
+			if (len < 12)
+				panic("");
+			addr = get_word(payload);
+			encoding = get_word(payload + 4);
+			nbytes = get_word(payload + 8);
+			if (!nbytes || nbytes > TARGET_COMM_FRAME_MAX_DATA_SIZE
+					|| encoding >= TARGET_COMM_NR_ENCODINGS
+					|| (encoding != TARGET_COMM_ENCODING_RAW && !(payload_encodings & (1 << encoding)))
+					|| target_comm_unpack(encoding, unpacked_buf, nbytes, payload + 12, len - 12))
+				panic("malformed packed frame");
+			i = nbytes;
+			err = ctx->cc->core_mem_write(ctx, addr, unpacked_buf, &nbytes);
+			if (err == GEAR_ERR_NO_ERROR && nbytes != i)
+				panic("");
+			send_frame(frame_type, err, seq, 0);
+			break;
+		case TARGET_COMM_FRAME_HALT_SNAPSHOT:
+			/* payload: register bitmap, number of memory windows,
+			 * memory window descriptors; for details, see the
+			 * comments in file target-comm-frame.h from the gear
+			 * engine source code package */
+			if (len < 8)
+				panic("");
+			mask = get_word(payload);
+			nwindows = get_word(payload + 4);
+			if (nwindows > TARGET_COMM_FRAME_MAX_SNAPSHOT_WINDOWS || len != 8 + 12 * nwindows)
+				panic("");
+			/* the reply is built in the same buffer as the
+			 * request, so save the window descriptors first */
+			for (i = 0; i < nwindows; i++)
+			{
+				windows[i].base_reg = get_word(payload + 8 + 12 * i);
+				windows[i].offset = get_word(payload + 12 + 12 * i);
+				windows[i].nbytes = get_word(payload + 16 + 12 * i);
+			}
+			if ((err = ctx->cc->core_get_status(ctx, &state)) != GEAR_ERR_NO_ERROR)
+			{
+				send_frame(frame_type, err, seq, 0);
+				break;
+			}
+			put_word(payload, state);
+			len = 4;
+			if (state == TARGET_CORE_STATE_HALTED)
+			{
+				for (i = 0; i < 19 && err == GEAR_ERR_NO_ERROR; i++)
+					if (mask & (1 << i))
+					{
+						if ((err = ctx->cc->core_reg_read(ctx, 0, 255, 1 << i, regs + i)) == GEAR_ERR_NO_ERROR)
+						{
+							put_word(payload + len, regs[i]);
+							len += 4;
+						}
+					}
+				if (err != GEAR_ERR_NO_ERROR)
+				{
+					send_frame(frame_type, err, seq, 0);
+					break;
+				}
+				for (i = 0; i < nwindows; i++)
+				{
+					if (windows[i].base_reg == 0xffffffff)
+						addr = windows[i].offset;
+					else if (windows[i].base_reg < 19 && (mask & (1 << windows[i].base_reg)))
+						addr = regs[windows[i].base_reg] + windows[i].offset;
+					else
+						panic("");
+					nbytes = windows[i].nbytes;
+					if (!nbytes || len + 8 + ((nbytes + 3) & ~ 3) > TARGET_COMM_FRAME_MAX_PAYLOAD_SIZE)
+						panic("");
+					err = ctx->cc->core_mem_read(ctx, payload + len + 8, addr, &nbytes);
+					if (err == GEAR_ERR_NO_ERROR && nbytes != windows[i].nbytes)
+						panic("");
+					if (err != GEAR_ERR_NO_ERROR)
+						nbytes = 0;
+					put_word(payload + len, err);
+					put_word(payload + len + 4, nbytes);
+					memset(payload + len + 8 + nbytes, 0, ((nbytes + 3) & ~ 3) - nbytes);
+					len += 8 + ((nbytes + 3) & ~ 3);
+				}
+			}
+			send_frame(frame_type, GEAR_ERR_NO_ERROR, seq, len);
+			break;
+		default:
+			panic("bad frame type");
+	}
+}
+
+int main(int argc, char ** argv)
 {
 int fd;	
 struct sockaddr_in addr;
@@ -382,6 +928,22 @@ struct target_ctl_context * ctx;
 
 
 	printf("target core controller stub - put your id here\n");
+	for (i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--reply-latency") && i + 1 < argc)
+			reply_latency_ms = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--reply-bandwidth") && i + 1 < argc)
+			reply_bandwidth = strtoul(argv[++i], 0, 0);
+		else
+		{
+			printf("usage: %s [--reply-latency milliseconds] [--reply-bandwidth bytes_per_second]\n", argv[0]);
+			exit(1);
+		}
+	}
+	if (reply_latency_ms)
+		printf("injecting %i ms of latency before each reply\n", reply_latency_ms);
+	if (reply_bandwidth)
+		printf("limiting the reply bandwidth to %lu bytes per second\n", reply_bandwidth);
 	printf("initializing gear communication channels...\n");
 
 #ifdef __LINUX__	
@@ -405,6 +967,14 @@ struct target_ctl_context * ctx;
 	{
 		panic("socket");
 	}
+#ifdef __LINUX__
+	/* allow restarting the controller right after a previous
+	 * instance has exited, without waiting for the old
+	 * connections to time out */
+	len = 1;
+	if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &len, sizeof len) == -1)
+		panic("setsockopt");
+#endif
 
 	/* create comm socket */
 	addr.sin_family = AF_INET;
@@ -430,7 +1000,7 @@ struct target_ctl_context * ctx;
 		printf("waiting for connection... ");
 		fflush(stdout);
 		len = sizeof addr;
-#ifdef __LINUIX__
+#ifdef __LINUX__
 		if ((gear_comm_fd = accept(fd, (struct sockaddr *) &addr, (socklen_t *) &len)) == -1)
 #else
 		if ((gear_comm_fd = accept(fd, (struct sockaddr *) &addr, &len)) == -1)
@@ -440,9 +1010,12 @@ struct target_ctl_context * ctx;
 		}
 		i = ntohl(addr.sin_addr.s_addr);
 		printf("ok, connection request accepted from %s\n", inet_ntoa(addr.sin_addr));
+		/* a new connection always starts with the ascii protocol */
+		is_binary_protocol_enabled = 0;
+		payload_encodings = 0;
 		printf("invoking core_open()");
 
-		if (ctx->cc->core_open(ctx, 0, 0, 0) != GEAR_ERR_NO_ERROR)
+		if (ctx->cc->core_open(ctx, 0, 0, 0, 0) != GEAR_ERR_NO_ERROR)
 			panic("");
 
 		/* request dispatch loop */
@@ -451,20 +1024,35 @@ struct target_ctl_context * ctx;
 			lex_vars.lex_idx = lex_vars.comm_buf_idx = 0;
 			lex_vars.mem_write_len = 0;
 			lex_vars.regmask = lex_vars.reg_nr = 0;
+			is_reply_delayed = 0;
+			wait_request();
+			/* binary frames bypass the request parser */
+			if (is_binary_protocol_enabled && is_frame_pending())
+			{
+				serve_frame(ctx);
+				continue;
+			}
 			if (yyparse(ctx))
 			{
 				if (lex_vars.is_scanner_aborted)
 				/* connection aborted */
 				{
 					printf("connection shut down\n");
+					discard_delayed_replies();
 					if (target_is_core_running(ctx))
 						/*! \todo	properly detach from the target */
 						panic("");
 					if (ctx->cc->core_close(ctx)
 							!= GEAR_ERR_NO_ERROR)
 						panic("");
+#ifdef __LINUX__
+					if (shutdown(gear_comm_fd, SHUT_RDWR))
+						panic("");
+					close(gear_comm_fd);
+#else
 					if (shutdown(gear_comm_fd, SD_BOTH))
 						panic("");
+#endif
 					printf("*** handle memory leaks here ***\n");
 					break;
 				}
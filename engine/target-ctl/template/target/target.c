@@ -9,7 +9,7 @@
 #include "target.h"
 #include "constants.h"
 
-static enum GEAR_ENGINE_ERR_ENUM core_open(struct target_ctl_context * ctx, const char * executable_fname, int argc, const char ** argv)
+static enum GEAR_ENGINE_ERR_ENUM core_open(struct target_ctl_context * ctx, const char * executable_fname, int argc, const char ** argv, const char ** errmsg_hint)
 {
 	return GEAR_ERR_NO_ERROR;
 }
@@ -67,11 +67,15 @@ static enum GEAR_ENGINE_ERR_ENUM core_clear_break(struct target_ctl_context * ct
 {
 	panic("");
 }
-static enum GEAR_ENGINE_ERR_ENUM core_step(struct target_ctl_context * ctx)
+static enum GEAR_ENGINE_ERR_ENUM core_run(struct target_ctl_context * ctx, unsigned thread_id/*ARM_CORE_WORD * halt_addr*/)
 {
 	panic("");
 }
-static enum GEAR_ENGINE_ERR_ENUM core_run(struct target_ctl_context * ctx, unsigned thread_id/*ARM_CORE_WORD * halt_addr*/)
+static enum GEAR_ENGINE_ERR_ENUM core_halt(struct target_ctl_context * ctx, unsigned thread_id)
+{
+	panic("");
+}
+static enum GEAR_ENGINE_ERR_ENUM core_insn_step(struct target_ctl_context * ctx, unsigned thread_id/*ARM_CORE_WORD * halt_addr*/)
 {
 	panic("");
 }
@@ -108,10 +112,12 @@ static struct core_access_struct core_funcs =
 	core_set_break,
 	/* core_clear_break */
 	core_clear_break,
-	/* core_step */
-	core_step,
 	/* core_run */
 	core_run,
+	/* core_halt */
+	core_halt,
+	/* core_insn_step */
+	core_insn_step,
 	/* io_ctl */
 	core_ioctl,
 	/* core_get_status */
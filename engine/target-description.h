@@ -30,6 +30,21 @@
  */
 
 
+/*! a target core register value of a target call stack frame, as used by fallback frame unwinders
+ *
+ * see the unwind_frame field in struct target_desc_struct below */
+struct tdesc_unwound_reg
+{
+	/*! nonzero, if the register value is known */
+	bool		is_valid;
+	/*! nonzero, if the register value has been saved in target memory, at address reg_addr below */
+	bool		is_stored_in_memory;
+	/*! the target address the register value has been saved at, if is_stored_in_memory is nonzero */
+	ARM_CORE_WORD	reg_addr;
+	/*! the register value, if is_valid is nonzero */
+	ARM_CORE_WORD	reg_val;
+};
+
 /*! target description data structure
  *
  * also read the comments at the start of this file */
@@ -175,5 +190,44 @@ struct target_desc_struct
 	 * or the given target memory address could not be accessed */
 	int (* print_disassembled_insn)(struct gear_engine_context * ctx, ARM_CORE_WORD addr,
 			int (*print_fn)(const char * format, ...));
+
+	/*! a fallback target call stack frame unwinder, for frames without call frame information
+	 *
+	 * this is used by the dwarf target stack frame register
+	 * unwinder (in module frame-reg-cache.c) for frames that the
+	 * call frame information of the executable does not cover
+	 * (e.g. code in libraries built without debug information,
+	 * assembly language code, exception entry sequences); it
+	 * computes the register values of the previous (older) frame
+	 * by target specific means (e.g. by scanning the prologue of
+	 * the function executing in the frame)
+	 *
+	 * 'cur_regs' holds the target core register values of the
+	 * frame to unwind, indexed by target core register number;
+	 * on success, the target core register values of the previous
+	 * frame are stored in 'prev_regs', and the canonical frame
+	 * address of the frame unwound (which becomes the stack pointer
+	 * value of the previous frame) is stored in '* cfa'; target
+	 * stack memory must be read by calling 'read_stack_word()',
+	 * which is supplied by the caller; '* is_exception_frame' is
+	 * set to true if the frame unwound is an exception frame - i.e.
+	 * if the previous frame has been interrupted by an exception,
+	 * so that its program counter value is the address of the next
+	 * instruction to execute, rather than a return address - and is
+	 * left untouched otherwise
+	 *
+	 * on success, the function returns GEAR_ERR_NO_ERROR; if
+	 * the frame cannot be unwound, it returns
+	 * GEAR_ERR_CANT_UNWIND_STACK_FRAME
+	 *
+	 * \note	this can be null, if the target does not
+	 *		support fallback frame unwinding */
+	enum GEAR_ENGINE_ERR_ENUM (* unwind_frame)(struct gear_engine_context * ctx,
+			const struct tdesc_unwound_reg cur_regs[],
+			struct tdesc_unwound_reg prev_regs[],
+			ARM_CORE_WORD * cfa,
+			bool * is_exception_frame,
+			enum GEAR_ENGINE_ERR_ENUM (* read_stack_word)(struct gear_engine_context * ctx,
+				ARM_CORE_WORD addr, ARM_CORE_WORD * val));
 };
 
@@ -388,6 +388,8 @@
 #include "target-defs.h"
 #include "core-access.h"
 #include "util.h"
+#include "mem-cache.h"
+#include "image-mem.h"
 
 /*
  *
@@ -1072,6 +1074,8 @@ struct gear_flash_data * gear_flash_data;
 				phdr = (Elf32_Phdr *)((char *) phdr
 						+ img_ehdr->e_phentsize);
 			}
+			/* target memory now matches the image */
+			image_mem_notify_image_loaded(ctx, elf_img_name);
 		}
 		/* cleanup */
 		if (ctx->cc->core_unregister_target_state_change_callback(ctx, flasher_target_state_change_callback)
@@ -1216,6 +1220,10 @@ struct gear_flash_data * gear_flash_data;
 					+ img_ehdr->e_phentsize);
 		}
 	}
+	/* target flash memory has been reprogrammed behind the back
+	 * of the memory cache, and now matches the image */
+	mem_cache_invalidate(ctx);
+	image_mem_notify_image_loaded(ctx, elf_img_name);
 	/* cleanup */
 	if (ctx->cc->core_unregister_target_state_change_callback(ctx, flasher_target_state_change_callback)
 			!= GEAR_ERR_NO_ERROR)
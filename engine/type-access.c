@@ -28,6 +28,8 @@
 #include <string.h>
 #include <stdarg.h>
 #include <limits.h>
+/* for elf_hash()... */
+#include <libelf.h>
 
 #include "dwarf-common.h"
 #include "target-defs.h"
@@ -44,6 +46,7 @@
 #include "symtab.h"
 
 #include "cxx-hacks.h"
+#include "node-alloc.h"
 
 /*
  *
@@ -239,41 +242,166 @@ Dwarf_Die child_die, sib_die;
 /*
  *
  * type hash operations
- * these are just stubs for the time being...
- *
- *	\todo	actually implement this
  *
  */
 
 
-/*! \todo document this */
-struct type_hash_node
-{
-	/*! the die offset for the described type */
-	Dwarf_Off		die_offset;
-	/*! pointer to the data type tree built for the type */
-	struct dtype_data	* dtype;
-	/*! link pointer for the hash table */
-	struct type_hash_node	* next;
-};
-
-/*! \todo document this */
+/*! the data type hash table, keyed by type die offset
+ *
+ * this is an open addressing hash table, with linear
+ * probing; the table size is always a power of two, and
+ * the table is doubled (and rehashed) whenever its load
+ * factor would exceed TYPE_HASH_MAX_LOAD_PERCENT; entries
+ * are never deleted from the table (they may only be
+ * redirected to another data type node, see
+ * hash_replace_type()), so no tombstones are needed;
+ * a slot is free if, and only if, its dtype field is null
+ *
+ * type die offsets are strongly clustered (type dies
+ * of a compilation unit are usually laid out next
+ * to each other), so they are passed through an integer
+ * mixer before being reduced to a slot index - see
+ * type_hash_offset(); the table also keeps some statistics
+ * on its efficiency - these can be dumped by
+ * dtype_access_dump_hash_stats()
+ *
+ * the table also holds an index of named data types, keyed
+ * by type name, which is used for merging identical data types
+ * (see dedup_type()); named data types are deliberately not
+ * put in the symbol table - it is used for resolving the
+ * identifiers of data objects and subprograms, and type names
+ * (structure, union and enumeration tags in particular, which
+ * live in a namespace of their own) would clash there with the
+ * names of data objects */
 struct type_hash
 {
-	int	tcache_nodes;
-	struct dtype_data	* tcache;
+	/*! the number of slots in the htab array below; always a power of two */
 	int	htab_size;
-	struct type_hash_node	* htab[0];
+	/*! the number of slots used in the htab array below */
+	int	nr_entries;
+	/*! the number of times the table has been grown */
+	int	nr_grows;
+	/*! the number of lookups performed on the table (both for retrieval and for insertion) */
+	unsigned long	nr_lookups;
+	/*! the total number of slots examined by all lookups; nr_probes / nr_lookups gives the average probe length */
+	unsigned long	nr_probes;
+	/*! the number of lookups that did not find their key (or a free slot) in the first slot examined */
+	unsigned long	nr_collisions;
+	/*! the maximum number of slots examined by a single lookup */
+	int	max_probe_len;
+	/*! the hash table slots */
+	struct type_hash_node
+	{
+		/*! the die offset for the described type */
+		Dwarf_Off		die_offset;
+		/*! pointer to the data type tree built for the type; null for free slots */
+		struct dtype_data	* dtype;
+	}
+	* htab;
+	/*! the named data type index; a chained hash table of TYPE_NAME_HTAB_SIZE slots, keyed by type name */
+	struct type_name_node
+	{
+		/*! the named data type node */
+		struct dtype_data	* dtype;
+		/*! link pointer for the hash chain */
+		struct type_name_node	* next;
+	}
+	** names_htab;
 };
 
+/*! the initial number of slots in the type hash table */
+#define TYPE_HASH_MIN_SIZE		4096
+/*! the maximum load factor of the type hash table, in percent, before it gets grown */
+#define TYPE_HASH_MAX_LOAD_PERCENT	50
+/*! the number of slots in the named data type index */
+#define TYPE_NAME_HTAB_SIZE		4093
+
+/*!
+ *	\fn	static unsigned int type_hash_offset(Dwarf_Off die_offset)
+ *	\brief	computes the hash value of a type die offset
+ *
+ *	this is the same integer mixer as the one used for
+ *	the compilation unit hash table (the fibonacci hashing
+ *	multiplier, with the high bits folded down) - see
+ *	cu_hash_offset() in cu-hash.c
+ *
+ *	\param	die_offset	the die offset to hash
+ *	\return	the hash value for die_offset
+ */
+static unsigned int type_hash_offset(Dwarf_Off die_offset)
+{
+unsigned long long x;
+
+	x = (unsigned long long) die_offset * 0x9e3779b97f4a7c15ULL;
+	return (unsigned int) (x >> 32) ^ (unsigned int) x;
+}
+
+/*!
+ *	\fn	static struct type_hash_node * hash_find_slot(struct type_hash * p, Dwarf_Off die_offset)
+ *	\brief	locates the hash table slot for a type die offset
+ *
+ *	this also updates the hash table probe statistics
+ *
+ *	\param	p	the hash table to search
+ *	\param	die_offset	the offset of the type die of interest
+ *	\return	the slot holding the type die at offset ::die_offset,
+ *		if present in the table, otherwise - the free slot at
+ *		which the type die should be inserted
+ */
+static struct type_hash_node * hash_find_slot(struct type_hash * p, Dwarf_Off die_offset)
+{
+int i, len;
+
+	p->nr_lookups++;
+	for (len = 1, i = type_hash_offset(die_offset) & (p->htab_size - 1);
+			p->htab[i].dtype && p->htab[i].die_offset != die_offset;
+			len++, i = (i + 1) & (p->htab_size - 1))
+		;
+	p->nr_probes += len;
+	if (len > 1)
+		p->nr_collisions++;
+	if (len > p->max_probe_len)
+		p->max_probe_len = len;
+	return p->htab + i;
+}
+
+/*!
+ *	\fn	static void grow_type_hash(struct type_hash * p)
+ *	\brief	doubles the size of the type hash table and rehashes its entries
+ *
+ *	\param	p	the hash table to grow
+ *	\return	none
+ */
+static void grow_type_hash(struct type_hash * p)
+{
+struct type_hash_node * old_htab;
+int old_size;
+int i, j;
+
+	old_htab = p->htab;
+	old_size = p->htab_size;
+	p->htab_size <<= 1;
+	if (!(p->htab = calloc(p->htab_size, sizeof * p->htab)))
+		panic("out of core");
+	for (i = 0; i < old_size; i++)
+	{
+		if (!old_htab[i].dtype)
+			continue;
+		for (j = type_hash_offset(old_htab[i].die_offset) & (p->htab_size - 1);
+				p->htab[j].dtype;
+				j = (j + 1) & (p->htab_size - 1))
+			;
+		p->htab[j] = old_htab[i];
+	}
+	free(old_htab);
+	p->nr_grows++;
+}
 
 /*!
  *	\fn	static struct dtype_data * hash_get_type(struct gear_engine_context * ctx, Dwarf_Off die_offset)
  *	\brief	retrieves a pointer to the data type described by the die at
  *		offset ::die_offset, if present
  *
- *	\todo	actually implement this
- *
  *	\param	ctx	context used to access the type hash table
  *	\param	die_offset	the offset of the type die of interest
  *	\return	pointer to the type data for the type die at offset ::die_offset, or
@@ -282,24 +410,40 @@ struct type_hash
 
 static struct dtype_data * hash_get_type(struct gear_engine_context * ctx, Dwarf_Off die_offset)
 {
-struct type_hash_node * p;
+	return hash_find_slot(ctx->types, die_offset)->dtype;
+}
+
+/*!
+ *	\fn	static void hash_replace_type(struct gear_engine_context * ctx, Dwarf_Off die_offset, struct dtype_data * dtype)
+ *	\brief	redirects a type die offset already in the hash table to another data type node
+ *
+ *	this is used when a data type node just built turns out to be
+ *	a duplicate of an already existing one (see ::is_type_dedup_enabled
+ *	in the gear engine context settings)
+ *
+ *	\param	ctx	gear engine context data structure, used to access
+ *			the data types hash table
+ *	\param	die_offset	the offset of the data type die of interest
+ *	\param	dtype		the data node to use for this die offset from now on
+ *	\return	none
+ */
 
-	p = ctx->types->htab[die_offset % ctx->types->htab_size];
+static void hash_replace_type(struct gear_engine_context * ctx, Dwarf_Off die_offset, struct dtype_data * dtype)
+{
+struct type_hash_node * p;
 
-	while (p)
-	{
-		if (p->die_offset == die_offset)
-			break;
-		p = p->next;
-	}
-	return p ? p->dtype : 0;
+	p = hash_find_slot(ctx->types, die_offset);
+	if (!p->dtype || !dtype)
+		panic("");
+	p->dtype = dtype;
 }
 
 /*!
  * 	\fn	static void hash_put_type(struct gear_engine_context * ctx, Dwarf_Off die_offset, struct dtype_data * dtype)
  *	\brief	put a data type node in the hash table for the file being debugged
  *
- *	\todo	actually implement this
+ *	\note	it is a fatal error to attempt inserting a
+ *		data type that is already in the table
  *
  *	\param	ctx	gear engine context data structure, used to access
  *			the data types hash table
@@ -310,10 +454,16 @@ struct type_hash_node * p;
 
 static void hash_put_type(struct gear_engine_context * ctx, Dwarf_Off die_offset, struct dtype_data * dtype)
 {
+struct type_hash * t;
 struct type_hash_node * p;
-int idx;
 
-	if (hash_get_type(ctx, die_offset))
+	if (!dtype)
+		panic("");
+	t = ctx->types;
+	if ((t->nr_entries + 1) * 100 > t->htab_size * TYPE_HASH_MAX_LOAD_PERCENT)
+		grow_type_hash(t);
+	p = hash_find_slot(t, die_offset);
+	if (p->dtype)
 	{
 		Dwarf_Die die;
 		Dwarf_Error err;
@@ -328,14 +478,9 @@ int idx;
 		gprintf("cu die offset %i\n", (int) offset);
 		panic("data type already in hash table");
 	}
-	if (!(p = malloc(sizeof(struct type_hash_node))))
-		panic("out of core");
-	/* just put it in front of the list */
 	p->dtype = dtype;
 	p->die_offset = die_offset;
-	idx = die_offset % ctx->types->htab_size;
-	p->next = ctx->types->htab[idx];
-	ctx->types->htab[idx] = p;
+	t->nr_entries++;
 
 	/*! \todo	remove this, debug only */
 	dtype->head.die_offset = die_offset;
@@ -346,32 +491,280 @@ int idx;
  *	\fn	static struct dtype_data * get_dtype_node(struct gear_engine_context * ctx)
  *	\brief	allocates memory for a dtype_data structure and initializes it
  *
+ *	\param	ctx	context to work in
  *	\return	a pointer to the newly allocated dtype_data data structure
  */
 
 static struct dtype_data * get_dtype_node(struct gear_engine_context * ctx)
 {
-#if 1
-struct dtype_data * p;
-#define TCACHE_GROW_STEP	256
+	return node_alloc(ctx, NODE_KIND_DTYPE, sizeof(struct dtype_data));
+}
 
-	if (!ctx->types->tcache_nodes)
+/*!
+ *	\fn	static void put_dtype_node(struct gear_engine_context * ctx, struct dtype_data * p)
+ *	\brief	gives back a dtype_data structure allocated by get_dtype_node()
+ *
+ *	this is used for dropping a data type node that has turned
+ *	out to be a duplicate of an already existing one
+ *
+ *	\param	ctx	context to work in
+ *	\param	p	the node to give back; nothing may be referencing it
+ *	\return	none
+ */
+
+static void put_dtype_node(struct gear_engine_context * ctx, struct dtype_data * p)
+{
+	node_unalloc(ctx, NODE_KIND_DTYPE, p, sizeof(struct dtype_data));
+}
+
+/*!
+ *	\fn	static bool are_names_equal(const char * s1, const char * s2)
+ *	\brief	compares two (possibly null) type names
+ *
+ *	\param	s1	the first name to compare, may be null
+ *	\param	s2	the second name to compare, may be null
+ *	\return	true, if both names are null, or if both are non-null
+ *		and equal, false otherwise
+ */
+static bool are_names_equal(const char * s1, const char * s2)
+{
+	if (!s1 || !s2)
+		return s1 == s2;
+	return !strcmp(s1, s2);
+}
+
+/*!
+ *	\fn	static bool are_types_identical(struct dtype_data * t1, struct dtype_data * t2)
+ *	\brief	determines if two data types are structurally identical
+ *
+ *	this is much stricter than dtype_access_are_types_compatible() -
+ *	names, sizes, member locations, qualifiers, etc. all must match;
+ *	this is used for merging data types that have been duplicated
+ *	across compilation units (see dedup_type())
+ *
+ *	\note	pointers are not recursed through - when comparing
+ *		two pointer types, pointer, type qualifier and typedef
+ *		chains are followed down to the first other type,
+ *		and the two types found are then only compared by
+ *		class, size and name; this is what keeps the comparison
+ *		from looping forever on self-referential types
+ *		(e.g. 'struct list { struct list * next; };') - the
+ *		only way to build a cycle in a c type is through a pointer
+ *	\note	cxx classes with base classes or member functions
+ *		are never considered identical
+ *
+ *	\param t1	a pointer to the first type to be compared
+ *	\param t2	a pointer to the second type to be compared
+ *	\return	true, if the types t1 and t2 are identical,
+ *		false otherwise
+ */
+static bool are_types_identical(struct dtype_data * t1, struct dtype_data * t2)
+{
+int i;
+
+	if (t1 == t2)
+		return true;
+	if (!t1 || !t2)
+		return false;
+	if (t1->dtype_class != t2->dtype_class
+			|| t1->data_size != t2->data_size
+			|| t1->is_node_a_declaration != t2->is_node_a_declaration
+			|| !are_names_equal(t1->name, t2->name))
+		return false;
+	switch (t1->dtype_class)
 	{
-		if (!(p = (struct dtype_data * ) calloc(TCACHE_GROW_STEP, sizeof * p)))
-			panic("out of core");
-		ctx->types->tcache = p;
-		ctx->types->tcache_nodes = TCACHE_GROW_STEP;
+		case DTYPE_CLASS_BASE_TYPE:
+			return t1->base_type_encoding == t2->base_type_encoding;
+		case DTYPE_CLASS_PTR:
+			t1 = t1->ptr_type;
+			t2 = t2->ptr_type;
+			while (t1 && t2 && t1 != t2 && t1->dtype_class == t2->dtype_class)
+			{
+				if (t1->dtype_class == DTYPE_CLASS_PTR)
+				{
+					t1 = t1->ptr_type;
+					t2 = t2->ptr_type;
+				}
+				else if (t1->dtype_class == DTYPE_CLASS_TYPE_QUALIFIER)
+				{
+					if (t1->type_qualifier_data.qualifier_id
+							!= t2->type_qualifier_data.qualifier_id)
+						return false;
+					t1 = t1->type_qualifier_data.type;
+					t2 = t2->type_qualifier_data.type;
+				}
+				else if (t1->dtype_class == DTYPE_CLASS_TYPEDEF)
+				{
+					if (!are_names_equal(t1->name, t2->name))
+						return false;
+					t1 = t1->typedef_data.type;
+					t2 = t2->typedef_data.type;
+				}
+				else
+					break;
+			}
+			if (t1 == t2)
+				return true;
+			if (!t1 || !t2)
+				return false;
+			return t1->dtype_class == t2->dtype_class
+				&& t1->data_size == t2->data_size
+				&& are_names_equal(t1->name, t2->name);
+		case DTYPE_CLASS_TYPEDEF:
+			return are_types_identical(t1->typedef_data.type, t2->typedef_data.type);
+		case DTYPE_CLASS_TYPE_QUALIFIER:
+			return t1->type_qualifier_data.qualifier_id == t2->type_qualifier_data.qualifier_id
+				&& are_types_identical(t1->type_qualifier_data.type, t2->type_qualifier_data.type);
+		case DTYPE_CLASS_MEMBER:
+			return t1->member_data.member_location == t2->member_data.member_location
+				&& t1->member_data.bit_size == t2->member_data.bit_size
+				&& t1->member_data.bit_offset == t2->member_data.bit_offset
+				&& are_types_identical(t1->member_data.member_type, t2->member_data.member_type);
+		case DTYPE_CLASS_STRUCT:
+		case DTYPE_CLASS_UNION:
+			if (t1->struct_data.inherited_bases || t2->struct_data.inherited_bases
+					|| t1->struct_data.member_functions || t2->struct_data.member_functions)
+				return false;
+			t1 = t1->struct_data.data_members;
+			t2 = t2->struct_data.data_members;
+			while (t1 && t2)
+			{
+				if (!are_types_identical(t1, t2))
+					return false;
+				t1 = t1->member_data.sib_ptr;
+				t2 = t2->member_data.sib_ptr;
+			}
+			return !t1 && !t2;
+		case DTYPE_CLASS_ENUMERATION:
+			if (t1->enum_data.nr_enumerators != t2->enum_data.nr_enumerators)
+				return false;
+			for (i = 0; i < t1->enum_data.nr_enumerators; i++)
+				if (t1->enum_data.enumerators[i].enum_const != t2->enum_data.enumerators[i].enum_const
+						|| strcmp(t1->enum_data.enumerators[i].name, t2->enum_data.enumerators[i].name))
+					return false;
+			return true;
+		case DTYPE_CLASS_ARRAY:
+			if (!are_types_identical(t1->arr_data.element_type, t2->arr_data.element_type))
+				return false;
+			t1 = t1->arr_data.subranges;
+			t2 = t2->arr_data.subranges;
+			while (t1 && t2)
+			{
+				if (t1->arr_subrange_data.upper_bound != t2->arr_subrange_data.upper_bound)
+					return false;
+				t1 = t1->arr_subrange_data.sib_ptr;
+				t2 = t2->arr_subrange_data.sib_ptr;
+			}
+			return !t1 && !t2;
+		default:
+			return false;
 	}
-	p = ctx->types->tcache ++;
-	ctx->types->tcache_nodes --;
-	return p;
-#else	
-struct dtype_data * p;
+}
 
-	if (!(p = (struct dtype_data * ) calloc(1, sizeof * p)))
-		panic("out of core");
-	return p;
-#endif	
+/*!
+ *	\fn	static struct type_name_node ** find_named_type_chain(struct gear_engine_context * ctx, const char * name)
+ *	\brief	locates the hash chain in the named data type index for a type name
+ *
+ *	\param	ctx	context to work in
+ *	\param	name	the type name of interest
+ *	\return	a pointer to the head of the hash chain for ::name
+ */
+static struct type_name_node ** find_named_type_chain(struct gear_engine_context * ctx, const char * name)
+{
+	return ctx->types->names_htab + elf_hash(name) % TYPE_NAME_HTAB_SIZE;
+}
+
+/*!
+ *	\fn	static void add_named_type(struct gear_engine_context * ctx, struct dtype_data * p)
+ *	\brief	records a named data type node in the named data type index
+ *
+ *	\param	ctx	context to work in
+ *	\param	p	the data type node to record
+ *	\return	none
+ */
+static void add_named_type(struct gear_engine_context * ctx, struct dtype_data * p)
+{
+struct type_name_node ** chain, * n;
+
+	chain = find_named_type_chain(ctx, p->name);
+	n = node_alloc(ctx, NODE_KIND_TYPE_NAME, sizeof * n);
+	n->dtype = p;
+	n->next = * chain;
+	* chain = n;
+}
+
+/*!
+ *	\fn	static struct dtype_data * dedup_type(struct gear_engine_context * ctx, Dwarf_Off die_offset, struct dtype_data * p)
+ *	\brief	merges a (named) data type node just built with an identical, already existing one, if any
+ *
+ *	this is only used when data type deduplication is enabled (see
+ *	::is_type_dedup_enabled in the gear engine context settings);
+ *	c (and especially c++) programs typically have the same types
+ *	(the ones declared in commonly included header files) described
+ *	over and over again in each compilation unit; when deduplication
+ *	is enabled, named types are recorded in the named data type
+ *	index, and each new named type is looked up there and, if an
+ *	identical (see are_types_identical()) type is found, the type
+ *	die offset (and, for structures and unions, the die offsets of
+ *	the data members) is redirected in the type hash table to the
+ *	already existing node, so that all subsequent references to
+ *	the type die resolve to the same node
+ *
+ *	the duplicate node (along with its data member nodes) is then
+ *	given back with put_dtype_node(), unless a reference to it
+ *	has already been handed out from the type hash table (e.g.
+ *	for self-referential structures, such as
+ *	'struct list { struct list * next; };') - see ::is_referenced
+ *	in struct dtype_data
+ *
+ *	\param	ctx	context to work in
+ *	\param	die_offset	the offset of the type die from which node
+ *			::p has been built
+ *	\param	p	the data type node just built
+ *	\return	the data type node to use for the type die at
+ *		offset ::die_offset; this is either an already existing
+ *		node identical to ::p, or ::p itself, if no such node exists
+ */
+static struct dtype_data * dedup_type(struct gear_engine_context * ctx, Dwarf_Off die_offset, struct dtype_data * p)
+{
+struct type_name_node * n;
+struct dtype_data * q, * pm, * qm, * next;
+bool is_aggregate, is_referenced;
+
+	if (!p->name || p->is_node_a_declaration)
+		return p;
+	for (n = * find_named_type_chain(ctx, p->name); n; n = n->next)
+		if (are_types_identical(n->dtype, p))
+			break;
+	if (!n)
+	{
+		add_named_type(ctx, p);
+		return p;
+	}
+	q = n->dtype;
+	hash_replace_type(ctx, die_offset, q);
+	type_access_stats.nr_deduplicated_type_nodes ++;
+
+	is_referenced = p->is_referenced;
+	is_aggregate = p->dtype_class == DTYPE_CLASS_STRUCT || p->dtype_class == DTYPE_CLASS_UNION;
+	if (is_aggregate)
+		/* the data member lists are identical - redirect the data member dies as well */
+		for (pm = p->struct_data.data_members, qm = q->struct_data.data_members;
+				pm; pm = pm->member_data.sib_ptr, qm = qm->member_data.sib_ptr)
+		{
+			hash_replace_type(ctx, pm->head.die_offset, qm);
+			is_referenced = is_referenced || pm->is_referenced;
+		}
+	if (is_referenced)
+		return q;
+	if (is_aggregate)
+		for (pm = p->struct_data.data_members; pm; pm = next)
+		{
+			next = pm->member_data.sib_ptr;
+			put_dtype_node(ctx, pm);
+		}
+	put_dtype_node(ctx, p);
+	return q;
 }
 
 /*!
@@ -1296,6 +1689,7 @@ int res;
 
 	if ((p = hash_get_type(ctx, type_die_offset)))
 	{
+		p->is_referenced = true;
 		return p;
 	}
 
@@ -1761,32 +2155,26 @@ type_access_stats.nr_arr_type_nodes ++;
 			/*! \todo	comment what is being done here */
 			if (1 && p->name)
 			{
-				struct sym_struct	* sym;
-				sym = symtab_find_sym(ctx, p->name);
-				while (sym)
+				struct type_name_node	* n;
+				for (n = * find_named_type_chain(ctx, p->name); n; n = n->next)
 				{
-					if (sym->symclass == SYM_TYPE
-							&& dtype_access_are_types_compatible(sym->dtype, p))
+					if (n->dtype->dtype_class == DTYPE_CLASS_ENUMERATION
+							&& dtype_access_are_types_compatible(n->dtype, p))
 					{
 						for (i = 0; i < p->enum_data.nr_enumerators; i++)
 							dwarf_dealloc(ctx->dbg,
 									p->enum_data.enumerators[i].name,
 									DW_DLA_STRING);
 						free(p->enum_data.enumerators);
-						//free(p);
-						memset(p, 0, sizeof * p);
-						ctx->types->tcache --;
-						ctx->types->tcache_nodes ++;
+						put_dtype_node(ctx, p);
 
-						p = sym->dtype;
+						p = n->dtype;
 						break;
 					}
-
-					sym = sym->next;
 				}
-				if (!sym)
+				if (!n)
 				{
-					symtab_store_sym(ctx, p->name, SYM_TYPE, p);
+					add_named_type(ctx, p);
 					type_access_stats.nr_enumeration_nodes ++;
 				}
 			}
@@ -1864,6 +2252,8 @@ type_access_stats.nr_ptr_nodes ++;
 			}
 			p->typedef_data.type = type_process(ctx, type_die);
 			dwarf_dealloc(ctx->dbg, type_die, DW_DLA_DIE);
+			if (ctx->settings.is_type_dedup_enabled)
+				p = dedup_type(ctx, type_die_offset, p);
 
 type_access_stats.nr_typedef_nodes ++;			
 
@@ -2132,6 +2522,8 @@ printf("warning: zero-sized data object\n");
 				dwarf_dealloc(ctx->dbg, child_die, DW_DLA_DIE);
 				child_die = sib_die;
 			}
+			if (ctx->settings.is_type_dedup_enabled)
+				p = dedup_type(ctx, type_die_offset, p);
 
 			break;
 		}
@@ -2276,61 +2668,22 @@ type_access_stats.nr_member_nodes ++;
 				panic("dwarf_formudata()");
 			dwarf_dealloc(ctx->dbg, attr, DW_DLA_ATTR);
 			p->base_type_encoding = return_uvalue;
-			/* see if the type already is present in the 
-			 * symbol table */
-			/* HACKS HACKS HACKS */
-			if (0) {
-				struct sym_struct	* sym;
-				sym = symtab_find_sym(ctx, p->name);
-				while (sym)
+			/* see if an identical type has already been
+			 * built; if so, dedup_type() gives back the
+			 * duplicate node */
+			if (ctx->settings.is_type_dedup_enabled)
+			{
+				struct dtype_data * p1;
+				p1 = dedup_type(ctx, type_die_offset, p);
+				if (p1 != p)
 				{
-					if (sym->symclass == SYM_TYPE)
-					{
-					struct dtype_data * p1;
-					p1 = sym->dtype;
-						if (p1->dtype_class == p->dtype_class
-								&& p1->data_size == p->data_size
-								&& !strcmp(p1->name, p->name))
-						{
-
-
-{
-struct type_hash_node * px;
-
-	px = ctx->types->htab[type_die_offset % ctx->types->htab_size];
-
-	while (px)
-	{
-		if (px->die_offset == type_die_offset)
-			break;
-		px = px->next;
-	}
-	if (!px)
-		panic("");
-	px->dtype = p1;
-}
-
-							ctx->types->tcache --;
-							ctx->types->tcache_nodes ++;
-							p = p1;
-							break;
-						}
-					}
-					sym = sym->next;
+					p = p1;
+					break;
 				}
-				if (!sym)
-{
-
-type_access_stats.nr_base_type_nodes ++;
-
-					symtab_store_sym(ctx, p->name, SYM_TYPE, p);
-}
 			}
-		else
-type_access_stats.nr_base_type_nodes ++;
-		}
 type_access_stats.nr_base_type_nodes ++;			
 			break;
+		}
 
 		case DW_TAG_volatile_type:
 			p->type_qualifier_data.qualifier_id = TYPE_QUALIFIER_VOLATILE;
@@ -3477,16 +3830,79 @@ struct dtype_data * dtype_access_get_unqualified_base_type(struct dtype_data * t
  *	\return	none */
 void init_types(struct gear_engine_context * ctx)
 {
-int size;
-/*! \todo	make the size adjustable */
-#define HTAB_SIZE	39989
+struct type_hash * p;
 
+	if (!(p = calloc(1, sizeof * p)))
+		panic("out of core");
+	if (!(p->htab = calloc(TYPE_HASH_MIN_SIZE, sizeof * p->htab)))
+		panic("out of core");
+	if (!(p->names_htab = calloc(TYPE_NAME_HTAB_SIZE, sizeof * p->names_htab)))
+		panic("out of core");
+	p->htab_size = TYPE_HASH_MIN_SIZE;
+	ctx->types = p;
+}
 
-	/*! \todo	make the size adjustable */
-	size = sizeof * ctx->types + HTAB_SIZE * sizeof(struct type_hash_node *);
-	if (!(ctx->types = malloc(size)))
-		panic("");
-	memset(ctx->types, 0, size);
-	ctx->types->htab_size = HTAB_SIZE;
+/*!
+ *	\fn	void discard_types(struct gear_engine_context * ctx)
+ *	\brief	deallocates the data type hash table
+ *
+ *	the data type nodes themselves (and the nodes of the
+ *	named data type index) are owned by the node
+ *	allocator, and are deallocated by node_alloc_free_all()
+ *
+ *	\param	ctx	context to work in
+ *	\return	none */
+void discard_types(struct gear_engine_context * ctx)
+{
+	if (!ctx->types)
+		return;
+	free(ctx->types->htab);
+	free(ctx->types->names_htab);
+	free(ctx->types);
+	ctx->types = 0;
+}
+
+/*!
+ *	\fn	void dtype_access_dump_hash_stats(struct gear_engine_context * ctx)
+ *	\brief	dumps data type hash table statistics
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void dtype_access_dump_hash_stats(struct gear_engine_context * ctx)
+{
+struct type_hash * p;
+
+	p = ctx->types;
+	gprintf("type hash table statistics:\n");
+	gprintf("size == %i, entries == %i, grows == %i\n", p->htab_size, p->nr_entries, p->nr_grows);
+	gprintf("lookups == %lu, collisions == %lu, probes == %lu, max probe length == %i\n",
+			p->nr_lookups, p->nr_collisions, p->nr_probes, p->max_probe_len);
+	if (p->nr_lookups)
+		gprintf("average probe length == %i.%02i\n",
+				(int) (p->nr_probes / p->nr_lookups),
+				(int) (p->nr_probes * 100 / p->nr_lookups % 100));
+	gprintf("deduplicated type nodes == %i\n", type_access_stats.nr_deduplicated_type_nodes);
+}
+
+/*!
+ *	\fn	void dtype_access_dump_mem_usage_mi(struct gear_engine_context * ctx)
+ *	\brief	dumps data type hash table statistics, in machine interface format
+ *
+ *	\param	ctx	context to work in
+ *	\return	none
+ */
+void dtype_access_dump_mem_usage_mi(struct gear_engine_context * ctx)
+{
+struct type_hash * p;
+
+	p = ctx->types;
+	miprintf("TYPE_HASH = [SIZE = %i, NR_ENTRIES = %i, BYTES = %lu, NR_GROWS = %i, "
+			"NR_LOOKUPS = %lu, NR_COLLISIONS = %lu, NR_PROBES = %lu, MAX_PROBE_LEN = %i, "
+			"NR_DEDUPLICATED = %i,],",
+			p->htab_size, p->nr_entries,
+			(unsigned long) (p->htab_size * sizeof * p->htab), p->nr_grows,
+			p->nr_lookups, p->nr_collisions, p->nr_probes, p->max_probe_len,
+			type_access_stats.nr_deduplicated_type_nodes);
 }
 
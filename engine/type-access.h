@@ -250,6 +250,14 @@ struct dtype_data
 		 * read the comments about the member_data.member_location
 		 * field below */ 
 		bool	is_node_a_static_cxx_struct_member	: 1;
+		/*! set when a reference to this node has been handed out from the type hash table
+		 *
+		 * a data type node that turns out to be a duplicate
+		 * of an already existing one can only be released if
+		 * nothing can be referencing it - i.e., if this is still
+		 * clear when the node has been built; see dedup_type()
+		 * in type-access.c */
+		bool	is_referenced	: 1;
 	};
 	/*! reference counter for this type
 	 *
@@ -528,6 +536,9 @@ struct dtype_data * dtype_access_get_deref_type(struct dtype_data * type);
 struct dtype_data * dtype_access_get_unqualified_base_type(struct dtype_data * type);
 
 void init_types(struct gear_engine_context * ctx);
+void discard_types(struct gear_engine_context * ctx);
+void dtype_access_dump_hash_stats(struct gear_engine_context * ctx);
+void dtype_access_dump_mem_usage_mi(struct gear_engine_context * ctx);
 
 #endif /* __TYPE_ACCESS_H__ */
 
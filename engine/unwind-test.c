@@ -116,6 +116,7 @@ static enum GEAR_ENGINE_ERR_ENUM register_runctl_callback(struct gear_engine_con
 }
 
 extern void dwarf_hacked_init(struct gear_engine_context * ctx);
+extern void dwarf_hacked_shutdown(struct gear_engine_context * ctx);
 extern struct srcinfo_type_struct * srcfile_get_srcinfo(struct gear_engine_context * ctx);
 
 static struct core_control target_cc =
@@ -234,6 +235,7 @@ uint32_t pc;
 	}
 	while (frame_move_to_relative(& ctx, -1, 0) == GEAR_ERR_NO_ERROR);
 
+	dwarf_hacked_shutdown(& ctx);
 	return 0;
 }
 